@@ -4,6 +4,8 @@
 #  FFTW3_FOUND - system has FFTW3
 #  FFTW3_INCLUDE_DIR - the FFTW3 include directory
 #  FFTW3_LIBRARIES - Link these to use FFTW3
+#  FFTW3_THREADS_FOUND - system has the FFTW3 threads library
+#  FFTW3_THREADS_LIBRARIES - Link these to use multithreaded FFTW3
 #  FFTW3_VERSION_STRING - Human readable version number of fftw3
 #  FFTW3_VERSION_MAJOR  - Major version number of fftw3
 #  FFTW3_VERSION_MINOR  - Minor version number of fftw3
@@ -50,3 +52,21 @@ else (FFTW3_LIBRARIES)
   mark_as_advanced(FFTW3_LIBRARIES)
   
 endif (FFTW3_LIBRARIES)
+
+# The threads library is optional
+if (FFTW3_FOUND AND NOT FFTW3_THREADS_LIBRARIES)
+  find_library(FFTW3_THREADS_LIBRARIES NAMES fftw3_threads
+    PATHS
+    ${_obLinkDir}
+    ${GNUWIN32_DIR}/lib
+    /usr/local/lib
+  )
+  mark_as_advanced(FFTW3_THREADS_LIBRARIES)
+endif (FFTW3_FOUND AND NOT FFTW3_THREADS_LIBRARIES)
+
+if (FFTW3_THREADS_LIBRARIES)
+  set(FFTW3_THREADS_FOUND TRUE)
+else (FFTW3_THREADS_LIBRARIES)
+  set(FFTW3_THREADS_FOUND FALSE)
+  set(FFTW3_THREADS_LIBRARIES "")
+endif (FFTW3_THREADS_LIBRARIES)
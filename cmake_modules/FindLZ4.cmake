@@ -0,0 +1,50 @@
+# - Try to find LZ4
+# Once done this will define
+#
+#  LZ4_FOUND - system has LZ4
+#  LZ4_INCLUDE_DIR - the LZ4 include directory
+#  LZ4_LIBRARIES - Link these to use LZ4
+
+# Redistribution and use is allowed according to the terms of the BSD license.
+# For details see the accompanying COPYING-CMAKE-SCRIPTS file.
+
+if (LZ4_INCLUDE_DIR AND LZ4_LIBRARIES)
+
+  # in cache already
+  set(LZ4_FOUND TRUE)
+  message(STATUS "Found LZ4: ${LZ4_LIBRARIES}")
+
+else (LZ4_INCLUDE_DIR AND LZ4_LIBRARIES)
+
+  find_path(LZ4_INCLUDE_DIR lz4frame.h
+    ${_obIncDir}
+    ${GNUWIN32_DIR}/include
+    /usr/local/include
+  )
+
+  find_library(LZ4_LIBRARIES NAMES lz4
+    PATHS
+    ${_obLinkDir}
+    ${GNUWIN32_DIR}/lib
+    /usr/local/lib
+  )
+
+  if(LZ4_INCLUDE_DIR AND LZ4_LIBRARIES)
+    set(LZ4_FOUND TRUE)
+  else (LZ4_INCLUDE_DIR AND LZ4_LIBRARIES)
+    set(LZ4_FOUND FALSE)
+  endif(LZ4_INCLUDE_DIR AND LZ4_LIBRARIES)
+
+  if (LZ4_FOUND)
+    if (NOT LZ4_FIND_QUIETLY)
+      message(STATUS "Found LZ4: ${LZ4_LIBRARIES}")
+    endif (NOT LZ4_FIND_QUIETLY)
+  else (LZ4_FOUND)
+    if (LZ4_FIND_REQUIRED)
+      message(FATAL_ERROR "LZ4 not found. Please install liblz4-dev")
+    endif (LZ4_FIND_REQUIRED)
+  endif (LZ4_FOUND)
+
+  mark_as_advanced(LZ4_INCLUDE_DIR LZ4_LIBRARIES)
+
+endif (LZ4_INCLUDE_DIR AND LZ4_LIBRARIES)
@@ -6,3 +6,12 @@
 
 /* Set when theora is detected */
 #cmakedefine HAVE_THEORA
+
+/* Set when zstd is detected */
+#cmakedefine HAVE_ZSTD
+
+/* Set when lz4 is detected */
+#cmakedefine HAVE_LZ4
+
+/* Set when the FFTW3 threads library is detected */
+#cmakedefine HAVE_FFTW3_THREADS
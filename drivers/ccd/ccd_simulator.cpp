@@ -21,6 +21,7 @@
 #include "stream/streammanager.h"
 
 #include "locale_compat.h"
+#include "indiutility.h"
 
 #include <libnova/julian_day.h>
 #include <libastro.h>
@@ -237,6 +238,11 @@ bool CCDSim::initProperties()
     TelescopeTypeS[TELESCOPE_PRIMARY].s = ISS_OFF;
     TelescopeTypeS[TELESCOPE_GUIDE].s = ISS_ON;
 
+    // Optional in-memory star list, gsc is used otherwise
+    const char *catalog = getenv("INDISTARCATALOG");
+    if (catalog != nullptr && m_StarCatalog.load(catalog) == false)
+        LOGF_WARN("Failed to load star catalog %s, falling back to gsc.", catalog);
+
     return true;
 }
 
@@ -709,94 +715,64 @@ int CCDSim::DrawCcdFrame(INDI::CCDChip * targetChip)
         //  if this is a light frame, we need a star field drawn
         INDI::CCDChip::CCD_FRAME ftype = targetChip->getFrameType();
 
-        std::unique_lock<std::mutex> guard(ccdBufferLock);
-
-        //  Start by clearing the frame buffer
-        memset(targetChip->getFrameBuffer(), 0, targetChip->getFrameBufferSize());
+        std::vector<ImageStar> imageStars;
 
         if (ftype == INDI::CCDChip::LIGHT_FRAME)
         {
-            AutoCNumeric locale;
-            char gsccmd[250];
-            FILE * pp;
             int drawn = 0;
+            std::vector<StarCatalog::Star> stars;
 
-            sprintf(gsccmd, "gsc -c %8.6f %+8.6f -r %4.1f -m 0 %4.2f -n 3000",
-                    range360(rad + PEOffset),
-                    rangeDec(cameradec),
-                    radius,
-                    lookuplimit);
+            int subX = targetChip->getSubX();
+            int subY = targetChip->getSubY();
+            int subW = targetChip->getSubW() + subX;
+            int subH = targetChip->getSubH() + subY;
 
-            pp = popen(gsccmd, "r");
-            if (pp != nullptr)
+            if (m_StarCatalog.query(rad + PEOffset, cameradec, radius, lookuplimit, stars))
             {
-                char line[256];
-                int stars = 0;
-                int lines = 0;
+                imageStars.reserve(stars.size());
 
-                while (fgets(line, 256, pp) != nullptr)
+                for (const auto &star : stars)
                 {
-                    //  ok, lets parse this line for specifcs we want
-                    char id[20];
-                    char plate[6];
-                    char ob[6];
-                    float mag;
-                    float mage;
-                    float ra;
-                    float dec;
-                    float pose;
-                    int band;
-                    float dist;
-                    int dir;
-                    int c;
-
-                    int rc = sscanf(line, "%10s %f %f %f %f %f %d %d %4s %2s %f %d", id, &ra, &dec, &pose, &mag, &mage,
-                                    &band, &c, plate, ob, &dist, &dir);
-                    if (rc == 12)
-                    {
-                        lines++;
-                        stars++;
-
-                        //  Convert the ra/dec to standard co-ordinates
-                        double sx;    //  standard co-ords
-                        double sy;    //
-                        double srar;  //  star ra in radians
-                        double sdecr; //  star dec in radians;
-                        double ccdx;
-                        double ccdy;
-
-                        srar  = ra * 0.0174532925;
-                        sdecr = dec * 0.0174532925;
-
-                        //  Handbook of astronomical image processing
-                        //  page 253
-                        //  equations 9.1 and 9.2
-                        //  convert ra/dec to standard co-ordinates
-
-                        sx = cos(sdecr) * sin(srar - rar) /
-                             (cos(decr) * cos(sdecr) * cos(srar - rar) + sin(decr) * sin(sdecr));
-                        sy = (sin(decr) * cos(sdecr) * cos(srar - rar) - cos(decr) * sin(sdecr)) /
-                             (cos(decr) * cos(sdecr) * cos(srar - rar) + sin(decr) * sin(sdecr));
-
-                        //  now convert to pixels
-                        ccdx = pa * sx + pb * sy + pc;
-                        ccdy = pd * sx + pe * sy + pf;
-
-                        // Invert horizontally
-                        ccdx = ccdW - ccdx;
-
-                        rc = DrawImageStar(targetChip, mag, ccdx, ccdy, exposure_time);
-                        drawn += rc;
-#ifdef __DEV__
-                        if (rc == 1)
-                        {
-                            LOGF_DEBUG("star %s scope %6.4f %6.4f star %6.4f %6.4f ccd %6.2f %6.2f", id, rad, decPE, ra, dec, ccdx, ccdy);
-                            LOGF_DEBUG("star %s ccd %6.2f %6.2f", id, ccdx, ccdy);
-                        }
-#endif
-                    }
+                    //  Convert the ra/dec to standard co-ordinates
+                    double sx;    //  standard co-ords
+                    double sy;    //
+                    double srar;  //  star ra in radians
+                    double sdecr; //  star dec in radians;
+                    double ccdx;
+                    double ccdy;
+
+                    srar  = star.ra * 0.0174532925;
+                    sdecr = star.dec * 0.0174532925;
+
+                    //  Handbook of astronomical image processing
+                    //  page 253
+                    //  equations 9.1 and 9.2
+                    //  convert ra/dec to standard co-ordinates
+
+                    sx = cos(sdecr) * sin(srar - rar) /
+                         (cos(decr) * cos(sdecr) * cos(srar - rar) + sin(decr) * sin(sdecr));
+                    sy = (sin(decr) * cos(sdecr) * cos(srar - rar) - cos(decr) * sin(sdecr)) /
+                         (cos(decr) * cos(sdecr) * cos(srar - rar) + sin(decr) * sin(sdecr));
+
+                    //  now convert to pixels
+                    ccdx = pa * sx + pb * sy + pc;
+                    ccdy = pd * sx + pe * sy + pf;
+
+                    // Invert horizontally
+                    ccdx = ccdW - ccdx;
+
+                    //  this star is not on the ccd frame anyways
+                    if ((ccdx < subX) || (ccdx > subW || (ccdy < subY) || (ccdy > subH)))
+                        continue;
+
+                    //  flux represents one second, scale up linearly for exposure time
+                    ImageStar imageStar;
+                    imageStar.x    = static_cast<int>(std::floor(ccdx)) - subX;
+                    imageStar.y    = static_cast<int>(std::floor(ccdy)) - subY;
+                    imageStar.flux = static_cast<float>(flux(star.mag)) * exposure_time;
+                    imageStars.push_back(imageStar);
+                    drawn++;
                 }
-                pclose(pp);
             }
             else
             {
@@ -811,8 +787,10 @@ int CCDSim::DrawCcdFrame(INDI::CCDChip * targetChip)
         //  now we need to add background sky glow, with vignetting
         //  this is essentially the same math as drawing a dim star with
         //  fwhm equivalent to the full field of view
+        float skyflux = 0;
+        bool const addSkyGlow = (ftype == INDI::CCDChip::LIGHT_FRAME || ftype == INDI::CCDChip::FLAT_FRAME);
 
-        if (ftype == INDI::CCDChip::LIGHT_FRAME || ftype == INDI::CCDChip::FLAT_FRAME)
+        if (addSkyGlow)
         {
             //  calculate flux from our zero point and gain values
             float glow = m_SkyGlow;
@@ -825,70 +803,16 @@ int CCDSim::DrawCcdFrame(INDI::CCDChip * targetChip)
                 glow = m_SkyGlow / 10;
             }
 
-            //fprintf(stderr,"Using glow %4.2f\n",glow);
-
             // Flux represents one second, scale up linearly for exposure time
-            float const skyflux = flux(glow) * exposure_time;
-
-            uint16_t * pt = reinterpret_cast<uint16_t *>(targetChip->getFrameBuffer());
-
-            nheight = targetChip->getSubH();
-            nwidth  = targetChip->getSubW();
-
-            for (int y = 0; y < nheight; y++)
-            {
-                float const sy = nheight / 2 - y;
-
-                for (int x = 0; x < nwidth; x++)
-                {
-                    float const sx = nwidth / 2 - x;
-
-                    // Vignetting parameter in arcsec
-                    float const vig = std::min(nwidth, nheight) * ImageScalex;
-
-                    // Squared distance to center in arcsec (need to make this account for actual pixel size)
-                    float const dc2 = sx * sx * ImageScalex * ImageScalex + sy * sy * ImageScaley * ImageScaley;
-
-                    // Gaussian falloff to the edges of the frame
-                    float const fa = exp(-2.0 * 0.7 * dc2 / (vig * vig));
-
-                    // Get the current value of the pixel, add the sky glow and scale for vignetting
-                    float fp = (pt[0] + skyflux) * fa;
-
-                    // Clamp to limits, store minmax
-                    if (fp > m_MaxVal) fp = m_MaxVal;
-                    if (fp < pt[0]) fp = pt[0];
-                    if (fp > maxpix) maxpix = fp;
-                    if (fp < minpix) minpix = fp;
-
-                    // And put it back
-                    pt[0] = fp;
-                    pt++;
-                }
-            }
+            skyflux = flux(glow) * exposure_time;
         }
 
-        //  Now we add some bias and read noise
-        int subX = targetChip->getSubX();
-        int subY = targetChip->getSubY();
-        int subW = targetChip->getSubW() + subX;
-        int subH = targetChip->getSubH() + subY;
-
-        if (m_MaxNoise > 0)
-        {
-            for (int x = subX; x < subW; x++)
-            {
-                for (int y = subY; y < subH; y++)
-                {
-                    int noise;
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
 
-                    noise = random();
-                    noise = noise % m_MaxNoise; //
+        //  Start by clearing the frame buffer
+        memset(targetChip->getFrameBuffer(), 0, targetChip->getFrameBufferSize());
 
-                    AddToPixel(targetChip, x, y, m_Bias + noise);
-                }
-            }
-        }
+        RenderFrame(targetChip, imageStars, addSkyGlow, skyflux);
     }
     else
     {
@@ -908,113 +832,146 @@ int CCDSim::DrawCcdFrame(INDI::CCDChip * targetChip)
     return 0;
 }
 
-int CCDSim::DrawImageStar(INDI::CCDChip * targetChip, float mag, float x, float y, float exposure_time)
+void CCDSim::UpdatePSFKernel()
 {
-    int sx, sy;
-    int drew     = 0;
-    //int boxsizex = 5;
-    int boxsizey = 5;
-    float flux;
-
-    int subX = targetChip->getSubX();
-    int subY = targetChip->getSubY();
-    int subW = targetChip->getSubW() + subX;
-    int subH = targetChip->getSubH() + subY;
-
-    if ((x < subX) || (x > subW || (y < subY) || (y > subH)))
-    {
-        //  this star is not on the ccd frame anyways
-        return 0;
-    }
-
-    //  calculate flux from our zero point and gain values
-    flux = this->flux(mag);
+    if (m_PSFKernel.size() > 0 && m_PSFSeeing == seeing && m_PSFScaleX == ImageScalex && m_PSFScaleY == ImageScaley)
+        return;
 
-    //  ok, flux represents one second now
-    //  scale up linearly for exposure time
-    flux = flux * exposure_time;
+    m_PSFSeeing = seeing;
+    m_PSFScaleX = ImageScalex;
+    m_PSFScaleY = ImageScaley;
 
-    float qx;
     //  we need a box size that gives a radius at least 3 times fwhm
-    qx       = seeing / ImageScalex;
-    qx       = qx * 3;
-    //boxsizex = (int)qx;
-    //boxsizex++;
-    qx       = seeing / ImageScaley;
-    qx       = qx * 3;
-    boxsizey = static_cast<int>(qx);
-    boxsizey++;
-
-    //IDLog("BoxSize %d %d\n",boxsizex,boxsizey);
-
-    for (sy = -boxsizey; sy <= boxsizey; sy++)
+    m_PSFBox = static_cast<int>(seeing / ImageScaley * 3) + 1;
+
+    int const size = 2 * m_PSFBox + 1;
+    m_PSFKernel.resize(size * size);
+
+    // Use a gaussian of unitary integral, scale it with the source flux
+    // f(x) = 1/(sqrt(2*pi)*sigma) * exp( -x² / (2*sigma²) )
+    // FWHM = 2*sqrt(2*log(2))*sigma => sigma = seeing/(2*sqrt(2*log(2)))
+    float const sigma = seeing / ( 2 * sqrt(2 * log(2)));
+
+    for (int sy = -m_PSFBox; sy <= m_PSFBox; sy++)
     {
-        for (sx = -boxsizey; sx <= boxsizey; sx++)
+        for (int sx = -m_PSFBox; sx <= m_PSFBox; sx++)
         {
-            int rc;
-
             // Squared distance to center in arcsec (need to make this account for actual pixel size)
             float const dc2 = sx * sx * ImageScalex * ImageScalex + sy * sy * ImageScaley * ImageScaley;
-
-            // Use a gaussian of unitary integral, scale it with the source flux
-            // f(x) = 1/(sqrt(2*pi)*sigma) * exp( -x² / (2*sigma²) )
-            // FWHM = 2*sqrt(2*log(2))*sigma => sigma = seeing/(2*sqrt(2*log(2)))
-            float const sigma = seeing / ( 2 * sqrt(2 * log(2)));
             float const fa = 1 / (sigma * sqrt(2 * 3.1416)) * exp( -dc2 / (2 * sigma * sigma));
-
-            // The source contribution is the gaussian value, stretched by seeing/FWHM
-            float fp = fa * flux;
-
-            if (fp < 0)
-                fp = 0;
-
-            rc = AddToPixel(targetChip, x + sx, y + sy, fp);
-            if (rc != 0)
-                drew = 1;
+            m_PSFKernel[(sy + m_PSFBox) * size + (sx + m_PSFBox)] = std::max(0.0f, fa);
         }
     }
-    return drew;
 }
 
-int CCDSim::AddToPixel(INDI::CCDChip * targetChip, int x, int y, int val)
+// splitmix64, a counter based generator: each pixel gets its own random number and rows can be drawn in any order.
+static inline uint64_t pixelRandom(uint64_t seed, uint64_t index)
+{
+    uint64_t z = seed + index * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void CCDSim::RenderFrame(INDI::CCDChip * targetChip, const std::vector<ImageStar> &stars, bool addSkyGlow,
+                         float skyflux)
 {
-    int nwidth  = targetChip->getSubW();
-    int nheight = targetChip->getSubH();
+    uint16_t * const buffer = reinterpret_cast<uint16_t *>(targetChip->getFrameBuffer());
+    int const width  = targetChip->getSubW();
+    int const height = targetChip->getSubH();
+    int const maxVal = m_MaxVal;
+
+    UpdatePSFKernel();
+    int const box        = m_PSFBox;
+    int const kernelSize = 2 * box + 1;
+    float const * const kernel = m_PSFKernel.data();
+
+    //  The vignetting falloff exp(-a * (dx² + dy²)) is separable, so it is computed once per row and per column.
+    // Vignetting parameter in arcsec
+    float const vig = std::min(width, height) * ImageScalex;
+    std::vector<float> columnFalloff(width);
+    for (int x = 0; x < width; x++)
+    {
+        float const sx = width / 2 - x;
+        columnFalloff[x] = exp(-2.0 * 0.7 * sx * sx * ImageScalex * ImageScalex / (vig * vig));
+    }
+
+    uint64_t const seed = (static_cast<uint64_t>(random()) << 32) ^ static_cast<uint64_t>(random());
 
-    x -= targetChip->getSubX();
-    y -= targetChip->getSubY();
+    // Each job renders a band of rows: stars overlapping the band, then sky glow and noise.
+    int const rowsPerJob = 32;
+    int const jobs = (height + rowsPerJob - 1) / rowsPerJob;
 
-    int drew = 0;
-    if (x >= 0)
+    INDI::parallel_for(jobs, 0, [&](size_t job)
     {
-        if (x < nwidth)
+        int const rowBegin = job * rowsPerJob;
+        int const rowEnd   = std::min(height, rowBegin + rowsPerJob);
+
+        for (const auto &star : stars)
         {
-            if (y >= 0)
+            int const top    = std::max(rowBegin, star.y - box);
+            int const bottom = std::min(rowEnd - 1, star.y + box);
+            int const left   = std::max(0, star.x - box);
+            int const right  = std::min(width - 1, star.x + box);
+
+            for (int y = top; y <= bottom; y++)
             {
-                if (y < nheight)
+                uint16_t * const row = buffer + static_cast<size_t>(y) * width;
+                float const * const weights = kernel + (y - star.y + box) * kernelSize + (box - star.x);
+
+                for (int x = left; x <= right; x++)
                 {
-                    unsigned short * pt;
-                    int newval;
-                    drew++;
-
-                    pt = reinterpret_cast<uint16_t *>(targetChip->getFrameBuffer());
-
-                    pt += (y * nwidth);
-                    pt += x;
-                    newval = pt[0];
-                    newval += val;
-                    if (newval > m_MaxVal)
-                        newval = m_MaxVal;
-                    if (newval > maxpix)
-                        maxpix = newval;
-                    if (newval < minpix)
-                        minpix = newval;
-                    pt[0] = newval;
+                    int const value = row[x] + static_cast<int>(weights[x] * star.flux);
+                    row[x] = std::min(value, maxVal);
                 }
             }
         }
-    }
-    return drew;
+
+        for (int y = rowBegin; y < rowEnd; y++)
+        {
+            uint16_t * const row = buffer + static_cast<size_t>(y) * width;
+
+            if (addSkyGlow)
+            {
+                float const sy = height / 2 - y;
+                // Gaussian falloff to the edges of the frame
+                float const rowFalloff = exp(-2.0 * 0.7 * sy * sy * ImageScaley * ImageScaley / (vig * vig));
+
+                for (int x = 0; x < width; x++)
+                {
+                    // Get the current value of the pixel, add the sky glow and scale for vignetting
+                    float fp = (row[x] + skyflux) * columnFalloff[x] * rowFalloff;
+
+                    // Clamp to limits
+                    fp = std::min(fp, static_cast<float>(maxVal));
+                    fp = std::max(fp, static_cast<float>(row[x]));
+                    row[x] = fp;
+                }
+            }
+
+            //  Now we add some bias, shot noise and read noise
+            if (m_MaxNoise > 0)
+            {
+                uint64_t const index = static_cast<uint64_t>(y) * width;
+                uint64_t const maxNoise = m_MaxNoise;
+
+                for (int x = 0; x < width; x++)
+                {
+                    uint64_t const r = pixelRandom(seed, index + x);
+
+                    // The sum of three uniform variables approximates a unit gaussian for the shot noise
+                    float const g = ((r >> 16 & 0xFFFF) + (r >> 32 & 0xFFFF) + (r >> 48)) * (1.0f / 65536) - 1.5f;
+                    float const shot = std::sqrt(static_cast<float>(row[x])) * g * 2.0f;
+
+                    // Uniform read noise in [0, m_MaxNoise)
+                    int const noise = ((r & 0xFFFF) * maxNoise) >> 16;
+
+                    int const value = std::max(0, static_cast<int>(row[x] + shot)) + m_Bias + noise;
+                    row[x] = std::min(value, maxVal);
+                }
+            }
+        }
+    });
 }
 
 IPState CCDSim::GuideNorth(uint32_t v)
@@ -19,14 +19,17 @@
 #pragma once
 
 #include <deque>
+#include <vector>
 
 #include "indiccd.h"
 #include "indifilterinterface.h"
+#include "star_catalog.h"
 
 /**
  * @brief The CCDSim class provides an advanced simulator for a CCD that includes a dedicated on-board guide chip.
  *
  * The CCD driver can generate star fields given that General-Star-Catalog (gsc) tool is installed on the same machine the driver is running.
+ * Alternatively, a star list set in the INDISTARCATALOG environment variable is loaded into memory at startup, see StarCatalog.
  *
  * Many simulator parameters can be configured to generate the final star field image. In addition to support guider chip and guiding pulses (ST4),
  * a filter wheel support is provided for 8 filter wheels. Cooler and temperature control is also supported.
@@ -97,8 +100,19 @@ class CCDSim : public INDI::CCD, public INDI::FilterInterface
 
         int DrawCcdFrame(INDI::CCDChip *targetChip);
 
-        int DrawImageStar(INDI::CCDChip *targetChip, float, float, float, float ExposureTime);
-        int AddToPixel(INDI::CCDChip *targetChip, int, int, int);
+
+        // Star position in sub frame pixels and its flux in ADU for the current exposure
+        struct ImageStar
+        {
+            int x;
+            int y;
+            float flux;
+        };
+
+        // Draw stars, sky glow and noise into the frame buffer, split in bands of rows across threads
+        void RenderFrame(INDI::CCDChip *targetChip, const std::vector<ImageStar> &stars, bool addSkyGlow, float skyflux);
+        // Recompute the star PSF when the seeing or the image scale changed
+        void UpdatePSFKernel();
 
         virtual IPState GuideNorth(uint32_t) override;
         virtual IPState GuideSouth(uint32_t) override;
@@ -152,14 +166,19 @@ class CCDSim : public INDI::CCD, public INDI::FilterInterface
         int m_Bias { 1500 };
         int m_MaxNoise { 20 };
         int m_MaxVal { 65000 };
-        int maxpix { 0 };
-        int minpix { 65000 };
         float m_SkyGlow { 40 };
         float m_LimitingMag { 11.5 };
         float m_SaturationMag { 2 };
         float seeing { 3.5 };
         float ImageScalex { 1.0 };
         float ImageScaley { 1.0 };
+
+        // Star PSF, (2 * m_PSFBox + 1)² weights, for the seeing and image scale below
+        std::vector<float> m_PSFKernel;
+        int m_PSFBox { 0 };
+        float m_PSFSeeing { 0 };
+        float m_PSFScaleX { 0 };
+        float m_PSFScaleY { 0 };
         //  An oag is offset this much from center of scope position (arcminutes)
         float m_OAGOffset { 0 };
         float m_RotationCW { 0 };
@@ -201,6 +220,9 @@ class CCDSim : public INDI::CCD, public INDI::FilterInterface
 
         std::deque<std::string> m_AllFiles, m_RemainingFiles;
 
+        // Stars of the current field, looked up once and reused while the pointing stays within the field
+        StarCatalog m_StarCatalog;
+
         //  And this lives in our simulator settings page
         INumberVectorProperty SimulatorSettingsNP;
         INumber SimulatorSettingsN[SIM_N];
@@ -0,0 +1,242 @@
+/*******************************************************************************
+  Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include "star_catalog.h"
+
+#include "indicom.h"
+#include "locale_compat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// Fields are fetched this much larger than requested so they can be reused while the pointing moves a little.
+static constexpr double FIELD_MARGIN = 1.5;
+// gsc returns at most this many stars for a field of the requested radius.
+static constexpr int GSC_MAX_STARS = 3000;
+static constexpr char BINARY_MAGIC[8] = {'I', 'N', 'D', 'I', 'S', 'T', 'A', 'R'};
+
+// Angular separation of two positions in degrees
+static double separation(double ra1, double dec1, double ra2, double dec2)
+{
+    const double d2r = M_PI / 180.0;
+    double sdec = std::sin((dec2 - dec1) * d2r / 2);
+    double sra  = std::sin((ra2 - ra1) * d2r / 2);
+    double a    = sdec * sdec + std::cos(dec1 * d2r) * std::cos(dec2 * d2r) * sra * sra;
+    return 2 * std::asin(std::min(1.0, std::sqrt(a))) / d2r;
+}
+
+static int bandIndex(double dec)
+{
+    return std::max(0, std::min(179, static_cast<int>(std::floor(dec + 90))));
+}
+
+bool StarCatalog::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::vector<Star> stars;
+
+    char magic[sizeof(BINARY_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    if (file && memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0)
+    {
+        uint32_t count = 0;
+        file.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (!file)
+            return false;
+
+        // A corrupt or truncated file must not size the allocation
+        std::streamoff start = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streamoff available = file.tellg() - start;
+        if (count == 0 || static_cast<uint64_t>(count) * sizeof(Star) > static_cast<uint64_t>(available))
+            return false;
+
+        file.seekg(start);
+        stars.resize(count);
+        file.read(reinterpret_cast<char *>(stars.data()), static_cast<std::streamsize>(count) * sizeof(Star));
+        stars.resize(file.gcount() / sizeof(Star));
+    }
+    else
+    {
+        file.clear();
+        file.seekg(0);
+
+        AutoCNumeric locale;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            Star star;
+            if (sscanf(line.c_str(), "%f %f %f", &star.ra, &star.dec, &star.mag) == 3)
+                stars.push_back(star);
+        }
+    }
+
+    if (stars.empty())
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_Lock);
+
+    m_Bands.assign(180, std::vector<Star>());
+    for (const auto &star : stars)
+        m_Bands[bandIndex(star.dec)].push_back(star);
+
+    for (auto &band : m_Bands)
+        std::sort(band.begin(), band.end(), [](const Star & a, const Star & b)
+    {
+        return a.ra < b.ra;
+    });
+
+    m_FieldValid = false;
+    return true;
+}
+
+bool StarCatalog::query(double ra, double dec, double radius, double limitMag, std::vector<Star> &stars)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+
+    ra = range360(ra);
+    dec = rangeDec(dec);
+    stars.clear();
+
+    bool reuse = m_FieldValid && limitMag <= m_FieldLimit &&
+                 separation(ra, dec, m_FieldRA, m_FieldDE) * 60 + radius <= m_FieldRadius;
+
+    if (!reuse)
+    {
+        m_FieldValid = false;
+        m_Field.clear();
+
+        double fieldRadius = radius * FIELD_MARGIN;
+        if (m_Bands.empty())
+        {
+            if (!searchGSC(ra, dec, fieldRadius, limitMag, m_Field))
+                return false;
+        }
+        else
+            searchBands(ra, dec, fieldRadius, limitMag, m_Field);
+
+        m_FieldValid  = true;
+        m_FieldRA     = ra;
+        m_FieldDE     = dec;
+        m_FieldRadius = fieldRadius;
+        m_FieldLimit  = limitMag;
+    }
+
+    // Stars outside the requested radius are cheap to reject when drawing, only the magnitude limit is applied.
+    stars.reserve(m_Field.size());
+    for (const auto &star : m_Field)
+    {
+        if (star.mag <= limitMag)
+            stars.push_back(star);
+    }
+
+    return true;
+}
+
+void StarCatalog::searchBands(double ra, double dec, double radius, double limitMag, std::vector<Star> &stars) const
+{
+    const double r      = radius / 60;
+    const double maxDec = std::min(90.0, std::fabs(dec) + r);
+
+    // Half width of the field in right ascension at the declination farthest from the equator
+    double halfWidth = 180;
+    if (maxDec < 89.9)
+        halfWidth = std::min(180.0, r / std::cos(maxDec * M_PI / 180.0));
+
+    auto search = [&](const std::vector<Star> &band, double from, double to)
+    {
+        auto begin = std::lower_bound(band.begin(), band.end(), from, [](const Star & star, double value)
+        {
+            return star.ra < value;
+        });
+
+        for (auto it = begin; it != band.end() && it->ra <= to; ++it)
+        {
+            if (it->mag <= limitMag && separation(ra, dec, it->ra, it->dec) <= r)
+                stars.push_back(*it);
+        }
+    };
+
+    for (int b = bandIndex(dec - r); b <= bandIndex(dec + r); b++)
+    {
+        const auto &band = m_Bands[b];
+        if (halfWidth >= 180)
+            search(band, 0, 360);
+        else
+        {
+            double from = ra - halfWidth, to = ra + halfWidth;
+            if (from < 0)
+            {
+                search(band, from + 360, 360);
+                from = 0;
+            }
+            if (to >= 360)
+            {
+                search(band, 0, to - 360);
+                to = 360;
+            }
+            search(band, from, to);
+        }
+    }
+}
+
+bool StarCatalog::searchGSC(double ra, double dec, double radius, double limitMag, std::vector<Star> &stars) const
+{
+    AutoCNumeric locale;
+    char gsccmd[250];
+
+    snprintf(gsccmd, sizeof(gsccmd), "gsc -c %8.6f %+8.6f -r %4.1f -m 0 %4.2f -n %d", ra, dec, radius, limitMag,
+             static_cast<int>(GSC_MAX_STARS * FIELD_MARGIN * FIELD_MARGIN));
+
+    FILE *pp = popen(gsccmd, "r");
+    if (pp == nullptr)
+        return false;
+
+    char line[256];
+    while (fgets(line, 256, pp) != nullptr)
+    {
+        //  ok, lets parse this line for specifcs we want
+        char id[20];
+        char plate[6];
+        char ob[6];
+        float mag;
+        float mage;
+        float sra;
+        float sdec;
+        float pose;
+        int band;
+        float dist;
+        int dir;
+        int c;
+
+        int rc = sscanf(line, "%10s %f %f %f %f %f %d %d %4s %2s %f %d", id, &sra, &sdec, &pose, &mag, &mage,
+                        &band, &c, plate, ob, &dist, &dir);
+        if (rc == 12)
+            stars.push_back({sra, sdec, mag});
+    }
+
+    pclose(pp);
+    return true;
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+  Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The StarCatalog class answers cone searches for the simulators.
+ *
+ * A star list can be loaded once into memory, either as text with one "ra dec mag" line per star, or in a compact
+ * binary form: the 8 byte magic "INDISTAR", a 32 bit star count, and one native float triplet (ra, dec, mag) per
+ * star. All coordinates are J2000 degrees. Stars are kept in one degree declination bands sorted by right ascension,
+ * so a query only visits the stars near the requested field.
+ *
+ * Without a loaded star list, queries fall back to running the gsc tool.
+ *
+ * Either way, the last field is cached. It is fetched with a margin around the requested radius and reused for as
+ * long as the requested field lies within it, so small pointing changes from guiding, periodic error or drift do not
+ * trigger a new lookup.
+ */
+class StarCatalog
+{
+    public:
+        struct Star
+        {
+            float ra;
+            float dec;
+            float mag;
+        };
+
+        /**
+         * @brief load Load a star list into memory.
+         * @param path text or binary star list.
+         * @return True if at least one star was loaded.
+         */
+        bool load(const std::string &path);
+
+        /**
+         * @return True if a star list is loaded, false if queries use gsc.
+         */
+        bool isLoaded() const
+        {
+            return !m_Bands.empty();
+        }
+
+        /**
+         * @brief query Find stars around a position.
+         * @param ra J2000 right ascension of the field center in degrees.
+         * @param dec J2000 declination of the field center in degrees.
+         * @param radius field radius in arcminutes.
+         * @param limitMag faintest magnitude to return.
+         * @param stars cleared and filled with the stars of the field. May include a few stars slightly outside the
+         * radius.
+         * @return False if the catalog could not be searched, e.g. gsc is not installed.
+         */
+        bool query(double ra, double dec, double radius, double limitMag, std::vector<Star> &stars);
+
+    private:
+        void searchBands(double ra, double dec, double radius, double limitMag, std::vector<Star> &stars) const;
+        bool searchGSC(double ra, double dec, double radius, double limitMag, std::vector<Star> &stars) const;
+
+        // Stars sorted by right ascension, one vector per degree of declination
+        std::vector<std::vector<Star>> m_Bands;
+
+        std::mutex m_Lock;
+        bool m_FieldValid {false};
+        double m_FieldRA {0};
+        double m_FieldDE {0};
+        double m_FieldRadius {0};
+        double m_FieldLimit {0};
+        std::vector<Star> m_Field;
+};
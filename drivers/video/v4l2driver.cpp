@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
 #include "v4l2driver.h"
 #include "indistandardproperty.h"
 #include "lx/Lx.h"
+#include "ccvt.h"
 
 // Pixel size info for different cameras
 typedef struct PixelSizeInfo
@@ -198,6 +199,12 @@ bool V4L2_Driver::initProperties()
 
     stackMode = STACK_NONE;
 
+    /* Debayering */
+    IUFillSwitch(&DebayerS[DEBAYER_BILINEAR], "DEBAYER_BILINEAR", "Bilinear", ISS_ON);
+    IUFillSwitch(&DebayerS[DEBAYER_VNG], "DEBAYER_VNG", "VNG", ISS_OFF);
+    IUFillSwitchVector(&DebayerSP, DebayerS, NARRAY(DebayerS), getDeviceName(), "V4L2_DEBAYER", "Debayer", CAPTURE_FORMAT,
+                       IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
     /* Inputs */
     IUFillSwitchVector(&InputsSP, nullptr, 0, getDeviceName(), "V4L2_INPUT", "Inputs", CAPTURE_FORMAT, IP_RW,
                        ISR_1OFMANY, 0, IPS_IDLE);
@@ -281,6 +288,7 @@ void V4L2_Driver::ISGetProperties(const char * dev)
             defineProperty(&FrameRateNP);
 
         defineProperty(&StackModeSP);
+        defineProperty(&DebayerSP);
 
 #ifdef WITH_V4L2_EXPERIMENTS
         defineProperty(&ImageDepthSP);
@@ -312,6 +320,7 @@ bool V4L2_Driver::updateProperties()
             defineProperty(&FrameRateNP);
 
         defineProperty(&StackModeSP);
+        defineProperty(&DebayerSP);
 
 #ifdef WITH_V4L2_EXPERIMENTS
         defineProperty(&ImageDepthSP);
@@ -399,6 +408,7 @@ bool V4L2_Driver::updateProperties()
         v4loptions = 0;
 
         deleteProperty(StackModeSP.name);
+        deleteProperty(DebayerSP.name);
 
 #ifdef WITH_V4L2_EXPERIMENTS
         deleteProperty(ImageDepthSP.name);
@@ -653,6 +663,16 @@ bool V4L2_Driver::ISNewSwitch(const char * dev, const char * name, ISState * sta
         return true;
     }
 
+    /* Debayering */
+    if (strcmp(name, DebayerSP.name) == 0)
+    {
+        IUUpdateSwitch(&DebayerSP, states, names, n);
+        v4l_base->setBayerMethod(DebayerS[DEBAYER_VNG].s == ISS_ON ? CCVT_BAYER_VNG : CCVT_BAYER_BILINEAR);
+        DebayerSP.s = IPS_OK;
+        IDSetSwitch(&DebayerSP, nullptr);
+        return true;
+    }
+
     /* V4L2 Options/Menus */
     for (iopt = 0; iopt < v4loptions; iopt++)
         if (strcmp(Options[iopt].name, name) == 0)
@@ -1902,6 +1922,7 @@ bool V4L2_Driver::saveConfigItems(FILE * fp)
 
     IUSaveConfigText(fp, &PortTP);
     IUSaveConfigSwitch(fp, &StackModeSP);
+    IUSaveConfigSwitch(fp, &DebayerSP);
 
     if (ImageAdjustNP.nnp > 0)
         IUSaveConfigNumber(fp, &ImageAdjustNP);
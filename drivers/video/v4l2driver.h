@@ -104,6 +104,12 @@ public:
             IMAGE_RGB
         };
 
+        enum
+        {
+            DEBAYER_BILINEAR = 0,
+            DEBAYER_VNG
+        };
+
         enum stackmodes
         {
             STACK_NONE       = 0,
@@ -118,6 +124,7 @@ public:
         ISwitch ImageDepthS[2];
         ISwitch StackModeS[5];
         ISwitch ColorProcessingS[3];
+        ISwitch DebayerS[2];
 
         /* Texts */
         IText PortT[1] {};
@@ -138,6 +145,7 @@ public:
         ISwitchVectorProperty FrameRatesSP;     /* Select Frame rate (Discrete) */
         ISwitchVectorProperty *Options;
         ISwitchVectorProperty ColorProcessingSP;
+        ISwitchVectorProperty DebayerSP;        /* Demosaicing of Bayer formats */
 
         unsigned int v4loptions;
         unsigned int v4ladjustments;
@@ -1148,357 +1148,359 @@ int IUSaveDefaultConfig(const char *source_config, const char *dest_config, cons
     return -1;
 }
 
-int IUGetConfigOnSwitch(const ISwitchVectorProperty *property, int *index)
+/* Config cache. The IUGetConfigXXX lookups are typically issued many times in a row while a driver
+ * initializes, so the config file of each device is parsed once and kept in memory together with a
+ * sorted index of its properties. An entry is reloaded whenever the file modification time, to the
+ * nanosecond where the file system records it, or size changes, and dropped whenever the file is
+ * opened for writing or purged.
+ */
+typedef struct {
+    char propName[MAXINDINAME];
+    int order;
+    XMLEle *root;
+} ConfigCacheProperty;
+
+typedef struct {
+    char devName[MAXINDIDEVICE];
+    char fileName[MAXRBUF];
+    time_t mtime;
+    long mtimeNsec;
+    off_t size;
+    XMLEle *fproot;
+    ConfigCacheProperty *properties;
+    int nProperties;
+} ConfigCache;
+
+static pthread_mutex_t configCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static ConfigCache *configCache = NULL;
+static int nConfigCache = 0;
+
+static void IUGetConfigFileName(const char *filename, const char *dev, char configFileName[])
 {
-    char *rname, *rdev;
-    XMLEle *root = NULL, *fproot = NULL;
+    if (filename)
+        strncpy(configFileName, filename, MAXRBUF - 1);
+    else if (getenv("INDICONFIG"))
+        strncpy(configFileName, getenv("INDICONFIG"), MAXRBUF - 1);
+    else
+        snprintf(configFileName, MAXRBUF, "%s/.indi/%s_config.xml", getenv("HOME"), dev);
+
+    configFileName[MAXRBUF - 1] = '\0';
+}
+
+static void configcache_clear(ConfigCache *cc)
+{
+    if (cc->fproot)
+        delXMLEle(cc->fproot);
+    free(cc->properties);
+
+    cc->fproot      = NULL;
+    cc->properties  = NULL;
+    cc->nProperties = 0;
+    cc->mtime       = 0;
+    cc->mtimeNsec   = 0;
+    cc->size        = 0;
+}
+
+/* Nanoseconds part of the modification time, a same size rewrite within one second changes only this */
+static long configcache_mtime_nsec(const struct stat *st)
+{
+#ifdef __APPLE__
+    return st->st_mtimespec.tv_nsec;
+#else
+    return st->st_mtim.tv_nsec;
+#endif
+}
+
+static int configcache_compare(const void *a, const void *b)
+{
+    const ConfigCacheProperty *pa = (const ConfigCacheProperty *)a;
+    const ConfigCacheProperty *pb = (const ConfigCacheProperty *)b;
+    int rc = strcmp(pa->propName, pb->propName);
+    return rc != 0 ? rc : pa->order - pb->order;
+}
+
+static int configcache_compare_name(const void *key, const void *b)
+{
+    return strcmp((const char *)key, ((const ConfigCacheProperty *)b)->propName);
+}
+
+/* Return cache entry of device, create an empty one if it does not exist yet. Call with configCacheMutex held. */
+static ConfigCache *configcache_entry(const char *dev)
+{
+    for (int i = 0; i < nConfigCache; i++)
+        if (!strcmp(dev, configCache[i].devName))
+            return &configCache[i];
+
+    assert_mem(configCache = (ConfigCache *)(realloc(configCache, (nConfigCache + 1) * sizeof *configCache)));
+
+    ConfigCache *cc = &configCache[nConfigCache++];
+    memset(cc, 0, sizeof(*cc));
+    strncpy(cc->devName, dev, MAXINDIDEVICE - 1);
+    return cc;
+}
+
+/* Parse the device config file if it changed since the last call. Call with configCacheMutex held. */
+static ConfigCache *configcache_load(const char *dev)
+{
+    char configFileName[MAXRBUF];
     char errmsg[MAXRBUF];
-    LilXML *lp = newLilXML();
-    int propertyFound = 0;
-    *index = -1;
+    struct stat st;
+
+    IUGetConfigFileName(NULL, dev, configFileName);
+
+    ConfigCache *cc = configcache_entry(dev);
 
-    FILE *fp = IUGetConfigFP(NULL, property->device, "r", errmsg);
+    if (stat(configFileName, &st) != 0)
+    {
+        configcache_clear(cc);
+        return NULL;
+    }
 
+    if (cc->fproot != NULL && !strcmp(cc->fileName, configFileName) && cc->mtime == st.st_mtime &&
+            cc->mtimeNsec == configcache_mtime_nsec(&st) && cc->size == st.st_size)
+        return cc;
+
+    configcache_clear(cc);
+    strncpy(cc->fileName, configFileName, MAXRBUF - 1);
+
+    FILE *fp = IUGetConfigFP(configFileName, dev, "r", errmsg);
     if (fp == NULL)
-        return -1;
+        return NULL;
 
-    fproot = readXMLFile(fp, lp, errmsg);
+    LilXML *lp = newLilXML();
+    cc->fproot = readXMLFile(fp, lp, errmsg);
+    delLilXML(lp);
+    fclose(fp);
 
-    if (fproot == NULL)
+    if (cc->fproot == NULL)
+        return NULL;
+
+    cc->mtime     = st.st_mtime;
+    cc->mtimeNsec = configcache_mtime_nsec(&st);
+    cc->size      = st.st_size;
+
+    int n = nXMLEle(cc->fproot);
+    if (n > 0)
+        assert_mem(cc->properties = (ConfigCacheProperty *)(malloc(n * sizeof *cc->properties)));
+
+    char *rname, *rdev;
+    for (XMLEle *root = nextXMLEle(cc->fproot, 1); root != NULL; root = nextXMLEle(cc->fproot, 0))
     {
-        fclose(fp);
-        return -1;
+        /* pull out device and name, skip malformed elements and elements of other devices */
+        if (crackDN(root, &rdev, &rname, errmsg) < 0 || strcmp(dev, rdev))
+            continue;
+
+        ConfigCacheProperty *property = &cc->properties[cc->nProperties];
+        strncpy(property->propName, rname, MAXINDINAME - 1);
+        property->propName[MAXINDINAME - 1] = '\0';
+        property->order = cc->nProperties++;
+        property->root  = root;
     }
 
-    for (root = nextXMLEle(fproot, 1); root != NULL; root = nextXMLEle(fproot, 0))
+    /* sort by name, then by file order, and keep only the first occurrence of each property */
+    qsort(cc->properties, cc->nProperties, sizeof *cc->properties, configcache_compare);
+
+    int unique = 0;
+    for (int i = 0; i < cc->nProperties; i++)
+        if (unique == 0 || strcmp(cc->properties[unique - 1].propName, cc->properties[i].propName))
+            cc->properties[unique++] = cc->properties[i];
+    cc->nProperties = unique;
+
+    return cc;
+}
+
+/* Return config element of property, or of first device property if property is NULL. Call with configCacheMutex held. */
+static XMLEle *configcache_find(const char *dev, const char *property)
+{
+    ConfigCache *cc = configcache_load(dev);
+
+    if (cc == NULL || cc->nProperties == 0)
+        return NULL;
+
+    if (property == NULL)
     {
-        /* pull out device and name */
-        if (crackDN(root, &rdev, &rname, errmsg) < 0)
-        {
-            fclose(fp);
-            delXMLEle(fproot);
-            return -1;
-        }
+        ConfigCacheProperty *first = &cc->properties[0];
+        for (int i = 1; i < cc->nProperties; i++)
+            if (cc->properties[i].order < first->order)
+                first = &cc->properties[i];
+        return first->root;
+    }
 
-        // It doesn't belong to our device??
-        if (strcmp(property->device, rdev))
-            continue;
+    ConfigCacheProperty *found = (ConfigCacheProperty *)bsearch(property, cc->properties, cc->nProperties,
+                                 sizeof *cc->properties, configcache_compare_name);
+
+    return found ? found->root : NULL;
+}
+
+void IUInvalidateConfigCache(const char *dev)
+{
+    pthread_mutex_lock(&configCacheMutex);
+
+    for (int i = 0; i < nConfigCache; i++)
+        if (dev == NULL || !strcmp(dev, configCache[i].devName))
+            configcache_clear(&configCache[i]);
 
-        if (!strcmp(property->name, rname))
+    pthread_mutex_unlock(&configCacheMutex);
+}
+
+int IUGetConfigOnSwitch(const ISwitchVectorProperty *property, int *index)
+{
+    int propertyFound = 0;
+    *index = -1;
+
+    pthread_mutex_lock(&configCacheMutex);
+
+    XMLEle *root = configcache_find(property->device, property->name);
+    if (root != NULL)
+    {
+        propertyFound = 1;
+        XMLEle *oneSwitch = NULL;
+        int oneSwitchIndex = 0;
+        ISState oneSwitchState;
+        for (oneSwitch = nextXMLEle(root, 1); oneSwitch != NULL; oneSwitch = nextXMLEle(root, 0), oneSwitchIndex++)
         {
-            propertyFound = 1;
-            XMLEle *oneSwitch = NULL;
-            int oneSwitchIndex = 0;
-            ISState oneSwitchState;
-            for (oneSwitch = nextXMLEle(root, 1); oneSwitch != NULL; oneSwitch = nextXMLEle(root, 0), oneSwitchIndex++)
+            if (crackISState(pcdataXMLEle(oneSwitch), &oneSwitchState) == 0 && oneSwitchState == ISS_ON)
             {
-                if (crackISState(pcdataXMLEle(oneSwitch), &oneSwitchState) == 0 && oneSwitchState == ISS_ON)
-                {
-                    *index = oneSwitchIndex;
-                    break;
-                }
+                *index = oneSwitchIndex;
+                break;
             }
-            break;
         }
     }
 
-    fclose(fp);
-    delXMLEle(fproot);
-    delLilXML(lp);
+    pthread_mutex_unlock(&configCacheMutex);
 
     return (propertyFound ? 0 : -1);
 }
 
 int IUGetConfigSwitch(const char *dev, const char *property, const char *member, ISState *value)
 {
-    char *rname, *rdev;
-    XMLEle *root = NULL, *fproot = NULL;
-    char errmsg[MAXRBUF];
-    LilXML *lp = newLilXML();
     int valueFound = 0;
 
-    FILE *fp = IUGetConfigFP(NULL, dev, "r", errmsg);
-
-    if (fp == NULL)
-        return -1;
-
-    fproot = readXMLFile(fp, lp, errmsg);
-
-    if (fproot == NULL)
-    {
-        fclose(fp);
-        return -1;
-    }
+    pthread_mutex_lock(&configCacheMutex);
 
-    for (root = nextXMLEle(fproot, 1); root != NULL; root = nextXMLEle(fproot, 0))
+    XMLEle *root = configcache_find(dev, property);
+    if (root != NULL)
     {
-        /* pull out device and name */
-        if (crackDN(root, &rdev, &rname, errmsg) < 0)
+        XMLEle *oneSwitch = NULL;
+        for (oneSwitch = nextXMLEle(root, 1); oneSwitch != NULL; oneSwitch = nextXMLEle(root, 0))
         {
-            fclose(fp);
-            delXMLEle(fproot);
-            return -1;
-        }
-
-        // It doesn't belong to our device??
-        if (strcmp(dev, rdev))
-            continue;
-
-        if ((property && !strcmp(property, rname)) || property == NULL)
-        {
-            XMLEle *oneSwitch = NULL;
-            for (oneSwitch = nextXMLEle(root, 1); oneSwitch != NULL; oneSwitch = nextXMLEle(root, 0))
+            if (!strcmp(member, findXMLAttValu(oneSwitch, "name")))
             {
-                if (!strcmp(member, findXMLAttValu(oneSwitch, "name")))
-                {
-                    if (crackISState(pcdataXMLEle(oneSwitch), value) == 0)
-                        valueFound = 1;
-                    break;
-                }
+                if (crackISState(pcdataXMLEle(oneSwitch), value) == 0)
+                    valueFound = 1;
+                break;
             }
-            break;
         }
     }
 
-    fclose(fp);
-    delXMLEle(fproot);
-    delLilXML(lp);
+    pthread_mutex_unlock(&configCacheMutex);
 
     return (valueFound == 1 ? 0 : -1);
 }
 
 int IUGetConfigOnSwitchIndex(const char *dev, const char *property, int *index)
 {
-    char *rname, *rdev;
-    XMLEle *root = NULL, *fproot = NULL;
-    char errmsg[MAXRBUF];
-    LilXML *lp = newLilXML();
     int valueFound = 0;
 
-    FILE *fp = IUGetConfigFP(NULL, dev, "r", errmsg);
-
-    if (fp == NULL)
-        return -1;
-
-    fproot = readXMLFile(fp, lp, errmsg);
-
-    if (fproot == NULL)
-    {
-        fclose(fp);
-        return -1;
-    }
+    pthread_mutex_lock(&configCacheMutex);
 
-    for (root = nextXMLEle(fproot, 1); root != NULL; root = nextXMLEle(fproot, 0))
+    XMLEle *root = configcache_find(dev, property);
+    if (root != NULL)
     {
-        /* pull out device and name */
-        if (crackDN(root, &rdev, &rname, errmsg) < 0)
+        XMLEle *oneSwitch = NULL;
+        int currentIndex = 0;
+        for (oneSwitch = nextXMLEle(root, 1); oneSwitch != NULL; oneSwitch = nextXMLEle(root, 0), currentIndex++)
         {
-            fclose(fp);
-            delXMLEle(fproot);
-            return -1;
-        }
-
-        // It doesn't belong to our device??
-        if (strcmp(dev, rdev))
-            continue;
-
-        if ((property && !strcmp(property, rname)) || property == NULL)
-        {
-            XMLEle *oneSwitch = NULL;
-            int currentIndex = 0;
-            for (oneSwitch = nextXMLEle(root, 1); oneSwitch != NULL; oneSwitch = nextXMLEle(root, 0), currentIndex++)
+            ISState s = ISS_OFF;
+            if (crackISState(pcdataXMLEle(oneSwitch), &s) == 0 && s == ISS_ON)
             {
-                ISState s = ISS_OFF;
-                if (crackISState(pcdataXMLEle(oneSwitch), &s) == 0 && s == ISS_ON)
-                {
-                    *index = currentIndex;
-                    valueFound = 1;
-                    break;
-                }
+                *index = currentIndex;
+                valueFound = 1;
+                break;
             }
-            break;
         }
     }
 
-    fclose(fp);
-    delXMLEle(fproot);
-    delLilXML(lp);
+    pthread_mutex_unlock(&configCacheMutex);
 
     return (valueFound == 1 ? 0 : -1);
 }
 
 int IUGetConfigOnSwitchLabel(const char *dev, const char *property, char *label, size_t size)
 {
-    char *rname, *rdev;
-    XMLEle *root = NULL, *fproot = NULL;
-    char errmsg[MAXRBUF];
-    LilXML *lp = newLilXML();
     int found = -1;
 
-    FILE *fp = IUGetConfigFP(NULL, dev, "r", errmsg);
-
-    if (fp == NULL)
-        return -1;
-
-    fproot = readXMLFile(fp, lp, errmsg);
+    pthread_mutex_lock(&configCacheMutex);
 
-    if (fproot == NULL)
-    {
-        fclose(fp);
-        return -1;
-    }
-
-    for (root = nextXMLEle(fproot, 1); root != NULL; root = nextXMLEle(fproot, 0))
+    XMLEle *root = configcache_find(dev, property);
+    if (root != NULL)
     {
-        /* pull out device and name */
-        if (crackDN(root, &rdev, &rname, errmsg) < 0)
-        {
-            fclose(fp);
-            delXMLEle(fproot);
-            return -1;
-        }
-
-        // It doesn't belong to our device??
-        if (strcmp(dev, rdev))
-            continue;
-
-        if ((property && !strcmp(property, rname)) || property == NULL)
+        XMLEle *oneSwitch = NULL;
+        for (oneSwitch = nextXMLEle(root, 1); oneSwitch != NULL; oneSwitch = nextXMLEle(root, 0))
         {
-            XMLEle *oneSwitch = NULL;
-            int currentIndex = 0;
-            for (oneSwitch = nextXMLEle(root, 1); oneSwitch != NULL; oneSwitch = nextXMLEle(root, 0), currentIndex++)
+            ISState s = ISS_OFF;
+            if (crackISState(pcdataXMLEle(oneSwitch), &s) == 0 && s == ISS_ON)
             {
-                ISState s = ISS_OFF;
-                if (crackISState(pcdataXMLEle(oneSwitch), &s) == 0 && s == ISS_ON)
-                {
-                    found = 0;
-                    strncpy(label, findXMLAttValu(oneSwitch, "name"), size);
-                    break;
-                }
+                found = 0;
+                strncpy(label, findXMLAttValu(oneSwitch, "name"), size);
+                break;
             }
-            break;
         }
     }
 
-    fclose(fp);
-    delXMLEle(fproot);
-    delLilXML(lp);
+    pthread_mutex_unlock(&configCacheMutex);
 
     return found;
 }
 
 int IUGetConfigNumber(const char *dev, const char *property, const char *member, double *value)
 {
-    char *rname, *rdev;
-    XMLEle *root = NULL, *fproot = NULL;
-    char errmsg[MAXRBUF];
-    LilXML *lp = newLilXML();
     int valueFound = 0;
 
-    FILE *fp = IUGetConfigFP(NULL, dev, "r", errmsg);
-
-    if (fp == NULL)
-        return -1;
-
-    fproot = readXMLFile(fp, lp, errmsg);
-
-    if (fproot == NULL)
-    {
-        fclose(fp);
-        return -1;
-    }
+    pthread_mutex_lock(&configCacheMutex);
 
-    for (root = nextXMLEle(fproot, 1); root != NULL; root = nextXMLEle(fproot, 0))
+    XMLEle *root = configcache_find(dev, property);
+    if (root != NULL)
     {
-        /* pull out device and name */
-        if (crackDN(root, &rdev, &rname, errmsg) < 0)
-        {
-            fclose(fp);
-            delXMLEle(fproot);
-            return -1;
-        }
-
-        // It doesn't belong to our device??
-        if (strcmp(dev, rdev))
-            continue;
-
-        if ((property && !strcmp(property, rname)) || property == NULL)
+        XMLEle *oneNumber = NULL;
+        for (oneNumber = nextXMLEle(root, 1); oneNumber != NULL; oneNumber = nextXMLEle(root, 0))
         {
-            XMLEle *oneNumber = NULL;
-            for (oneNumber = nextXMLEle(root, 1); oneNumber != NULL; oneNumber = nextXMLEle(root, 0))
+            if (!strcmp(member, findXMLAttValu(oneNumber, "name")))
             {
-                if (!strcmp(member, findXMLAttValu(oneNumber, "name")))
-                {
-                    *value = atof(pcdataXMLEle(oneNumber));
-                    valueFound = 1;
-                    break;
-                }
+                *value = atof(pcdataXMLEle(oneNumber));
+                valueFound = 1;
+                break;
             }
-            break;
         }
     }
 
-    fclose(fp);
-    delXMLEle(fproot);
-    delLilXML(lp);
+    pthread_mutex_unlock(&configCacheMutex);
 
     return (valueFound == 1 ? 0 : -1);
 }
 
 int IUGetConfigText(const char *dev, const char *property, const char *member, char *value, int len)
 {
-    char *rname, *rdev;
-    XMLEle *root = NULL, *fproot = NULL;
-    char errmsg[MAXRBUF];
-    LilXML *lp = newLilXML();
     int valueFound = 0;
 
-    FILE *fp = IUGetConfigFP(NULL, dev, "r", errmsg);
-
-    if (fp == NULL)
-        return -1;
-
-    fproot = readXMLFile(fp, lp, errmsg);
+    pthread_mutex_lock(&configCacheMutex);
 
-    if (fproot == NULL)
-    {
-        fclose(fp);
-        return -1;
-    }
-
-    for (root = nextXMLEle(fproot, 1); root != NULL; root = nextXMLEle(fproot, 0))
+    XMLEle *root = configcache_find(dev, property);
+    if (root != NULL)
     {
-        /* pull out device and name */
-        if (crackDN(root, &rdev, &rname, errmsg) < 0)
+        XMLEle *oneText = NULL;
+        for (oneText = nextXMLEle(root, 1); oneText != NULL; oneText = nextXMLEle(root, 0))
         {
-            fclose(fp);
-            delXMLEle(fproot);
-            return -1;
-        }
-
-        // It doesn't belong to our device??
-        if (strcmp(dev, rdev))
-            continue;
-
-        if ((property && !strcmp(property, rname)) || property == NULL)
-        {
-            XMLEle *oneText = NULL;
-            for (oneText = nextXMLEle(root, 1); oneText != NULL; oneText = nextXMLEle(root, 0))
+            if (!strcmp(member, findXMLAttValu(oneText, "name")))
             {
-                if (!strcmp(member, findXMLAttValu(oneText, "name")))
-                {
-                    strncpy(value, pcdataXMLEle(oneText), len);
-                    valueFound = 1;
-                    break;
-                }
+                strncpy(value, pcdataXMLEle(oneText), len);
+                valueFound = 1;
+                break;
             }
-            break;
         }
     }
 
-    fclose(fp);
-    delXMLEle(fproot);
-    delLilXML(lp);
+    pthread_mutex_unlock(&configCacheMutex);
 
     return (valueFound == 1 ? 0 : -1);
 }
@@ -1544,6 +1546,8 @@ int IUPurgeConfig(const char *filename, const char *dev, char errmsg[])
             snprintf(configFileName, MAXRBUF, "%s%s_config.xml", configDir, dev);
     }
 
+    IUInvalidateConfigCache(dev);
+
     if (remove(configFileName) != 0)
     {
         snprintf(errmsg, MAXRBUF, "Unable to purge configuration file %s. Error %s", configFileName, strerror(errno));
@@ -1591,6 +1595,10 @@ FILE *IUGetConfigFP(const char *filename, const char *dev, const char *mode, cha
         return NULL;
     }
 
+    /* Any cached copy is stale once the file is opened for writing, including "r+" */
+    if (mode[0] != 'r' || strchr(mode, '+') != NULL)
+        IUInvalidateConfigCache(dev);
+
     fp = fopen(configFileName, mode);
     if (fp == NULL)
     {
@@ -1602,6 +1610,76 @@ FILE *IUGetConfigFP(const char *filename, const char *dev, const char *mode, cha
     return fp;
 }
 
+int IUWriteConfig(const char *filename, const char *dev, const char *buffer, size_t size, char errmsg[])
+{
+    char configFileName[MAXRBUF];
+    char configDir[MAXRBUF];
+    char tmpFileName[MAXRBUF + 8];
+    struct stat st;
+    mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+
+    IUGetConfigFileName(filename, dev, configFileName);
+
+    snprintf(configDir, MAXRBUF, "%s/.indi/", getenv("HOME"));
+    if (filename == NULL && getenv("INDICONFIG") == NULL && stat(configDir, &st) != 0)
+    {
+        if (mkdir(configDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) < 0)
+        {
+            snprintf(errmsg, MAXRBUF, "Unable to create config directory. Error %s: %s", configDir, strerror(errno));
+            return -1;
+        }
+    }
+
+    /* Keep the permissions of an existing config file */
+    if (stat(configFileName, &st) == 0)
+        mode = st.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO);
+
+    snprintf(tmpFileName, sizeof(tmpFileName), "%s.XXXXXX", configFileName);
+    int fd = mkstemp(tmpFileName);
+    if (fd < 0)
+    {
+        snprintf(errmsg, MAXRBUF, "Unable to create temporary config file %s: %s", tmpFileName, strerror(errno));
+        return -1;
+    }
+
+    fchmod(fd, mode);
+
+    size_t written = 0;
+    while (written < size)
+    {
+        ssize_t rc = write(fd, buffer + written, size - written);
+        if (rc < 0 && errno == EINTR)
+            continue;
+        if (rc <= 0)
+        {
+            snprintf(errmsg, MAXRBUF, "Unable to write config file %s: %s", tmpFileName, strerror(errno));
+            close(fd);
+            unlink(tmpFileName);
+            return -1;
+        }
+        written += rc;
+    }
+
+    /* The data must be on disk before the rename, otherwise a crash may leave an empty config file behind */
+    if (fsync(fd) != 0 || close(fd) != 0)
+    {
+        snprintf(errmsg, MAXRBUF, "Unable to flush config file %s: %s", tmpFileName, strerror(errno));
+        unlink(tmpFileName);
+        return -1;
+    }
+
+    if (rename(tmpFileName, configFileName) != 0)
+    {
+        snprintf(errmsg, MAXRBUF, "Unable to replace config file %s: %s", configFileName, strerror(errno));
+        unlink(tmpFileName);
+        return -1;
+    }
+
+    IUInvalidateConfigCache(dev);
+
+    return 0;
+}
+
 void IUSaveConfigTag(FILE *fp, int ctag, const char *dev, int silent)
 {
     if (!fp)
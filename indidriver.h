@@ -80,6 +80,19 @@ be used as the configuration filename</li>
 */
 extern FILE *IUGetConfigFP(const char *filename, const char *dev, const char *mode, char errmsg[]);
 
+/** \brief Atomically replace a configuration file with the contents of a buffer.
+
+  The buffer is written to a temporary file next to the configuration file, flushed to disk and then renamed over
+  the configuration file, so readers and crashes never observe a partially written configuration.
+    \param filename full path of the configuration file. If set to NULL, it will attempt to generate the filename as described in the <b>Detailed Description</b> introduction.
+    \param dev device name. This is used if the filename parameter is NULL, and INDICONFIG environment variable is not set as described in the <b>Detailed Description</b> introduction.
+    \param buffer complete configuration file contents.
+    \param size size of buffer in bytes.
+    \param errmsg In case of errors, store the error message in this buffer. The size of the buffer must be at least MAXRBUF.
+    \return 0 on success, -1 on failure.
+*/
+extern int IUWriteConfig(const char *filename, const char *dev, const char *buffer, size_t size, char errmsg[]);
+
 /**
     \param filename full path of the configuration file. If set, it will be deleted from disk.
            If set to NULL, it will attempt to generate the filename as described in the <b>Detailed Description</b> introduction and then delete it.
@@ -89,6 +102,15 @@ extern FILE *IUGetConfigFP(const char *filename, const char *dev, const char *mo
 */
 extern int IUPurgeConfig(const char *filename, const char *dev, char errmsg[]);
 
+/** \brief Drop the in-memory copy of a configuration file used by the IUGetConfigXXX functions.
+
+  The IUGetConfigXXX functions parse the configuration file of a device once and answer subsequent lookups from memory
+  until the file modification time or size changes. The cache is invalidated automatically when the file is opened for
+  writing with IUGetConfigFP or purged with IUPurgeConfig. Call this function if the file is modified by other means.
+    \param dev device name. If NULL, the cached configuration of all devices is dropped.
+*/
+extern void IUInvalidateConfigCache(const char *dev);
+
 /** \brief Loads and processes a configuration file.
 
   Once a configuration file is successful loaded, the function will iterate over the enclosed newXXX commands, and dispatches
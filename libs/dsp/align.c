@@ -0,0 +1,667 @@
+/*
+ *   libDSPAU - a digital signal processing library for astronomy usage
+ *   Copyright (C) 2026  INDI Library contributors
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dsp.h"
+
+/* Rows per job of the detection passes */
+#define DSP_ALIGN_ROWS 16
+/* Background estimation, clipping in units of the noise and iterations */
+#define DSP_ALIGN_CLIP 3.0
+#define DSP_ALIGN_CLIP_ITERATIONS 3
+/* FWHM of a gaussian over its standard deviation */
+#define DSP_ALIGN_FWHM 2.35482
+
+/*
+ * Star detection. Each threshold level is found in two parallel passes over the rows: the first counts the runs of
+ * elements above the threshold, the second fills them with their intensity moments. The runs touching between
+ * consecutive rows are then joined into components with a union-find, which only costs as much as the runs count.
+ */
+typedef struct dsp_align_run_t
+{
+    int x0;
+    int x1;
+    int y;
+    int parent;
+    double n;
+    double w;
+    double wx;
+    double wy;
+    double wxx;
+    double wyy;
+    double peak;
+    int peak_x;
+    int peak_y;
+} dsp_align_run;
+
+typedef struct dsp_align_detection_t
+{
+    /* Stream thresholded and stream measured, they differ when a star shape is given */
+    dsp_stream_p detect;
+    dsp_stream_p measure;
+    int width;
+    int height;
+    double background;
+    double threshold;
+    /* Background clipping range and partial sums of each job */
+    double lo;
+    double hi;
+    double *sum;
+    double *sum2;
+    double *count;
+    double *max;
+    /* Runs of each row, the runs of row y start at offsets[y] */
+    int *offsets;
+    dsp_align_run *runs;
+    dsp_t **lines;
+    dsp_t **lines_measure;
+    unsigned char **masks;
+} dsp_align_detection;
+
+typedef struct dsp_align_star_t
+{
+    double x;
+    double y;
+    double flux;
+    double diameter;
+    int peak_x;
+    int peak_y;
+} dsp_align_star;
+
+static const dsp_t *dsp_align_row(dsp_stream_p stream, int y, dsp_t *line)
+{
+    int width = stream->sizes[0];
+    if(stream->data == NULL)
+        return stream->buf + (size_t)y * width;
+    dsp_stream_read(stream, (size_t)y * width, 1, line, width);
+    return line;
+}
+
+static void dsp_align_background_pass(void *arg, int index, int thread)
+{
+    dsp_align_detection *d = (dsp_align_detection*)arg;
+    double sum = 0, sum2 = 0, count = 0, mx = dsp_t_min;
+    int x, y;
+    for(y = index * DSP_ALIGN_ROWS; y < Min(d->height, (index + 1) * DSP_ALIGN_ROWS); y++) {
+        const dsp_t *row = dsp_align_row(d->detect, y, d->lines[thread]);
+        for(x = 0; x < d->width; x++) {
+            double v = row[x];
+            double in = (v >= d->lo && v <= d->hi);
+            sum += in * v;
+            sum2 += in * v * v;
+            count += in;
+            mx = Max(mx, v);
+        }
+    }
+    d->sum[index] = sum;
+    d->sum2[index] = sum2;
+    d->count[index] = count;
+    d->max[index] = mx;
+}
+
+static void dsp_align_count_pass(void *arg, int index, int thread)
+{
+    dsp_align_detection *d = (dsp_align_detection*)arg;
+    unsigned char *mask = d->masks[thread];
+    int x, y;
+    for(y = index * DSP_ALIGN_ROWS; y < Min(d->height, (index + 1) * DSP_ALIGN_ROWS); y++) {
+        const dsp_t *row = dsp_align_row(d->detect, y, d->lines[thread]);
+        int runs = 0;
+        /* mask[0] is a guard, element x is at mask[x + 1] */
+        for(x = 0; x < d->width; x++)
+            mask[x + 1] = row[x] > d->threshold;
+        for(x = 0; x < d->width; x++)
+            runs += mask[x + 1] & !mask[x];
+        d->offsets[y + 1] = runs;
+    }
+}
+
+static void dsp_align_fill_pass(void *arg, int index, int thread)
+{
+    dsp_align_detection *d = (dsp_align_detection*)arg;
+    int x, y;
+    for(y = index * DSP_ALIGN_ROWS; y < Min(d->height, (index + 1) * DSP_ALIGN_ROWS); y++) {
+        const dsp_t *row = dsp_align_row(d->detect, y, d->lines[thread]);
+        const dsp_t *values = row;
+        dsp_align_run *run = d->runs + d->offsets[y];
+        if(d->offsets[y + 1] == d->offsets[y])
+            continue;
+        if(d->measure != d->detect)
+            values = dsp_align_row(d->measure, y, d->lines_measure[thread]);
+        for(x = 0; x < d->width; x++) {
+            if(row[x] <= d->threshold)
+                continue;
+            run->x0 = x;
+            run->y = y;
+            run->parent = (int)(run - d->runs);
+            run->n = run->w = run->wx = run->wxx = 0;
+            run->peak = dsp_t_min;
+            for(; x < d->width && row[x] > d->threshold; x++) {
+                double w = Max(0.0, values[x] - d->background);
+                run->n += 1;
+                run->w += w;
+                run->wx += w * x;
+                run->wxx += w * x * x;
+                if(values[x] > run->peak) {
+                    run->peak = values[x];
+                    run->peak_x = x;
+                }
+            }
+            run->x1 = x - 1;
+            run->peak_y = y;
+            run->wy = run->w * y;
+            run->wyy = run->w * y * y;
+            run++;
+        }
+    }
+}
+
+static int dsp_align_find(dsp_align_run *runs, int i)
+{
+    while(runs[i].parent != i) {
+        runs[i].parent = runs[runs[i].parent].parent;
+        i = runs[i].parent;
+    }
+    return i;
+}
+
+static void dsp_align_union(dsp_align_run *runs, int a, int b)
+{
+    a = dsp_align_find(runs, a);
+    b = dsp_align_find(runs, b);
+    if(a == b)
+        return;
+    /* The root is always the first run, so it is the topmost one */
+    if(a < b)
+        runs[b].parent = a;
+    else
+        runs[a].parent = b;
+}
+
+/* Threshold the stream, join the runs and sum their moments into the root runs, returns the runs count */
+static int dsp_align_components(dsp_align_detection *d)
+{
+    int jobs = (d->height + DSP_ALIGN_ROWS - 1) / DSP_ALIGN_ROWS;
+    int y, i, j, total;
+
+    d->offsets[0] = 0;
+    dsp_parallel_for(jobs, dsp_align_count_pass, d);
+    for(y = 0; y < d->height; y++)
+        d->offsets[y + 1] += d->offsets[y];
+    total = d->offsets[d->height];
+    d->runs = (dsp_align_run*)realloc(d->runs, sizeof(dsp_align_run) * Max(1, total));
+    dsp_parallel_for(jobs, dsp_align_fill_pass, d);
+
+    /* Runs of consecutive rows are sorted by x0, walk both rows to join the touching ones, diagonals included */
+    for(y = 1; y < d->height; y++) {
+        i = d->offsets[y - 1];
+        j = d->offsets[y];
+        while(i < d->offsets[y] && j < d->offsets[y + 1]) {
+            if(d->runs[i].x0 <= d->runs[j].x1 + 1 && d->runs[j].x0 <= d->runs[i].x1 + 1)
+                dsp_align_union(d->runs, i, j);
+            if(d->runs[i].x1 < d->runs[j].x1)
+                i++;
+            else
+                j++;
+        }
+    }
+
+    for(i = 0; i < total; i++) {
+        dsp_align_run *run = &d->runs[i];
+        dsp_align_run *root = &d->runs[dsp_align_find(d->runs, i)];
+        if(root == run)
+            continue;
+        root->n += run->n;
+        root->w += run->w;
+        root->wx += run->wx;
+        root->wy += run->wy;
+        root->wxx += run->wxx;
+        root->wyy += run->wyy;
+        if(run->peak > root->peak) {
+            root->peak = run->peak;
+            root->peak_x = run->peak_x;
+            root->peak_y = run->peak_y;
+        }
+    }
+    return total;
+}
+
+/* Root run of the component holding the element, -1 if the element is below the threshold */
+static int dsp_align_component_at(dsp_align_detection *d, int x, int y)
+{
+    int lo = d->offsets[y], hi = d->offsets[y + 1] - 1;
+    while(lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if(d->runs[mid].x1 < x)
+            lo = mid + 1;
+        else if(d->runs[mid].x0 > x)
+            hi = mid - 1;
+        else
+            return dsp_align_find(d->runs, mid);
+    }
+    return -1;
+}
+
+static void dsp_align_measure(dsp_align_run *root, dsp_align_star *star)
+{
+    double var;
+    star->x = root->wx / root->w;
+    star->y = root->wy / root->w;
+    star->flux = root->w;
+    var = root->wxx / root->w - star->x * star->x + root->wyy / root->w - star->y * star->y;
+    star->diameter = DSP_ALIGN_FWHM * sqrt(Max(0.0, var) / 2.0);
+    star->peak_x = root->peak_x;
+    star->peak_y = root->peak_y;
+}
+
+static int dsp_align_star_compare(const void *a, const void *b)
+{
+    double fa = ((const dsp_align_star*)a)->flux;
+    double fb = ((const dsp_align_star*)b)->flux;
+    return (fa < fb) - (fa > fb);
+}
+
+static void dsp_align_clear_stars(dsp_stream_p stream)
+{
+    int i;
+    for(i = 0; i < stream->stars_count; i++)
+        free(stream->stars[i].center.location);
+    stream->stars_count = 0;
+}
+
+int dsp_align_find_stars(dsp_stream_p stream, int levels, int min_size, float threshold, dsp_stream_p matrix)
+{
+    dsp_align_detection d;
+    dsp_align_star *stars = NULL;
+    int *owners = NULL;
+    int stars_count = 0;
+    int threads = dsp_parallel_threads();
+    int jobs, t, i, l, total;
+    double mean = 0, sigma = 0, peak = dsp_t_min, min_area;
+
+    if(stream->dims < 1 || levels < 1)
+        return 0;
+
+    memset(&d, 0, sizeof(d));
+    d.measure = stream;
+    d.detect = stream;
+    if(matrix != NULL) {
+        d.detect = dsp_convolution_convolution(stream, matrix);
+        if(d.detect == NULL)
+            return 0;
+    }
+    d.width = stream->sizes[0];
+    d.height = stream->dims > 1 ? stream->sizes[1] : 1;
+    jobs = (d.height + DSP_ALIGN_ROWS - 1) / DSP_ALIGN_ROWS;
+
+    d.sum = (double*)malloc(sizeof(double) * jobs);
+    d.sum2 = (double*)malloc(sizeof(double) * jobs);
+    d.count = (double*)malloc(sizeof(double) * jobs);
+    d.max = (double*)malloc(sizeof(double) * jobs);
+    d.offsets = (int*)malloc(sizeof(int) * (d.height + 1));
+    d.lines = (dsp_t**)malloc(sizeof(dsp_t*) * threads);
+    d.lines_measure = (dsp_t**)malloc(sizeof(dsp_t*) * threads);
+    d.masks = (unsigned char**)malloc(sizeof(unsigned char*) * threads);
+    for(t = 0; t < threads; t++) {
+        d.lines[t] = (dsp_t*)malloc(sizeof(dsp_t) * d.width);
+        d.lines_measure[t] = (dsp_t*)malloc(sizeof(dsp_t) * d.width);
+        d.masks[t] = (unsigned char*)calloc(d.width + 1, 1);
+    }
+
+    /* Sigma clipped background, the first iteration takes every element */
+    d.lo = dsp_t_min;
+    d.hi = dsp_t_max;
+    for(i = 0; i < DSP_ALIGN_CLIP_ITERATIONS; i++) {
+        double sum = 0, sum2 = 0, count = 0;
+        dsp_parallel_for(jobs, dsp_align_background_pass, &d);
+        for(t = 0; t < jobs; t++) {
+            sum += d.sum[t];
+            sum2 += d.sum2[t];
+            count += d.count[t];
+            peak = Max(peak, d.max[t]);
+        }
+        if(count < 1)
+            break;
+        mean = sum / count;
+        sigma = sqrt(Max(0.0, sum2 / count - mean * mean));
+        d.lo = mean - DSP_ALIGN_CLIP * sigma;
+        d.hi = mean + DSP_ALIGN_CLIP * sigma;
+    }
+    d.background = mean;
+    min_area = M_PI * min_size * min_size / 4.0;
+
+    /* From the highest level down, a component holding the peak of one star refines it, one holding none is a new star */
+    for(l = levels - 1; l >= 0 && threshold * sigma > 0 && peak > mean + threshold * sigma; l--) {
+        double base = threshold * sigma;
+        d.threshold = mean + base * pow((peak - mean) / base, (double)l / levels);
+        total = dsp_align_components(&d);
+
+        owners = (int*)realloc(owners, sizeof(int) * Max(1, total));
+        for(i = 0; i < total; i++)
+            owners[i] = -1;
+        for(i = 0; i < stars_count; i++) {
+            int root = dsp_align_component_at(&d, stars[i].peak_x, stars[i].peak_y);
+            if(root < 0)
+                continue;
+            /* -2 marks components joining several stars, they are left to the higher levels */
+            owners[root] = owners[root] == -1 ? i : -2;
+        }
+        for(i = 0; i < total; i++) {
+            if(d.runs[i].parent != i || owners[i] == -2 || d.runs[i].n < min_area || d.runs[i].w <= 0)
+                continue;
+            if(owners[i] == -1) {
+                stars = (dsp_align_star*)realloc(stars, sizeof(dsp_align_star) * (stars_count + 1));
+                owners[i] = stars_count++;
+            }
+            dsp_align_measure(&d.runs[i], &stars[owners[i]]);
+        }
+    }
+
+    if(stars_count > 0)
+        qsort(stars, stars_count, sizeof(dsp_align_star), dsp_align_star_compare);
+    dsp_align_clear_stars(stream);
+    for(i = 0; i < stars_count; i++) {
+        dsp_star star;
+        star.center.dims = 2;
+        star.center.location = (double*)malloc(sizeof(double) * 2);
+        star.center.location[0] = stars[i].x;
+        star.center.location[1] = stars[i].y;
+        star.diameter = stars[i].diameter;
+        dsp_stream_add_star(stream, star);
+    }
+
+    for(t = 0; t < threads; t++) {
+        free(d.lines[t]);
+        free(d.lines_measure[t]);
+        free(d.masks[t]);
+    }
+    free(d.lines);
+    free(d.lines_measure);
+    free(d.masks);
+    free(d.sum);
+    free(d.sum2);
+    free(d.count);
+    free(d.max);
+    free(d.offsets);
+    free(d.runs);
+    free(owners);
+    free(stars);
+    if(d.detect != stream) {
+        dsp_stream_free_buffer(d.detect);
+        dsp_stream_free(d.detect);
+    }
+    return stars_count;
+}
+
+int dsp_align_crop_limit(dsp_stream_p reference, dsp_stream_p to_align, int n, int radius)
+{
+    int width = to_align->sizes[0];
+    int height = to_align->dims > 1 ? to_align->sizes[1] : 1;
+    int i, y, added = 0;
+
+    if(to_align->dims < 1 || radius < 0)
+        return 0;
+
+    for(i = 0; i < Min(n, reference->stars_count); i++) {
+        double *center = reference->stars[i].center.location;
+        int x0 = Max(0, (int)floor(center[0]) - radius);
+        int x1 = Min(width - 1, (int)floor(center[0]) + radius);
+        int y0 = to_align->dims > 1 ? Max(0, (int)floor(center[1]) - radius) : 0;
+        int y1 = to_align->dims > 1 ? Min(height - 1, (int)floor(center[1]) + radius) : 0;
+        dsp_stream_p crop;
+        if(x0 > x1 || y0 > y1)
+            continue;
+        crop = dsp_stream_new();
+        dsp_stream_add_dim(crop, x1 - x0 + 1);
+        crop->ROI[0].start = x0;
+        crop->ROI[0].len = x1 - x0 + 1;
+        if(to_align->dims > 1) {
+            dsp_stream_add_dim(crop, y1 - y0 + 1);
+            crop->ROI[1].start = y0;
+            crop->ROI[1].len = y1 - y0 + 1;
+        }
+        dsp_stream_alloc_buffer(crop, crop->len);
+        for(y = y0; y <= y1; y++)
+            dsp_stream_read(to_align, (size_t)y * width + x0, 1, crop->buf + (size_t)(y - y0) * crop->sizes[0], crop->sizes[0]);
+        dsp_stream_add_child(to_align, crop);
+        added++;
+    }
+    return added;
+}
+
+/*
+ * Registration. Triangles are described by the ratios of their shorter sides to the longest one, which do not change
+ * with translation, rotation and scale, and by their orientation, which tells mirrored triangles apart. Each pair of
+ * triangles with the same description votes for the three star pairs at the corresponding vertices.
+ */
+typedef struct dsp_align_triangle_t
+{
+    double ratios[2];
+    /* Stars opposite to the longest, middle and shortest side */
+    int stars[3];
+    int orientation;
+} dsp_align_triangle;
+
+static int dsp_align_triangle_compare(const void *a, const void *b)
+{
+    double ra = ((const dsp_align_triangle*)a)->ratios[0];
+    double rb = ((const dsp_align_triangle*)b)->ratios[0];
+    return (ra > rb) - (ra < rb);
+}
+
+static int dsp_align_triangles(dsp_stream_p stream, int n, dsp_align_triangle *triangles)
+{
+    int a, b, c, k, count = 0;
+    for(a = 0; a < n; a++) {
+        for(b = a + 1; b < n; b++) {
+            for(c = b + 1; c < n; c++) {
+                double *p[3] = { stream->stars[a].center.location, stream->stars[b].center.location, stream->stars[c].center.location };
+                int v[3] = { a, b, c };
+                double sides[3];
+                int order[3] = { 0, 1, 2 };
+                double cross;
+                /* sides[k] is opposite to vertex k */
+                for(k = 0; k < 3; k++) {
+                    double dx = p[(k + 2) % 3][0] - p[(k + 1) % 3][0];
+                    double dy = p[(k + 2) % 3][1] - p[(k + 1) % 3][1];
+                    sides[k] = sqrt(dx * dx + dy * dy);
+                }
+                for(k = 0; k < 3; k++) {
+                    int m;
+                    for(m = k + 1; m < 3; m++) {
+                        if(sides[order[m]] > sides[order[k]]) {
+                            int tmp = order[k];
+                            order[k] = order[m];
+                            order[m] = tmp;
+                        }
+                    }
+                }
+                if(sides[order[2]] <= 0)
+                    continue;
+                triangles[count].ratios[0] = sides[order[1]] / sides[order[0]];
+                triangles[count].ratios[1] = sides[order[2]] / sides[order[0]];
+                for(k = 0; k < 3; k++)
+                    triangles[count].stars[k] = v[order[k]];
+                /* Orientation of the vertices in side order */
+                {
+                    double *p0 = p[order[0]], *p1 = p[order[1]], *p2 = p[order[2]];
+                    cross = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p1[1] - p0[1]) * (p2[0] - p0[0]);
+                }
+                triangles[count].orientation = cross > 0 ? 1 : -1;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/* Least squares similarity from the points q to the points p, around the centroid of q */
+static void dsp_align_fit(const double *p, const double *q, int n, double *center, double *offset, double *radians, double *factor)
+{
+    double pc[2] = { 0, 0 }, qc[2] = { 0, 0 };
+    double a = 0, b = 0, norm = 0;
+    int i;
+    for(i = 0; i < n; i++) {
+        pc[0] += p[i * 2] / n;
+        pc[1] += p[i * 2 + 1] / n;
+        qc[0] += q[i * 2] / n;
+        qc[1] += q[i * 2 + 1] / n;
+    }
+    for(i = 0; i < n; i++) {
+        double px = p[i * 2] - pc[0], py = p[i * 2 + 1] - pc[1];
+        double qx = q[i * 2] - qc[0], qy = q[i * 2 + 1] - qc[1];
+        a += qx * px + qy * py;
+        b += qx * py - qy * px;
+        norm += qx * qx + qy * qy;
+    }
+    center[0] = qc[0];
+    center[1] = qc[1];
+    offset[0] = pc[0] - qc[0];
+    offset[1] = pc[1] - qc[1];
+    *radians = atan2(b, a);
+    *factor = norm > 0 ? sqrt(a * a + b * b) / norm : 1.0;
+}
+
+static double dsp_align_residual(const double *p, const double *q, const double *center, const double *offset, double radians, double factor)
+{
+    double x = q[0] - center[0], y = q[1] - center[1];
+    double tx = factor * (x * cos(radians) - y * sin(radians)) + center[0] + offset[0];
+    double ty = factor * (x * sin(radians) + y * cos(radians)) + center[1] + offset[1];
+    return sqrt((tx - p[0]) * (tx - p[0]) + (ty - p[1]) * (ty - p[1]));
+}
+
+static int dsp_align_double_compare(const void *a, const void *b)
+{
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+int dsp_align_get_offset(dsp_stream_p stream1, dsp_stream_p stream2, int max_stars, int decimals)
+{
+    int n1 = Min(stream1->stars_count, max_stars);
+    int n2 = Min(stream2->stars_count, max_stars);
+    double tolerance = pow(10.0, -decimals);
+    dsp_align_triangle *t1, *t2;
+    int *votes, *best;
+    double *p, *q, *residuals;
+    double center[2], offset[2], radians, factor;
+    int count1, count2, i, j, k, pairs = 0, max_votes = 0;
+
+    if(n1 < 3 || n2 < 3 || stream2->dims < 2)
+        return 0;
+
+    t1 = (dsp_align_triangle*)malloc(sizeof(dsp_align_triangle) * n1 * (n1 - 1) * (n1 - 2) / 6);
+    t2 = (dsp_align_triangle*)malloc(sizeof(dsp_align_triangle) * n2 * (n2 - 1) * (n2 - 2) / 6);
+    count1 = dsp_align_triangles(stream1, n1, t1);
+    count2 = dsp_align_triangles(stream2, n2, t2);
+    qsort(t1, count1, sizeof(dsp_align_triangle), dsp_align_triangle_compare);
+
+    votes = (int*)calloc(n1 * n2, sizeof(int));
+    for(j = 0; j < count2; j++) {
+        int lo = 0, hi = count1;
+        /* First triangle of stream1 within the tolerance of the first ratio */
+        while(lo < hi) {
+            int mid = (lo + hi) / 2;
+            if(t1[mid].ratios[0] < t2[j].ratios[0] - tolerance)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        for(i = lo; i < count1 && t1[i].ratios[0] <= t2[j].ratios[0] + tolerance; i++) {
+            if(fabs(t1[i].ratios[1] - t2[j].ratios[1]) > tolerance || t1[i].orientation != t2[j].orientation)
+                continue;
+            for(k = 0; k < 3; k++) {
+                int v = ++votes[t1[i].stars[k] * n2 + t2[j].stars[k]];
+                max_votes = Max(max_votes, v);
+            }
+        }
+    }
+
+    /* Pairs voted by at least half of the best one, and the best one of both their stars */
+    best = (int*)malloc(sizeof(int) * n2);
+    p = (double*)malloc(sizeof(double) * 2 * n2);
+    q = (double*)malloc(sizeof(double) * 2 * n2);
+    for(j = 0; j < n2; j++) {
+        int v = 0;
+        best[j] = -1;
+        for(i = 0; i < n1; i++) {
+            if(votes[i * n2 + j] > v) {
+                v = votes[i * n2 + j];
+                best[j] = i;
+            }
+        }
+        if(best[j] < 0 || v * 2 < max_votes)
+            continue;
+        for(k = 0; k < n2; k++) {
+            if(k != j && votes[best[j] * n2 + k] >= v)
+                break;
+        }
+        if(k < n2)
+            continue;
+        p[pairs * 2] = stream1->stars[best[j]].center.location[0];
+        p[pairs * 2 + 1] = stream1->stars[best[j]].center.location[1];
+        q[pairs * 2] = stream2->stars[j].center.location[0];
+        q[pairs * 2 + 1] = stream2->stars[j].center.location[1];
+        pairs++;
+    }
+
+    if(pairs >= 2) {
+        dsp_align_fit(p, q, pairs, center, offset, &radians, &factor);
+
+        /* Drop the pairs far from the fit and fit again */
+        residuals = (double*)malloc(sizeof(double) * pairs);
+        for(i = 0; i < pairs; i++)
+            residuals[i] = dsp_align_residual(p + i * 2, q + i * 2, center, offset, radians, factor);
+        qsort(residuals, pairs, sizeof(double), dsp_align_double_compare);
+        {
+            double limit = 3.0 * residuals[pairs / 2] + 1.0;
+            int kept = 0;
+            for(i = 0; i < pairs; i++) {
+                if(dsp_align_residual(p + i * 2, q + i * 2, center, offset, radians, factor) > limit)
+                    continue;
+                p[kept * 2] = p[i * 2];
+                p[kept * 2 + 1] = p[i * 2 + 1];
+                q[kept * 2] = q[i * 2];
+                q[kept * 2 + 1] = q[i * 2 + 1];
+                kept++;
+            }
+            if(kept >= 2 && kept < pairs) {
+                dsp_align_fit(p, q, kept, center, offset, &radians, &factor);
+                pairs = kept;
+            }
+        }
+        free(residuals);
+
+        stream2->align_info.center[0] = center[0];
+        stream2->align_info.center[1] = center[1];
+        stream2->align_info.offset[0] = offset[0];
+        stream2->align_info.offset[1] = offset[1];
+        stream2->align_info.radians[0] = radians;
+        stream2->align_info.factor = factor;
+    } else {
+        pairs = 0;
+    }
+
+    free(t1);
+    free(t2);
+    free(votes);
+    free(best);
+    free(p);
+    free(q);
+    return pairs;
+}
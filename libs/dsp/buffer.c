@@ -197,27 +197,12 @@ void dsp_buffer_log1(dsp_stream_p stream, double val)
 
 }
 
-static int compare( const void* a, const void* b)
-{
-     dsp_t int_a = * ( (dsp_t*) a );
-     dsp_t int_b = * ( (dsp_t*) b );
-
-     if ( int_a == int_b ) return 0;
-     else if ( int_a < int_b ) return -1;
-     else return 1;
-}
-
 void dsp_buffer_median(dsp_stream_p stream, int size, int median)
 {
-	int k;
-    int mid = (size / 2) + (size % 2);
-    dsp_t* sorted = (dsp_t*)malloc(size * sizeof(dsp_t));
-    for(k = mid; k < stream->len; k++) {
-        memcpy (sorted, stream->buf + (k - mid), size * sizeof(dsp_t));
-        qsort(sorted, size, sizeof(dsp_t), compare);
-        stream->buf[k] = sorted[median];
-	}
-
+    dsp_t* in = (dsp_t*)malloc(sizeof(dsp_t) * stream->len);
+    dsp_buffer_copy(stream->buf, in, stream->len);
+    dsp_filter_rank_buffer(in, stream->buf, stream->len, size, median);
+    free(in);
 }
 
 void dsp_buffer_deviate(dsp_stream_p stream, dsp_t* deviation, dsp_t mindeviation, dsp_t maxdeviation)
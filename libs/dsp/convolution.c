@@ -17,52 +17,494 @@
  */
 
 #include "dsp.h"
+#include "fft_p.h"
 
-static void* dsp_convolution_convolution_th(void* arg)
+/* Output rows per job of the direct and separable paths */
+#define DSP_CONVOLUTION_ROWS 16
+/* Output rows per job of typed streams, the input rows of a band are converted to dsp_t once */
+#define DSP_CONVOLUTION_BAND 64
+/* Output tile size of the FFT path, the transform size adds the matrix size */
+#define DSP_CONVOLUTION_TILE 256
+
+enum
 {
-    dsp_stream_p matrix = (dsp_stream_p)arg;
-    dsp_stream_p field = (dsp_stream_p)matrix->parent;
-    dsp_stream_p stream = (dsp_stream_p)field->parent;
-    int y = matrix->ROI[0].start;
-    int* pos = dsp_stream_get_position(matrix, y);
-    int x, d;
-    for(x = 0; x < stream->len; x++)
-    {
-        int* pos1 = dsp_stream_get_position(field, x);
-        for(d = 0; d < field->dims; d++)
-            pos1[d] += pos[d];
-        int z = dsp_stream_set_position(field, pos1);
-        if(z >= 0 && z < field->len && x >= 0 && x < stream->len && y >= 0)
-            stream->buf[x] += field->buf[z] * matrix->buf[y];
-        free(pos1);
+    DSP_CONVOLUTION_ROW,
+    DSP_CONVOLUTION_COLUMN,
+    DSP_CONVOLUTION_SEPARABLE,
+    DSP_CONVOLUTION_DIRECT,
+};
+
+typedef struct dsp_convolution_job_t
+{
+    const dsp_t *in;
+    dsp_t *out;
+    /* Streams, read and written through dsp_stream_read and dsp_stream_write when typed */
+    dsp_stream_p stream_in;
+    dsp_stream_p stream_out;
+    int mode;
+    int width;
+    int height;
+    const dsp_t *matrix;
+    int mwidth;
+    int mheight;
+    int cx;
+    int cy;
+    /* Separable path */
+    dsp_t *row;
+    dsp_t *column;
+    /* Typed streams, per thread rows of a band */
+    dsp_t **band_in;
+    dsp_t **band_tmp;
+    dsp_t **band_out;
+    /* FFT path */
+    int fx;
+    int fy;
+    int bx;
+    int by;
+    int tiles_x;
+    dsp_fourier_plan *forward;
+    dsp_fourier_plan *backward;
+    fftw_complex *spectrum;
+    double **real;
+    fftw_complex **complex;
+    /* N-dimensional path */
+    int dims;
+    int *sizes;
+    int *msizes;
+    int len;
+    int mlen;
+} dsp_convolution_job;
+
+/* dst[x] += k * src[x + d] for all x where x + d is inside the row */
+static inline void dsp_convolution_axpy(dsp_t *dst, const dsp_t *src, int width, int d, dsp_t k)
+{
+    int x;
+    int start = Max(0, -d);
+    int end = Min(width, width - d);
+    for(x = start; x < end; x++)
+        dst[x] += k * src[x + d];
+}
+
+/* Rank one matrices are the outer product of a column and a row */
+static int dsp_convolution_separate(const dsp_t *matrix, int mwidth, int mheight, dsp_t *row, dsp_t *column)
+{
+    int i, j, p = 0;
+    double peak = 0;
+    for(i = 0; i < mwidth * mheight; i++) {
+        if(fabs(matrix[i]) > peak) {
+            peak = fabs(matrix[i]);
+            p = i;
+        }
+    }
+    if(peak == 0)
+        return 0;
+    for(i = 0; i < mwidth; i++)
+        row[i] = matrix[(p / mwidth) * mwidth + i];
+    for(j = 0; j < mheight; j++)
+        column[j] = matrix[j * mwidth + p % mwidth] / matrix[p];
+    for(j = 0; j < mheight; j++) {
+        for(i = 0; i < mwidth; i++) {
+            if(fabs(matrix[j * mwidth + i] - column[j] * row[i]) > peak * 1e-9)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static void dsp_convolution_row(const dsp_convolution_job *job, const dsp_t *src, dsp_t *dst)
+{
+    int i;
+    memset(dst, 0, sizeof(dsp_t) * job->width);
+    for(i = 0; i < job->mwidth; i++)
+        dsp_convolution_axpy(dst, src, job->width, job->cx - i, job->row[i]);
+}
+
+/* Output row y from the input rows [first, last), in points at row first */
+static void dsp_convolution_column(const dsp_convolution_job *job, const dsp_t *in, int first, int last, int y,
+                                   dsp_t *dst)
+{
+    int j;
+    memset(dst, 0, sizeof(dsp_t) * job->width);
+    for(j = 0; j < job->mheight; j++) {
+        int yy = y + job->cy - j;
+        if(yy >= first && yy < last)
+            dsp_convolution_axpy(dst, in + (size_t)(yy - first) * job->width, job->width, 0, job->column[j]);
+    }
+}
+
+static void dsp_convolution_direct(const dsp_convolution_job *job, const dsp_t *in, int first, int last, int y,
+                                   dsp_t *dst)
+{
+    int j, i;
+    memset(dst, 0, sizeof(dsp_t) * job->width);
+    for(j = 0; j < job->mheight; j++) {
+        int yy = y + job->cy - j;
+        if(yy < first || yy >= last)
+            continue;
+        for(i = 0; i < job->mwidth; i++) {
+            dsp_t k = job->matrix[j * job->mwidth + i];
+            if(k != 0)
+                dsp_convolution_axpy(dst, in + (size_t)(yy - first) * job->width, job->width, job->cx - i, k);
+        }
+    }
+}
+
+static void dsp_convolution_row_pass(void *arg, int index, int thread)
+{
+    dsp_convolution_job *job = (dsp_convolution_job*)arg;
+    int y;
+    int end = Min(job->height, (index + 1) * DSP_CONVOLUTION_ROWS);
+    (void)thread;
+    for(y = index * DSP_CONVOLUTION_ROWS; y < end; y++)
+        dsp_convolution_row(job, job->in + (size_t)y * job->width, job->out + (size_t)y * job->width);
+}
+
+static void dsp_convolution_column_pass(void *arg, int index, int thread)
+{
+    dsp_convolution_job *job = (dsp_convolution_job*)arg;
+    int y;
+    int end = Min(job->height, (index + 1) * DSP_CONVOLUTION_ROWS);
+    (void)thread;
+    for(y = index * DSP_CONVOLUTION_ROWS; y < end; y++)
+        dsp_convolution_column(job, job->in, 0, job->height, y, job->out + (size_t)y * job->width);
+}
+
+static void dsp_convolution_direct_pass(void *arg, int index, int thread)
+{
+    dsp_convolution_job *job = (dsp_convolution_job*)arg;
+    int y;
+    int end = Min(job->height, (index + 1) * DSP_CONVOLUTION_ROWS);
+    (void)thread;
+    for(y = index * DSP_CONVOLUTION_ROWS; y < end; y++)
+        dsp_convolution_direct(job, job->in, 0, job->height, y, job->out + (size_t)y * job->width);
+}
+
+/*
+ * Typed streams are processed in bands of output rows. The input rows of a band are converted to dsp_t, filtered,
+ * and the output rows converted back, so no dsp_t copy of the whole stream is made. The separable path repeats the
+ * row pass on the mheight - 1 rows shared by neighbouring bands.
+ */
+static void dsp_convolution_band_pass(void *arg, int index, int thread)
+{
+    dsp_convolution_job *job = (dsp_convolution_job*)arg;
+    dsp_t *in = job->band_in[thread];
+    dsp_t *tmp = job->band_tmp[thread];
+    dsp_t *out = job->band_out[thread];
+    int y0 = index * DSP_CONVOLUTION_BAND;
+    int y1 = Min(job->height, y0 + DSP_CONVOLUTION_BAND);
+    int first = Max(0, y0 + job->cy - job->mheight + 1);
+    int last = Min(job->height, y1 + job->cy);
+    int y;
+
+    if(last > first)
+        dsp_stream_read(job->stream_in, (size_t)first * job->width, 1, in, (last - first) * job->width);
+
+    for(y = y0; y < y1; y++) {
+        dsp_t *dst = out + (size_t)(y - y0) * job->width;
+        switch(job->mode) {
+            case DSP_CONVOLUTION_ROW:
+                dsp_convolution_row(job, in + (size_t)(y - first) * job->width, dst);
+                break;
+            case DSP_CONVOLUTION_COLUMN:
+                dsp_convolution_column(job, in, first, last, y, dst);
+                break;
+            case DSP_CONVOLUTION_SEPARABLE:
+                if(y == y0) {
+                    int r;
+                    for(r = first; r < last; r++)
+                        dsp_convolution_row(job, in + (size_t)(r - first) * job->width, tmp + (size_t)(r - first) * job->width);
+                }
+                dsp_convolution_column(job, tmp, first, last, y, dst);
+                break;
+            default:
+                dsp_convolution_direct(job, in, first, last, y, dst);
+                break;
+        }
+    }
+
+    dsp_stream_write(job->stream_out, (size_t)y0 * job->width, 1, out, (y1 - y0) * job->width);
+}
+
+static void dsp_convolution_typed(dsp_convolution_job *job)
+{
+    int threads = dsp_parallel_threads();
+    size_t rows = DSP_CONVOLUTION_BAND + job->mheight - 1;
+    int t;
+
+    job->band_in = (dsp_t**)malloc(sizeof(dsp_t*) * threads);
+    job->band_tmp = (dsp_t**)malloc(sizeof(dsp_t*) * threads);
+    job->band_out = (dsp_t**)malloc(sizeof(dsp_t*) * threads);
+    for(t = 0; t < threads; t++) {
+        job->band_in[t] = (dsp_t*)malloc(sizeof(dsp_t) * rows * job->width);
+        job->band_tmp[t] = job->mode == DSP_CONVOLUTION_SEPARABLE ? (dsp_t*)malloc(sizeof(dsp_t) * rows * job->width) : NULL;
+        job->band_out[t] = (dsp_t*)malloc(sizeof(dsp_t) * DSP_CONVOLUTION_BAND * job->width);
+    }
+
+    dsp_parallel_for((job->height + DSP_CONVOLUTION_BAND - 1) / DSP_CONVOLUTION_BAND, dsp_convolution_band_pass, job);
+
+    for(t = 0; t < threads; t++) {
+        free(job->band_in[t]);
+        free(job->band_tmp[t]);
+        free(job->band_out[t]);
+    }
+    free(job->band_in);
+    free(job->band_tmp);
+    free(job->band_out);
+}
+
+/*
+ * Overlap-save: each output tile is the valid part of the circular convolution of an input tile, extended by the
+ * matrix size minus one, with the matrix. Tiles do not share any output, so they run in parallel without locking.
+ */
+static void dsp_convolution_fft_tile(void *arg, int index, int thread)
+{
+    dsp_convolution_job *job = (dsp_convolution_job*)arg;
+    double *real = job->real[thread];
+    fftw_complex *spectrum = job->complex[thread];
+    int ox = (index % job->tiles_x) * job->bx;
+    int oy = (index / job->tiles_x) * job->by;
+    int x0 = ox - (job->mwidth - 1 - job->cx);
+    int y0 = oy - (job->mheight - 1 - job->cy);
+    int xs = Max(0, x0);
+    int xe = Min(job->width, x0 + job->fx);
+    int v, y, n;
+
+    for(v = 0; v < job->fy; v++) {
+        double *dst = real + (size_t)v * job->fx;
+        int yy = y0 + v;
+        memset(dst, 0, sizeof(double) * job->fx);
+        if(yy >= 0 && yy < job->height && xe > xs)
+            dsp_stream_read(job->stream_in, (size_t)yy * job->width + xs, 1, dst + xs - x0, xe - xs);
+    }
+
+    fftw_execute_dft_r2c(job->forward->plan, real, spectrum);
+    for(n = 0; n < job->fy * (job->fx / 2 + 1); n++) {
+        double re = spectrum[n][0] * job->spectrum[n][0] - spectrum[n][1] * job->spectrum[n][1];
+        double im = spectrum[n][0] * job->spectrum[n][1] + spectrum[n][1] * job->spectrum[n][0];
+        spectrum[n][0] = re;
+        spectrum[n][1] = im;
+    }
+    fftw_execute_dft_c2r(job->backward->plan, spectrum, real);
+
+    for(y = oy; y < Min(job->height, oy + job->by); y++) {
+        v = y - oy + job->mheight - 1;
+        dsp_stream_write(job->stream_out, (size_t)y * job->width + ox, 1, real + (size_t)v * job->fx + job->mwidth - 1,
+                         Min(job->bx, job->width - ox));
+    }
+}
+
+/* Smallest size >= n whose only prime factors are 2, 3, 5 and 7, FFTW is fastest on these */
+static int dsp_convolution_fft_size(int n)
+{
+    for(;; n++) {
+        int m = n;
+        while(m % 2 == 0) m /= 2;
+        while(m % 3 == 0) m /= 3;
+        while(m % 5 == 0) m /= 5;
+        while(m % 7 == 0) m /= 7;
+        if(m == 1)
+            return n;
+    }
+}
+
+/* Returns 0 without touching the output when the sizes cannot be planned */
+static int dsp_convolution_fft(dsp_convolution_job *job)
+{
+    int threads = dsp_parallel_threads();
+    int sizes[2] = { job->fx, job->fy };
+    int spectrum_len, t, j;
+    double *matrix;
+
+    /* Tiles are transformed in parallel already, the plans run single threaded */
+    job->forward = dsp_fourier_plan_acquire(2, sizes, 0, 1);
+    job->backward = dsp_fourier_plan_acquire(2, sizes, 1, 1);
+    if(job->forward == NULL || job->backward == NULL) {
+        if(job->forward != NULL)
+            dsp_fourier_plan_release(job->forward);
+        if(job->backward != NULL)
+            dsp_fourier_plan_release(job->backward);
+        return 0;
+    }
+
+    spectrum_len = job->fy * (job->fx / 2 + 1);
+    job->real = (double**)malloc(sizeof(double*) * threads);
+    job->complex = (fftw_complex**)malloc(sizeof(fftw_complex*) * threads);
+    for(t = 0; t < threads; t++) {
+        job->real[t] = (double*)fftw_malloc(sizeof(double) * job->fx * job->fy);
+        job->complex[t] = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * spectrum_len);
+    }
+    job->spectrum = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * spectrum_len);
+
+    /* Transform of the matrix, scaled by the normalization of the inverse transform */
+    matrix = job->real[0];
+    memset(matrix, 0, sizeof(double) * job->fx * job->fy);
+    for(j = 0; j < job->mheight; j++)
+        memcpy(matrix + (size_t)j * job->fx, job->matrix + (size_t)j * job->mwidth, sizeof(double) * job->mwidth);
+    fftw_execute_dft_r2c(job->forward->plan, matrix, job->spectrum);
+    for(j = 0; j < spectrum_len; j++) {
+        job->spectrum[j][0] /= (double)job->fx * job->fy;
+        job->spectrum[j][1] /= (double)job->fx * job->fy;
+    }
+
+    dsp_parallel_for(job->tiles_x * ((job->height + job->by - 1) / job->by), dsp_convolution_fft_tile, job);
+
+    dsp_fourier_plan_release(job->forward);
+    dsp_fourier_plan_release(job->backward);
+    for(t = 0; t < threads; t++) {
+        fftw_free(job->real[t]);
+        fftw_free(job->complex[t]);
+    }
+    fftw_free(job->spectrum);
+    free(job->real);
+    free(job->complex);
+    return 1;
+}
+
+/* Streams with more than two dimensions, the matrix is applied element by element */
+static void dsp_convolution_nd_pass(void *arg, int index, int thread)
+{
+    dsp_convolution_job *job = (dsp_convolution_job*)arg;
+    int chunk = DSP_CONVOLUTION_ROWS * job->sizes[0];
+    int end = Min(job->len, (index + 1) * chunk);
+    int *pos = (int*)malloc(sizeof(int) * job->dims);
+    int x, k, d;
+    (void)thread;
+    for(x = index * chunk; x < end; x++) {
+        dsp_t sum = 0;
+        int rest = x;
+        for(d = 0; d < job->dims; d++) {
+            pos[d] = rest % job->sizes[d];
+            rest /= job->sizes[d];
+        }
+        for(k = 0; k < job->mlen; k++) {
+            int z = 0, stride = 1, mrest = k, inside = 1;
+            for(d = 0; d < job->dims; d++) {
+                int c = pos[d] + job->msizes[d] / 2 - mrest % job->msizes[d];
+                mrest /= job->msizes[d];
+                if(c < 0 || c >= job->sizes[d]) {
+                    inside = 0;
+                    break;
+                }
+                z += c * stride;
+                stride *= job->sizes[d];
+            }
+            if(inside)
+                sum += job->in[z] * job->matrix[k];
+        }
+        job->out[x] = sum;
     }
     free(pos);
-    dsp_stream_free_buffer(matrix);
-    dsp_stream_free(matrix);
-    return NULL;
 }
 
 dsp_stream_p dsp_convolution_convolution(dsp_stream_p stream, dsp_stream_p object) {
-    dsp_stream_p field = dsp_stream_copy(stream);
-    dsp_stream_p tmp = dsp_stream_copy(stream);
-    dsp_buffer_set(tmp->buf, tmp->len, 0);
-    field->parent = tmp;
-    int n_threads = object->len;
-    pthread_t *th = malloc(sizeof(pthread_t)*n_threads);
-    int y, xy;
-    for(y = -n_threads; y < n_threads; y+=DSP_MAX_THREADS)
+    dsp_convolution_job job;
+    dsp_stream_p out;
+    dsp_t *matrix = object->buf;
+    int d, rows;
+
+    if(object->dims > stream->dims || stream->len <= 0 || object->len <= 0)
+        return NULL;
+
+    /* The result of a typed stream has the same type */
+    out = dsp_stream_copy(stream);
+    if(object->data != NULL) {
+        matrix = (dsp_t*)malloc(sizeof(dsp_t) * object->len);
+        dsp_stream_read(object, 0, 1, matrix, object->len);
+    }
+    memset(&job, 0, sizeof(job));
+    job.stream_in = stream;
+    job.stream_out = out;
+    job.in = stream->buf;
+    job.out = out->buf;
+    job.matrix = matrix;
+
+    if(stream->dims > 2) {
+        dsp_t *in = NULL, *result = NULL;
+        /* Typed streams are converted as a whole, this path is not meant for large streams */
+        if(stream->data != NULL) {
+            in = (dsp_t*)malloc(sizeof(dsp_t) * stream->len);
+            result = (dsp_t*)malloc(sizeof(dsp_t) * stream->len);
+            dsp_stream_read(stream, 0, 1, in, stream->len);
+            job.in = in;
+            job.out = result;
+        }
+        job.dims = stream->dims;
+        job.len = stream->len;
+        job.mlen = object->len;
+        job.sizes = stream->sizes;
+        job.msizes = (int*)malloc(sizeof(int) * stream->dims);
+        for(d = 0; d < stream->dims; d++)
+            job.msizes[d] = d < object->dims ? object->sizes[d] : 1;
+        dsp_parallel_for((stream->len + DSP_CONVOLUTION_ROWS * stream->sizes[0] - 1) / (DSP_CONVOLUTION_ROWS * stream->sizes[0]),
+                         dsp_convolution_nd_pass, &job);
+        if(stream->data != NULL)
+            dsp_stream_write(out, 0, 1, result, stream->len);
+        free(in);
+        free(result);
+        free(job.msizes);
+        if(matrix != object->buf)
+            free(matrix);
+        return out;
+    }
+
+    job.width = stream->sizes[0];
+    job.height = stream->dims > 1 ? stream->sizes[1] : 1;
+    job.mwidth = object->sizes[0];
+    job.mheight = object->dims > 1 ? object->sizes[1] : 1;
+    job.cx = job.mwidth / 2;
+    job.cy = job.mheight / 2;
+    job.row = (dsp_t*)malloc(sizeof(dsp_t) * job.mwidth);
+    job.column = (dsp_t*)malloc(sizeof(dsp_t) * job.mheight);
+    rows = (job.height + DSP_CONVOLUTION_ROWS - 1) / DSP_CONVOLUTION_ROWS;
+
+    job.fx = dsp_convolution_fft_size(Min(DSP_CONVOLUTION_TILE, job.width) + job.mwidth - 1);
+    job.fy = dsp_convolution_fft_size(Min(DSP_CONVOLUTION_TILE, job.height) + job.mheight - 1);
+    job.bx = job.fx - job.mwidth + 1;
+    job.by = job.fy - job.mheight + 1;
+    job.tiles_x = (job.width + job.bx - 1) / job.bx;
+
     {
-        for(xy = 0; xy < DSP_MAX_THREADS; xy++) {
-            dsp_stream_p matrix = dsp_stream_copy(object);
-            matrix->parent = field;
-            matrix->ROI[0].start = xy;
-            matrix->ROI[0].len = 0;
-            pthread_create(&th[xy], NULL, dsp_convolution_convolution_th, (void*)matrix);
+        int separable = dsp_convolution_separate(job.matrix, job.mwidth, job.mheight, job.row, job.column);
+        double direct_cost = separable ? job.mwidth + job.mheight : (double)job.mwidth * job.mheight;
+        double fft_cost = 6.0 * Log((double)job.fx * job.fy, 2) * job.fx * job.fy / ((double)job.bx * job.by);
+
+        if(separable && job.mheight == 1) {
+            job.mode = DSP_CONVOLUTION_ROW;
+        } else if(separable && job.mwidth == 1) {
+            for(d = 0; d < job.mheight; d++)
+                job.column[d] *= job.row[0];
+            job.mode = DSP_CONVOLUTION_COLUMN;
+        } else if(separable) {
+            job.mode = DSP_CONVOLUTION_SEPARABLE;
+        } else {
+            job.mode = DSP_CONVOLUTION_DIRECT;
+        }
+
+        /* The direct paths are the fallback when the transform cannot be planned */
+        if(direct_cost <= fft_cost || !dsp_convolution_fft(&job)) {
+            if(stream->data != NULL) {
+                dsp_convolution_typed(&job);
+            } else if(job.mode == DSP_CONVOLUTION_ROW) {
+                dsp_parallel_for(rows, dsp_convolution_row_pass, &job);
+            } else if(job.mode == DSP_CONVOLUTION_COLUMN) {
+                dsp_parallel_for(rows, dsp_convolution_column_pass, &job);
+            } else if(job.mode == DSP_CONVOLUTION_SEPARABLE) {
+                dsp_t *tmp = (dsp_t*)malloc(sizeof(dsp_t) * stream->len);
+                job.out = tmp;
+                dsp_parallel_for(rows, dsp_convolution_row_pass, &job);
+                job.in = tmp;
+                job.out = out->buf;
+                dsp_parallel_for(rows, dsp_convolution_column_pass, &job);
+                free(tmp);
+            } else {
+                dsp_parallel_for(rows, dsp_convolution_direct_pass, &job);
+            }
         }
-        for(xy = 0; xy < DSP_MAX_THREADS; xy++)
-            pthread_join(th[xy], NULL);
     }
-    dsp_stream_free_buffer(field);
-    dsp_stream_free(field);
-    return tmp;
+
+    free(job.row);
+    free(job.column);
+    if(matrix != object->buf)
+        free(matrix);
+    return out;
 }
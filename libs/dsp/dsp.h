@@ -36,6 +36,7 @@ extern "C" {
 #include <time.h>
 #include <assert.h>
 #include <pthread.h>
+#include <stdint.h>
 
 
 /**
@@ -165,6 +166,23 @@ typedef struct dsp_star_t
 */
 typedef void *(*dsp_func_t) (void *, ...);
 
+/**
+* \brief Element type of a typed stream buffer
+* \sa dsp_stream_alloc_typed_buffer
+* \sa dsp_stream_set_typed_buffer
+*/
+typedef enum
+{
+/// double, the type of dsp_t
+    dsp_type_double = 0,
+/// float
+    dsp_type_float,
+/// unsigned 8 bit integer
+    dsp_type_uint8,
+/// unsigned 16 bit integer
+    dsp_type_uint16,
+} dsp_type;
+
 /**
 * \brief Contains a set of informations and data relative to a buffer and how to use it
 * \sa dsp_stream_new
@@ -224,6 +242,12 @@ typedef struct dsp_stream_t
     dsp_align_info align_info;
 /// Frame number (if part of a series)
     int frame_number;
+/// Typed buffer, holds the elements in place of buf when not NULL
+    void *data;
+/// Element type of the typed buffer
+    dsp_type type;
+/// Whether the typed buffer is freed with the stream buffer
+    int data_owned;
 } dsp_stream, *dsp_stream_p;
 
 /*@}*/
@@ -234,13 +258,17 @@ typedef struct dsp_stream_t
 
 /**
 * \brief Perform a discrete Fourier Transform of a dsp_stream
+* Typed streams are supported.
 * \param stream the inout stream.
+* \return the full complex spectrum, of the stream length, to be freed by the caller.
 */
 DLL_EXPORT dsp_complex* dsp_fourier_dft(dsp_stream_p stream);
 
 /**
 * \brief Perform an inverse discrete Fourier Transform of a dsp_stream
+* Typed streams are converted with dsp_stream_convert_typed_buffer first, the result is written to the dsp_t buffer.
 * \param stream the inout stream.
+* \return the dsp_t buffer of the stream
 */
 DLL_EXPORT dsp_t* dsp_fourier_idft(dsp_stream_p stream);
 
@@ -355,18 +383,88 @@ DLL_EXPORT void dsp_filter_bandpass(dsp_stream_p stream, double samplingfrequenc
 */
 DLL_EXPORT void dsp_filter_bandreject(dsp_stream_p stream, double samplingfrequency, double LowFrequency, double HighFrequency);
 
+/*@}*/
+/**
+ * \defgroup dsp_RankFilters DSP API Rank filtering functions
+*/
+/*@{*/
+
+/**
+* \brief Sliding rank filter of a buffer, each output element is the element of the given rank of the centered window
+* The buffer edges are replicated. Each element costs O(log size).
+* \param in the input buffer.
+* \param out the output buffer, it must not overlap the input buffer.
+* \param len the length in elements of the buffers.
+* \param size the window size.
+* \param rank the rank in the sorted window, from 0 (minimum) to size - 1 (maximum).
+*/
+DLL_EXPORT void dsp_filter_rank_buffer(const dsp_t *in, dsp_t *out, int len, int size, int rank);
+
+/**
+* \brief Separable rank filter of a stream, the sliding rank filter is applied along each dimension in turn
+* This is the usual fast approximation of the rank filter over a square window, exact for the minimum and the maximum.
+* Lines are filtered in parallel on the libdsp thread pool. Typed streams are supported, the result has the type of
+* the input stream.
+* \param stream the input stream.
+* \param size the window size along each dimension.
+* \param rank the rank in the sorted window, from 0 (minimum) to size - 1 (maximum).
+* \return A new stream holding the result, or NULL if rank is out of range.
+*/
+DLL_EXPORT dsp_stream_p dsp_filter_rank(dsp_stream_p stream, int size, int rank);
+
+/**
+* \brief Separable median filter of a stream
+* \param stream the input stream.
+* \param size the window size along each dimension.
+* \return A new stream holding the result, or NULL if size is not positive.
+*/
+DLL_EXPORT dsp_stream_p dsp_filter_median(dsp_stream_p stream, int size);
+
 /*@}*/
 /**
  * \defgroup dsp_Convolution DSP API Convolution and cross-correlation functions
 */
 /*@{*/
 /**
-* \brief A cross-convolution processor
-* \param stream1 the first input stream.
-* \param stream2 the second input stream.
+* \brief Convolute a stream with a matrix
+*
+* The matrix is centered on each element and elements outside the stream count as zero, so the output has the
+* size of the input stream. Separable two-dimensional matrices are applied as two one-dimensional passes, small
+* matrices directly, and large matrices by FFT in overlapping tiles. Work is split across the threads of the
+* libdsp thread pool. Typed streams are supported, the result has the type of the input stream.
+* \param stream1 the input stream.
+* \param stream2 the convolution matrix, with at most as many dimensions as the input stream.
+* \return A new stream holding the result, or NULL if the matrix has more dimensions than the stream.
 */
 DLL_EXPORT dsp_stream_p dsp_convolution_convolution(dsp_stream_p stream1, dsp_stream_p stream2);
 
+/*@}*/
+/**
+ * \defgroup dsp_Parallel DSP API Multithreading functions
+*/
+/*@{*/
+
+/**
+* \brief Job function for dsp_parallel_for
+* \param arg the argument passed to dsp_parallel_for.
+* \param index the index of the job, from 0 to count - 1.
+* \param thread the index of the thread running the job, from 0 to dsp_parallel_threads() - 1.
+*/
+typedef void (*dsp_parallel_func)(void *arg, int index, int thread);
+
+/**
+* \brief Obtain the number of threads of the libdsp thread pool, including the calling thread
+*/
+DLL_EXPORT int dsp_parallel_threads();
+
+/**
+* \brief Run count jobs on the libdsp thread pool and wait for them to complete
+* \param count the number of jobs.
+* \param func the job function.
+* \param arg the argument passed to the job function.
+*/
+DLL_EXPORT void dsp_parallel_for(int count, dsp_parallel_func func, void *arg);
+
 /*@}*/
 /**
  * \defgroup dsp_Stats DSP API Buffer statistics functions
@@ -724,6 +822,7 @@ DLL_EXPORT void dsp_buffer_log1(dsp_stream_p stream, double val);
 * \param stream the stream on which execute
 * \param size the length of the median.
 * \param median the location of the median value.
+* \sa dsp_filter_rank_buffer
 */
 DLL_EXPORT void dsp_buffer_median(dsp_stream_p stream, int size, int median);
 
@@ -744,8 +843,8 @@ DLL_EXPORT void dsp_buffer_deviate(dsp_stream_p stream, dsp_t* deviation, dsp_t
 #ifndef dsp_buffer_reverse
 #define dsp_buffer_reverse(buf, len) \
     ({ \
-        int i = (len - 1) / 2; \
-        int j = i + 1; \
+        int i = len / 2 - 1; \
+        int j = (len + 1) / 2; \
         __typeof__(buf[0]) _x; \
         while(i >= 0) \
         { \
@@ -847,11 +946,60 @@ DLL_EXPORT void dsp_stream_set_buffer(dsp_stream_p stream, void *buffer, int len
 DLL_EXPORT dsp_t* dsp_stream_get_buffer(dsp_stream_p stream);
 
 /**
-* \brief Free the buffer of the DSP Stream passed as argument
+* \brief Free the buffer of the DSP Stream passed as argument, and its typed buffer if allocated by libdsp
 * \param stream the target DSP stream.
 */
 DLL_EXPORT void dsp_stream_free_buffer(dsp_stream_p stream);
 
+/**
+* \brief Allocate a typed buffer of the stream length, the elements are kept in the given type instead of dsp_t
+* Functions supporting typed streams read and write the typed buffer, converting single lines from and to dsp_t,
+* so a 16 bit frame takes a quarter of the memory of its dsp_t copy. The other functions require a dsp_t buffer,
+* convert the stream with dsp_stream_convert_typed_buffer before passing it to them.
+* \param stream the target DSP stream.
+* \param type the element type.
+* \sa dsp_stream_convert_typed_buffer
+*/
+DLL_EXPORT void dsp_stream_alloc_typed_buffer(dsp_stream_p stream, dsp_type type);
+
+/**
+* \brief Use existing memory as the typed buffer of the stream, without copying it
+* The memory is not freed by libdsp.
+* \param stream the target DSP stream.
+* \param data the elements, the stream length must be set already.
+* \param type the element type.
+*/
+DLL_EXPORT void dsp_stream_set_typed_buffer(dsp_stream_p stream, void *data, dsp_type type);
+
+/**
+* \brief Convert a typed stream into a dsp_t stream, for the functions that do not support typed streams
+* The elements are copied into the dsp_t buffer and the typed buffer is released, freed only if allocated by libdsp.
+* Streams without a typed buffer are left as they are.
+* \param stream the target DSP stream.
+* \return the dsp_t buffer of the stream
+*/
+DLL_EXPORT dsp_t* dsp_stream_convert_typed_buffer(dsp_stream_p stream);
+
+/**
+* \brief Read elements of a stream as dsp_t, from the typed buffer if any
+* \param stream the source DSP stream.
+* \param offset the index of the first element.
+* \param stride the distance between two elements.
+* \param out the output buffer.
+* \param count the number of elements.
+*/
+DLL_EXPORT void dsp_stream_read(dsp_stream_p stream, size_t offset, int stride, dsp_t *out, int count);
+
+/**
+* \brief Write dsp_t elements to a stream, integer types are rounded and saturated
+* \param stream the target DSP stream.
+* \param offset the index of the first element.
+* \param stride the distance between two elements.
+* \param in the input buffer.
+* \param count the number of elements.
+*/
+DLL_EXPORT void dsp_stream_write(dsp_stream_p stream, size_t offset, int stride, const dsp_t *in, int count);
+
 /**
 * \brief Allocate a new DSP stream type
 * \return the newly created DSP stream type
@@ -868,6 +1016,7 @@ DLL_EXPORT void dsp_stream_free(dsp_stream_p stream);
 
 /**
 * \brief Create a copy of the DSP stream passed as argument
+* The copy of a typed stream is a typed stream of the same type.
 * \param stream the DSP stream to copy.
 * \return the copy of the DSP stream
 * \sa dsp_stream_new
@@ -892,6 +1041,7 @@ DLL_EXPORT void dsp_stream_add_child(dsp_stream_p stream, dsp_stream_p child);
 
 /**
 * \brief Add a star to the DSP Stream passed as argument
+* The stream owns the location of the star, it is freed with the stream or by dsp_stream_del_star.
 * \param stream the target DSP stream.
 * \param child the star to add to DSP stream.
 * \sa dsp_stream_new
@@ -1030,19 +1180,32 @@ DLL_EXPORT void dsp_modulation_frequency(dsp_stream_p stream, double samplefreq,
 */
 DLL_EXPORT void dsp_modulation_amplitude(dsp_stream_p stream, double samplefreq, double freq);
 
+/*@}*/
+/**
+ * \defgroup dsp_Align DSP API Star detection and alignment functions
+*/
+/*@{*/
+
 /**
 * \brief Find stars into the stream
+* The background and its noise are estimated with a sigma clipped mean, then the stream is thresholded at levels
+* thresholds, spaced exponentially from threshold times the noise over the background up to the brightest element.
+* Stars found at a level are measured again on their larger component at the lower levels, unless that component
+* joins more stars. The stars of the stream are replaced with the ones found, brightest first, their center is the
+* intensity weighted centroid and their diameter the FWHM estimated from the second moments.
+* Only the first two dimensions are searched.
 * \param stream The stream containing stars
 * \param levels The level of thresholding
-* \param min_size Minimum stellar size
-* \param threshold Intensity treshold
-* \param matrix The star shape
-* \return The new dsp_stream_p structure pointer
+* \param min_size Minimum stellar size, the diameter of the circle with the area of the thresholded star
+* \param threshold Intensity treshold, in units of the background noise
+* \param matrix The star shape, the stream is convolved with it before thresholding, NULL to threshold the stream
+* \return The number of stars found
 */
 DLL_EXPORT int dsp_align_find_stars(dsp_stream_p stream, int levels, int min_size, float threshold, dsp_stream_p matrix);
 
 /**
 * \brief Limit search area to the radius around the first n stars and store those streams as children of the stream to be aligned
+* The ROI of each child holds the position of the area into to_align.
 * \param reference The reference solved stream
 * \param to_align The stream to be aligned
 * \param n Stars count limit
@@ -1053,14 +1216,17 @@ DLL_EXPORT int dsp_align_crop_limit(dsp_stream_p reference, dsp_stream_p to_alig
 
 /**
 * \brief Find offsets between 2 streams and extract align informations
-* \param stream1 The first stream
-* \param stream2 The second stream
+* The triangles formed by the brightest stars of both streams are matched by their side ratios, the star pairs voted
+* by the matching triangles give the scale, rotation and translation of stream2 against stream1. A star at p into
+* stream2 is at factor * R(radians) * (p - center) + center + offset into stream1, the results are stored into the
+* align_info of stream2.
+* \param stream1 The reference stream, its stars have been found
+* \param stream2 The stream to be aligned, its stars have been found
 * \param max_stars The maximum stars count allowed
-* \param precision The precision used for comparison
-* \param start_star Start compare from the start_star brigher star
-* \return The new dsp_align_info structure pointer
+* \param decimals The precision used to compare the side ratios, in decimal digits
+* \return The number of matched stars, 0 if the streams could not be matched
 */
-DLL_EXPORT int dsp_align_get_offset(dsp_stream_p stream1, dsp_stream_p stream, int max_stars, int decimals);
+DLL_EXPORT int dsp_align_get_offset(dsp_stream_p stream1, dsp_stream_p stream2, int max_stars, int decimals);
 
 /**
 * \brief Rotate a stream around an axis and offset
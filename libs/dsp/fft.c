@@ -16,8 +16,240 @@
  *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "dsp.h"
-#include <fftw3.h>
+#include "fft_p.h"
+#include "config.h"
+#include <unistd.h>
+
+/* Number of plans kept by the cache, plans in use are never destroyed */
+#define DSP_FOURIER_CACHE_SIZE 16
+/* Streams with at least this many elements are transformed with the FFTW threads */
+#define DSP_FOURIER_THREADS_MIN 65536
+/* Upper bound in seconds of the FFTW_MEASURE planning of a single plan */
+#define DSP_FOURIER_PLAN_TIMELIMIT 5.0
+
+/*
+ * Plans are measured once and kept, the wisdom gathered by the planner is saved to $HOME/.indi/fftw_wisdom, or to
+ * the file named by INDIFFTWWISDOM, so later runs plan the same sizes almost instantly.
+ * The FFTW planner is not thread safe, plans are created and destroyed under the planner lock only. Measuring a plan
+ * takes up to DSP_FOURIER_PLAN_TIMELIMIT seconds, the cache lock is never held meanwhile so lookups of cached plans
+ * do not wait for the planner. When both are needed the planner lock is taken first.
+ */
+static pthread_mutex_t dsp_fourier_planner_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t dsp_fourier_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static dsp_fourier_plan *dsp_fourier_cache = NULL;
+/* Plans trimmed from the cache, destroyed by the next holder of the planner lock */
+static dsp_fourier_plan *dsp_fourier_retired = NULL;
+static int dsp_fourier_cache_count = 0;
+static unsigned long dsp_fourier_cache_clock = 0;
+static int dsp_fourier_wisdom_loaded = 0;
+
+static int dsp_fourier_wisdom_filename(char *filename, size_t size)
+{
+    if(getenv("INDIFFTWWISDOM"))
+        return snprintf(filename, size, "%s", getenv("INDIFFTWWISDOM")) < (int)size;
+    if(getenv("HOME"))
+        return snprintf(filename, size, "%s/.indi/fftw_wisdom", getenv("HOME")) < (int)size;
+    return 0;
+}
+
+static void dsp_fourier_wisdom_load()
+{
+    char filename[1024];
+    if(dsp_fourier_wisdom_loaded)
+        return;
+    dsp_fourier_wisdom_loaded = 1;
+#ifdef HAVE_FFTW3_THREADS
+    fftw_init_threads();
+#endif
+    fftw_set_timelimit(DSP_FOURIER_PLAN_TIMELIMIT);
+    fftw_import_system_wisdom();
+    if(dsp_fourier_wisdom_filename(filename, sizeof(filename)))
+        fftw_import_wisdom_from_filename(filename);
+}
+
+static void dsp_fourier_wisdom_save()
+{
+    char filename[1024], tmp[1040];
+    int fd;
+    FILE *f;
+    if(!dsp_fourier_wisdom_filename(filename, sizeof(filename)))
+        return;
+    /* Other processes may save their wisdom at the same time, replace the file atomically */
+    snprintf(tmp, sizeof(tmp), "%s.XXXXXX", filename);
+    fd = mkstemp(tmp);
+    if(fd < 0)
+        return;
+    f = fdopen(fd, "w");
+    if(f == NULL) {
+        close(fd);
+        unlink(tmp);
+        return;
+    }
+    fftw_export_wisdom_to_file(f);
+    if(fclose(f) != 0 || rename(tmp, filename) != 0)
+        unlink(tmp);
+}
+
+/* The planner lock must be held */
+static void dsp_fourier_plan_destroy(dsp_fourier_plan *plan)
+{
+    fftw_destroy_plan(plan->plan);
+    free(plan->sizes);
+    free(plan);
+}
+
+/* The planner lock must be held, the buffers are only needed while measuring */
+static dsp_fourier_plan *dsp_fourier_plan_create(int dims, const int *sizes, int inverse, int threads)
+{
+    dsp_fourier_plan *plan = (dsp_fourier_plan*)calloc(1, sizeof(dsp_fourier_plan));
+    int *n = (int*)malloc(sizeof(int) * dims);
+    double *real;
+    fftw_complex *complex;
+    int d;
+
+    plan->inverse = inverse;
+    plan->threads = threads;
+    plan->dims = dims;
+    plan->sizes = (int*)malloc(sizeof(int) * dims);
+    memcpy(plan->sizes, sizes, sizeof(int) * dims);
+    plan->len = 1;
+    for(d = 0; d < dims; d++)
+        plan->len *= sizes[d];
+    plan->complex_len = plan->len / sizes[0] * (sizes[0] / 2 + 1);
+    real = (double*)fftw_malloc(sizeof(double) * plan->len);
+    complex = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * plan->complex_len);
+
+    /* FFTW expects the slowest varying dimension first */
+    memcpy(n, sizes, sizeof(int) * dims);
+    dsp_buffer_reverse(n, dims);
+#ifdef HAVE_FFTW3_THREADS
+    fftw_plan_with_nthreads(threads);
+#endif
+    if(inverse)
+        plan->plan = fftw_plan_dft_c2r(dims, n, complex, real, FFTW_MEASURE);
+    else
+        plan->plan = fftw_plan_dft_r2c(dims, n, real, complex, FFTW_MEASURE);
+    free(n);
+    fftw_free(real);
+    fftw_free(complex);
+
+    if(plan->plan == NULL) {
+        free(plan->sizes);
+        free(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+/* Move the least recently used plans beyond the cache size to the retired list, the cache lock must be held */
+static void dsp_fourier_cache_trim()
+{
+    while(dsp_fourier_cache_count > DSP_FOURIER_CACHE_SIZE) {
+        dsp_fourier_plan **p, **oldest = NULL;
+        for(p = &dsp_fourier_cache; *p != NULL; p = &(*p)->next) {
+            if((*p)->users == 0 && (oldest == NULL || (*p)->used < (*oldest)->used))
+                oldest = p;
+        }
+        if(oldest == NULL)
+            break;
+        dsp_fourier_plan *plan = *oldest;
+        *oldest = plan->next;
+        plan->next = dsp_fourier_retired;
+        dsp_fourier_retired = plan;
+        dsp_fourier_cache_count--;
+    }
+}
+
+/* Destroy the retired plans, the planner lock must be held */
+static void dsp_fourier_retired_destroy()
+{
+    dsp_fourier_plan *plan;
+    pthread_mutex_lock(&dsp_fourier_cache_lock);
+    plan = dsp_fourier_retired;
+    dsp_fourier_retired = NULL;
+    pthread_mutex_unlock(&dsp_fourier_cache_lock);
+    while(plan != NULL) {
+        dsp_fourier_plan *next = plan->next;
+        dsp_fourier_plan_destroy(plan);
+        plan = next;
+    }
+}
+
+/* Find a cached plan and mark it used, the cache lock must be held */
+static dsp_fourier_plan *dsp_fourier_cache_find(int dims, const int *sizes, int inverse, int threads)
+{
+    dsp_fourier_plan *plan;
+    int d;
+    for(plan = dsp_fourier_cache; plan != NULL; plan = plan->next) {
+        if(plan->inverse != inverse || plan->threads != threads || plan->dims != dims)
+            continue;
+        for(d = 0; d < dims && plan->sizes[d] == sizes[d]; d++);
+        if(d == dims)
+            break;
+    }
+    if(plan != NULL) {
+        plan->users++;
+        plan->used = ++dsp_fourier_cache_clock;
+    }
+    return plan;
+}
+
+dsp_fourier_plan *dsp_fourier_plan_acquire(int dims, const int *sizes, int inverse, int threads)
+{
+    dsp_fourier_plan *plan;
+
+    if(dims < 1 || sizes[0] < 1)
+        return NULL;
+#ifndef HAVE_FFTW3_THREADS
+    threads = 1;
+#endif
+
+    pthread_mutex_lock(&dsp_fourier_cache_lock);
+    plan = dsp_fourier_cache_find(dims, sizes, inverse, threads);
+    pthread_mutex_unlock(&dsp_fourier_cache_lock);
+    if(plan != NULL)
+        return plan;
+
+    pthread_mutex_lock(&dsp_fourier_planner_lock);
+    /* Another thread may have planned the same sizes while this one waited for the planner */
+    pthread_mutex_lock(&dsp_fourier_cache_lock);
+    plan = dsp_fourier_cache_find(dims, sizes, inverse, threads);
+    pthread_mutex_unlock(&dsp_fourier_cache_lock);
+    if(plan == NULL) {
+        dsp_fourier_wisdom_load();
+        plan = dsp_fourier_plan_create(dims, sizes, inverse, threads);
+        if(plan != NULL) {
+            dsp_fourier_wisdom_save();
+            pthread_mutex_lock(&dsp_fourier_cache_lock);
+            plan->users = 1;
+            plan->used = ++dsp_fourier_cache_clock;
+            plan->next = dsp_fourier_cache;
+            dsp_fourier_cache = plan;
+            dsp_fourier_cache_count++;
+            dsp_fourier_cache_trim();
+            pthread_mutex_unlock(&dsp_fourier_cache_lock);
+        }
+    }
+    dsp_fourier_retired_destroy();
+    pthread_mutex_unlock(&dsp_fourier_planner_lock);
+    return plan;
+}
+
+void dsp_fourier_plan_release(dsp_fourier_plan *plan)
+{
+    int retired;
+    pthread_mutex_lock(&dsp_fourier_cache_lock);
+    plan->users--;
+    dsp_fourier_cache_trim();
+    retired = dsp_fourier_retired != NULL;
+    pthread_mutex_unlock(&dsp_fourier_cache_lock);
+    /* Do not wait for a plan being measured, the retired plans are left to the planner or to a later release */
+    if(retired && pthread_mutex_trylock(&dsp_fourier_planner_lock) == 0) {
+        dsp_fourier_retired_destroy();
+        pthread_mutex_unlock(&dsp_fourier_planner_lock);
+    }
+}
+
 
 double dsp_fourier_complex_get_magnitude(dsp_complex n)
 {
@@ -53,38 +285,83 @@ double* dsp_fourier_complex_array_get_phase(dsp_complex* in, int len)
     return out;
 }
 
+static void dsp_fourier_expand(const dsp_fourier_plan *plan, const fftw_complex *complex, dsp_complex *out)
+{
+    /* FFTW stores half of the last dimension, the other half is the complex conjugate of the mirrored elements */
+    int n = plan->sizes[0];
+    int h = n / 2 + 1;
+    int rows = plan->len / n;
+    int r, x, d;
+    for(r = 0; r < rows; r++) {
+        int m = 0, rest = r, stride = 1;
+        for(d = 1; d < plan->dims; d++) {
+            int c = rest % plan->sizes[d];
+            rest /= plan->sizes[d];
+            m += ((plan->sizes[d] - c) % plan->sizes[d]) * stride;
+            stride *= plan->sizes[d];
+        }
+        const fftw_complex *src = complex + (size_t)r * h;
+        const fftw_complex *mirror = complex + (size_t)m * h;
+        dsp_complex *dst = out + (size_t)r * n;
+        for(x = 0; x < h && x < n; x++) {
+            dst[x].real = src[x][0];
+            dst[x].imaginary = src[x][1];
+        }
+        for(; x < n; x++) {
+            dst[x].real = mirror[n - x][0];
+            dst[x].imaginary = -mirror[n - x][1];
+        }
+    }
+}
+
+/* Transforms of large streams use the FFTW threads, small ones would only pay the synchronization */
+static int dsp_fourier_threads(int len)
+{
+    return len >= DSP_FOURIER_THREADS_MIN ? dsp_parallel_threads() : 1;
+}
+
 dsp_complex* dsp_fourier_dft(dsp_stream_p stream)
 {
-    double* dft = (double*)malloc(sizeof(double) * stream->len);
-    dsp_complex* out = (dsp_complex*)malloc(sizeof(dsp_complex) * stream->len);
-    dsp_buffer_copy(stream->buf, dft, stream->len);
-    int *sizes = (int*)malloc(sizeof(int)*stream->dims);
-    memcpy (sizes, stream->sizes, sizeof(int)*stream->dims);
-    dsp_buffer_reverse(sizes, stream->dims);
-    fftw_plan plan = fftw_plan_dft_r2c(stream->dims, sizes, dft, (fftw_complex*)out, FFTW_ESTIMATE);
-    fftw_execute(plan);
-    fftw_free(plan);
-    fftw_free(dft);
+    dsp_complex* out;
+    double *real;
+    fftw_complex *complex;
+    dsp_fourier_plan *plan = dsp_fourier_plan_acquire(stream->dims, stream->sizes, 0, dsp_fourier_threads(stream->len));
+    if(plan == NULL)
+        return NULL;
+    out = (dsp_complex*)malloc(sizeof(dsp_complex) * stream->len);
+    real = (double*)fftw_malloc(sizeof(double) * plan->len);
+    complex = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * plan->complex_len);
+    dsp_stream_read(stream, 0, 1, real, stream->len);
+    fftw_execute_dft_r2c(plan->plan, real, complex);
+    dsp_fourier_expand(plan, complex, out);
+    fftw_free(real);
+    fftw_free(complex);
+    dsp_fourier_plan_release(plan);
     return out;
 }
 
 dsp_t* dsp_fourier_idft(dsp_stream_p stream)
 {
-    dsp_complex* dft = (dsp_complex*)malloc(sizeof(dsp_complex) * stream->len);
-    double* out = (double*)malloc(sizeof(double) * stream->len);
     int x;
-    for (x=0; x<stream->len; x++) {
-        dft[x].real = stream->buf[x];
-        dft[x].imaginary = stream->buf[x];
+    double *real;
+    fftw_complex *complex;
+    dsp_fourier_plan *plan;
+    /* The result is returned as dsp_t, the type of the input could not hold it anyway */
+    dsp_stream_convert_typed_buffer(stream);
+    plan = dsp_fourier_plan_acquire(stream->dims, stream->sizes, 1, dsp_fourier_threads(stream->len));
+    if(plan == NULL)
+        return stream->buf;
+    real = (double*)fftw_malloc(sizeof(double) * plan->len);
+    complex = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * plan->complex_len);
+    dsp_stream_read(stream, 0, 1, real, stream->len);
+    for (x=0; x<plan->complex_len; x++) {
+        complex[x][0] = real[x];
+        complex[x][1] = real[x];
     }
-    int *sizes = (int*)malloc(sizeof(int)*stream->dims);
-    memcpy (sizes, stream->sizes, sizeof(int)*stream->dims);
-    dsp_buffer_reverse(sizes, stream->dims);
-    fftw_plan plan = fftw_plan_dft_c2r(stream->dims, sizes, (fftw_complex*)dft, out, FFTW_ESTIMATE);
-    fftw_execute(plan);
-    dsp_buffer_copy(out, stream->buf, stream->len);
-    fftw_free(plan);
-    free(dft);
-    free(out);
+    fftw_execute_dft_c2r(plan->plan, complex, real);
+    dsp_stream_write(stream, 0, 1, real, stream->len);
+    fftw_free(real);
+    fftw_free(complex);
+    dsp_fourier_plan_release(plan);
     return stream->buf;
 }
@@ -0,0 +1,57 @@
+/*
+ *   libDSPAU - a digital signal processing library for astronoms usage
+ *   Copyright (C) 2026  INDI Library contributors
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DSP_FFT_P_H
+#define _DSP_FFT_P_H
+
+#include "dsp.h"
+#include <fftw3.h>
+
+/*
+ * Cached real to complex (forward) or complex to real (inverse) FFTW plan. The cache keeps no data buffers, the plan
+ * is executed with fftw_execute_dft_r2c or fftw_execute_dft_c2r on fftw_malloc buffers of the caller, with len real
+ * and complex_len complex elements. Execution does not need any lock, the input of inverse plans is overwritten.
+ */
+typedef struct dsp_fourier_plan_t
+{
+    int inverse;
+    int threads;
+    int dims;
+    /* Sizes in stream order, the first dimension is the fastest varying one */
+    int *sizes;
+    int len;
+    int complex_len;
+    fftw_plan plan;
+    int users;
+    unsigned long used;
+    struct dsp_fourier_plan_t *next;
+} dsp_fourier_plan;
+
+/*
+ * Obtain the cached plan of the given sizes, planning it on first use. threads is the number of FFTW threads,
+ * use 1 for plans executed from dsp_parallel_for jobs. Every call must be matched by dsp_fourier_plan_release.
+ * Returns NULL when the sizes cannot be planned.
+ */
+dsp_fourier_plan *dsp_fourier_plan_acquire(int dims, const int *sizes, int inverse, int threads);
+
+/*
+ * Release a plan obtained from dsp_fourier_plan_acquire. Unused plans are destroyed when the cache is full.
+ */
+void dsp_fourier_plan_release(dsp_fourier_plan *plan);
+
+#endif /* _DSP_FFT_P_H */
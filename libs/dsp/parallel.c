@@ -0,0 +1,137 @@
+/*
+ *   libDSPAU - a digital signal processing library for astronoms usage
+ *   Copyright (C) 2026  INDI Library contributors
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dsp.h"
+#include <unistd.h>
+
+/*
+ * Persistent worker pool. Workers are started on first use and wait for jobs, so a parallel loop costs two
+ * condition variable round trips instead of creating and joining threads. The calling thread takes part in every
+ * loop. Loops submitted from different threads run one after the other, loops submitted from inside a loop run on
+ * the calling thread.
+ */
+
+static pthread_once_t dsp_parallel_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t dsp_parallel_submit = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t dsp_parallel_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dsp_parallel_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t dsp_parallel_done = PTHREAD_COND_INITIALIZER;
+
+static int dsp_parallel_workers = 0;
+static __thread int dsp_parallel_nested = 0;
+
+static struct
+{
+    dsp_parallel_func func;
+    void *arg;
+    int count;
+    int next;
+    int running;
+    unsigned long generation;
+} dsp_parallel_job;
+
+static void dsp_parallel_run(dsp_parallel_func func, void *arg, int count, int thread)
+{
+    dsp_parallel_nested = 1;
+    for(;;)
+    {
+        int index = __atomic_fetch_add(&dsp_parallel_job.next, 1, __ATOMIC_RELAXED);
+        if(index >= count)
+            break;
+        func(arg, index, thread);
+    }
+    dsp_parallel_nested = 0;
+}
+
+static void* dsp_parallel_worker(void* arg)
+{
+    int thread = (int)(intptr_t)arg;
+    unsigned long generation = 0;
+    pthread_mutex_lock(&dsp_parallel_mutex);
+    for(;;)
+    {
+        while(dsp_parallel_job.generation == generation)
+            pthread_cond_wait(&dsp_parallel_start, &dsp_parallel_mutex);
+        generation = dsp_parallel_job.generation;
+        dsp_parallel_func func = dsp_parallel_job.func;
+        void *job_arg = dsp_parallel_job.arg;
+        int count = dsp_parallel_job.count;
+        pthread_mutex_unlock(&dsp_parallel_mutex);
+
+        dsp_parallel_run(func, job_arg, count, thread);
+
+        /* Every worker acknowledges every job, so none can pick up indices of the next one */
+        pthread_mutex_lock(&dsp_parallel_mutex);
+        if(--dsp_parallel_job.running == 0)
+            pthread_cond_signal(&dsp_parallel_done);
+    }
+    return NULL;
+}
+
+static void dsp_parallel_init()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int n = (int)Max(1, Min(cpus, 64)) - 1;
+    int i;
+    for(i = 0; i < n; i++)
+    {
+        pthread_t th;
+        if(pthread_create(&th, NULL, dsp_parallel_worker, (void*)(intptr_t)(i + 1)) != 0)
+            break;
+        pthread_detach(th);
+        dsp_parallel_workers++;
+    }
+}
+
+int dsp_parallel_threads()
+{
+    pthread_once(&dsp_parallel_once, dsp_parallel_init);
+    return dsp_parallel_workers + 1;
+}
+
+void dsp_parallel_for(int count, dsp_parallel_func func, void *arg)
+{
+    int i;
+    if(count <= 0)
+        return;
+    if(dsp_parallel_nested || count == 1 || dsp_parallel_threads() == 1)
+    {
+        for(i = 0; i < count; i++)
+            func(arg, i, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&dsp_parallel_submit);
+    pthread_mutex_lock(&dsp_parallel_mutex);
+    dsp_parallel_job.func = func;
+    dsp_parallel_job.arg = arg;
+    dsp_parallel_job.count = count;
+    dsp_parallel_job.next = 0;
+    dsp_parallel_job.running = dsp_parallel_workers;
+    dsp_parallel_job.generation++;
+    pthread_cond_broadcast(&dsp_parallel_start);
+    pthread_mutex_unlock(&dsp_parallel_mutex);
+
+    dsp_parallel_run(func, arg, count, 0);
+
+    pthread_mutex_lock(&dsp_parallel_mutex);
+    while(dsp_parallel_job.running > 0)
+        pthread_cond_wait(&dsp_parallel_done, &dsp_parallel_mutex);
+    pthread_mutex_unlock(&dsp_parallel_mutex);
+    pthread_mutex_unlock(&dsp_parallel_submit);
+}
@@ -0,0 +1,261 @@
+/*
+ *   libDSPAU - a digital signal processing library for astronomy usage
+ *   Copyright (C) 2026  INDI Library contributors
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dsp.h"
+
+/* Lines per job of the stream filter */
+#define DSP_RANK_LINES 16
+
+/*
+ * Sliding rank filter on two heaps of fixed size. The max heap holds the rank + 1 smallest elements of the window,
+ * the min heap holds the others, so the root of the max heap is the element of the given rank. When the window
+ * slides, the value of the oldest element is replaced by the new one in its heap, then the heap and, if needed, the
+ * two roots are swapped back into order. Each step costs O(log size).
+ */
+typedef struct dsp_rank_window_t
+{
+    int size;
+    /* Number of elements of the max heap, rank + 1 */
+    int low;
+    dsp_t *values;
+    /* Slots of the window elements, the max heap first, the min heap after it */
+    int *heap;
+    /* Position of each slot in heap */
+    int *pos;
+} dsp_rank_window;
+
+static inline int dsp_rank_less(const dsp_rank_window *w, int a, int b)
+{
+    /* The max heap is stored with the comparison reversed */
+    dsp_t va = w->values[w->heap[a]];
+    dsp_t vb = w->values[w->heap[b]];
+    return a < w->low ? va > vb : va < vb;
+}
+
+static inline void dsp_rank_swap(dsp_rank_window *w, int a, int b)
+{
+    int slot = w->heap[a];
+    w->heap[a] = w->heap[b];
+    w->heap[b] = slot;
+    w->pos[w->heap[a]] = a;
+    w->pos[w->heap[b]] = b;
+}
+
+/* Heap positions are relative to the start of their heap, base is 0 for the max heap and low for the min heap */
+static void dsp_rank_sift_up(dsp_rank_window *w, int base, int i)
+{
+    while(i > 0) {
+        int parent = (i - 1) / 2;
+        if(!dsp_rank_less(w, base + i, base + parent))
+            break;
+        dsp_rank_swap(w, base + i, base + parent);
+        i = parent;
+    }
+}
+
+static void dsp_rank_sift_down(dsp_rank_window *w, int base, int n, int i)
+{
+    for(;;) {
+        int child = 2 * i + 1;
+        if(child >= n)
+            break;
+        if(child + 1 < n && dsp_rank_less(w, base + child + 1, base + child))
+            child++;
+        if(!dsp_rank_less(w, base + child, base + i))
+            break;
+        dsp_rank_swap(w, base + i, base + child);
+        i = child;
+    }
+}
+
+static void dsp_rank_fix(dsp_rank_window *w, int base, int n, int i)
+{
+    int slot = w->heap[base + i];
+    dsp_rank_sift_up(w, base, i);
+    dsp_rank_sift_down(w, base, n, w->pos[slot] - base);
+}
+
+static void dsp_rank_window_replace(dsp_rank_window *w, int slot, dsp_t value)
+{
+    int high = w->size - w->low;
+    int i = w->pos[slot];
+    w->values[slot] = value;
+    if(i < w->low)
+        dsp_rank_fix(w, 0, w->low, i);
+    else
+        dsp_rank_fix(w, w->low, high, i - w->low);
+
+    /* The new value may belong to the other heap, exchange the roots */
+    if(high > 0 && w->values[w->heap[0]] > w->values[w->heap[w->low]]) {
+        dsp_rank_swap(w, 0, w->low);
+        dsp_rank_sift_down(w, 0, w->low, 0);
+        dsp_rank_sift_down(w, w->low, high, 0);
+    }
+}
+
+/* Filter one line of len elements, the edges are replicated */
+static void dsp_rank_line(dsp_rank_window *w, const dsp_t *in, dsp_t *out, int len)
+{
+    int half = w->size / 2;
+    int i, j;
+
+    /* A window of equal values is ordered, the first elements are then added one by one */
+    for(j = 0; j < w->size; j++) {
+        w->values[j] = in[0];
+        w->heap[j] = j;
+        w->pos[j] = j;
+    }
+    for(j = 0; j < w->size; j++)
+        dsp_rank_window_replace(w, j, in[Max(0, Min(len - 1, j - half))]);
+
+    for(i = 0; i < len; i++) {
+        out[i] = w->values[w->heap[0]];
+        /* Element i - half leaves the window, element i - half + size enters it in the same slot */
+        j = i + w->size - half;
+        dsp_rank_window_replace(w, i % w->size, in[Max(0, Min(len - 1, j))]);
+    }
+}
+
+static dsp_rank_window *dsp_rank_window_new(int size, int rank)
+{
+    dsp_rank_window *w = (dsp_rank_window*)malloc(sizeof(dsp_rank_window));
+    w->size = size;
+    w->low = rank + 1;
+    w->values = (dsp_t*)malloc(sizeof(dsp_t) * size);
+    w->heap = (int*)malloc(sizeof(int) * size);
+    w->pos = (int*)malloc(sizeof(int) * size);
+    return w;
+}
+
+static void dsp_rank_window_free(dsp_rank_window *w)
+{
+    free(w->values);
+    free(w->heap);
+    free(w->pos);
+    free(w);
+}
+
+void dsp_filter_rank_buffer(const dsp_t *in, dsp_t *out, int len, int size, int rank)
+{
+    dsp_rank_window *w;
+    if(len <= 0 || size <= 0 || rank < 0 || rank >= size)
+        return;
+    w = dsp_rank_window_new(size, rank);
+    dsp_rank_line(w, in, out, len);
+    dsp_rank_window_free(w);
+}
+
+typedef struct dsp_rank_job_t
+{
+    dsp_stream_p in;
+    dsp_stream_p out;
+    /* Length and stride of the filtered dimension */
+    int len;
+    int stride;
+    int lines;
+    dsp_rank_window **windows;
+    dsp_t **lines_in;
+    dsp_t **lines_out;
+} dsp_rank_job;
+
+static void dsp_rank_pass(void *arg, int index, int thread)
+{
+    dsp_rank_job *job = (dsp_rank_job*)arg;
+    dsp_rank_window *w = job->windows[thread];
+    dsp_t *line_in = job->lines_in[thread];
+    dsp_t *line_out = job->lines_out[thread];
+    int l;
+
+    for(l = index * DSP_RANK_LINES; l < Min(job->lines, (index + 1) * DSP_RANK_LINES); l++) {
+        size_t start = (size_t)(l / job->stride) * job->stride * job->len + l % job->stride;
+        if(job->stride == 1 && job->in->data == NULL) {
+            dsp_rank_line(w, job->in->buf + start, job->out->buf + start, job->len);
+            continue;
+        }
+        /* Gather the line as dsp_t, so that the window reads are contiguous and typed streams are converted once */
+        dsp_stream_read(job->in, start, job->stride, line_in, job->len);
+        dsp_rank_line(w, line_in, line_out, job->len);
+        dsp_stream_write(job->out, start, job->stride, line_out, job->len);
+    }
+}
+
+dsp_stream_p dsp_filter_rank(dsp_stream_p stream, int size, int rank)
+{
+    dsp_stream_p out, tmp = NULL;
+    dsp_rank_job job;
+    int threads = dsp_parallel_threads();
+    int d, t, stride = 1, maxlen = 1;
+
+    if(size <= 0 || rank < 0 || rank >= size)
+        return NULL;
+
+    for(d = 0; d < stream->dims; d++)
+        maxlen = Max(maxlen, stream->sizes[d]);
+
+    /* Typed streams stay typed, the output is one of the input elements, so no precision is lost between passes */
+    out = dsp_stream_copy(stream);
+    job.out = out;
+    job.in = stream;
+    job.windows = (dsp_rank_window**)malloc(sizeof(dsp_rank_window*) * threads);
+    job.lines_in = (dsp_t**)malloc(sizeof(dsp_t*) * threads);
+    job.lines_out = (dsp_t**)malloc(sizeof(dsp_t*) * threads);
+    for(t = 0; t < threads; t++) {
+        job.windows[t] = dsp_rank_window_new(size, rank);
+        job.lines_in[t] = (dsp_t*)malloc(sizeof(dsp_t) * maxlen);
+        job.lines_out[t] = (dsp_t*)malloc(sizeof(dsp_t) * maxlen);
+    }
+
+    /* One pass per dimension, each filters the result of the previous one */
+    for(d = 0; d < stream->dims; d++) {
+        if(stream->sizes[d] > 1) {
+            if(job.in != stream) {
+                if(tmp != NULL) {
+                    dsp_stream_free_buffer(tmp);
+                    dsp_stream_free(tmp);
+                }
+                tmp = dsp_stream_copy(out);
+                job.in = tmp;
+            }
+            job.len = stream->sizes[d];
+            job.stride = stride;
+            job.lines = stream->len / stream->sizes[d];
+            dsp_parallel_for((job.lines + DSP_RANK_LINES - 1) / DSP_RANK_LINES, dsp_rank_pass, &job);
+            job.in = out;
+        }
+        stride *= stream->sizes[d];
+    }
+
+    for(t = 0; t < threads; t++) {
+        dsp_rank_window_free(job.windows[t]);
+        free(job.lines_in[t]);
+        free(job.lines_out[t]);
+    }
+    free(job.windows);
+    free(job.lines_in);
+    free(job.lines_out);
+    if(tmp != NULL) {
+        dsp_stream_free_buffer(tmp);
+        dsp_stream_free(tmp);
+    }
+    return out;
+}
+
+dsp_stream_p dsp_filter_median(dsp_stream_p stream, int size)
+{
+    return dsp_filter_rank(stream, size, size / 2);
+}
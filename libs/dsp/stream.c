@@ -38,13 +38,157 @@ dsp_t* dsp_stream_get_buffer(dsp_stream_p stream)
     return stream->buf;
 }
 
+/* The stars own their locations, see dsp_stream_add_star */
+static void dsp_stream_free_stars(dsp_stream_p stream)
+{
+    int i;
+    for(i = 0; i < stream->stars_count; i++)
+        free(stream->stars[i].center.location);
+    free(stream->stars);
+    stream->stars = NULL;
+    stream->stars_count = 0;
+}
+
 void dsp_stream_free_buffer(dsp_stream_p stream)
 {
+    if(stream->data != NULL && stream->data_owned)
+        free(stream->data);
+    stream->data = NULL;
     if(stream->buf == NULL)
         return;
     free(stream->buf);
 }
 
+static size_t dsp_stream_type_size(dsp_type type)
+{
+    switch(type) {
+        case dsp_type_float:
+            return sizeof(float);
+        case dsp_type_uint8:
+            return sizeof(uint8_t);
+        case dsp_type_uint16:
+            return sizeof(uint16_t);
+        default:
+            return sizeof(dsp_t);
+    }
+}
+
+void dsp_stream_alloc_typed_buffer(dsp_stream_p stream, dsp_type type)
+{
+    if(stream->data != NULL && stream->data_owned)
+        free(stream->data);
+    stream->data = malloc(dsp_stream_type_size(type) * stream->len);
+    stream->type = type;
+    stream->data_owned = 1;
+}
+
+void dsp_stream_set_typed_buffer(dsp_stream_p stream, void *data, dsp_type type)
+{
+    if(stream->data != NULL && stream->data_owned)
+        free(stream->data);
+    stream->data = data;
+    stream->type = type;
+    stream->data_owned = 0;
+}
+
+dsp_t* dsp_stream_convert_typed_buffer(dsp_stream_p stream)
+{
+    if(stream->data == NULL)
+        return stream->buf;
+    dsp_stream_alloc_buffer(stream, stream->len);
+    dsp_stream_read(stream, 0, 1, stream->buf, stream->len);
+    if(stream->data_owned)
+        free(stream->data);
+    stream->data = NULL;
+    stream->data_owned = 0;
+    return stream->buf;
+}
+
+void dsp_stream_read(dsp_stream_p stream, size_t offset, int stride, dsp_t *out, int count)
+{
+    int i;
+    if(stream->data == NULL) {
+        dsp_t *in = stream->buf + offset;
+        if(stride == 1) {
+            memcpy(out, in, sizeof(dsp_t) * count);
+            return;
+        }
+        for(i = 0; i < count; i++)
+            out[i] = in[(size_t)i * stride];
+        return;
+    }
+    switch(stream->type) {
+        case dsp_type_float: {
+            const float *in = (const float*)stream->data + offset;
+            for(i = 0; i < count; i++)
+                out[i] = in[(size_t)i * stride];
+            break;
+        }
+        case dsp_type_uint8: {
+            const uint8_t *in = (const uint8_t*)stream->data + offset;
+            for(i = 0; i < count; i++)
+                out[i] = in[(size_t)i * stride];
+            break;
+        }
+        case dsp_type_uint16: {
+            const uint16_t *in = (const uint16_t*)stream->data + offset;
+            for(i = 0; i < count; i++)
+                out[i] = in[(size_t)i * stride];
+            break;
+        }
+        default: {
+            const dsp_t *in = (const dsp_t*)stream->data + offset;
+            for(i = 0; i < count; i++)
+                out[i] = in[(size_t)i * stride];
+            break;
+        }
+    }
+}
+
+/* Round to the nearest integer in [0, max], NaN gives 0 */
+#define dsp_stream_saturate(v, max) (!((v) > 0) ? 0 : (v) >= (max) ? (max) : (int)((v) + 0.5))
+
+void dsp_stream_write(dsp_stream_p stream, size_t offset, int stride, const dsp_t *in, int count)
+{
+    int i;
+    if(stream->data == NULL) {
+        dsp_t *out = stream->buf + offset;
+        if(stride == 1) {
+            memcpy(out, in, sizeof(dsp_t) * count);
+            return;
+        }
+        for(i = 0; i < count; i++)
+            out[(size_t)i * stride] = in[i];
+        return;
+    }
+    switch(stream->type) {
+        case dsp_type_float: {
+            float *out = (float*)stream->data + offset;
+            for(i = 0; i < count; i++)
+                out[(size_t)i * stride] = (float)in[i];
+            break;
+        }
+        case dsp_type_uint8: {
+            uint8_t *out = (uint8_t*)stream->data + offset;
+            for(i = 0; i < count; i++)
+                out[(size_t)i * stride] = (uint8_t)dsp_stream_saturate(in[i], UINT8_MAX);
+            break;
+        }
+        case dsp_type_uint16: {
+            uint16_t *out = (uint16_t*)stream->data + offset;
+            for(i = 0; i < count; i++)
+                out[(size_t)i * stride] = (uint16_t)dsp_stream_saturate(in[i], UINT16_MAX);
+            break;
+        }
+        default: {
+            dsp_t *out = (dsp_t*)stream->data + offset;
+            for(i = 0; i < count; i++)
+                out[(size_t)i * stride] = in[i];
+            break;
+        }
+    }
+}
+
 dsp_stream_p dsp_stream_new()
 {
     dsp_stream_p stream = (dsp_stream_p)malloc(sizeof(dsp_stream) * 1);
@@ -70,6 +214,9 @@ dsp_stream_p dsp_stream_new()
     stream->diameter = 1;
     stream->focal_ratio = 1;
     stream->samplerate = 0;
+    stream->data = NULL;
+    stream->type = dsp_type_double;
+    stream->data_owned = 0;
     return stream;
 }
 
@@ -77,6 +224,7 @@ void dsp_stream_free(dsp_stream_p stream)
 {
     if(stream == NULL)
         return;
+    dsp_stream_free_stars(stream);
     free(stream->sizes);
     free(stream->pixel_sizes);
     free(stream->children);
@@ -92,10 +240,12 @@ dsp_stream_p dsp_stream_copy(dsp_stream_p stream)
     int i;
     for(i = 0; i < stream->dims; i++)
        dsp_stream_add_dim(dest, abs(stream->sizes[i]));
-    dsp_stream_alloc_buffer(dest, dest->len);
+    if(stream->data != NULL)
+        dsp_stream_alloc_typed_buffer(dest, stream->type);
+    else
+        dsp_stream_alloc_buffer(dest, dest->len);
     dest->wavelength = stream->wavelength;
     dest->samplerate = stream->samplerate;
-    dest->stars_count = stream->stars_count;
     dest->diameter = stream->diameter;
     dest->focal_ratio = stream->focal_ratio;
     dest->starttimeutc = stream->starttimeutc;
@@ -104,7 +254,16 @@ dsp_stream_p dsp_stream_copy(dsp_stream_p stream)
     memcpy(dest->pixel_sizes, stream->pixel_sizes, sizeof(double) * stream->dims);
     memcpy(dest->target, stream->target, sizeof(double) * 3);
     memcpy(dest->location, stream->location, sizeof(double) * 3);
-    memcpy(dest->buf, stream->buf, sizeof(dsp_t) * stream->len);
+    for(i = 0; i < stream->stars_count; i++) {
+        dsp_star star = stream->stars[i];
+        star.center.location = (double*)malloc(sizeof(double) * star.center.dims);
+        memcpy(star.center.location, stream->stars[i].center.location, sizeof(double) * star.center.dims);
+        dsp_stream_add_star(dest, star);
+    }
+    if(stream->data != NULL)
+        memcpy(dest->data, stream->data, dsp_stream_type_size(stream->type) * stream->len);
+    else
+        memcpy(dest->buf, stream->buf, sizeof(dsp_t) * stream->len);
     return dest;
 }
 
@@ -172,17 +331,11 @@ void dsp_stream_add_star(dsp_stream_p stream, dsp_star star)
 
 void dsp_stream_del_star(dsp_stream_p stream, int index)
 {
-    dsp_star* stars = (dsp_star*)malloc(sizeof(dsp_star) * stream->stars_count);
-    int stars_count = stream->stars_count;
-    memcpy(stars, stream->stars, sizeof(dsp_star*) * stream->stars_count);
-    free(stream->stars);
-    stream->stars_count = 0;
-    int i;
-    for(i = 0; i < stars_count; i++) {
-        if(i != index) {
-            dsp_stream_add_star(stream, stars[i]);
-        }
-    }
+    if(index < 0 || index >= stream->stars_count)
+        return;
+    free(stream->stars[index].center.location);
+    memmove(&stream->stars[index], &stream->stars[index + 1], sizeof(dsp_star) * (stream->stars_count - index - 1));
+    stream->stars_count--;
 }
 
 int* dsp_stream_get_position(dsp_stream_p stream, int index) {
@@ -25,6 +25,7 @@
 #include "indistandardproperty.h"
 #include "connectionplugins/connectionserial.h"
 
+#include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <assert.h>
@@ -118,17 +119,338 @@ void timerfunc(void *t)
 namespace INDI
 {
 
+// Single property saves are written after this delay so bursts of changes end up in one write.
+static constexpr int CONFIG_SAVE_DELAY_MS = 500;
+
 DefaultDevicePrivate::DefaultDevicePrivate(DefaultDevice *defaultDevice)
     : defaultDevice(defaultDevice)
 {
     const std::unique_lock<std::recursive_mutex> lock(DefaultDevicePrivate::devicesLock);
     devices.push_back(this);
+
+    m_ConfigSaveTimer.setSingleShot(true);
+    m_ConfigSaveTimer.setInterval(CONFIG_SAVE_DELAY_MS);
+    m_ConfigSaveTimer.callOnTimeout(std::bind(&DefaultDevicePrivate::scheduleConfigWrite, this));
+
+    m_ConfigWriter = std::thread(&DefaultDevicePrivate::configWriterThread, this);
 }
 
 DefaultDevicePrivate::~DefaultDevicePrivate()
 {
-    const std::unique_lock<std::recursive_mutex> lock(DefaultDevicePrivate::devicesLock);
-    devices.remove(this);
+    {
+        const std::unique_lock<std::recursive_mutex> lock(DefaultDevicePrivate::devicesLock);
+        devices.remove(this);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_ConfigRequestLock);
+        m_ConfigWriterQuit = true;
+    }
+    m_ConfigRequest.notify_one();
+    m_ConfigWriter.join();
+
+    // Do not lose debounced changes on exit
+    flushConfig();
+    delXMLEle(m_ConfigRoot);
+}
+
+void DefaultDevicePrivate::setConfig(const char *buffer, size_t size)
+{
+    std::string snapshot(buffer, size);
+    char errmsg[MAXRBUF];
+
+    LilXML *lp = newLilXML();
+    XMLEle **nodes = parseXMLChunk(lp, &snapshot[0], static_cast<int>(snapshot.size()), errmsg);
+    XMLEle *root = nullptr;
+    if (nodes != nullptr)
+    {
+        root = nodes[0];
+        for (int i = 1; root != nullptr && nodes[i] != nullptr; i++)
+            delXMLEle(nodes[i]);
+        free(nodes);
+    }
+    delLilXML(lp);
+
+    m_ConfigSaveTimer.stop();
+
+    std::lock_guard<std::mutex> lock(m_ConfigLock);
+    delXMLEle(m_ConfigRoot);
+    m_ConfigRoot = root;
+    m_ConfigDirtyProperties.clear();
+    m_ConfigPendingProperties.clear();
+    m_ConfigSnapshot = std::move(snapshot);
+    m_ConfigSnapshotProperties.clear();
+    ++m_ConfigSnapshotGeneration;
+}
+
+DefaultDevicePrivate::ConfigStamp DefaultDevicePrivate::configStamp() const
+{
+    char configFileName[MAXRBUF];
+    if (getenv("INDICONFIG"))
+        snprintf(configFileName, MAXRBUF, "%s", getenv("INDICONFIG"));
+    else
+        snprintf(configFileName, MAXRBUF, "%s/.indi/%s_config.xml", getenv("HOME"), deviceName.c_str());
+
+    ConfigStamp stamp;
+    struct stat st;
+    if (stat(configFileName, &st) != 0)
+        return stamp;
+
+    stamp.mtime = st.st_mtime;
+#ifdef __APPLE__
+    stamp.mtimeNsec = st.st_mtimespec.tv_nsec;
+#else
+    stamp.mtimeNsec = st.st_mtim.tv_nsec;
+#endif
+    stamp.size  = st.st_size;
+    stamp.inode = st.st_ino;
+    return stamp;
+}
+
+bool DefaultDevicePrivate::updateConfig(const char *property)
+{
+    std::lock_guard<std::mutex> lock(m_ConfigLock);
+
+    if (loadConfigRoot() == false || applyConfig(property) == false)
+        return false;
+
+    m_ConfigDirtyProperties.insert(property);
+    return true;
+}
+
+bool DefaultDevicePrivate::loadConfigRoot()
+{
+    ConfigStamp stamp = configStamp();
+
+    // The driver's own IUGetConfigFP writes, other devices sharing INDICONFIG or the user may have changed the file
+    if (m_ConfigRoot != nullptr && stamp == m_ConfigStamp)
+        return true;
+
+    delXMLEle(m_ConfigRoot);
+    m_ConfigRoot = nullptr;
+
+    char errmsg[MAXRBUF] = {0};
+    FILE *fp = IUGetConfigFP(nullptr, deviceName.c_str(), "r", errmsg);
+    if (fp == nullptr)
+        return false;
+
+    LilXML *lp   = newLilXML();
+    m_ConfigRoot = readXMLFile(fp, lp, errmsg);
+
+    fclose(fp);
+    delLilXML(lp);
+
+    if (m_ConfigRoot == nullptr)
+        return false;
+
+    m_ConfigStamp = stamp;
+
+    // Changes made before the reload are not in the file yet
+    std::set<std::string> unsaved = m_ConfigDirtyProperties;
+    unsaved.insert(m_ConfigPendingProperties.begin(), m_ConfigPendingProperties.end());
+    m_ConfigDirtyProperties.clear();
+    for (const auto &property : unsaved)
+    {
+        if (applyConfig(property.c_str()))
+            m_ConfigDirtyProperties.insert(property);
+    }
+
+    return true;
+}
+
+bool DefaultDevicePrivate::applyConfig(const char *property)
+{
+    for (XMLEle *ep = nextXMLEle(m_ConfigRoot, 1); ep != nullptr; ep = nextXMLEle(m_ConfigRoot, 0))
+    {
+        const char *elemName = findXMLAttValu(ep, "name");
+        const char *tagName  = tagXMLEle(ep);
+
+        if (strcmp(elemName, property))
+            continue;
+
+        if (!strcmp(tagName, "newSwitchVector"))
+        {
+            auto svp = defaultDevice->getSwitch(elemName);
+            if (svp == nullptr)
+                return false;
+
+            for (XMLEle *sw = nextXMLEle(ep, 1); sw != nullptr; sw = nextXMLEle(ep, 0))
+            {
+                auto oneSwitch = svp->findWidgetByName(findXMLAttValu(sw, "name"));
+                if (oneSwitch == nullptr)
+                    return false;
+
+                char formatString[MAXRBUF];
+                snprintf(formatString, MAXRBUF, "      %s\n", oneSwitch->getStateAsString());
+                editXMLEle(sw, formatString);
+            }
+        }
+        else if (!strcmp(tagName, "newNumberVector"))
+        {
+            auto nvp = defaultDevice->getNumber(elemName);
+            if (nvp == nullptr)
+                return false;
+
+            for (XMLEle *np = nextXMLEle(ep, 1); np != nullptr; np = nextXMLEle(ep, 0))
+            {
+                auto oneNumber = nvp->findWidgetByName(findXMLAttValu(np, "name"));
+                if (oneNumber == nullptr)
+                    return false;
+
+                char formatString[MAXRBUF];
+                snprintf(formatString, MAXRBUF, "      %.20g\n", oneNumber->getValue());
+                editXMLEle(np, formatString);
+            }
+        }
+        else if (!strcmp(tagName, "newTextVector"))
+        {
+            auto tvp = defaultDevice->getText(elemName);
+            if (tvp == nullptr)
+                return false;
+
+            for (XMLEle *tp = nextXMLEle(ep, 1); tp != nullptr; tp = nextXMLEle(ep, 0))
+            {
+                auto oneText = tvp->findWidgetByName(findXMLAttValu(tp, "name"));
+                if (oneText == nullptr)
+                    return false;
+
+                char formatString[MAXRBUF];
+                snprintf(formatString, MAXRBUF, "      %s\n", oneText->getText() ? oneText->getText() : "");
+                editXMLEle(tp, formatString);
+            }
+        }
+        else
+            continue;
+
+        return true;
+    }
+
+    return false;
+}
+
+bool DefaultDevicePrivate::snapshotConfig()
+{
+    std::lock_guard<std::mutex> lock(m_ConfigLock);
+
+    if (m_ConfigRoot == nullptr || m_ConfigDirtyProperties.empty())
+        return false;
+
+    if (loadConfigRoot() == false || m_ConfigDirtyProperties.empty())
+        return false;
+
+    int length = sprlXMLEle(m_ConfigRoot, 0);
+    m_ConfigSnapshot.resize(length + 1);
+    sprXMLEle(&m_ConfigSnapshot[0], m_ConfigRoot, 0);
+    m_ConfigSnapshot.resize(length);
+
+    // Names of the changed properties, for the log once the snapshot is on disk
+    m_ConfigSnapshotProperties.clear();
+    for (const auto &property : m_ConfigDirtyProperties)
+        m_ConfigSnapshotProperties += (m_ConfigSnapshotProperties.empty() ? "" : ", ") + property;
+
+    m_ConfigPendingProperties.insert(m_ConfigDirtyProperties.begin(), m_ConfigDirtyProperties.end());
+    m_ConfigDirtyProperties.clear();
+    ++m_ConfigSnapshotGeneration;
+    return true;
+}
+
+void DefaultDevicePrivate::scheduleConfigWrite()
+{
+    if (snapshotConfig() == false)
+        return;
+
+    requestConfigWrite();
+}
+
+void DefaultDevicePrivate::requestConfigWrite()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_ConfigRequestLock);
+        m_ConfigWriteRequested = true;
+    }
+    m_ConfigRequest.notify_one();
+}
+
+void DefaultDevicePrivate::configWriterThread()
+{
+    std::unique_lock<std::mutex> lock(m_ConfigRequestLock);
+    for (;;)
+    {
+        m_ConfigRequest.wait(lock, [this] { return m_ConfigWriteRequested || m_ConfigWriterQuit; });
+        if (m_ConfigWriterQuit)
+            break;
+
+        // Requests made while writing coalesce into one more write of the newest snapshot
+        m_ConfigWriteRequested = false;
+        lock.unlock();
+        commitConfig();
+        lock.lock();
+    }
+}
+
+bool DefaultDevicePrivate::flushConfig()
+{
+    m_ConfigSaveTimer.stop();
+    snapshotConfig();
+    return commitConfig();
+}
+
+bool DefaultDevicePrivate::commitConfig()
+{
+    std::lock_guard<std::mutex> writeLock(m_ConfigWriteLock);
+
+    std::string snapshot, properties;
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_ConfigLock);
+        // A newer snapshot was already written by a previous call
+        if (m_ConfigSnapshotGeneration <= m_ConfigWrittenGeneration)
+            return true;
+
+        snapshot   = m_ConfigSnapshot;
+        properties = m_ConfigSnapshotProperties;
+        generation = m_ConfigSnapshotGeneration;
+    }
+
+    char errmsg[MAXRBUF] = {0};
+    if (IUWriteConfig(nullptr, deviceName.c_str(), snapshot.data(), snapshot.size(), errmsg) != 0)
+    {
+        DEBUGFDEVICE(deviceName.c_str(), Logger::DBG_WARNING, "Failed to save configuration. %s", errmsg);
+        return false;
+    }
+
+    m_ConfigWrittenGeneration = generation;
+
+    {
+        std::lock_guard<std::mutex> lock(m_ConfigLock);
+        m_ConfigStamp = configStamp();
+        // Nothing newer was snapshotted while writing, everything is on disk
+        if (m_ConfigSnapshotGeneration == generation)
+            m_ConfigPendingProperties.clear();
+    }
+
+    if (properties.empty())
+        DEBUGDEVICE(deviceName.c_str(), Logger::DBG_DEBUG, "Configuration successfully saved.");
+    else
+        DEBUGFDEVICE(deviceName.c_str(), Logger::DBG_DEBUG, "Configuration successfully saved for %s.", properties.c_str());
+
+    if (isDefaultConfigLoaded == false)
+        isDefaultConfigLoaded = IUSaveDefaultConfig(nullptr, nullptr, deviceName.c_str()) == 0;
+
+    return true;
+}
+
+void DefaultDevicePrivate::dropConfig()
+{
+    m_ConfigSaveTimer.stop();
+
+    std::lock_guard<std::mutex> lock(m_ConfigLock);
+    delXMLEle(m_ConfigRoot);
+    m_ConfigRoot = nullptr;
+    m_ConfigDirtyProperties.clear();
+    m_ConfigPendingProperties.clear();
+    m_ConfigSnapshot.clear();
+    m_ConfigWrittenGeneration = m_ConfigSnapshotGeneration;
 }
 
 DefaultDevice::DefaultDevice()
@@ -148,6 +470,10 @@ bool DefaultDevice::loadConfig(bool silent, const char *property)
 {
     D_PTR(DefaultDevice);
     char errmsg[MAXRBUF] = {0};
+
+    // Make sure pending saves are on disk before reading the file back
+    d->flushConfig();
+
     d->isConfigLoading = true;
     bool pResult = IUReadConfig(nullptr, getDeviceName(), property, silent ? 1 : 0, errmsg) == 0 ? true : false;
     d->isConfigLoading = false;
@@ -207,7 +533,13 @@ bool DefaultDevice::saveAllConfigItems(FILE *fp)
 
 bool DefaultDevice::purgeConfig()
 {
+    D_PTR(DefaultDevice);
     char errmsg[MAXRBUF];
+
+    // Hold the write lock so a pending save cannot recreate the file
+    std::lock_guard<std::mutex> lock(d->m_ConfigWriteLock);
+    d->dropConfig();
+
     if (IUPurgeConfig(nullptr, getDeviceName(), errmsg) == -1)
     {
         LOGF_WARN("%s", errmsg);
@@ -222,18 +554,19 @@ bool DefaultDevice::saveConfig(bool silent, const char *property)
 {
     D_PTR(DefaultDevice);
     silent = false;
-    char errmsg[MAXRBUF] = {0};
-
-    FILE *fp = nullptr;
 
     if (property == nullptr)
     {
-        fp = IUGetConfigFP(nullptr, getDeviceName(), "w", errmsg);
+        char *buffer = nullptr;
+        size_t size  = 0;
+
+        // Serialize into memory, the file itself is replaced atomically.
+        FILE *fp = open_memstream(&buffer, &size);
 
         if (fp == nullptr)
         {
             if (!silent)
-                LOGF_WARN("Failed to save configuration. %s", errmsg);
+                LOGF_WARN("Failed to save configuration. %s", strerror(errno));
             return false;
         }
 
@@ -243,141 +576,21 @@ bool DefaultDevice::saveConfig(bool silent, const char *property)
 
         IUSaveConfigTag(fp, 1, getDeviceName(), silent ? 1 : 0);
 
-        fflush(fp);
         fclose(fp);
 
-        if (d->isDefaultConfigLoaded == false)
-        {
-            d->isDefaultConfigLoaded = IUSaveDefaultConfig(nullptr, nullptr, getDeviceName()) == 0;
-        }
+        d->setConfig(buffer, size);
+        free(buffer);
 
-        LOG_DEBUG("Configuration successfully saved.");
+        // Written here rather than on the config writer thread, so the caller knows whether it reached the disk
+        return d->commitConfig();
     }
     else
     {
-        fp = IUGetConfigFP(nullptr, getDeviceName(), "r", errmsg);
-
-        if (fp == nullptr)
-        {
-            //if (!silent)
-            //   LOGF_ERROR("Error saving configuration. %s", errmsg);
-            //return false;
-            // If we don't have an existing file pointer, save all properties.
+        // If property does not exist, save the whole thing
+        if (d->updateConfig(property) == false)
             return saveConfig(silent);
-        }
-
-        LilXML *lp   = newLilXML();
-        XMLEle *root = readXMLFile(fp, lp, errmsg);
-
-        fclose(fp);
-        delLilXML(lp);
-
-        if (root == nullptr)
-            return false;
-
-        XMLEle *ep         = nullptr;
-        bool propertySaved = false;
-
-        for (ep = nextXMLEle(root, 1); ep != nullptr; ep = nextXMLEle(root, 0))
-        {
-            const char *elemName = findXMLAttValu(ep, "name");
-            const char *tagName  = tagXMLEle(ep);
-
-            if (strcmp(elemName, property))
-                continue;
-
-            if (!strcmp(tagName, "newSwitchVector"))
-            {
-                auto svp = getSwitch(elemName);
-                if (svp == nullptr)
-                {
-                    delXMLEle(root);
-                    return false;
-                }
-
-                XMLEle *sw = nullptr;
-                for (sw = nextXMLEle(ep, 1); sw != nullptr; sw = nextXMLEle(ep, 0))
-                {
-                    auto oneSwitch = svp->findWidgetByName(findXMLAttValu(sw, "name"));
-                    if (oneSwitch == nullptr)
-                    {
-                        delXMLEle(root);
-                        return false;
-                    }
-                    char formatString[MAXRBUF];
-                    snprintf(formatString, MAXRBUF, "      %s\n", oneSwitch->getStateAsString());
-                    editXMLEle(sw, formatString);
-                }
-
-                propertySaved = true;
-                break;
-            }
-            else if (!strcmp(tagName, "newNumberVector"))
-            {
-                auto nvp = getNumber(elemName);
-                if (nvp == nullptr)
-                {
-                    delXMLEle(root);
-                    return false;
-                }
-
-                XMLEle *np = nullptr;
-                for (np = nextXMLEle(ep, 1); np != nullptr; np = nextXMLEle(ep, 0))
-                {
-                    auto oneNumber = nvp->findWidgetByName(findXMLAttValu(np, "name"));
-                    if (oneNumber == nullptr)
-                        return false;
-
-                    char formatString[MAXRBUF];
-                    snprintf(formatString, MAXRBUF, "      %.20g\n", oneNumber->getValue());
-                    editXMLEle(np, formatString);
-                }
-
-                propertySaved = true;
-                break;
-            }
-            else if (!strcmp(tagName, "newTextVector"))
-            {
-                auto tvp = getText(elemName);
-                if (tvp == nullptr)
-                {
-                    delXMLEle(root);
-                    return false;
-                }
-
-                XMLEle *tp = nullptr;
-                for (tp = nextXMLEle(ep, 1); tp != nullptr; tp = nextXMLEle(ep, 0))
-                {
-                    auto oneText = tvp->findWidgetByName(findXMLAttValu(tp, "name"));
-                    if (oneText == nullptr)
-                        return false;
-
-                    char formatString[MAXRBUF];
-                    snprintf(formatString, MAXRBUF, "      %s\n", oneText->getText() ? oneText->getText() : "");
-                    editXMLEle(tp, formatString);
-                }
 
-                propertySaved = true;
-                break;
-            }
-        }
-
-        if (propertySaved)
-        {
-            fp = IUGetConfigFP(nullptr, getDeviceName(), "w", errmsg);
-            prXMLEle(fp, root, 0);
-            fflush(fp);
-            fclose(fp);
-            delXMLEle(root);
-            LOGF_DEBUG("Configuration successfully saved for %s.", property);
-            return true;
-        }
-        else
-        {
-            delXMLEle(root);
-            // If property does not exist, save the whole thing
-            return saveConfig(silent);
-        }
+        d->m_ConfigSaveTimer.start();
     }
 
     return true;
@@ -341,6 +341,10 @@ class DefaultDevice : public BaseDevice
          * \param property Name of specific property to save while leaving all others properties in the
          * file as is.
          * \return True if successful, false otherwise.
+         * \note The file is replaced atomically. A full save is written before returning. Saves of a single property
+         * update the configuration in memory and are collected for a short while, then written together on a background
+         * thread, so their write errors are only logged. Pending changes are flushed before the configuration is loaded
+         * and when the driver exits.
          */
         virtual bool saveConfig(bool silent = false, const char *property = nullptr);
 
@@ -21,14 +21,22 @@
 #include "basedevice_p.h"
 #include "defaultdevice.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <list>
 #include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include <sys/stat.h>
 
 #include "indipropertyswitch.h"
 #include "indipropertynumber.h"
 #include "indipropertytext.h"
 #include "inditimer.h"
+#include "lilxml.h"
 
 namespace INDI
 {
@@ -43,7 +51,7 @@ class DefaultDevicePrivate: public BaseDevicePrivate
         bool isInit { false };
         bool isDebug { false };
         bool isSimulation { false };
-        bool isDefaultConfigLoaded {false};
+        std::atomic_bool isDefaultConfigLoaded {false};
         bool isConfigLoading { false };
 
         uint16_t majorVersion { 1 };
@@ -73,6 +81,117 @@ class DefaultDevicePrivate: public BaseDevicePrivate
         // TimerHit timer
         INDI::Timer m_MainLoopTimer;
 
+    public:
+        /**
+         * @brief ConfigStamp Identifies a version of the config file. An atomic rename changes the inode, a write in
+         * place the modification time or the size.
+         */
+        struct ConfigStamp
+        {
+            time_t mtime {0};
+            long mtimeNsec {0};
+            off_t size {-1};
+            ino_t inode {0};
+
+            bool operator==(const ConfigStamp &other) const
+            {
+                return mtime == other.mtime && mtimeNsec == other.mtimeNsec && size == other.size && inode == other.inode;
+            }
+        };
+
+        /**
+         * @brief configStamp Stat the config file of the device.
+         * @return The stamp of the file on disk, the default stamp if it does not exist.
+         */
+        ConfigStamp configStamp() const;
+
+        /**
+         * @brief setConfig Replace the in-memory configuration with a freshly serialized config file. The caller writes
+         * it with commitConfig.
+         */
+        void setConfig(const char *buffer, size_t size);
+
+        /**
+         * @brief updateConfig Update the values of a single property in the in-memory configuration.
+         * @return True if the property exists in the configuration, false otherwise.
+         */
+        bool updateConfig(const char *property);
+
+        /**
+         * @brief loadConfigRoot Parse the config file unless m_ConfigRoot is up to date with it. After a reload, the
+         * changes not yet on disk are applied again. Call with m_ConfigLock held.
+         * @return True if m_ConfigRoot holds the configuration, false otherwise.
+         */
+        bool loadConfigRoot();
+
+        /**
+         * @brief applyConfig Copy the current values of a property into m_ConfigRoot. Call with m_ConfigLock held.
+         * @return True if the property exists in the configuration, false otherwise.
+         */
+        bool applyConfig(const char *property);
+
+        /**
+         * @brief snapshotConfig Serialize the in-memory configuration if it has unsaved changes.
+         * @return True if a new snapshot was taken, false otherwise.
+         */
+        bool snapshotConfig();
+
+        /**
+         * @brief scheduleConfigWrite Serialize the dirty in-memory configuration and write it on the config writer thread.
+         */
+        void scheduleConfigWrite();
+
+        /**
+         * @brief requestConfigWrite Wake the config writer thread without waiting for it, requests made while it is
+         * writing are coalesced.
+         */
+        void requestConfigWrite();
+
+        /**
+         * @brief configWriterThread Commit the latest snapshot each time a write is requested, until the device is destroyed.
+         */
+        void configWriterThread();
+
+        /**
+         * @brief flushConfig Write any pending configuration changes to disk before returning.
+         */
+        bool flushConfig();
+
+        /**
+         * @brief commitConfig Atomically write the most recent configuration snapshot unless it is already on disk.
+         */
+        bool commitConfig();
+
+        /**
+         * @brief dropConfig Discard the in-memory configuration and any pending writes. Call with m_ConfigWriteLock held.
+         */
+        void dropConfig();
+
+        // Parsed config file contents as last saved by the driver, guarded by m_ConfigLock.
+        std::mutex m_ConfigLock;
+        XMLEle *m_ConfigRoot { nullptr };
+        // The file m_ConfigRoot was read from or last written to
+        ConfigStamp m_ConfigStamp;
+        std::set<std::string> m_ConfigDirtyProperties;
+        // Properties of the snapshot not yet on disk
+        std::set<std::string> m_ConfigPendingProperties;
+        std::string m_ConfigSnapshot;
+        std::string m_ConfigSnapshotProperties;
+        uint64_t m_ConfigSnapshotGeneration { 0 };
+
+        // Serializes writes to the config file, guards m_ConfigWrittenGeneration.
+        std::mutex m_ConfigWriteLock;
+        uint64_t m_ConfigWrittenGeneration { 0 };
+
+        // Debounces single property saves
+        INDI::Timer m_ConfigSaveTimer;
+        // Writes config files off the event thread, guarded by m_ConfigRequestLock.
+        std::mutex m_ConfigRequestLock;
+        std::condition_variable m_ConfigRequest;
+        bool m_ConfigWriteRequested { false };
+        bool m_ConfigWriterQuit { false };
+        std::thread m_ConfigWriter;
+
     public:
         static std::list<DefaultDevicePrivate*> devices;
         static std::recursive_mutex             devicesLock;
@@ -83,15 +83,21 @@ bool Convolution::ISNewBLOB(const char *dev, const char *name, int sizes[], int
 
 uint8_t* Convolution::Callback(uint8_t *buf, uint32_t dims, int *sizes, int bits_per_sample)
 {
-    setStream(buf, dims, sizes, bits_per_sample);
-    Convolute();
-    return getStream();
+    // Convolution works on the frame in its own type, without a dsp_t copy
+    if (!setTypedStream(buf, dims, sizes, bits_per_sample))
+        setStream(buf, dims, sizes, bits_per_sample);
+    return processStream();
 }
 
-void Convolution::Convolute()
+dsp_stream_p Convolution::Process(dsp_stream_p input)
 {
-    if(matrix_loaded)
-        dsp_convolution_convolution(stream, matrix);
+    if(!matrix_loaded)
+        return nullptr;
+
+    dsp_stream_p result = dsp_convolution_convolution(input, matrix);
+    if(result == nullptr)
+        LOGF_ERROR("Convolution matrix of %s has more dimensions than the stream", getDeviceName());
+    return result;
 }
 
 Wavelets::Wavelets(INDI::DefaultDevice *dev) : Interface(dev, DSP_CONVOLUTION, "WAVELETS", "Wavelets")
@@ -134,34 +140,45 @@ bool Wavelets::ISNewNumber(const char *dev, const char *name, double *values, ch
 uint8_t* Wavelets::Callback(uint8_t *buf, uint32_t dims, int *sizes, int bits_per_sample)
 {
     setStream(buf, dims, sizes, bits_per_sample);
-    double min = dsp_stats_min(stream->buf, stream->len);
-    double max = dsp_stats_max(stream->buf, stream->len);
-    dsp_stream_p out = dsp_stream_copy(stream);
+    return processStream();
+}
+
+dsp_stream_p Wavelets::Process(dsp_stream_p input)
+{
+    double min = dsp_stats_min(input->buf, input->len);
+    double max = dsp_stats_max(input->buf, input->len);
+    dsp_stream_p out = dsp_stream_copy(input);
     for (int i = 0; i < WaveletsNP.nnp; i++) {
+        if (WaveletsNP.np[i].value == 0)
+            continue;
         int size = (i+1)*3;
-        dsp_stream_p tmp = dsp_stream_copy(stream);
         dsp_stream_p matrix = dsp_stream_new();
         dsp_stream_add_dim(matrix, size);
         dsp_stream_add_dim(matrix, size);
         dsp_stream_alloc_buffer(matrix, matrix->len);
+        // The matrix is separable, it is applied as two one-dimensional passes
+        double sum = 0;
         for(int y = 0; y < size; y++) {
             for(int x = 0; x < size; x++) {
                 matrix->buf[x + y * size] = sin(static_cast<double>(x)*M_PI/static_cast<double>(size))*sin(static_cast<double>(y)*M_PI/static_cast<double>(size));
+                sum += matrix->buf[x + y * size];
             }
         }
-        dsp_convolution_convolution(tmp, matrix);
-        dsp_buffer_sub(tmp, matrix->buf, matrix->len);
+        dsp_buffer_mul1(matrix, 1.0 / sum);
+        // Detail layer, the difference between the input and the smoothed input
+        dsp_stream_p smoothed = dsp_convolution_convolution(input, matrix);
+        dsp_stream_p tmp = dsp_stream_copy(input);
+        dsp_buffer_sub(tmp, smoothed->buf, smoothed->len);
         dsp_buffer_mul1(tmp, WaveletsNP.np[i].value/8.0);
         dsp_buffer_sum(out, tmp->buf, tmp->len);
-        dsp_buffer_normalize(tmp->buf, min, max, tmp->len);
+        dsp_stream_free_buffer(smoothed);
+        dsp_stream_free(smoothed);
         dsp_stream_free_buffer(matrix);
         dsp_stream_free(matrix);
         dsp_stream_free_buffer(tmp);
         dsp_stream_free(tmp);
     }
-    dsp_stream_free_buffer(stream);
-    dsp_stream_free(stream);
-    stream = dsp_stream_copy(out);
-    return getStream();
+    dsp_buffer_normalize(out->buf, out->len, min, max);
+    return out;
 }
 }
@@ -33,6 +33,7 @@ class Convolution : public Interface
 public:
     Convolution(INDI::DefaultDevice *dev);
     bool ISNewBLOB(const char *dev, const char *name, int sizes[], int blobsizes[], char *blobs[], char *formats[], char *names[], int n) override;
+    Input getInput() override { return DSP_INPUT_TYPED_FRAME; }
 
 protected:
     ~Convolution();
@@ -40,6 +41,7 @@ protected:
     void Deactivated() override;
 
     uint8_t *Callback(uint8_t *out, uint32_t dims, int *sizes, int bits_per_sample) override;
+    dsp_stream_p Process(dsp_stream_p input) override;
 
 private:
     dsp_stream_p matrix;
@@ -48,7 +50,6 @@ private:
     IBLOB DownloadB;
 
     bool matrix_loaded { false };
-    void Convolute();
 };
 
 class Wavelets : public Interface
@@ -63,6 +64,7 @@ protected:
     void Deactivated() override;
 
     uint8_t *Callback(uint8_t *out, uint32_t dims, int *sizes, int bits_per_sample) override;
+    dsp_stream_p Process(dsp_stream_p input) override;
 
 private:
     dsp_stream_p matrix;
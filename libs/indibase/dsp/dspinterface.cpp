@@ -33,9 +33,6 @@
 #include <libnova/ln_types.h>
 #include <libnova/precession.h>
 
-#include <regex>
-
-#include <dirent.h>
 #include <cerrno>
 #include <locale.h>
 #include <cstdio>
@@ -46,13 +43,6 @@
 #include <unistd.h>
 #include <fcntl.h>
 
-static std::string regex_replace_compat(const std::string &input, const std::string &pattern, const std::string &replace)
-{
-    std::stringstream s;
-    std::regex_replace(std::ostreambuf_iterator<char>(s), input.begin(), input.end(), std::regex(pattern), replace);
-    return s.str();
-}
-
 namespace DSP
 {
 const char *DSP_TAB = "Signal Processing";
@@ -179,6 +169,12 @@ uint8_t* Interface::Callback(uint8_t* buf, uint32_t ndims, int* dims, int bits_p
     return nullptr;
 }
 
+dsp_stream_p Interface::Process(dsp_stream_p input)
+{
+    INDI_UNUSED(input);
+    return nullptr;
+}
+
 bool Interface::processBLOB(uint8_t* buf, uint32_t ndims, int* dims, int bits_per_sample)
 {
     if(PluginActive)
@@ -188,36 +184,76 @@ bool Interface::processBLOB(uint8_t* buf, uint32_t ndims, int* dims, int bits_pe
         bool saveCapture = (m_Device->getSwitch("UPLOAD_MODE")->sp[1].s == ISS_ON
                             || m_Device->getSwitch("UPLOAD_MODE")->sp[2].s == ISS_ON);
 
-        if (sendCapture || saveCapture)
-        {
-            setSizes(ndims, dims);
-            setBPS(bits_per_sample);
-            uint8_t* buffer = Callback(buf, ndims, dims, bits_per_sample);
-            if (buffer)
-            {
-                LOGF_INFO("%s processing done. Creating file..", m_Label);
-                if (!strcmp(FitsB.format, ".fits"))
-                {
-                    sendFITS(buffer, sendCapture, saveCapture);
-                }
-                else
-                {
-                    long len = 1;
-                    uint32_t i;
-                    for (len = 1, i = 0; i < BufferSizesQty; len *= BufferSizes[i++]);
-                    len *= getBPS() / 8;
-                    uploadFile(buffer, len, sendCapture, saveCapture, FitsB.format);
-                }
-
-                if (sendCapture)
-                    IDSetBLOB(&FitsBP, nullptr);
-            }
-            free(buffer);
-        }
+        if ((sendCapture || saveCapture) && prepareBLOB(buf, ndims, dims, bits_per_sample, nullptr))
+            uploadBLOB(sendCapture, saveCapture);
+    }
+    return true;
+}
+
+bool Interface::prepareBLOB(uint8_t* buf, uint32_t ndims, int* dims, int bits_per_sample, dsp_stream_p input)
+{
+    setSizes(ndims, dims);
+    setBPS(bits_per_sample);
+
+    uint8_t* buffer = nullptr;
+    dsp_stream_p result = (input != nullptr ? Process(input) : nullptr);
+    if (result != nullptr)
+        buffer = getResult(result);
+    else
+        buffer = Callback(buf, ndims, dims, bits_per_sample);
+
+    if (buffer == nullptr)
+        return false;
+
+    if (!strcmp(FitsB.format, ".fits"))
+    {
+        bool created = createFITS(buffer, &m_File, &m_FileSize);
+        free(buffer);
+        return created;
     }
+
+    long len = 1;
+    uint32_t i;
+    for (len = 1, i = 0; i < BufferSizesQty; len *= BufferSizes[i++]);
+    m_File = buffer;
+    m_FileSize = len * std::abs(getBPS()) / 8;
+    return true;
+}
+
+bool Interface::uploadBLOB(bool sendCapture, bool saveCapture)
+{
+    if (m_File == nullptr)
+        return false;
+
+    LOGF_INFO("%s processing done. Creating file..", m_Label);
+    bool r = uploadFile(m_File, m_FileSize, sendCapture, saveCapture, FitsB.format[0] == '.' ? FitsB.format + 1 : FitsB.format);
+    releaseBLOB();
+    return r;
+}
+
+bool Interface::saveBLOB(IBLOB *blob, bool saveCapture)
+{
+    if (m_File == nullptr)
+        return false;
+
+    LOGF_INFO("%s processing done. Creating file..", m_Label);
+    if (saveCapture && !uploadFile(m_File, m_FileSize, false, true, FitsB.format[0] == '.' ? FitsB.format + 1 : FitsB.format))
+        return false;
+
+    IUFillBLOB(blob, m_Name, m_Label, FitsB.format);
+    blob->blob    = m_File;
+    blob->bloblen = static_cast<int>(m_FileSize);
+    blob->size    = static_cast<int>(m_FileSize);
     return true;
 }
 
+void Interface::releaseBLOB()
+{
+    free(m_File);
+    m_File = nullptr;
+    m_FileSize = 0;
+}
+
 void Interface::Activated()
 {
     m_Device->defineProperty(&FitsBP);
@@ -413,7 +449,7 @@ err_free:
     return loaded_stream;
 }
 
-bool Interface::sendFITS(uint8_t *buf, bool sendCapture, bool saveCapture)
+bool Interface::createFITS(uint8_t *buf, void **file, size_t *size)
 {
     int img_type  = USHORT_IMG;
     int byte_type = TUSHORT;
@@ -467,9 +503,9 @@ bool Interface::sendFITS(uint8_t *buf, bool sendCapture, bool saveCapture)
     int status    = 0;
     int naxis    = static_cast<int>(BufferSizesQty);
     long *naxes = static_cast<long*>(malloc(sizeof(long) * BufferSizesQty));
-    long nelements = 0;
+    long nelements = 1;
 
-    for (uint32_t i = 0, nelements = 1; i < BufferSizesQty; nelements *= static_cast<long>(BufferSizes[i++]))
+    for (uint32_t i = 0; i < BufferSizesQty; nelements *= static_cast<long>(BufferSizes[i++]))
         naxes[i] = BufferSizes[i];
     char error_status[MAXINDINAME];
 
@@ -479,6 +515,7 @@ bool Interface::sendFITS(uint8_t *buf, bool sendCapture, bool saveCapture)
     if (!memptr)
     {
         LOGF_ERROR("Error: failed to allocate memory: %lu", memsize);
+        free(naxes);
         return false;
     }
 
@@ -490,6 +527,7 @@ bool Interface::sendFITS(uint8_t *buf, bool sendCapture, bool saveCapture)
         fits_get_errstatus(status, error_status);
         fits_close_file(fptr, &status);
         free(memptr);
+        free(naxes);
         LOGF_ERROR("FITS Error: %s", error_status);
         return false;
     }
@@ -502,6 +540,7 @@ bool Interface::sendFITS(uint8_t *buf, bool sendCapture, bool saveCapture)
         fits_get_errstatus(status, error_status);
         fits_close_file(fptr, &status);
         free(memptr);
+        free(naxes);
         LOGF_ERROR("FITS Error: %s", error_status);
         return false;
     }
@@ -516,14 +555,16 @@ bool Interface::sendFITS(uint8_t *buf, bool sendCapture, bool saveCapture)
         fits_get_errstatus(status, error_status);
         fits_close_file(fptr, &status);
         free(memptr);
+        free(naxes);
         LOGF_ERROR("FITS Error: %s", error_status);
         return false;
     }
 
     fits_close_file(fptr, &status);
+    free(naxes);
 
-    uploadFile(memptr, memsize, sendCapture, saveCapture, "fits");
-    free(memptr);
+    *file = memptr;
+    *size = memsize;
     return true;
 }
 
@@ -540,43 +581,22 @@ bool Interface::uploadFile(const void *fitsData, size_t totalBytes, bool sendCap
 
         FILE *fp = nullptr;
 
-        std::string prefix = m_Device->getText("UPLOAD_SETTINGS")->tp[1].text;
-
-        int maxIndex = getFileIndex(m_Device->getText("UPLOAD_SETTINGS")->tp[0].text, prefix.c_str(),
-                                    format);
-
-        if (maxIndex < 0)
+        std::string dir    = m_Device->getText("UPLOAD_SETTINGS")->tp[0].text;
+        std::string suffix = std::string("_") + m_Name + "." + format;
+        std::string fileName = m_FileIndex.nextFileName(dir, m_Device->getText("UPLOAD_SETTINGS")->tp[1].text, suffix);
+        if (fileName.empty())
         {
-            DEBUGF(INDI::Logger::DBG_ERROR, "Error iterating directory %s. %s", m_Device->getText("UPLOAD_SETTINGS")->tp[0].text,
-                   strerror(errno));
+            DEBUGF(INDI::Logger::DBG_ERROR, "Error iterating directory %s. %s", dir.c_str(), strerror(errno));
             return false;
         }
 
-        if (maxIndex > 0)
-        {
-            char ts[32];
-            struct tm *tp;
-            time_t t;
-            time(&t);
-            tp = localtime(&t);
-            strftime(ts, sizeof(ts), "%Y-%m-%dT%H-%M-%S", tp);
-            std::string filets(ts);
-            prefix = std::regex_replace(prefix, std::regex("ISO8601"), filets);
-
-            char indexString[8];
-            snprintf(indexString, 8, "%03d", maxIndex);
-            std::string prefixIndex = indexString;
-            //prefix.replace(prefix.find("XXX"), std::string::npos, prefixIndex);
-            prefix = std::regex_replace(prefix, std::regex("XXX"), prefixIndex);
-        }
-
-        snprintf(processedFileName, MAXINDINAME, "%s/%s_%s.%s", m_Device->getText("UPLOAD_SETTINGS")->tp[0].text, prefix.c_str(),
-                 m_Name, format);
+        snprintf(processedFileName, MAXINDINAME, "%s", fileName.c_str());
 
         fp = fopen(processedFileName, "w");
         if (fp == nullptr)
         {
             DEBUGF(INDI::Logger::DBG_ERROR, "Unable to save image file (%s). %s", processedFileName, strerror(errno));
+            m_FileIndex.invalidate();
             return false;
         }
 
@@ -607,61 +627,6 @@ bool Interface::uploadFile(const void *fitsData, size_t totalBytes, bool sendCap
     return true;
 }
 
-int Interface::getFileIndex(const char *dir, const char *prefix, const char *ext)
-{
-    INDI_UNUSED(ext);
-
-    DIR *dpdf = nullptr;
-    struct dirent *epdf = nullptr;
-    std::vector<std::string> files = std::vector<std::string>();
-
-    std::string prefixIndex = prefix;
-    prefixIndex             = regex_replace_compat(prefixIndex, "_ISO8601", "");
-    prefixIndex             = regex_replace_compat(prefixIndex, "_XXX", "");
-
-    // Create directory if does not exist
-    struct stat st;
-
-    if (stat(dir, &st) == -1)
-    {
-        LOGF_DEBUG("Creating directory %s...", dir);
-        if (INDI::mkpath(dir, 0755) == -1)
-            LOGF_ERROR("Error creating directory %s (%s)", dir, strerror(errno));
-    }
-
-    dpdf = opendir(dir);
-    if (dpdf != nullptr)
-    {
-        while ((epdf = readdir(dpdf)))
-        {
-            if (strstr(epdf->d_name, prefixIndex.c_str()))
-                files.push_back(epdf->d_name);
-        }
-        closedir(dpdf);
-    }
-    else
-        return -1;
-
-    int maxIndex = 0;
-
-    for (unsigned long i = 0; i < static_cast<unsigned long>(files.size()); i++)
-    {
-        int index = -1;
-
-        std::string file  = files.at(i);
-        std::size_t start = file.find_last_of("_");
-        std::size_t end   = file.find_last_of(".");
-        if (start != std::string::npos)
-        {
-            index = atoi(file.substr(start + 1, end).c_str());
-            if (index > maxIndex)
-                maxIndex = index;
-        }
-    }
-
-    return (maxIndex + 1);
-}
-
 void Interface::setStream(void *buf, uint32_t dims, int *sizes, int bits_per_sample)
 {
     //Create the dsp stream
@@ -696,9 +661,76 @@ void Interface::setStream(void *buf, uint32_t dims, int *sizes, int bits_per_sam
     }
 }
 
+bool Interface::setTypedStream(void *buf, uint32_t dims, int *sizes, int bits_per_sample)
+{
+    dsp_type type;
+    switch (bits_per_sample)
+    {
+        case 8:
+            type = dsp_type_uint8;
+            break;
+        case 16:
+            type = dsp_type_uint16;
+            break;
+        case -32:
+            type = dsp_type_float;
+            break;
+        case -64:
+            type = dsp_type_double;
+            break;
+        default:
+            return false;
+    }
+
+    stream = dsp_stream_new();
+    for(uint32_t dim = 0; dim < dims; dim++)
+        dsp_stream_add_dim(stream, sizes[dim]);
+    // The input buffer is owned by the caller, it is not freed with the stream
+    dsp_stream_set_typed_buffer(stream, buf, type);
+    return true;
+}
+
+uint8_t* Interface::getResult(dsp_stream_p result)
+{
+    ResultSizes.assign(result->sizes, result->sizes + result->dims);
+    setSizes(ResultSizes.size(), ResultSizes.data());
+    stream = result;
+    return getStream();
+}
+
+uint8_t* Interface::processStream()
+{
+    dsp_stream_p result = Process(stream);
+    if (result == nullptr)
+        return getStream();
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+    return getResult(result);
+}
+
 uint8_t* Interface::getStream()
 {
-    void *buffer = malloc(stream->len * getBPS() / 8);
+    size_t size = stream->len * std::abs(getBPS()) / 8;
+    void *buffer = nullptr;
+    if (stream->data != nullptr)
+    {
+        // Typed results of libdsp are handed over as they are, the wrapped input buffer is copied
+        if (stream->data_owned)
+        {
+            buffer = stream->data;
+            stream->data = nullptr;
+        }
+        else
+        {
+            buffer = malloc(size);
+            memcpy(buffer, stream->data, size);
+        }
+        dsp_stream_free_buffer(stream);
+        dsp_stream_free(stream);
+        return static_cast<uint8_t *>(buffer);
+    }
+
+    buffer = malloc(size);
     switch (getBPS())
     {
         case 8:
@@ -22,10 +22,12 @@
 
 #include "indidevapi.h"
 #include "dsp.h"
+#include "indifileindex.h"
 
 #include <fitsio.h>
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace INDI
 {
@@ -57,6 +59,7 @@ class Interface
      * sample size.
      * Classes that use the Interface class children should call processBLOB to propagate until children's Callback methods and
      * generate BLOBs.
+     * Plugins that implement Process can be run by DSP::Manager on a stream shared with the other plugins, getInput selects it.
      *
      * @see DSP::Convolution
      * @see DSP::Transforms
@@ -76,6 +79,18 @@ class Interface
         DSP_SPECTRUM,
         } Type;
 
+        /**
+         * \struct Input
+         * \brief The intermediate stream processed by the plugin, DSP::Manager computes each one once per frame
+         */
+        typedef enum  {
+        DSP_INPUT_FRAME = 0,
+        /// Typed stream wrapping the frame, see setTypedStream, or the dsp_t frame for bit depths without a type
+        DSP_INPUT_TYPED_FRAME,
+        DSP_INPUT_IDFT,
+        DSP_INPUT_COUNT,
+        } Input;
+
         virtual void ISGetProperties(const char *dev);
         virtual bool ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n);
         virtual bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n);
@@ -94,6 +109,56 @@ class Interface
          */
         bool processBLOB(uint8_t* buf, uint32_t ndims, int* dims, int bits_per_sample);
 
+        /**
+         * @brief prepareBLOB Process the input and create the file of the result, without sending or saving it.
+         * @param buf The input buffer
+         * @param ndims Number of the dimensions of the input buffer
+         * @param dims Sizes of the dimensions of the input buffer
+         * @param bits_per_sample original bit depth of the input buffer
+         * @param input The shared intermediate stream returned by getInput(), it is passed to Process.
+         * When nullptr or when Process returns nullptr, Callback is called with the input buffer.
+         * @return True if a file was created.
+         */
+        bool prepareBLOB(uint8_t* buf, uint32_t ndims, int* dims, int bits_per_sample, dsp_stream_p input);
+
+        /**
+         * @brief uploadBLOB Send and/or save the file created by prepareBLOB.
+         * @param sendCapture Send the file to the client.
+         * @param saveCapture Save the file to the upload directory.
+         * @return True if successful, false otherwise.
+         */
+        bool uploadBLOB(bool sendCapture, bool saveCapture);
+
+        /**
+         * @brief saveBLOB Save the file created by prepareBLOB, and describe it for a caller that sends the results
+         * of several plugins together.
+         * @param blob Filled with the file and its format, valid until releaseBLOB.
+         * @param saveCapture Save the file to the upload directory.
+         * @return True if successful, false otherwise.
+         */
+        bool saveBLOB(IBLOB *blob, bool saveCapture);
+
+        /**
+         * @brief releaseBLOB Free the file created by prepareBLOB.
+         */
+        void releaseBLOB();
+
+        /**
+         * @brief isActive Whether the plugin has been activated from the client.
+         */
+        bool isActive() { return PluginActive; }
+
+        /**
+         * @brief getName Name of the plugin, also the name of its BLOB.
+         */
+        const char *getName() { return m_Name; }
+        const char *getLabel() { return m_Label; }
+
+        /**
+         * @brief getInput The intermediate stream passed to Process, the frame by default.
+         */
+        virtual Input getInput() { return DSP_INPUT_FRAME; }
+
         /**
          * @brief setSizes Set the returned file dimensions and corresponding sizes.
          * @param num Number of dimensions.
@@ -142,6 +207,13 @@ class Interface
          */
         virtual uint8_t* Callback(uint8_t* buf, uint32_t ndims, int* dims, int bits_per_sample);
 
+        /**
+         * @brief Process Called by prepareBLOB with the intermediate stream selected by getInput.
+         * @param input The input stream, shared with other plugins running at the same time, it must not be modified
+         * @return A new stream with the result, or nullptr to have Callback called instead
+         */
+        virtual dsp_stream_p Process(dsp_stream_p input);
+
         /**
          * @brief loadFITS Converts FITS data into a dsp_stream structure pointer.
          * @param buf The input buffer
@@ -150,7 +222,7 @@ class Interface
          */
         dsp_stream_p loadFITS(char* buf, int len);
 
-        bool PluginActive;
+        bool PluginActive { false };
 
         IBLOBVectorProperty FitsBP;
         IBLOB FitsB;
@@ -174,19 +246,37 @@ class Interface
         const char *m_Label {  nullptr };
         Type m_Type {  DSP_NONE };
         void setStream(void *buf, uint32_t dims, int *sizes, int bits_per_sample);
+        /**
+         * @brief setTypedStream Wraps the input buffer in a typed stream, the elements are not converted to dsp_t.
+         * Process may only pass it to libdsp functions supporting typed streams, the others dereference the dsp_t
+         * buffer, which is NULL: convert the stream with dsp_stream_convert_typed_buffer before calling them.
+         * @return false if the bit depth has no typed stream, use setStream then.
+         */
+        bool setTypedStream(void *buf, uint32_t dims, int *sizes, int bits_per_sample);
         uint8_t *getStream();
+        /**
+         * @brief processStream Replaces stream with the result of Process, for Callback implementations.
+         * @return The processed buffer, as getStream.
+         */
+        uint8_t *processStream();
         dsp_stream_p stream;
 
     private:
         uint32_t BufferSizesQty;
         int *BufferSizes;
         int BPS;
+        uint8_t *getResult(dsp_stream_p result);
+        // Sizes of the result of Process, the stream is freed before the file is created
+        std::vector<int> ResultSizes;
+        // File created by prepareBLOB
+        void *m_File { nullptr };
+        size_t m_FileSize { 0 };
 
         char processedFileName[MAXINDINAME];
         void fits_update_key_s(fitsfile *fptr, int type, std::string name, void *p, std::string explanation, int *status);
         void addFITSKeywords(fitsfile *fptr);
-        bool sendFITS(uint8_t *buf, bool sendCapture, bool saveCapture);
+        bool createFITS(uint8_t *buf, void **file, size_t *size);
         bool uploadFile(const void *fitsData, size_t totalBytes, bool sendIntegration, bool saveIntegration, const char* format);
-        int getFileIndex(const char *dir, const char *prefix, const char *ext);
+        INDI::FileIndex m_FileIndex;
 };
 }
@@ -26,12 +26,11 @@
 #include <cerrno>
 #include <cstring>
 #include <algorithm>
-#include <thread>
 #include <chrono>
 
 namespace DSP
 {
-Manager::Manager(INDI::DefaultDevice *dev)
+Manager::Manager(INDI::DefaultDevice *dev) : m_Device(dev)
 {
     convolution = new Convolution(dev);
     dft = new FourierTransform(dev);
@@ -39,6 +38,14 @@ Manager::Manager(INDI::DefaultDevice *dev)
     spectrum = new Spectrum(dev);
     histogram = new Histogram(dev);
     wavelets = new Wavelets(dev);
+    plugins = { convolution, dft, idft, spectrum, histogram, wavelets };
+
+    // One element per plugin, the results of a frame are sent together
+    ResultsB.resize(plugins.size());
+    for (size_t i = 0; i < plugins.size(); i++)
+        IUFillBLOB(&ResultsB[i], plugins[i]->getName(), plugins[i]->getLabel(), "");
+    IUFillBLOBVector(&ResultsBP, ResultsB.data(), static_cast<int>(ResultsB.size()), dev->getDeviceName(), "DSP_RESULTS",
+                     "Results", DSP_TAB, IP_RO, 60, IPS_IDLE);
 }
 
 Manager::~Manager()
@@ -53,6 +60,9 @@ void Manager::ISGetProperties(const char *dev)
     spectrum->ISGetProperties(dev);
     histogram->ISGetProperties(dev);
     wavelets->ISGetProperties(dev);
+
+    if (m_Device->isConnected())
+        m_Device->defineProperty(&ResultsBP);
 }
 
 bool Manager::updateProperties()
@@ -64,6 +74,11 @@ bool Manager::updateProperties()
     r |= spectrum->updateProperties();
     r |= histogram->updateProperties();
     r |= wavelets->updateProperties();
+
+    if (m_Device->isConnected())
+        m_Device->defineProperty(&ResultsBP);
+    else
+        m_Device->deleteProperty(ResultsBP.name);
     return r;
 }
 
@@ -130,14 +145,161 @@ bool Manager::saveConfigItems(FILE *fp)
 
 bool Manager::processBLOB(uint8_t* buf, uint32_t ndims, int* dims, int bits_per_sample)
 {
-    bool r = false;
-    r |= convolution->processBLOB(buf, ndims, dims, bits_per_sample);
-    r |= dft->processBLOB(buf, ndims, dims, bits_per_sample);
-    r |= idft->processBLOB(buf, ndims, dims, bits_per_sample);
-    r |= spectrum->processBLOB(buf, ndims, dims, bits_per_sample);
-    r |= histogram->processBLOB(buf, ndims, dims, bits_per_sample);
-    r |= wavelets->processBLOB(buf, ndims, dims, bits_per_sample);
+    ISwitchVectorProperty *uploadMode = m_Device->getSwitch("UPLOAD_MODE");
+    if (uploadMode == nullptr)
+        return false;
+    bool sendCapture = (uploadMode->sp[0].s == ISS_ON || uploadMode->sp[2].s == ISS_ON);
+    bool saveCapture = (uploadMode->sp[1].s == ISS_ON || uploadMode->sp[2].s == ISS_ON);
+    if (!sendCapture && !saveCapture)
+        return true;
+
+    std::vector<Interface*> active;
+    std::copy_if(plugins.begin(), plugins.end(), std::back_inserter(active), [](Interface * plugin)
+    {
+        return plugin->isActive();
+    });
+    if (active.empty())
+        return true;
+
+    // Intermediate streams, each is computed once and shared read only by the plugins that process it
+    dsp_stream_p inputs[Interface::DSP_INPUT_COUNT] = { nullptr };
+    bool needed[Interface::DSP_INPUT_COUNT] = { false };
+    for (auto plugin : active)
+        needed[plugin->getInput()] = true;
+
+    if (needed[Interface::DSP_INPUT_TYPED_FRAME])
+    {
+        dsp_type type = dsp_type_double;
+        bool typed = true;
+        switch (bits_per_sample)
+        {
+            case 8:
+                type = dsp_type_uint8;
+                break;
+            case 16:
+                type = dsp_type_uint16;
+                break;
+            case -32:
+                type = dsp_type_float;
+                break;
+            case -64:
+                type = dsp_type_double;
+                break;
+            default:
+                typed = false;
+                break;
+        }
+        if (typed)
+        {
+            // Wraps the input buffer, nothing is copied
+            inputs[Interface::DSP_INPUT_TYPED_FRAME] = newStream(ndims, dims);
+            dsp_stream_set_typed_buffer(inputs[Interface::DSP_INPUT_TYPED_FRAME], buf, type);
+        }
+        else
+            needed[Interface::DSP_INPUT_FRAME] = true;
+    }
+    if (needed[Interface::DSP_INPUT_IDFT])
+        needed[Interface::DSP_INPUT_FRAME] = true;
+
+    if (needed[Interface::DSP_INPUT_FRAME])
+    {
+        void *data = buf;
+        dsp_stream_p frame = newStream(ndims, dims);
+        dsp_stream_alloc_buffer(frame, frame->len);
+        switch (bits_per_sample)
+        {
+            case 8:
+                dsp_buffer_copy((static_cast<uint8_t *>(data)), frame->buf, frame->len);
+                break;
+            case 16:
+                dsp_buffer_copy((static_cast<uint16_t *>(data)), frame->buf, frame->len);
+                break;
+            case 32:
+                dsp_buffer_copy((static_cast<uint32_t *>(data)), frame->buf, frame->len);
+                break;
+            case 64:
+                dsp_buffer_copy((static_cast<unsigned long *>(data)), frame->buf, frame->len);
+                break;
+            case -32:
+                dsp_buffer_copy((static_cast<float *>(data)), frame->buf, frame->len);
+                break;
+            case -64:
+                dsp_buffer_copy((static_cast<double *>(data)), frame->buf, frame->len);
+                break;
+            default:
+                dsp_stream_free_buffer(frame);
+                dsp_stream_free(frame);
+                frame = nullptr;
+                break;
+        }
+        inputs[Interface::DSP_INPUT_FRAME] = frame;
+        if (inputs[Interface::DSP_INPUT_TYPED_FRAME] == nullptr)
+            inputs[Interface::DSP_INPUT_TYPED_FRAME] = frame;
+    }
+
+    if (needed[Interface::DSP_INPUT_IDFT] && inputs[Interface::DSP_INPUT_FRAME] != nullptr)
+    {
+        inputs[Interface::DSP_INPUT_IDFT] = dsp_stream_copy(inputs[Interface::DSP_INPUT_FRAME]);
+        dsp_fourier_idft(inputs[Interface::DSP_INPUT_IDFT]);
+    }
+
+    // The plugins run one after another on this thread, so the libdsp loops inside each of them use the whole pool.
+    // Their files are saved as they complete, then sent together in a single message.
+    bool r = true;
+    std::vector<IBLOB> results;
+    std::vector<Interface*> prepared;
+    for (auto plugin : active)
+    {
+        if (plugin->prepareBLOB(buf, ndims, dims, bits_per_sample, inputs[plugin->getInput()]) == false)
+            continue;
+
+        prepared.push_back(plugin);
+        IBLOB result;
+        if (plugin->saveBLOB(&result, saveCapture))
+            results.push_back(result);
+        else
+            r = false;
+    }
+
+    if (sendCapture && !results.empty())
+    {
+        // Only the elements of this frame, the other plugins keep their previous result
+        IBLOBVectorProperty resultsBP = ResultsBP;
+        resultsBP.bp  = results.data();
+        resultsBP.nbp = static_cast<int>(results.size());
+        resultsBP.s   = IPS_OK;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        IDSetBLOB(&resultsBP, nullptr);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> diff = end - start;
+        DEBUGFDEVICE(m_Device->getDeviceName(), INDI::Logger::DBG_DEBUG, "BLOB transfer of %zu results took %g seconds",
+                     results.size(), diff.count());
+    }
+
+    for (auto plugin : prepared)
+        plugin->releaseBLOB();
+
+    if (inputs[Interface::DSP_INPUT_TYPED_FRAME] != inputs[Interface::DSP_INPUT_FRAME])
+        freeStream(inputs[Interface::DSP_INPUT_TYPED_FRAME]);
+    freeStream(inputs[Interface::DSP_INPUT_FRAME]);
+    freeStream(inputs[Interface::DSP_INPUT_IDFT]);
     return r;
 }
 
+dsp_stream_p Manager::newStream(uint32_t ndims, int* dims)
+{
+    dsp_stream_p stream = dsp_stream_new();
+    for(uint32_t dim = 0; dim < ndims; dim++)
+        dsp_stream_add_dim(stream, dims[dim]);
+    return stream;
+}
+
+void Manager::freeStream(dsp_stream_p stream)
+{
+    if (stream == nullptr)
+        return;
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
 }
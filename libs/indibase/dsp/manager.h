@@ -27,6 +27,7 @@
 #include <fitsio.h>
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace INDI
 {
@@ -49,6 +50,17 @@ class Manager
         virtual bool saveConfigItems(FILE *fp);
         virtual bool updateProperties();
 
+        /**
+         * @brief processBLOB Run the active plugins on a frame and upload their results.
+         * The frame is converted once into the intermediate streams the plugins need, see Interface::getInput. The
+         * plugins then run one after another on these shared streams, each with the libdsp loops parallel. Their
+         * files are saved, then sent together as the elements of the DSP_RESULTS property.
+         * @param buf The input buffer, it is not modified
+         * @param ndims Number of the dimensions of the input buffer
+         * @param dims Sizes of the dimensions of the input buffer
+         * @param bits_per_sample original bit depth of the input buffer
+         * @return True if successful, false otherwise.
+         */
         bool processBLOB(uint8_t* buf, uint32_t ndims, int* dims, int bits_per_sample);
 
         inline void setSizes(uint32_t num, int* sizes) { BufferSizes = sizes; BufferSizesQty = num; }
@@ -58,6 +70,11 @@ class Manager
         inline int getBPS() { return BPS; }
 
     private:
+        INDI::DefaultDevice *m_Device { nullptr };
+        std::vector<Interface*> plugins;
+        // Results of the plugins, one element per plugin
+        IBLOBVectorProperty ResultsBP;
+        std::vector<IBLOB> ResultsB;
         Convolution *convolution;
         FourierTransform *dft;
         InverseFourierTransform *idft;
@@ -67,5 +84,8 @@ class Manager
         uint32_t BufferSizesQty;
         int *BufferSizes;
         int BPS;
+
+        dsp_stream_p newStream(uint32_t ndims, int* dims);
+        void freeStream(dsp_stream_p stream);
 };
 }
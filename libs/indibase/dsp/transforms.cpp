@@ -43,11 +43,20 @@ FourierTransform::~FourierTransform()
 uint8_t* FourierTransform::Callback(uint8_t *buf, uint32_t dims, int *sizes, int bits_per_sample)
 {
     setStream(buf, dims, sizes, bits_per_sample);
-    dsp_complex* dft = dsp_fourier_dft(stream);
-    for(int x = 0; x < stream->len; x++)
-        stream->buf[x] = sqrt(pow(dft[x].real, 2)+pow(dft[x].imaginary, 2));
-    dsp_buffer_stretch(stream->buf, stream->len, 0.0, (bits_per_sample < 0 ? 1.0 : pow(2, bits_per_sample)-1));
-    return getStream();
+    return processStream();
+}
+
+dsp_stream_p FourierTransform::Process(dsp_stream_p input)
+{
+    dsp_complex* dft = dsp_fourier_dft(input);
+    if (dft == nullptr)
+        return nullptr;
+    dsp_stream_p out = dsp_stream_copy(input);
+    for(int x = 0; x < out->len; x++)
+        out->buf[x] = sqrt(pow(dft[x].real, 2)+pow(dft[x].imaginary, 2));
+    free(dft);
+    dsp_buffer_stretch(out->buf, out->len, 0.0, (getBPS() < 0 ? 1.0 : pow(2, getBPS())-1));
+    return out;
 }
 
 InverseFourierTransform::InverseFourierTransform(INDI::DefaultDevice *dev) : Interface(dev, DSP_IDFT, "IDFT", "IDFT")
@@ -62,8 +71,14 @@ uint8_t* InverseFourierTransform::Callback(uint8_t *buf, uint32_t dims, int *siz
 {
     setStream(buf, dims, sizes, bits_per_sample);
     dsp_fourier_idft(stream);
-    dsp_buffer_stretch(stream->buf, stream->len, 0.0, (bits_per_sample < 0 ? 1.0 : pow(2, bits_per_sample)-1));
-    return getStream();
+    return processStream();
+}
+
+dsp_stream_p InverseFourierTransform::Process(dsp_stream_p input)
+{
+    dsp_stream_p out = dsp_stream_copy(input);
+    dsp_buffer_stretch(out->buf, out->len, 0.0, (getBPS() < 0 ? 1.0 : pow(2, getBPS())-1));
+    return out;
 }
 
 Spectrum::Spectrum(INDI::DefaultDevice *dev) : Interface(dev, DSP_SPECTRUM, "SPECTRUM", "Spectrum")
@@ -78,11 +93,16 @@ uint8_t* Spectrum::Callback(uint8_t *buf, uint32_t dims, int *sizes, int bits_pe
 {
     setStream(buf, dims, sizes, bits_per_sample);
     dsp_fourier_idft(stream);
-    double *histo = dsp_stats_histogram(stream, 4096);
-    dsp_stream_free_buffer(stream);
-    dsp_stream_set_buffer(stream, histo, 4096);
-    setSizes(1, new int{4096});
-    return getStream();
+    return processStream();
+}
+
+dsp_stream_p Spectrum::Process(dsp_stream_p input)
+{
+    dsp_stream_p out = dsp_stream_new();
+    dsp_stream_add_dim(out, 4096);
+    dsp_stream_free_buffer(out);
+    dsp_stream_set_buffer(out, dsp_stats_histogram(input, 4096), 4096);
+    return out;
 }
 
 
@@ -97,10 +117,15 @@ Histogram::~Histogram()
 uint8_t* Histogram::Callback(uint8_t *buf, uint32_t dims, int *sizes, int bits_per_sample)
 {
     setStream(buf, dims, sizes, bits_per_sample);
-    double *histo = dsp_stats_histogram(stream, 4096);
-    dsp_stream_free_buffer(stream);
-    dsp_stream_set_buffer(stream, histo, 4096);
-    setSizes(1, new int{4096});
-    return getStream();
+    return processStream();
+}
+
+dsp_stream_p Histogram::Process(dsp_stream_p input)
+{
+    dsp_stream_p out = dsp_stream_new();
+    dsp_stream_add_dim(out, 4096);
+    dsp_stream_free_buffer(out);
+    dsp_stream_set_buffer(out, dsp_stats_histogram(input, 4096), 4096);
+    return out;
 }
 }
@@ -35,26 +35,31 @@ public:
 protected:
     ~FourierTransform();
     uint8_t *Callback(uint8_t *out, uint32_t dims, int *sizes, int bits_per_sample) override;
+    dsp_stream_p Process(dsp_stream_p input) override;
 };
 
 class InverseFourierTransform : public Interface
 {
 public:
     InverseFourierTransform(INDI::DefaultDevice *dev);
+    Input getInput() override { return DSP_INPUT_IDFT; }
 
 protected:
     ~InverseFourierTransform();
     uint8_t *Callback(uint8_t *out, uint32_t dims, int *sizes, int bits_per_sample) override;
+    dsp_stream_p Process(dsp_stream_p input) override;
 };
 
 class Spectrum : public Interface
 {
 public:
     Spectrum(INDI::DefaultDevice *dev);
+    Input getInput() override { return DSP_INPUT_IDFT; }
 
 protected:
     ~Spectrum();
     uint8_t *Callback(uint8_t *out, uint32_t dims, int *sizes, int bits_per_sample) override;
+    dsp_stream_p Process(dsp_stream_p input) override;
 };
 
 class Histogram : public Interface
@@ -65,5 +70,6 @@ public:
 protected:
     ~Histogram();
     uint8_t *Callback(uint8_t *out, uint32_t dims, int *sizes, int bits_per_sample) override;
+    dsp_stream_p Process(dsp_stream_p input) override;
 };
 }
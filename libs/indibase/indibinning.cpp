@@ -0,0 +1,272 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Software Binning
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "indibinning.h"
+#include "indiutility.h"
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Build an AVX2 and a generic version of each kernel and pick one at load time.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define BINNING_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define BINNING_KERNEL
+#endif
+
+#if defined(__GNUC__)
+#define BINNING_INLINE inline __attribute__((always_inline))
+#else
+#define BINNING_INLINE inline
+#endif
+
+namespace INDI
+{
+
+// Number of output rows handed to a thread at a time.
+static constexpr uint32_t ROWS_PER_JOB = 16;
+// Frames with fewer output pixels are binned on the calling thread.
+static constexpr uint64_t MIN_PARALLEL_PIXELS = 256 * 1024;
+
+struct BinningParams
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t outWidth;
+    uint32_t binX;
+    uint32_t binY;
+    // 1 for mono frames, 2 for Bayer frames where only every other pixel belongs to the same channel.
+    uint32_t step;
+    uint32_t sumDivisor;
+    Binning::Mode mode;
+};
+
+template <typename T, typename A>
+static BINNING_INLINE T saturate(A value)
+{
+    if (std::is_floating_point<T>::value)
+        return static_cast<T>(value);
+
+    return static_cast<T>(std::min<A>(value, static_cast<A>(std::numeric_limits<T>::max())));
+}
+
+template <typename A>
+static BINNING_INLINE A average(A sum, uint32_t count)
+{
+    if (std::is_floating_point<A>::value)
+        return sum / count;
+
+    return (sum + count / 2) / count;
+}
+
+// First input row or column of output row or column n.
+static BINNING_INLINE uint32_t firstInput(uint32_t n, uint32_t bin, uint32_t step)
+{
+    return (n / step) * step * bin + (n % step);
+}
+
+// Number of input rows or columns, starting at first, that are combined into one output pixel.
+static BINNING_INLINE uint32_t inputCount(uint32_t first, uint32_t bin, uint32_t step, uint32_t size)
+{
+    return first >= size ? 0 : std::min(bin, (size - first + step - 1) / step);
+}
+
+/**
+ * Bin output rows [begin, end). A is the accumulator type, it must hold the sum of binX * binY pixels.
+ */
+template <typename T, typename A>
+static BINNING_INLINE void binRows(const BinningParams &p, const T *in, T *out, uint32_t begin, uint32_t end)
+{
+    if (p.mode == Binning::BIN_MEDIAN)
+    {
+        std::vector<T> values(p.binX * p.binY);
+        for (uint32_t r = begin; r < end; r++)
+        {
+            uint32_t firstRow = firstInput(r, p.binY, p.step);
+            uint32_t rows     = inputCount(firstRow, p.binY, p.step, p.height);
+            T *dst            = out + static_cast<size_t>(r) * p.outWidth;
+
+            for (uint32_t c = 0; c < p.outWidth; c++)
+            {
+                uint32_t firstColumn = firstInput(c, p.binX, p.step);
+                uint32_t columns     = inputCount(firstColumn, p.binX, p.step, p.width);
+                size_t n = 0;
+
+                for (uint32_t t = 0; t < rows; t++)
+                {
+                    const T *src = in + static_cast<size_t>(firstRow + t * p.step) * p.width + firstColumn;
+                    for (uint32_t s = 0; s < columns; s++)
+                        values[n++] = src[s * p.step];
+                }
+
+                if (n == 0)
+                {
+                    dst[c] = 0;
+                    continue;
+                }
+
+                auto middle = values.begin() + n / 2;
+                std::nth_element(values.begin(), middle, values.begin() + n);
+                dst[c] = *middle;
+            }
+        }
+        return;
+    }
+
+    std::vector<A> accumulator(p.width);
+    A *acc = accumulator.data();
+
+    for (uint32_t r = begin; r < end; r++)
+    {
+        uint32_t firstRow = firstInput(r, p.binY, p.step);
+        uint32_t rows     = inputCount(firstRow, p.binY, p.step, p.height);
+        T *dst            = out + static_cast<size_t>(r) * p.outWidth;
+
+        if (rows == 0)
+        {
+            std::fill(dst, dst + p.outWidth, 0);
+            continue;
+        }
+
+        // Vertical pass: add the input rows of this output row.
+        const T *src = in + static_cast<size_t>(firstRow) * p.width;
+        for (uint32_t x = 0; x < p.width; x++)
+            acc[x] = src[x];
+
+        for (uint32_t t = 1; t < rows; t++)
+        {
+            src = in + static_cast<size_t>(firstRow + t * p.step) * p.width;
+            for (uint32_t x = 0; x < p.width; x++)
+                acc[x] += src[x];
+        }
+
+        // Horizontal pass: reduce groups of binX accumulated columns.
+        if (p.step == 1 && p.binX == 2)
+        {
+            for (uint32_t c = 0; c < p.outWidth; c++)
+            {
+                A sum  = acc[2 * c] + acc[2 * c + 1];
+                dst[c] = saturate<T, A>(p.mode == Binning::BIN_AVERAGE ? average<A>(sum, 2 * rows) : sum / p.sumDivisor);
+            }
+            continue;
+        }
+
+        for (uint32_t c = 0; c < p.outWidth; c++)
+        {
+            uint32_t firstColumn = firstInput(c, p.binX, p.step);
+            uint32_t columns     = inputCount(firstColumn, p.binX, p.step, p.width);
+            const A *column      = acc + firstColumn;
+
+            A sum = 0;
+            for (uint32_t s = 0; s < columns; s++)
+                sum += column[s * p.step];
+
+            if (columns == 0)
+                dst[c] = 0;
+            else if (p.mode == Binning::BIN_AVERAGE)
+                dst[c] = saturate<T, A>(average<A>(sum, rows * columns));
+            else
+                dst[c] = saturate<T, A>(sum / p.sumDivisor);
+        }
+    }
+}
+
+BINNING_KERNEL static void binRows8(const BinningParams &p, const uint8_t *in, uint8_t *out, uint32_t begin, uint32_t end)
+{
+    binRows<uint8_t, uint32_t>(p, in, out, begin, end);
+}
+
+BINNING_KERNEL static void binRows16(const BinningParams &p, const uint16_t *in, uint16_t *out, uint32_t begin,
+                                     uint32_t end)
+{
+    binRows<uint16_t, uint32_t>(p, in, out, begin, end);
+}
+
+BINNING_KERNEL static void binRows32(const BinningParams &p, const uint32_t *in, uint32_t *out, uint32_t begin,
+                                     uint32_t end)
+{
+    binRows<uint32_t, uint64_t>(p, in, out, begin, end);
+}
+
+BINNING_KERNEL static void binRowsFloat(const BinningParams &p, const float *in, float *out, uint32_t begin, uint32_t end)
+{
+    binRows<float, float>(p, in, out, begin, end);
+}
+
+template <typename T>
+static void binFrame(const BinningParams &p, uint32_t outHeight, const void *in, void *out, int threads,
+                     void (*kernel)(const BinningParams &, const T *, T *, uint32_t, uint32_t))
+{
+    const T *input = static_cast<const T *>(in);
+    T *output      = static_cast<T *>(out);
+
+    uint32_t jobs = (outHeight + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+    if (static_cast<uint64_t>(p.outWidth) * outHeight < MIN_PARALLEL_PIXELS)
+        threads = 1;
+
+    parallel_for(jobs, std::max(0, threads), [&](size_t job)
+    {
+        uint32_t begin = job * ROWS_PER_JOB;
+        kernel(p, input, output, begin, std::min(outHeight, begin + ROWS_PER_JOB));
+    });
+}
+
+bool Binning::bin(const void *in, void *out, uint32_t width, uint32_t height, int bpp, uint32_t binX, uint32_t binY,
+                  Mode mode, bool bayer, uint32_t sumDivisor, int threads)
+{
+    // Keep binX * binY * max pixel value within 32 bit accumulators.
+    if (in == nullptr || out == nullptr || binX == 0 || binY == 0 || binX > 255 || binY > 255 || sumDivisor == 0)
+        return false;
+
+    BinningParams p;
+    p.width      = width;
+    p.height     = height;
+    p.outWidth   = width / binX;
+    p.binX       = binX;
+    p.binY       = binY;
+    p.step       = bayer ? 2 : 1;
+    p.sumDivisor = sumDivisor;
+    p.mode       = mode;
+
+    uint32_t outHeight = height / binY;
+
+    switch (bpp)
+    {
+        case 8:
+            binFrame<uint8_t>(p, outHeight, in, out, threads, binRows8);
+            return true;
+        case 16:
+            binFrame<uint16_t>(p, outHeight, in, out, threads, binRows16);
+            return true;
+        case 32:
+            binFrame<uint32_t>(p, outHeight, in, out, threads, binRows32);
+            return true;
+        case -32:
+            binFrame<float>(p, outHeight, in, out, threads, binRowsFloat);
+            return true;
+    }
+
+    return false;
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Software Binning
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace INDI
+{
+
+/**
+ * @brief The Binning class implements software binning of image frames.
+ *
+ * Each output row is computed by adding the binY input rows into a row accumulator, which vectorizes well, and then
+ * reducing groups of binX accumulated pixels. Output rows are split across threads for large frames. Every output
+ * pixel is written exactly once, so the output buffer does not need to be cleared.
+ *
+ * Bayer frames are binned per color channel: pixels of the same color within a 2*binX by 2*binY block are combined
+ * and the output keeps the original 2x2 Bayer layout.
+ */
+class Binning
+{
+    public:
+        typedef enum
+        {
+            BIN_SUM,        /*!< Sum of the binned pixels, saturated at the maximum pixel value. */
+            BIN_AVERAGE,    /*!< Rounded average of the binned pixels. */
+            BIN_MEDIAN      /*!< Median of the binned pixels, rejects hot pixels and cosmic rays. */
+        } Mode;
+
+        /**
+         * @brief bin Bin a frame.
+         * @param in input frame, width x height pixels.
+         * @param out output frame of (width / binX) x (height / binY) pixels. Must not overlap the input frame.
+         * @param width input frame width in pixels.
+         * @param height input frame height in pixels.
+         * @param bpp bits per pixel. 8, 16, and 32 for unsigned integer frames, -32 for float frames.
+         * @param binX horizontal binning.
+         * @param binY vertical binning.
+         * @param mode sum, average or median.
+         * @param bayer bin each channel of a 2x2 Bayer matrix separately.
+         * @param sumDivisor divide sums by this value before saturating. Only used in BIN_SUM mode.
+         * @param threads number of threads to use. 0 selects the number of available cores.
+         * @return True on success, false if the parameters are not supported.
+         */
+        static bool bin(const void *in, void *out, uint32_t width, uint32_t height, int bpp, uint32_t binX, uint32_t binY,
+                        Mode mode, bool bayer = false, uint32_t sumDivisor = 1, int threads = 0);
+};
+
+}
@@ -29,8 +29,8 @@
 
 #include "indiccd.h"
 
-#include "fpack/fpack.h"
 #include "indicom.h"
+#include "indicompression.h"
 #include "locale_compat.h"
 #include "indiutility.h"
 
@@ -44,12 +44,8 @@
 #include <libastro.h>
 
 #include <cmath>
-#include <regex>
-
-#include <dirent.h>
 #include <cerrno>
 #include <cstdlib>
-#include <zlib.h>
 #include <sys/stat.h>
 
 const char * IMAGE_SETTINGS_TAB = "Image Settings";
@@ -64,6 +60,60 @@ uint16_t INDIWSServer::m_global_port = 11623;
 namespace INDI
 {
 
+// Number of idle frames kept for reuse by the upload pipeline. Two frames allow encoding one frame while
+// the previous one is uploaded without allocating buffers in steady state.
+static constexpr size_t UPLOAD_FRAME_POOL_SIZE = 2;
+// Frames copied but not uploaded yet. ExposureComplete() waits for the encoder beyond this limit, which bounds the
+// memory held by frame copies when encoding or uploading is slower than the exposures.
+static constexpr size_t UPLOAD_FRAME_LIMIT = 4;
+// Space reserved for the FITS header when preallocating the FITS memory file.
+static constexpr size_t FITS_HEADER_RESERVE = 2880 * 4;
+
+/**
+ * @brief The UploadFrame struct holds one completed exposure while it moves through the upload pipeline.
+ */
+struct CCD::UploadFrame
+{
+    ~UploadFrame()
+    {
+        free(fitsBuffer);
+    }
+
+    CCDChip *targetChip {nullptr};
+
+    // Exposure information for the FITS header
+    double exposureDuration {0};
+    char exposureStartTime[MAXINDINAME] {};
+    // Format and extension of the saved and sent file, without the compression suffix
+    bool encodeFits {true};
+    char extension[MAXINDIBLOBFMT] {};
+
+    // Chip settings of the exposure, the driver may change them for the next one while this frame is encoded
+    int xRes {0}, yRes {0};
+    int subW {0}, subH {0};
+    int binX {1}, binY {1};
+    int bpp {8};
+    int naxis {2};
+    CCDChip::CCD_FRAME frameType {CCDChip::LIGHT_FRAME};
+
+    // Copy of the chip frame buffer
+    std::vector<uint8_t> frame;
+
+    // FITS memory file, reused for subsequent frames
+    void *fitsBuffer {nullptr};
+    size_t fitsBufferSize {0};
+
+    // Statistics of 2D frames
+    ImageStatistics statistics;
+    bool hasStatistics {false};
+
+    // Encoded data to save and/or send
+    const void *data {nullptr};
+    size_t dataSize {0};
+    bool sendImage {false};
+    bool saveImage {false};
+};
+
 CCD::CCD()
 {
     //ctor
@@ -121,6 +171,11 @@ CCD::~CCD()
     // Only update if index is different.
     if (m_ConfigFastExposureIndex != IUFindOnSwitchIndex(&FastExposureToggleSP))
         saveConfig(true, FastExposureToggleSP.name);
+
+    // The derived driver is already destroyed, its virtual functions must not be called for the queued frames
+    stopUploadPipeline(true);
+
+    free(m_LiveStackFile);
 }
 
 void CCD::SetCCDCapability(uint32_t cap)
@@ -363,6 +418,58 @@ bool CCD::initProperties()
     EncodeFormatSP.fill(getDeviceName(), "CCD_TRANSFER_FORMAT", "Encode", IMAGE_SETTINGS_TAB, IP_RW, ISR_1OFMANY, 60,
                         IPS_IDLE);
 
+    /**********************************************/
+    /************** Image Statistics **************/
+    /**********************************************/
+    ImageStatisticsNP[STATISTICS_MIN].fill("STATISTICS_MIN", "Min", "%.f", 0, 0, 0, 0);
+    ImageStatisticsNP[STATISTICS_MAX].fill("STATISTICS_MAX", "Max", "%.f", 0, 0, 0, 0);
+    ImageStatisticsNP[STATISTICS_MEAN].fill("STATISTICS_MEAN", "Mean", "%.2f", 0, 0, 0, 0);
+    ImageStatisticsNP[STATISTICS_STDDEV].fill("STATISTICS_STDDEV", "StdDev", "%.2f", 0, 0, 0, 0);
+    ImageStatisticsNP[STATISTICS_MEDIAN].fill("STATISTICS_MEDIAN", "Median", "%.f", 0, 0, 0, 0);
+    ImageStatisticsNP.fill(getDeviceName(), "CCD_IMAGE_STATISTICS", "Statistics", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
+    /**********************************************/
+    /**************** Live Stacking ***************/
+    /**********************************************/
+    LiveStackSP[INDI_ENABLED].fill("INDI_ENABLED", "Enabled", ISS_OFF);
+    LiveStackSP[INDI_DISABLED].fill("INDI_DISABLED", "Disabled", ISS_ON);
+    LiveStackSP.fill(getDeviceName(), "CCD_LIVE_STACK", "Live Stack", IMAGE_SETTINGS_TAB, IP_RW, ISR_1OFMANY, 60,
+                     IPS_IDLE);
+
+    LiveStackSettingsNP[LIVE_STACK_SIGMA].fill("LIVE_STACK_SIGMA", "Clip sigma", "%.1f", 1, 10, 0.5, 3);
+    LiveStackSettingsNP[LIVE_STACK_THRESHOLD].fill("LIVE_STACK_THRESHOLD", "Star threshold", "%.1f", 1, 50, 1, 5);
+    LiveStackSettingsNP[LIVE_STACK_INTERVAL].fill("LIVE_STACK_INTERVAL", "Send every", "%.f", 1, 100, 1, 1);
+    LiveStackSettingsNP.fill(getDeviceName(), "CCD_LIVE_STACK_SETTINGS", "Stacking", IMAGE_SETTINGS_TAB, IP_RW, 60,
+                             IPS_IDLE);
+
+    LiveStackSubsSP[INDI_ENABLED].fill("INDI_ENABLED", "Enabled", ISS_ON);
+    LiveStackSubsSP[INDI_DISABLED].fill("INDI_DISABLED", "Disabled", ISS_OFF);
+    LiveStackSubsSP.fill(getDeviceName(), "CCD_LIVE_STACK_SUBS", "Send subs", IMAGE_SETTINGS_TAB, IP_RW, ISR_1OFMANY, 60,
+                         IPS_IDLE);
+
+    LiveStackInfoNP[LIVE_STACK_STACKED].fill("LIVE_STACK_STACKED", "Stacked", "%.f", 0, 0, 0, 0);
+    LiveStackInfoNP[LIVE_STACK_REJECTED].fill("LIVE_STACK_REJECTED", "Rejected", "%.f", 0, 0, 0, 0);
+    LiveStackInfoNP.fill(getDeviceName(), "CCD_LIVE_STACK_INFO", "Live Stack", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
+    LiveStackBP[0].fill("CCD_LIVE_STACK", "Stacked Image", "");
+    LiveStackBP.fill(getDeviceName(), "CCD_LIVE_STACK_IMAGE", "Stacked Image", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
+    /**********************************************/
+    /************ Compression Settings ************/
+    /**********************************************/
+    CompressionCodecSP[COMPRESSION_ZLIB].fill("COMPRESSION_ZLIB", "zlib", ISS_OFF);
+    CompressionCodecSP[COMPRESSION_ZSTD].fill("COMPRESSION_ZSTD", "zstd", ISS_OFF);
+    CompressionCodecSP[COMPRESSION_LZ4].fill("COMPRESSION_LZ4", "lz4", ISS_OFF);
+    CompressionCodecSP[COMPRESSION_RICE].fill("COMPRESSION_RICE", "Rice", ISS_ON);
+    CompressionCodecSP.fill(getDeviceName(), "CCD_COMPRESSION_CODEC", "Codec", IMAGE_SETTINGS_TAB, IP_RW, ISR_1OFMANY, 60,
+                            IPS_IDLE);
+
+    CompressionSettingsNP[COMPRESSION_LEVEL].fill("COMPRESSION_LEVEL", "Level", "%.f", 0, 22, 1, 6);
+    CompressionSettingsNP[COMPRESSION_THREADS].fill("COMPRESSION_THREADS", "Threads (0 auto)", "%.f", 0, 64, 1, 0);
+    CompressionSettingsNP[COMPRESSION_QUANTIZE].fill("COMPRESSION_QUANTIZE", "Quantize", "%.f", 1, 256, 1, 4);
+    CompressionSettingsNP.fill(getDeviceName(), "CCD_COMPRESSION_SETTINGS", "Compress", IMAGE_SETTINGS_TAB, IP_RW, 60,
+                               IPS_IDLE);
+
     /**********************************************/
     /************** Upload Settings ***************/
     /**********************************************/
@@ -380,6 +487,11 @@ bool CCD::initProperties()
     IUFillTextVector(&UploadSettingsTP, UploadSettingsT, 2, getDeviceName(), "UPLOAD_SETTINGS", "Upload Settings",
                      OPTIONS_TAB, IP_RW, 60, IPS_IDLE);
 
+    // Flush locally saved images to disk before reporting the exposure complete
+    UploadSyncSP[INDI_ENABLED].fill("INDI_ENABLED", "Enabled", ISS_OFF);
+    UploadSyncSP[INDI_DISABLED].fill("INDI_DISABLED", "Disabled", ISS_ON);
+    UploadSyncSP.fill(getDeviceName(), "UPLOAD_SYNC", "Sync to disk", OPTIONS_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
     // Upload File Path
     IUFillText(&FileNameT[0], "FILE_PATH", "Path", "");
     IUFillTextVector(&FileNameTP, FileNameT, 1, getDeviceName(), "CCD_FILE_PATH", "Filename", IMAGE_INFO_TAB, IP_RO, 60,
@@ -541,6 +653,12 @@ bool CCD::updateProperties()
         defineProperty(&EncodeFormatSP);
 
         defineProperty(&PrimaryCCD.ImagePixelSizeNP);
+        defineProperty(&ImageStatisticsNP);
+        defineProperty(&LiveStackSP);
+        defineProperty(&LiveStackSettingsNP);
+        defineProperty(&LiveStackSubsSP);
+        defineProperty(&LiveStackInfoNP);
+        defineProperty(&LiveStackBP);
         if (HasGuideHead())
         {
             defineProperty(&GuideCCD.ImagePixelSizeNP);
@@ -548,6 +666,8 @@ bool CCD::updateProperties()
                 defineProperty(&GuideCCD.ImageBinNP);
         }
         defineProperty(&PrimaryCCD.CompressSP);
+        defineProperty(&CompressionCodecSP);
+        defineProperty(&CompressionSettingsNP);
         defineProperty(&PrimaryCCD.FitsBP);
         if (HasGuideHead())
         {
@@ -592,6 +712,7 @@ bool CCD::updateProperties()
         if (UploadSettingsT[UPLOAD_DIR].text == nullptr)
             IUSaveText(&UploadSettingsT[UPLOAD_DIR], getenv("HOME"));
         defineProperty(&UploadSettingsTP);
+        defineProperty(&UploadSyncSP);
 
 #ifdef HAVE_WEBSOCKET
         if (HasWebSocket())
@@ -603,11 +724,20 @@ bool CCD::updateProperties()
     }
     else
     {
+        // Encode and upload the frames of the session while the driver is still complete
+        stopUploadPipeline(false);
+
         deleteProperty(PrimaryCCD.ImageFrameNP.name);
         if (CanBin() || CanSubFrame())
             deleteProperty(PrimaryCCD.ResetSP.name);
 
         deleteProperty(PrimaryCCD.ImagePixelSizeNP.name);
+        deleteProperty(ImageStatisticsNP.getName());
+        deleteProperty(LiveStackSP.getName());
+        deleteProperty(LiveStackSettingsNP.getName());
+        deleteProperty(LiveStackSubsSP.getName());
+        deleteProperty(LiveStackInfoNP.getName());
+        deleteProperty(LiveStackBP.getName());
 
         deleteProperty(CaptureFormatSP.getName());
         deleteProperty(EncodeFormatSP.getName());
@@ -620,6 +750,8 @@ bool CCD::updateProperties()
             deleteProperty(PrimaryCCD.AbortExposureSP.name);
         deleteProperty(PrimaryCCD.FitsBP.name);
         deleteProperty(PrimaryCCD.CompressSP.name);
+        deleteProperty(CompressionCodecSP.getName());
+        deleteProperty(CompressionSettingsNP.getName());
 
 #if 0
         deleteProperty(PrimaryCCD.RapidGuideSP.name);
@@ -677,6 +809,7 @@ bool CCD::updateProperties()
         deleteProperty(WorldCoordSP.name);
         deleteProperty(UploadSP.name);
         deleteProperty(UploadSettingsTP.name);
+        deleteProperty(UploadSyncSP.getName());
 
 #ifdef HAVE_WEBSOCKET
         if (HasWebSocket())
@@ -1303,6 +1436,28 @@ bool CCD::ISNewNumber(const char * dev, const char * name, double values[], char
             return true;
         }
 
+        // Compression Settings
+        if (CompressionSettingsNP.isNameMatch(name))
+        {
+            CompressionSettingsNP.update(values, names, n);
+            CompressionSettingsNP.setState(IPS_OK);
+            CompressionSettingsNP.apply();
+            saveConfig(true, CompressionSettingsNP.getName());
+            return true;
+        }
+
+        // Live Stacking
+        if (LiveStackSettingsNP.isNameMatch(name))
+        {
+            LiveStackSettingsNP.update(values, names, n);
+            m_LiveStack.setClipSigma(LiveStackSettingsNP[LIVE_STACK_SIGMA].getValue());
+            m_LiveStack.setThreshold(LiveStackSettingsNP[LIVE_STACK_THRESHOLD].getValue());
+            LiveStackSettingsNP.setState(IPS_OK);
+            LiveStackSettingsNP.apply();
+            saveConfig(true, LiveStackSettingsNP.getName());
+            return true;
+        }
+
         // CCD Rotation
         if (!strcmp(name, CCDRotationNP.name))
         {
@@ -1634,6 +1789,68 @@ bool CCD::ISNewSwitch(const char * dev, const char * name, ISState * states, cha
             return true;
         }
 
+        // Compression Codec
+        if (CompressionCodecSP.isNameMatch(name))
+        {
+            int previousIndex = CompressionCodecSP.findOnSwitchIndex();
+            CompressionCodecSP.update(states, names, n);
+
+            auto codec = static_cast<Compression::Codec>(CompressionCodecSP.findOnSwitchIndex());
+            if (Compression::isAvailable(codec) == false)
+            {
+                LOGF_ERROR("%s compression is not supported by this build.", CompressionCodecSP.findOnSwitch()->getLabel());
+                CompressionCodecSP.reset();
+                CompressionCodecSP[previousIndex].setState(ISS_ON);
+                CompressionCodecSP.setState(IPS_ALERT);
+                CompressionCodecSP.apply();
+                return false;
+            }
+
+            CompressionCodecSP.setState(IPS_OK);
+            CompressionCodecSP.apply();
+            if (previousIndex != CompressionCodecSP.findOnSwitchIndex())
+                saveConfig(true, CompressionCodecSP.getName());
+            return true;
+        }
+
+        // Upload Sync
+        if (UploadSyncSP.isNameMatch(name))
+        {
+            UploadSyncSP.update(states, names, n);
+            UploadSyncSP.setState(IPS_OK);
+            UploadSyncSP.apply();
+            saveConfig(true, UploadSyncSP.getName());
+            return true;
+        }
+
+        // Live Stacking
+        if (LiveStackSP.isNameMatch(name))
+        {
+            LiveStackSP.update(states, names, n);
+            // Every time stacking is enabled, a new stack is started
+            if (LiveStackSP[INDI_ENABLED].getState() == ISS_ON)
+            {
+                m_LiveStack.reset();
+                LiveStackInfoNP[LIVE_STACK_STACKED].setValue(0);
+                LiveStackInfoNP[LIVE_STACK_REJECTED].setValue(0);
+                LiveStackInfoNP.setState(IPS_IDLE);
+                LiveStackInfoNP.apply();
+                LOG_INFO("Live stacking enabled, the next frame is the reference.");
+            }
+            LiveStackSP.setState(IPS_OK);
+            LiveStackSP.apply();
+            return true;
+        }
+
+        if (LiveStackSubsSP.isNameMatch(name))
+        {
+            LiveStackSubsSP.update(states, names, n);
+            LiveStackSubsSP.setState(IPS_OK);
+            LiveStackSubsSP.apply();
+            saveConfig(true, LiveStackSubsSP.getName());
+            return true;
+        }
+
         // Encode Format
         if (EncodeFormatSP.isNameMatch(name))
         {
@@ -1870,19 +2087,25 @@ void CCD::addFITSKeywords(fitsfile * fptr, CCDChip * targetChip)
     // Object
     fits_update_key_str(fptr, "OBJECT", FITSHeaderT[FITS_OBJECT].text, "Object name", &status);
 
+    // The frame being encoded has its own copy of the chip settings
+    const UploadFrame * encoding = m_EncodingFrame != nullptr && m_EncodingFrame->targetChip == targetChip ?
+                                   m_EncodingFrame : nullptr;
     double subPixSize1 = static_cast<double>(targetChip->getPixelSizeX());
     double subPixSize2 = static_cast<double>(targetChip->getPixelSizeY());
-    uint32_t subW = targetChip->getSubW();
-    uint32_t subH = targetChip->getSubH();
-    uint32_t subBinX = targetChip->getBinX();
-    uint32_t subBinY = targetChip->getBinY();
+    uint32_t subW = encoding ? encoding->subW : targetChip->getSubW();
+    uint32_t subH = encoding ? encoding->subH : targetChip->getSubH();
+    uint32_t subBinX = encoding ? encoding->binX : targetChip->getBinX();
+    uint32_t subBinY = encoding ? encoding->binY : targetChip->getBinY();
+    int naxis = encoding ? encoding->naxis : targetChip->getNAxis();
+    CCDChip::CCD_FRAME frameType = encoding ? encoding->frameType : targetChip->getFrameType();
 
     strncpy(dev_name, getDeviceName(), MAXINDINAME);
 
-    fits_update_key_dbl(fptr, "EXPTIME", exposureDuration, 6, "Total Exposure Time (s)", &status);
+    double duration = encoding ? encoding->exposureDuration : exposureDuration;
+    fits_update_key_dbl(fptr, "EXPTIME", duration, 6, "Total Exposure Time (s)", &status);
 
-    if (targetChip->getFrameType() == CCDChip::DARK_FRAME)
-        fits_update_key_dbl(fptr, "DARKTIME", exposureDuration, 6, "Total Dark Exposure Time (s)", &status);
+    if (frameType == CCDChip::DARK_FRAME)
+        fits_update_key_dbl(fptr, "DARKTIME", duration, 6, "Total Dark Exposure Time (s)", &status);
 
     // If the camera has a cooler OR if the temperature permission was explicitly set to Read-Only, then record the temperature
     if (HasCooler() || TemperatureNP.p == IP_RO)
@@ -1890,15 +2113,15 @@ void CCD::addFITSKeywords(fitsfile * fptr, CCDChip * targetChip)
 
     fits_update_key_dbl(fptr, "PIXSIZE1", subPixSize1, 6, "Pixel Size 1 (microns)", &status);
     fits_update_key_dbl(fptr, "PIXSIZE2", subPixSize2, 6, "Pixel Size 2 (microns)", &status);
-    fits_update_key_lng(fptr, "XBINNING", targetChip->getBinX(), "Binning factor in width", &status);
-    fits_update_key_lng(fptr, "YBINNING", targetChip->getBinY(), "Binning factor in height", &status);
+    fits_update_key_lng(fptr, "XBINNING", subBinX, "Binning factor in width", &status);
+    fits_update_key_lng(fptr, "YBINNING", subBinY, "Binning factor in height", &status);
     // XPIXSZ and YPIXSZ are logical sizes including the binning factor
     double xpixsz = subPixSize1 * subBinX;
     double ypixsz = subPixSize2 * subBinY;
     fits_update_key_dbl(fptr, "XPIXSZ", xpixsz, 6, "X binned pixel size in microns", &status);
     fits_update_key_dbl(fptr, "YPIXSZ", ypixsz, 6, "Y binned pixel size in microns", &status);
 
-    switch (targetChip->getFrameType())
+    switch (frameType)
     {
         case CCDChip::LIGHT_FRAME:
             fits_update_key_str(fptr, "FRAME", "Light", "Frame Type", &status);
@@ -1924,17 +2147,19 @@ void CCD::addFITSKeywords(fitsfile * fptr, CCDChip * targetChip)
     }
 
 #ifdef WITH_MINMAX
-    if (targetChip->getNAxis() == 2)
+    if (naxis == 2)
     {
-        double min_val, max_val;
-        getMinMax(&min_val, &max_val, targetChip);
+        ImageStatistics statistics = getImageStatistics(targetChip);
 
-        fits_update_key_dbl(fptr, "DATAMIN", min_val, 6, "Minimum value", &status);
-        fits_update_key_dbl(fptr, "DATAMAX", max_val, 6, "Maximum value", &status);
+        fits_update_key_dbl(fptr, "DATAMIN", statistics.min, 6, "Minimum value", &status);
+        fits_update_key_dbl(fptr, "DATAMAX", statistics.max, 6, "Maximum value", &status);
+        fits_update_key_dbl(fptr, "DATAMEAN", statistics.mean, 6, "Mean value", &status);
+        fits_update_key_dbl(fptr, "DATASTD", statistics.stddev, 6, "Standard deviation", &status);
+        fits_update_key_dbl(fptr, "DATAMED", statistics.median, 6, "Median value (estimate)", &status);
     }
 #endif
 
-    if (HasBayer() && targetChip->getNAxis() == 2)
+    if (HasBayer() && naxis == 2)
     {
         fits_update_key_lng(fptr, "XBAYROFF", atoi(BayerT[0].text), "X offset of Bayer array", &status);
         fits_update_key_lng(fptr, "YBAYROFF", atoi(BayerT[1].text), "Y offset of Bayer array", &status);
@@ -1976,7 +2201,7 @@ void CCD::addFITSKeywords(fitsfile * fptr, CCDChip * targetChip)
     }
 
 
-    if ( targetChip->getFrameType() == CCDChip::LIGHT_FRAME && !std::isnan(RA) && !std::isnan(Dec) && (std::isnan(J2000RA)
+    if ( frameType == CCDChip::LIGHT_FRAME && !std::isnan(RA) && !std::isnan(Dec) && (std::isnan(J2000RA)
             || std::isnan(J2000DE) || !J2000Valid) )
     {
         INDI::IEquatorialCoordinates epochPos { 0, 0 }, J2000Pos { 0, 0 };
@@ -1991,7 +2216,7 @@ void CCD::addFITSKeywords(fitsfile * fptr, CCDChip * targetChip)
     }
     J2000Valid = false;  // enforce usage of EOD position if we receive no new epoch position
 
-    if ( targetChip->getFrameType() == CCDChip::LIGHT_FRAME && !std::isnan(J2000RA) && !std::isnan(J2000DE) )
+    if ( frameType == CCDChip::LIGHT_FRAME && !std::isnan(J2000RA) && !std::isnan(J2000DE) )
     {
         if (!std::isnan(Latitude) && !std::isnan(Longitude))
         {
@@ -2120,7 +2345,8 @@ void CCD::addFITSKeywords(fitsfile * fptr, CCDChip * targetChip)
         }
     }
 
-    fits_update_key_str(fptr, "DATE-OBS", exposureStartTime, "UTC start date of observation", &status);
+    fits_update_key_str(fptr, "DATE-OBS", encoding ? encoding->exposureStartTime : exposureStartTime,
+                        "UTC start date of observation", &status);
     fits_write_comment(fptr, "Generated by INDI", &status);
 }
 
@@ -2136,47 +2362,241 @@ bool CCD::ExposureComplete(CCDChip * targetChip)
     // Reset POLLMS to default value
     setCurrentPollingPeriod(getPollingPeriod());
 
+    std::unique_lock<std::mutex> lock(m_UploadLock);
+
     // Run async
-    std::thread(&CCD::ExposureCompletePrivate, this, targetChip).detach();
+    if (!m_EncoderThread.joinable())
+    {
+        m_EncoderThread = std::thread(&CCD::encoderThreadEntry, this);
+        m_UploadThread  = std::thread(&CCD::uploadThreadEntry, this);
+    }
+
+    // Wait for the pipeline to catch up rather than queue more copies. A driver that completes the next exposure
+    // from processFastExposure() calls this on the encoder thread, which must not wait for itself.
+    if (m_FramesInFlight >= UPLOAD_FRAME_LIMIT && std::this_thread::get_id() != m_EncoderThread.get_id())
+    {
+        m_UploadStalls++;
+        LOGF_DEBUG("Upload pipeline is full, waiting for %zu frames to be encoded and uploaded (%u times so far).",
+                   m_FramesInFlight, m_UploadStalls);
+        m_UploadCondition.wait(lock, [this] { return m_FramesInFlight < UPLOAD_FRAME_LIMIT || m_UploadQuit; });
+    }
+
+    std::unique_ptr<UploadFrame> frame;
+    if (m_FreeUploadFrames.empty())
+        frame.reset(new UploadFrame);
+    else
+    {
+        frame = std::move(m_FreeUploadFrames.front());
+        m_FreeUploadFrames.pop_front();
+    }
+    m_FramesInFlight++;
+    lock.unlock();
+
+    // save information used for the fits header
+    exposureDuration = targetChip->getExposureDuration();
+    strncpy(exposureStartTime, targetChip->getExposureStartTime(), MAXINDINAME - 1);
+
+    // If image extension was set to fits (default), change if bin if not already set to another format by the driver.
+    bool encodeFits = EncodeFormatSP[FORMAT_FITS].getState() == ISS_ON;
+    if (!encodeFits && !strcmp(targetChip->getImageExtension(), "fits"))
+        targetChip->setImageExtension("bin");
+
+    frame->targetChip       = targetChip;
+    frame->encodeFits       = encodeFits;
+    frame->exposureDuration = exposureDuration;
+    strncpy(frame->exposureStartTime, exposureStartTime, MAXINDINAME - 1);
+    strncpy(frame->extension, targetChip->getImageExtension(), MAXINDIBLOBFMT - 1);
+
+    // Copy the frame now, the driver may read out the next exposure into the chip buffer as soon as this returns.
+    // ccdBufferLock is not taken here, the driver calls this once it is done writing the buffer, with or without
+    // holding the lock.
+    frame->xRes      = targetChip->getXRes();
+    frame->yRes      = targetChip->getYRes();
+    frame->subW      = targetChip->getSubW();
+    frame->subH      = targetChip->getSubH();
+    frame->binX      = targetChip->getBinX();
+    frame->binY      = targetChip->getBinY();
+    frame->bpp       = targetChip->getBPP();
+    frame->naxis     = targetChip->getNAxis();
+    frame->frameType = targetChip->getFrameType();
+
+    const uint8_t * buffer = targetChip->getFrameBuffer();
+    if (buffer == nullptr)
+        frame->frame.clear();
+    else
+        frame->frame.assign(buffer, buffer + targetChip->getFrameBufferSize());
+
+    lock.lock();
+    m_EncodeQueue.push_back(std::move(frame));
+    lock.unlock();
+    m_UploadCondition.notify_all();
 
     return true;
 }
 
-bool CCD::ExposureCompletePrivate(CCDChip * targetChip)
+void CCD::recycleUploadFrame(std::unique_ptr<UploadFrame> frame)
 {
-    // save information used for the fits header
-    exposureDuration = targetChip->getExposureDuration();
-    strncpy(exposureStartTime, targetChip->getExposureStartTime(), MAXINDINAME);
+    {
+        std::lock_guard<std::mutex> lock(m_UploadLock);
+        m_FramesInFlight--;
+        if (m_FreeUploadFrames.size() < UPLOAD_FRAME_POOL_SIZE)
+            m_FreeUploadFrames.push_back(std::move(frame));
+    }
+    // Wakes ExposureComplete() when it waits for room in the pipeline
+    m_UploadCondition.notify_all();
+}
+
+void CCD::stopUploadPipeline(bool discard)
+{
+    // A driver may disconnect from processFastExposure(), the pipeline threads cannot join themselves
+    if (std::this_thread::get_id() == m_EncoderThread.get_id() || std::this_thread::get_id() == m_UploadThread.get_id())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_UploadLock);
+        m_UploadQuit = true;
+        if (discard && !m_EncodeQueue.empty())
+        {
+            LOGF_WARN("Discarding %zu frames that were not encoded yet.", m_EncodeQueue.size());
+            m_FramesInFlight -= m_EncodeQueue.size();
+            m_EncodeQueue.clear();
+        }
+    }
+    m_UploadCondition.notify_all();
 
-    if(HasDSP())
+    if (m_EncoderThread.joinable())
+        m_EncoderThread.join();
+    if (m_UploadThread.joinable())
+        m_UploadThread.join();
+
+    // The next ExposureComplete() starts the threads again
+    std::lock_guard<std::mutex> lock(m_UploadLock);
+    m_UploadQuit  = false;
+    m_EncoderDone = false;
+}
+
+void CCD::encoderThreadEntry()
+{
+    for (;;)
     {
-        uint8_t* buf = static_cast<uint8_t*>(malloc(targetChip->getFrameBufferSize()));
-        memcpy(buf, targetChip->getFrameBuffer(), targetChip->getFrameBufferSize());
-        DSP->processBLOB(buf, 2, new int[2] { targetChip->getXRes() / targetChip->getBinX(), targetChip->getYRes() / targetChip->getBinY() },
-                         targetChip->getBPP());
-        free(buf);
+        std::unique_ptr<UploadFrame> frame;
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(m_UploadLock);
+            m_UploadCondition.wait(lock, [this] { return m_UploadQuit || !m_EncodeQueue.empty(); });
+            // Frames queued before the pipeline is stopped are still encoded and uploaded, unless discarded
+            if (m_EncodeQueue.empty())
+            {
+                m_EncoderDone = true;
+                lock.unlock();
+                m_UploadCondition.notify_all();
+                return;
+            }
+
+            frame = std::move(m_EncodeQueue.front());
+            m_EncodeQueue.pop_front();
+            stopping = m_UploadQuit;
+        }
+
+        if (ExposureCompletePrivate(frame.get(), stopping) == false)
+        {
+            recycleUploadFrame(std::move(frame));
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_UploadLock);
+            m_UploadQueue.push_back(std::move(frame));
+        }
+        m_UploadCondition.notify_all();
     }
+}
 
-    if (processFastExposure(targetChip) == false)
+void CCD::uploadThreadEntry()
+{
+    for (;;)
+    {
+        std::unique_ptr<UploadFrame> frame;
+        {
+            std::unique_lock<std::mutex> lock(m_UploadLock);
+            m_UploadCondition.wait(lock, [this] { return m_EncoderDone || !m_UploadQueue.empty(); });
+            if (m_UploadQueue.empty())
+                return;
+
+            frame = std::move(m_UploadQueue.front());
+            m_UploadQueue.pop_front();
+        }
+
+        UploadCompletePrivate(frame.get());
+        recycleUploadFrame(std::move(frame));
+    }
+}
+
+bool CCD::ExposureCompletePrivate(UploadFrame * frame, bool stopping)
+{
+    CCDChip * targetChip = frame->targetChip;
+
+    if(HasDSP() && !frame->frame.empty())
+    {
+        // The plugins only read the frame, no further copy is needed
+        int sizes[2] = { frame->xRes / frame->binX, frame->yRes / frame->binY };
+        DSP->processBLOB(frame->frame.data(), 2, sizes, frame->bpp);
+    }
+
+    // No new exposure is started while the pipeline is stopped
+    if (stopping == false && processFastExposure(targetChip) == false)
         return false;
 
+    // Compute statistics once, they are used by the FITS header and the statistics property.
+    frame->hasStatistics = false;
+    if (frame->naxis == 2 && frame->bpp >= 8 && !frame->frame.empty())
+    {
+        size_t pixels = static_cast<size_t>(frame->subW / frame->binX) * (frame->subH / frame->binY);
+        pixels = std::min(pixels, frame->frame.size() / (frame->bpp / 8));
+
+        frame->statistics    = ImageStatistics::calculate(frame->frame.data(), pixels, frame->bpp);
+        frame->hasStatistics = true;
+
+        if (targetChip == &PrimaryCCD)
+        {
+            ImageStatisticsNP[STATISTICS_MIN].setValue(frame->statistics.min);
+            ImageStatisticsNP[STATISTICS_MAX].setValue(frame->statistics.max);
+            ImageStatisticsNP[STATISTICS_MEAN].setValue(frame->statistics.mean);
+            ImageStatisticsNP[STATISTICS_STDDEV].setValue(frame->statistics.stddev);
+            ImageStatisticsNP[STATISTICS_MEDIAN].setValue(frame->statistics.median);
+            ImageStatisticsNP.setState(IPS_OK);
+            ImageStatisticsNP.apply();
+        }
+    }
+
     bool sendImage = (UploadS[UPLOAD_CLIENT].s == ISS_ON || UploadS[UPLOAD_BOTH].s == ISS_ON);
     bool saveImage = (UploadS[UPLOAD_LOCAL].s == ISS_ON || UploadS[UPLOAD_BOTH].s == ISS_ON);
 
+    if (targetChip == &PrimaryCCD && LiveStackSP[INDI_ENABLED].getState() == ISS_ON && !frame->frame.empty())
+    {
+        processLiveStack(frame);
+        // The subs may still be saved locally
+        if (LiveStackSubsSP[INDI_DISABLED].getState() == ISS_ON)
+            sendImage = false;
+    }
+
     // Do not send or save an empty image.
-    if (targetChip->getFrameBufferSize() == 0)
+    if (frame->frame.empty())
         sendImage = saveImage = false;
 
+    frame->sendImage = sendImage;
+    frame->saveImage = saveImage;
+    frame->data      = nullptr;
+    frame->dataSize  = 0;
+
     if (sendImage || saveImage)
     {
-        if (EncodeFormatSP[FORMAT_FITS].getState() == ISS_ON)
+        if (frame->encodeFits)
         {
-            void * memptr;
-            size_t memsize;
             int img_type  = 0;
             int byte_type = 0;
             int status    = 0;
-            long naxis    = targetChip->getNAxis();
+            long naxis    = frame->naxis;
             long naxes[3];
             int nelements = 0;
             std::string bit_depth;
@@ -2184,10 +2604,10 @@ bool CCD::ExposureCompletePrivate(CCDChip * targetChip)
 
             fitsfile * fptr = nullptr;
 
-            naxes[0] = targetChip->getSubW() / targetChip->getBinX();
-            naxes[1] = targetChip->getSubH() / targetChip->getBinY();
+            naxes[0] = frame->subW / frame->binX;
+            naxes[1] = frame->subH / frame->binY;
 
-            switch (targetChip->getBPP())
+            switch (frame->bpp)
             {
                 case 8:
                     byte_type = TBYTE;
@@ -2208,7 +2628,7 @@ bool CCD::ExposureCompletePrivate(CCDChip * targetChip)
                     break;
 
                 default:
-                    LOGF_ERROR("Unsupported bits per pixel value %d", targetChip->getBPP());
+                    LOGF_ERROR("Unsupported bits per pixel value %d", frame->bpp);
                     return false;
             }
 
@@ -2222,25 +2642,29 @@ bool CCD::ExposureCompletePrivate(CCDChip * targetChip)
             /*DEBUGF(Logger::DBG_DEBUG, "Exposure complete. Image Depth: %s. Width: %d Height: %d nelements: %d", bit_depth.c_str(), naxes[0],
                     naxes[1], nelements);*/
 
-            std::unique_lock<std::mutex> guard(ccdBufferLock);
-
-            //  Now we have to send fits format data to the client
-            memsize = 5760;
-            memptr  = malloc(memsize);
-            if (!memptr)
+            //  Now we have to send fits format data to the client.
+            //  Allocate the whole file up front so cfitsio does not grow the memory file block by block.
+            size_t dataBytes = static_cast<size_t>(nelements) * (frame->bpp / 8);
+            size_t fileBytes = FITS_HEADER_RESERVE + (dataBytes + 2879) / 2880 * 2880;
+            if (frame->fitsBufferSize < fileBytes)
             {
-                LOGF_ERROR("Error: failed to allocate memory: %lu", memsize);
-                return false;
+                void * memptr = realloc(frame->fitsBuffer, fileBytes);
+                if (!memptr)
+                {
+                    LOGF_ERROR("Error: failed to allocate memory: %lu", fileBytes);
+                    return false;
+                }
+                frame->fitsBuffer     = memptr;
+                frame->fitsBufferSize = fileBytes;
             }
 
-            fits_create_memfile(&fptr, &memptr, &memsize, 2880, realloc, &status);
+            fits_create_memfile(&fptr, &frame->fitsBuffer, &frame->fitsBufferSize, 2880, realloc, &status);
 
             if (status)
             {
                 fits_report_error(stderr, status); /* print out any error messages */
                 fits_get_errstatus(status, error_status);
                 fits_close_file(fptr, &status);
-                free(memptr);
                 LOGF_ERROR("FITS Error: %s", error_status);
                 return false;
             }
@@ -2252,123 +2676,193 @@ bool CCD::ExposureCompletePrivate(CCDChip * targetChip)
                 fits_report_error(stderr, status); /* print out any error messages */
                 fits_get_errstatus(status, error_status);
                 fits_close_file(fptr, &status);
-                free(memptr);
                 LOGF_ERROR("FITS Error: %s", error_status);
                 return false;
             }
 
+            m_EncodingFrame = frame;
             addFITSKeywords(fptr, targetChip);
+            m_EncodingFrame = nullptr;
 
-            fits_write_img(fptr, byte_type, 1, nelements, targetChip->getFrameBuffer(), &status);
+            fits_write_img(fptr, byte_type, 1, nelements, frame->frame.data(), &status);
+
+            // The memory file is larger than the FITS file, the file ends with the padded data unit.
+            LONGLONG headStart = 0, dataStart = 0, dataEnd = 0;
+            fits_get_hduaddrll(fptr, &headStart, &dataStart, &dataEnd, &status);
 
             if (status)
             {
                 fits_report_error(stderr, status); /* print out any error messages */
                 fits_get_errstatus(status, error_status);
                 fits_close_file(fptr, &status);
-                free(memptr);
                 LOGF_ERROR("FITS Error: %s", error_status);
                 return false;
             }
 
             fits_close_file(fptr, &status);
 
-            bool rc = uploadFile(targetChip, memptr, memsize, sendImage, saveImage);
-
-            free(memptr);
+            frame->data     = frame->fitsBuffer;
+            frame->dataSize = std::min(static_cast<size_t>(dataEnd), frame->fitsBufferSize);
+        }
+        else
+        {
+            frame->data     = frame->frame.data();
+            frame->dataSize = frame->frame.size();
+        }
+    }
 
-            guard.unlock();
+    return true;
+}
 
-            if (rc == false)
-            {
-                targetChip->setExposureFailed();
-                return false;
-            }
+void CCD::processLiveStack(const UploadFrame * frame)
+{
+    // Color frames are not stacked. Bayer frames are not either, registration resamples them and would mix the
+    // colors of neighbouring pixels.
+    if (frame->naxis != 2)
+        return;
+    if (HasBayer())
+    {
+        if (LiveStackInfoNP.getState() != IPS_ALERT)
+        {
+            LOG_WARN("Live stacking: Bayer frames are not supported, frames are not stacked.");
+            LiveStackInfoNP.setState(IPS_ALERT);
+            LiveStackInfoNP.apply();
         }
-        else
+        return;
+    }
+
+    uint32_t width  = frame->subW / frame->binX;
+    uint32_t height = frame->subH / frame->binY;
+    if (frame->frame.size() < static_cast<size_t>(width) * height * (frame->bpp / 8))
+        return;
+
+    bool stacked = m_LiveStack.add(frame->frame.data(), width, height, frame->bpp);
+
+    LiveStackInfoNP[LIVE_STACK_STACKED].setValue(m_LiveStack.stacked());
+    LiveStackInfoNP[LIVE_STACK_REJECTED].setValue(m_LiveStack.rejected());
+    LiveStackInfoNP.setState(stacked ? IPS_OK : IPS_ALERT);
+    LiveStackInfoNP.apply();
+
+    if (!stacked)
+    {
+        LOG_WARN("Live stacking: frame rejected, not enough stars match the reference.");
+        return;
+    }
+
+    uint32_t interval = std::max(1, static_cast<int>(LiveStackSettingsNP[LIVE_STACK_INTERVAL].getValue()));
+    if (m_LiveStack.stacked() % interval == 0)
+        sendLiveStack();
+}
+
+bool CCD::sendLiveStack()
+{
+    int status = 0;
+    char error_status[MAXRBUF];
+    fitsfile * fptr = nullptr;
+
+    m_LiveStack.image(m_LiveStackImage);
+    long naxes[2] = { static_cast<long>(m_LiveStack.width()), static_cast<long>(m_LiveStack.height()) };
+    int stacked = m_LiveStack.stacked();
+
+    size_t dataBytes = m_LiveStackImage.size() * sizeof(float);
+    size_t fileBytes = FITS_HEADER_RESERVE + (dataBytes + 2879) / 2880 * 2880;
+    if (m_LiveStackFileSize < fileBytes)
+    {
+        void * memptr = realloc(m_LiveStackFile, fileBytes);
+        if (!memptr)
         {
-            // If image extension was set to fits (default), change if bin if not already set to another format by the driver.
-            if (!strcmp(targetChip->getImageExtension(), "fits"))
-                targetChip->setImageExtension("bin");
-            std::unique_lock<std::mutex> guard(ccdBufferLock);
-            bool rc = uploadFile(targetChip, targetChip->getFrameBuffer(), targetChip->getFrameBufferSize(), sendImage,
-                                 saveImage);
-            guard.unlock();
+            LOGF_ERROR("Error: failed to allocate memory: %lu", fileBytes);
+            return false;
+        }
+        m_LiveStackFile     = memptr;
+        m_LiveStackFileSize = fileBytes;
+    }
 
-            if (rc == false)
-            {
-                targetChip->setExposureFailed();
-                return false;
-            }
+    fits_create_memfile(&fptr, &m_LiveStackFile, &m_LiveStackFileSize, 2880, realloc, &status);
+    fits_create_img(fptr, FLOAT_IMG, 2, naxes, &status);
+    fits_update_key_str(fptr, "INSTRUME", getDeviceName(), "CCD Name", &status);
+    fits_update_key(fptr, TINT, "STACKCNT", &stacked, "Stacked frames", &status);
+    fits_write_img(fptr, TFLOAT, 1, m_LiveStackImage.size(), m_LiveStackImage.data(), &status);
+
+    LONGLONG headStart = 0, dataStart = 0, dataEnd = 0;
+    fits_get_hduaddrll(fptr, &headStart, &dataStart, &dataEnd, &status);
+
+    if (status)
+    {
+        fits_report_error(stderr, status); /* print out any error messages */
+        fits_get_errstatus(status, error_status);
+        fits_close_file(fptr, &status);
+        LOGF_ERROR("FITS Error: %s", error_status);
+        return false;
+    }
+
+    fits_close_file(fptr, &status);
+
+    size_t size = std::min(static_cast<size_t>(dataEnd), m_LiveStackFileSize);
+    LiveStackBP[0].setBlob(m_LiveStackFile);
+    LiveStackBP[0].setBlobLen(size);
+    LiveStackBP[0].setSize(size);
+    LiveStackBP[0].setFormat(".fits");
+    LiveStackBP.setState(IPS_OK);
+    LiveStackBP.apply();
+    return true;
+}
+
+void CCD::UploadCompletePrivate(UploadFrame * frame)
+{
+    CCDChip * targetChip = frame->targetChip;
+
+    if (frame->sendImage || frame->saveImage)
+    {
+        if (uploadFile(targetChip, frame->data, frame->dataSize, frame->sendImage, frame->saveImage,
+                       frame->extension) == false)
+        {
+            targetChip->setExposureFailed();
+            return;
         }
     }
 
     if (FastExposureToggleS[INDI_ENABLED].s != ISS_ON)
         targetChip->setExposureComplete();
-    return true;
 }
 
 bool CCD::uploadFile(CCDChip * targetChip, const void * fitsData, size_t totalBytes, bool sendImage,
-                     bool saveImage)
+                     bool saveImage, const char * extension)
 {
-    uint8_t * compressedData = nullptr;
-
     DEBUGF(Logger::DBG_DEBUG, "Uploading file. Ext: %s, Size: %d, sendImage? %s, saveImage? %s",
-           targetChip->getImageExtension(), totalBytes, sendImage ? "Yes" : "No", saveImage ? "Yes" : "No");
+           extension, totalBytes, sendImage ? "Yes" : "No", saveImage ? "Yes" : "No");
+
+    // The chip BLOB belongs to the event thread, send a copy that points to this frame
+    IBLOB fitsB = targetChip->FitsB;
+    IBLOBVectorProperty fitsBP = targetChip->FitsBP;
+    fitsBP.bp  = &fitsB;
+    fitsBP.nbp = 1;
 
     if (saveImage)
     {
-        targetChip->FitsB.blob    = const_cast<void *>(fitsData);
-        targetChip->FitsB.bloblen = totalBytes;
-        snprintf(targetChip->FitsB.format, MAXINDIBLOBFMT, ".%s", targetChip->getImageExtension());
+        fitsB.blob    = const_cast<void *>(fitsData);
+        fitsB.bloblen = totalBytes;
+        snprintf(fitsB.format, MAXINDIBLOBFMT, ".%s", extension);
 
-        FILE * fp = nullptr;
         char imageFileName[MAXRBUF];
 
-        std::string prefix = UploadSettingsT[UPLOAD_PREFIX].text;
-        int maxIndex       = getFileIndex(UploadSettingsT[UPLOAD_DIR].text, UploadSettingsT[UPLOAD_PREFIX].text,
-                                          targetChip->FitsB.format);
-
-        if (maxIndex < 0)
+        std::string fileName = m_FileIndex.nextFileName(UploadSettingsT[UPLOAD_DIR].text,
+                               UploadSettingsT[UPLOAD_PREFIX].text, fitsB.format);
+        if (fileName.empty())
         {
-            LOGF_ERROR("Error iterating directory %s. %s", UploadSettingsT[0].text,
-                       strerror(errno));
+            LOGF_ERROR("Error iterating directory %s. %s", UploadSettingsT[UPLOAD_DIR].text, strerror(errno));
             return false;
         }
 
-        if (maxIndex > 0)
-        {
-            char ts[32];
-            struct tm * tp;
-            time_t t;
-            time(&t);
-            tp = localtime(&t);
-            strftime(ts, sizeof(ts), "%Y-%m-%dT%H-%M-%S", tp);
-            std::string filets(ts);
-            prefix = std::regex_replace(prefix, std::regex("ISO8601"), filets);
-
-            char indexString[8];
-            snprintf(indexString, 8, "%03d", maxIndex);
-            std::string prefixIndex = indexString;
-            //prefix.replace(prefix.find("XXX"), std::string::npos, prefixIndex);
-            prefix = std::regex_replace(prefix, std::regex("XXX"), prefixIndex);
-        }
-
-        snprintf(imageFileName, MAXRBUF, "%s/%s%s", UploadSettingsT[0].text, prefix.c_str(), targetChip->FitsB.format);
+        snprintf(imageFileName, MAXRBUF, "%s", fileName.c_str());
 
-        fp = fopen(imageFileName, "w");
-        if (fp == nullptr)
+        if (INDI::write_file(imageFileName, fitsData, totalBytes, UploadSyncSP[INDI_ENABLED].getState() == ISS_ON) != 0)
         {
             LOGF_ERROR("Unable to save image file (%s). %s", imageFileName, strerror(errno));
+            m_FileIndex.invalidate();
             return false;
         }
 
-        int n = 0;
-        for (int nr = 0; nr < targetChip->FitsB.bloblen; nr += n)
-            n = fwrite((static_cast<char *>(targetChip->FitsB.blob) + nr), 1, targetChip->FitsB.bloblen - nr, fp);
-
-        fclose(fp);
-
         // Save image file path
         IUSaveText(&FileNameT[0], imageFileName);
 
@@ -2379,60 +2873,40 @@ bool CCD::uploadFile(CCDChip * targetChip, const void * fitsData, size_t totalBy
 
     if (targetChip->SendCompressed)
     {
-        if (EncodeFormatSP[FORMAT_FITS].getState() == ISS_ON && !strcmp(targetChip->getImageExtension(), "fits"))
-        {
-            fpstate	fpvar;
-            fp_init (&fpvar);
-            size_t compressedBytes = 0;
-            int islossless = 0;
-            if (fp_pack_data_to_data(reinterpret_cast<const char *>(fitsData), totalBytes, &compressedData, &compressedBytes, fpvar,
-                                     &islossless) < 0)
-            {
-                free(compressedData);
-                LOG_ERROR("Error: Ran out of memory compressing image");
-                return false;
-            }
+        Compression::Settings settings;
+        int codecIndex    = CompressionCodecSP.findOnSwitchIndex();
+        settings.codec    = codecIndex < 0 ? Compression::RICE : static_cast<Compression::Codec>(codecIndex);
+        settings.level    = CompressionSettingsNP[COMPRESSION_LEVEL].getValue();
+        settings.threads  = CompressionSettingsNP[COMPRESSION_THREADS].getValue();
+        settings.quantize = CompressionSettingsNP[COMPRESSION_QUANTIZE].getValue();
 
-            targetChip->FitsB.blob    = compressedData;
-            targetChip->FitsB.bloblen = compressedBytes;
-            snprintf(targetChip->FitsB.format, MAXINDIBLOBFMT, ".%s.fz", targetChip->getImageExtension());
-        }
-        else
-        {
-            uLong compressedBytes = sizeof(char) * totalBytes + totalBytes / 64 + 16 + 3;
-            compressedData  = new uint8_t[compressedBytes];
+        // Rice compression only applies to FITS images, raw frames never keep the fits extension
+        if (settings.codec == Compression::RICE && strcmp(extension, "fits"))
+            settings.codec = Compression::ZLIB;
 
-            if (fitsData == nullptr || compressedData == nullptr)
-            {
-                if (compressedData)
-                    delete [] compressedData;
-                LOG_ERROR("Error: Ran out of memory compressing image");
-                return false;
-            }
-
-            int r = compress2(compressedData, &compressedBytes, (const Bytef *)fitsData, totalBytes, 9);
-            if (r != Z_OK)
-            {
-                /* this should NEVER happen */
-                LOG_ERROR("Error: Failed to compress image");
-                delete [] compressedData;
-                return false;
-            }
-
-            targetChip->FitsB.blob    = compressedData;
-            targetChip->FitsB.bloblen = compressedBytes;
-            snprintf(targetChip->FitsB.format, MAXINDIBLOBFMT, ".%s.z", targetChip->getImageExtension());
+        auto start = std::chrono::high_resolution_clock::now();
+        if (Compression::compress(fitsData, totalBytes, m_CompressedData, settings) == false)
+        {
+            LOG_ERROR("Error: Failed to compress image");
+            return false;
         }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> diff = end - start;
+        LOGF_DEBUG("Compression took %g seconds (%zu -> %zu bytes)", diff.count(), totalBytes, m_CompressedData.size());
+
+        fitsB.blob    = m_CompressedData.data();
+        fitsB.bloblen = m_CompressedData.size();
+        snprintf(fitsB.format, MAXINDIBLOBFMT, ".%s%s", extension, Compression::extension(settings.codec));
     }
     else
     {
-        targetChip->FitsB.blob    = const_cast<void *>(fitsData);
-        targetChip->FitsB.bloblen = totalBytes;
-        snprintf(targetChip->FitsB.format, MAXINDIBLOBFMT, ".%s", targetChip->getImageExtension());
+        fitsB.blob    = const_cast<void *>(fitsData);
+        fitsB.bloblen = totalBytes;
+        snprintf(fitsB.format, MAXINDIBLOBFMT, ".%s", extension);
     }
 
-    targetChip->FitsB.size = totalBytes;
-    targetChip->FitsBP.s   = IPS_OK;
+    fitsB.size = totalBytes;
+    fitsBP.s   = IPS_OK;
 
     if (sendImage)
     {
@@ -2442,8 +2916,8 @@ bool CCD::uploadFile(CCDChip * targetChip, const void * fitsData, size_t totalBy
             auto start = std::chrono::high_resolution_clock::now();
 
             // Send format/size/..etc first later
-            wsServer.send_text(std::string(targetChip->FitsB.format));
-            wsServer.send_binary(targetChip->FitsB.blob, targetChip->FitsB.bloblen);
+            wsServer.send_text(std::string(fitsB.format));
+            wsServer.send_binary(fitsB.blob, fitsB.bloblen);
 
             auto end = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> diff = end - start;
@@ -2453,16 +2927,13 @@ bool CCD::uploadFile(CCDChip * targetChip, const void * fitsData, size_t totalBy
 #endif
         {
             auto start = std::chrono::high_resolution_clock::now();
-            IDSetBLOB(&targetChip->FitsBP, nullptr);
+            IDSetBLOB(&fitsBP, nullptr);
             auto end = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> diff = end - start;
             LOGF_DEBUG("BLOB transfer took %g seconds", diff.count());
         }
     }
 
-    if (compressedData)
-        delete [] compressedData;
-
     DEBUG(Logger::DBG_DEBUG, "Upload complete");
 
     return true;
@@ -2562,10 +3033,15 @@ bool CCD::saveConfigItems(FILE * fp)
     IUSaveConfigText(fp, &ActiveDeviceTP);
     IUSaveConfigSwitch(fp, &UploadSP);
     IUSaveConfigText(fp, &UploadSettingsTP);
+    IUSaveConfigSwitch(fp, &UploadSyncSP);
+    IUSaveConfigNumber(fp, &LiveStackSettingsNP);
+    IUSaveConfigSwitch(fp, &LiveStackSubsSP);
     IUSaveConfigSwitch(fp, &TelescopeTypeSP);
     IUSaveConfigSwitch(fp, &FastExposureToggleSP);
 
     IUSaveConfigSwitch(fp, &PrimaryCCD.CompressSP);
+    IUSaveConfigSwitch(fp, &CompressionCodecSP);
+    IUSaveConfigNumber(fp, &CompressionSettingsNP);
 
     IUSaveConfigSwitch(fp, &CaptureFormatSP);
     IUSaveConfigSwitch(fp, &EncodeFormatSP);
@@ -2625,140 +3101,15 @@ IPState CCD::GuideWest(uint32_t ms)
     return IPS_ALERT;
 }
 
-void CCD::getMinMax(double * min, double * max, CCDChip * targetChip)
-{
-    int ind         = 0, i, j;
-    int imageHeight = targetChip->getSubH() / targetChip->getBinY();
-    int imageWidth  = targetChip->getSubW() / targetChip->getBinX();
-    double lmin = 0, lmax = 0;
-
-    switch (targetChip->getBPP())
-    {
-        case 8:
-        {
-            uint8_t * imageBuffer = targetChip->getFrameBuffer();
-            lmin = lmax = imageBuffer[0];
-
-            for (i = 0; i < imageHeight; i++)
-                for (j = 0; j < imageWidth; j++)
-                {
-                    ind = (i * imageWidth) + j;
-                    if (imageBuffer[ind] < lmin)
-                        lmin = imageBuffer[ind];
-                    else if (imageBuffer[ind] > lmax)
-                        lmax = imageBuffer[ind];
-                }
-        }
-        break;
-
-        case 16:
-        {
-            uint16_t * imageBuffer = reinterpret_cast<uint16_t*>(targetChip->getFrameBuffer());
-            lmin = lmax = imageBuffer[0];
-
-            for (i = 0; i < imageHeight; i++)
-                for (j = 0; j < imageWidth; j++)
-                {
-                    ind = (i * imageWidth) + j;
-                    if (imageBuffer[ind] < lmin)
-                        lmin = imageBuffer[ind];
-                    else if (imageBuffer[ind] > lmax)
-                        lmax = imageBuffer[ind];
-                }
-        }
-        break;
-
-        case 32:
-        {
-            uint32_t * imageBuffer = reinterpret_cast<uint32_t*>(targetChip->getFrameBuffer());
-            lmin = lmax = imageBuffer[0];
-
-            for (i = 0; i < imageHeight; i++)
-                for (j = 0; j < imageWidth; j++)
-                {
-                    ind = (i * imageWidth) + j;
-                    if (imageBuffer[ind] < lmin)
-                        lmin = imageBuffer[ind];
-                    else if (imageBuffer[ind] > lmax)
-                        lmax = imageBuffer[ind];
-                }
-        }
-        break;
-    }
-    *min = lmin;
-    *max = lmax;
-}
-
-std::string regex_replace_compat(const std::string &input, const std::string &pattern, const std::string &replace)
+ImageStatistics CCD::getImageStatistics(CCDChip * targetChip)
 {
-    std::stringstream s;
-    std::regex_replace(std::ostreambuf_iterator<char>(s), input.begin(), input.end(), std::regex(pattern), replace);
-    return s.str();
-}
-
-int CCD::getFileIndex(const char * dir, const char * prefix, const char * ext)
-{
-    INDI_UNUSED(ext);
-
-    DIR * dpdf = nullptr;
-    struct dirent * epdf = nullptr;
-    std::vector<std::string> files = std::vector<std::string>();
-
-    std::string prefixIndex = prefix;
-    prefixIndex             = regex_replace_compat(prefixIndex, "_ISO8601", "");
-    prefixIndex             = regex_replace_compat(prefixIndex, "_XXX", "");
-
-    // Create directory if does not exist
-    struct stat st;
-
-    if (stat(dir, &st) == -1)
-    {
-        if (errno == ENOENT)
-        {
-            DEBUGF(Logger::DBG_DEBUG, "Creating directory %s...", dir);
-            if (INDI::mkpath(dir, 0755) == -1)
-                LOGF_ERROR("Error creating directory %s (%s)", dir, strerror(errno));
-        }
-        else
-        {
-            LOGF_ERROR("Couldn't stat directory %s: %s", dir, strerror(errno));
-            return -1;
-        }
-    }
-
-    dpdf = opendir(dir);
-    if (dpdf != nullptr)
-    {
-        while ((epdf = readdir(dpdf)))
-        {
-            if (strstr(epdf->d_name, prefixIndex.c_str()))
-                files.push_back(epdf->d_name);
-        }
-    }
-    else
-    {
-        closedir(dpdf);
-        return -1;
-    }
-    int maxIndex = 0;
-
-    for (uint32_t i = 0; i < files.size(); i++)
-    {
-        int index = -1;
-
-        std::string file  = files.at(i);
-        std::size_t start = file.find_last_of("_");
-        std::size_t end   = file.find_last_of(".");
-        if (start != std::string::npos)
-        {
-            index = atoi(file.substr(start + 1, end).c_str());
-            if (index > maxIndex)
-                maxIndex = index;
-        }
-    }
+    // Statistics of the frame being encoded were already computed by the encoder thread
+    if (m_EncodingFrame != nullptr && m_EncodingFrame->targetChip == targetChip && m_EncodingFrame->hasStatistics)
+        return m_EncodingFrame->statistics;
 
-    closedir(dpdf);
-    return (maxIndex + 1);
+    size_t pixels = static_cast<size_t>(targetChip->getSubW() / targetChip->getBinX()) *
+                    (targetChip->getSubH() / targetChip->getBinY());
+    return ImageStatistics::calculate(targetChip->getFrameBuffer(), pixels, targetChip->getBPP());
 }
 
 void CCD::GuideComplete(INDI_EQ_AXIS axis)
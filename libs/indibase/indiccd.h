@@ -29,10 +29,14 @@
 #include "indiccdchip.h"
 #include "defaultdevice.h"
 #include "indiguiderinterface.h"
+#include "indipropertyblob.h"
 #include "indipropertynumber.h"
 #include "indipropertyswitch.h"
 #include "inditimer.h"
 #include "indielapsedtimer.h"
+#include "indiimagestatistics.h"
+#include "indifileindex.h"
+#include "indilivestack.h"
 #include "dsp/manager.h"
 #include "stream/streammanager.h"
 
@@ -48,6 +52,9 @@
 #include <stdint.h>
 #include <mutex>
 #include <thread>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 
 extern const char * IMAGE_SETTINGS_TAB;
 extern const char * IMAGE_INFO_TAB;
@@ -104,6 +111,13 @@ class StreamManager;
  * Similiary, before calling Streamer->newFrame, the buffer needs to be protected in a similiar fashion using
  * the same ccdBufferLock mutex.
  *
+ * ExposureComplete() copies the frame buffer and the chip settings without taking ccdBufferLock, so it may be
+ * called with or without the lock held, and hands the copy to a two stage upload pipeline. The encoder thread builds
+ * the FITS file from the copy, while the upload thread compresses, saves and sends the previously encoded frame. The
+ * driver may therefore read out the next frame as soon as ExposureComplete() returns. When a few frames are already
+ * waiting in the pipeline, ExposureComplete() waits for the oldest one to be uploaded. The queued frames are uploaded
+ * when the driver disconnects, frames still queued when the driver is destroyed are discarded.
+ *
  * \example CCD Simulator
  * \version 1.1
  * \author Jasem Mutlaq
@@ -704,6 +718,62 @@ class CCD : public DefaultDevice, GuiderInterface
             FORMAT_NATIVE    /*!< Save Image as the native format of the camera itself. */
         };
 
+        /// Codec used to compress images when compression is enabled for a chip.
+        INDI::PropertySwitch CompressionCodecSP {4};
+        enum
+        {
+            COMPRESSION_ZLIB,    /*!< zlib, compatible with all clients. */
+            COMPRESSION_ZSTD,    /*!< zstd, if available. */
+            COMPRESSION_LZ4,     /*!< lz4, if available. Fastest, lowest ratio. */
+            COMPRESSION_RICE     /*!< Rice compressed FITS (fpack). Non-FITS images fall back to zlib. */
+        };
+
+        /// Statistics of the last primary chip image.
+        INDI::PropertyNumber ImageStatisticsNP {5};
+        enum
+        {
+            STATISTICS_MIN,
+            STATISTICS_MAX,
+            STATISTICS_MEAN,
+            STATISTICS_STDDEV,
+            STATISTICS_MEDIAN
+        };
+
+        /// Register and stack the primary chip frames.
+        INDI::PropertySwitch LiveStackSP {2};
+
+        /// Live stacking clip sigma, star detection threshold and number of frames between stacked images.
+        INDI::PropertyNumber LiveStackSettingsNP {3};
+        enum
+        {
+            LIVE_STACK_SIGMA,
+            LIVE_STACK_THRESHOLD,
+            LIVE_STACK_INTERVAL
+        };
+
+        /// Send the frames to the client while live stacking.
+        INDI::PropertySwitch LiveStackSubsSP {2};
+
+        /// Number of frames stacked and rejected since live stacking was enabled.
+        INDI::PropertyNumber LiveStackInfoNP {2};
+        enum
+        {
+            LIVE_STACK_STACKED,
+            LIVE_STACK_REJECTED
+        };
+
+        /// Stacked image, a 32 bit float FITS.
+        INDI::PropertyBlob LiveStackBP {1};
+
+        /// Compression level, number of compression threads and fpack quantization level.
+        INDI::PropertyNumber CompressionSettingsNP {3};
+        enum
+        {
+            COMPRESSION_LEVEL,
+            COMPRESSION_THREADS,
+            COMPRESSION_QUANTIZE
+        };
+
         ISwitch UploadS[3];
         ISwitchVectorProperty UploadSP;
 
@@ -715,6 +785,9 @@ class CCD : public DefaultDevice, GuiderInterface
             UPLOAD_PREFIX
         };
 
+        /// Call fdatasync after saving an image locally.
+        INDI::PropertySwitch UploadSyncSP {2};
+
         ISwitch TelescopeTypeS[2];
         ISwitchVectorProperty TelescopeTypeSP;
         enum
@@ -779,10 +852,58 @@ class CCD : public DefaultDevice, GuiderInterface
         ///////////////////////////////////////////////////////////////////////////////
         /// Utility Functions
         ///////////////////////////////////////////////////////////////////////////////
-        bool uploadFile(CCDChip * targetChip, const void * fitsData, size_t totalBytes, bool sendImage, bool saveImage);
-        void getMinMax(double * min, double * max, CCDChip * targetChip);
-        int getFileIndex(const char * dir, const char * prefix, const char * ext);
-        bool ExposureCompletePrivate(CCDChip * targetChip);
+        bool uploadFile(CCDChip * targetChip, const void * fitsData, size_t totalBytes, bool sendImage, bool saveImage,
+                        const char * extension);
+        // Compressed image, reused between uploads
+        std::vector<uint8_t> m_CompressedData;
+        ImageStatistics getImageStatistics(CCDChip * targetChip);
+        // Index of the next locally saved image
+        FileIndex m_FileIndex;
+
+        /** A completed exposure in the upload pipeline, defined in indiccd.cpp */
+        struct UploadFrame;
+
+        ///////////////////////////////////////////////////////////////////////////////
+        /// Live Stacking
+        ///////////////////////////////////////////////////////////////////////////////
+        /** Add a primary chip frame to the stack, and send the stacked image every LIVE_STACK_INTERVAL frames. */
+        void processLiveStack(const UploadFrame * frame);
+        bool sendLiveStack();
+
+        LiveStack m_LiveStack;
+        std::vector<float> m_LiveStackImage;
+        // FITS memory file of the stacked image, reused between uploads
+        void *m_LiveStackFile {nullptr};
+        size_t m_LiveStackFileSize {0};
+
+        ///////////////////////////////////////////////////////////////////////////////
+        /// Upload Pipeline
+        ///////////////////////////////////////////////////////////////////////////////
+        /** Encode a copied frame. No fast exposure is started when stopping. Return false if the frame should not be uploaded. */
+        bool ExposureCompletePrivate(UploadFrame * frame, bool stopping);
+        /** Compress, save and send an encoded frame, then complete the exposure. */
+        void UploadCompletePrivate(UploadFrame * frame);
+        void encoderThreadEntry();
+        void uploadThreadEntry();
+        void recycleUploadFrame(std::unique_ptr<UploadFrame> frame);
+        /** Join the pipeline threads after the queued frames are uploaded, or after dropping those not encoded yet. */
+        void stopUploadPipeline(bool discard);
+
+        std::mutex m_UploadLock;
+        std::condition_variable m_UploadCondition;
+        std::deque<std::unique_ptr<UploadFrame>> m_EncodeQueue;
+        std::deque<std::unique_ptr<UploadFrame>> m_UploadQueue;
+        std::deque<std::unique_ptr<UploadFrame>> m_FreeUploadFrames;
+        std::thread m_EncoderThread;
+        std::thread m_UploadThread;
+        bool m_UploadQuit {false};
+        // Set once the encoder thread has drained its queue on exit
+        bool m_EncoderDone {false};
+        // Frames between ExposureComplete() and the end of their upload, and times ExposureComplete() waited for them
+        size_t m_FramesInFlight {0};
+        uint32_t m_UploadStalls {0};
+        // Frame currently encoded by the encoder thread, used by addFITSKeywords
+        UploadFrame *m_EncodingFrame {nullptr};
 
         // Threading for Websocket
 #ifdef HAVE_WEBSOCKET
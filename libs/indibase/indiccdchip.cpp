@@ -19,6 +19,7 @@
 #include "indidevapi.h"
 #include "locale_compat.h"
 
+#include <algorithm>
 #include <cstring>
 #include <ctime>
 
@@ -235,179 +236,35 @@ void CCDChip::setImageExtension(const char *ext)
 
 void CCDChip::binFrame()
 {
-    if (BinX == 1)
-        return;
-
-    // Jasem: Keep full frame shadow in memory to enhance performance and just swap frame pointers after operation is complete
-    if (BinFrame == nullptr)
-        BinFrame = new uint8_t[RawFrameSize];
-
-    memset(BinFrame, 0, RawFrameSize);
-
-    switch (getBPP())
-    {
-        case 8:
-        {
-            uint8_t *bin_buf = BinFrame;
-            // Try to average pixels since in 8bit they get saturated pretty quickly
-            double factor      = (BinX * BinX) / 2;
-            double accumulator = 0;
-
-            for (uint32_t i = 0; i < SubH; i += BinX)
-                for (uint32_t j = 0; j < SubW; j += BinX)
-                {
-                    accumulator = 0;
-                    for (int k = 0; k < BinX; k++)
-                    {
-                        for (int l = 0; l < BinX; l++)
-                        {
-                            accumulator += *(RawFrame + j + (i + k) * SubW + l);
-                        }
-                    }
-
-                    accumulator /= factor;
-                    if (accumulator > UINT8_MAX)
-                        *bin_buf = UINT8_MAX;
-                    else
-                        *bin_buf += static_cast<uint8_t>(accumulator);
-                    bin_buf++;
-                }
-        }
-        break;
-
-        case 16:
-        {
-            uint16_t *bin_buf    = reinterpret_cast<uint16_t *>(BinFrame);
-            uint16_t *RawFrame16 = reinterpret_cast<uint16_t *>(RawFrame);
-            uint16_t val;
-
-            for (uint32_t i = 0; i < SubH; i += BinX)
-                for (uint32_t j = 0; j < SubW; j += BinX)
-                {
-                    for (int k = 0; k < BinX; k++)
-                    {
-                        for (int l = 0; l < BinX; l++)
-                        {
-                            val = *(RawFrame16 + j + (i + k) * SubW + l);
-                            if (val + *bin_buf > UINT16_MAX)
-                                *bin_buf = UINT16_MAX;
-                            else
-                                *bin_buf += val;
-                        }
-                    }
-                    bin_buf++;
-                }
-        }
-        break;
-
-        default:
-            return;
-    }
-
-    // Swap frame pointers
-    uint8_t *rawFramePointer = RawFrame;
-    RawFrame                 = BinFrame;
-    // We just memset it next time we use it
-    BinFrame = rawFramePointer;
+    binFrame(false);
 }
 
-
-// Thx8411:
-// Binning Bayer frames
-// Each raw frame pixel is mapped and summed onto the binned frame
-// The right place of each pixel in the 2x2 Bayer matrix is found by :
-// (((i/BinX) & 0xFFFFFFFE) + (i & 0x00000001))
-// and
-// ((j/BinX) & 0xFFFFFFFE) + (j & 0x00000001)
-//
 void CCDChip::binBayerFrame()
 {
-    if (BinX == 1)
+    binFrame(true);
+}
+
+void CCDChip::binFrame(bool bayer)
+{
+    if (BinX == 1 && BinY == 1)
         return;
 
     // Jasem: Keep full frame shadow in memory to enhance performance and just swap frame pointers after operation is complete
     if (BinFrame == nullptr)
         BinFrame = new uint8_t[RawFrameSize];
 
-    memset(BinFrame, 0, RawFrameSize);
+    // Try to average pixels since in 8bit they get saturated pretty quickly
+    uint32_t sumDivisor = 1;
+    if (getBPP() == 8)
+        sumDivisor = bayer ? BinX * BinY : std::max<uint32_t>(1, (BinX * BinY) / 2);
 
-    switch (getBPP())
-    {
-        // 8 bpp frame
-        case 8:
-        {
-            uint32_t BinFrameOffset;
-            uint32_t val;
-            uint32_t BinW=SubW/BinX;
-            uint8_t BinFactor=BinX*BinY;
-            uint32_t RawOffset=0;
-            uint32_t BinOffsetH;
-
-            // for each raw frame row
-            for (uint32_t i = 0; i < SubH; i++)
-            {
-                // find the binned frame row
-                BinOffsetH=(((i/BinY) & 0xFFFFFFFE) + (i & 0x00000001)) * BinW;
-                // for each raw column
-                for (uint32_t j = 0; j < SubW; j++)
-                {
-                    // find the proper position in the binned frame
-                    BinFrameOffset=BinOffsetH + ((j/BinX) & 0xFFFFFFFE) + (j & 0x00000001);
-                    // get the existing value in the binned frame
-                    val=BinFrame[BinFrameOffset];
-                    // add the new value, averaged and caped
-                    val+=RawFrame[RawOffset]/BinFactor;
-                    if(val>UINT8_MAX)
-                        val=UINT8_MAX;
-                    // write back into the binned frame
-                    BinFrame[BinFrameOffset]=(uint8_t)val;
-                    // next binned frame pixel
-                    RawOffset++;
-                }
-            }
-        }
-        break;
-
-        // 16 bpp frame
-        case 16:
-        {
-            // works the same as the 8 bits version, without averaging but
-            // mapped onto 16 bits pixel
-            uint16_t *RawFrame16 = reinterpret_cast<uint16_t *>(RawFrame);
-            uint16_t *BinFrame16 = reinterpret_cast<uint16_t *>(BinFrame);
-
-            uint32_t BinFrameOffset;
-            uint32_t val;
-            uint32_t BinW=SubW/BinX;
-            uint32_t RawOffset=0;
-            uint32_t BinOffsetH;
-
-            for (uint32_t i = 0; i < SubH; i++)
-            {
-                BinOffsetH=(((i/BinY) & 0xFFFFFFFE) + (i & 0x00000001)) * BinW;
-                for (uint32_t j = 0; j < SubW; j++)
-                {
-                    BinFrameOffset=BinOffsetH + ((j/BinX) & 0xFFFFFFFE) + (j & 0x00000001);
-                    val=BinFrame16[BinFrameOffset];
-                    val+=RawFrame16[RawOffset];
-                    if(val>UINT16_MAX)
-                        val=UINT16_MAX;
-                    BinFrame16[BinFrameOffset]=(uint16_t)val;
-                    RawOffset++;
-                }
-            }
-
-        }
-        break;
-
-        default:
-            return;
-    }
+    if (Binning::bin(RawFrame, BinFrame, SubW, SubH, getBPP(), BinX, BinY, BinningMode, bayer, sumDivisor) == false)
+        return;
 
     // Swap frame pointers
     uint8_t *rawFramePointer = RawFrame;
     RawFrame                 = BinFrame;
-    // We just memset it next time we use it
+    // Every binned pixel is overwritten next time, no need to clear it
     BinFrame = rawFramePointer;
 }
 
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "indiapi.h"
+#include "indibinning.h"
 
 #include <sys/time.h>
 #include <stdint.h>
@@ -382,16 +383,37 @@ class CCDChip
         /**
          * @brief binFrame Perform software binning on the CCD frame. Only use this function if hardware
          * binning is not supported.
+         * @note In BIN_SUM mode, 8 bit frames are scaled by 2 / (BinX * BinY) since 8 bit sums saturate quickly.
          */
         void binFrame();
 
         /**
          * @brief binBayerFrame Perform software binning on a 2x2 Bayer matrix CCD frame. Only use this function if hardware
          * binning is not supported.
+         * @note In BIN_SUM mode, 8 bit frames are averaged since 8 bit sums saturate quickly.
          */
         void binBayerFrame();
 
+        /**
+         * @brief setBinningMode Set how pixels are combined by binFrame() and binBayerFrame().
+         * @param mode sum (default), average or median.
+         */
+        void setBinningMode(Binning::Mode mode)
+        {
+            BinningMode = mode;
+        }
+
+        /**
+         * @return Software binning mode.
+         */
+        Binning::Mode getBinningMode() const
+        {
+            return BinningMode;
+        }
+
     private:
+        void binFrame(bool bayer);
+
         /////////////////////////////////////////////////////////////////////////////////////////
         /// Chip Variables
         /////////////////////////////////////////////////////////////////////////////////////////
@@ -427,6 +449,8 @@ class CCDChip
         uint32_t RawFrameSize {0};
         // BINNED Frame when software binning is used.
         uint8_t *BinFrame {nullptr};
+        // How pixels are combined by software binning.
+        Binning::Mode BinningMode {Binning::BIN_SUM};
         // Should we compress frame before transmission?
         bool SendCompressed {false};
         // Frame Type
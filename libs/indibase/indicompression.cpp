@@ -0,0 +1,287 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Compression
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "indicompression.h"
+#include "indiutility.h"
+
+#include "config.h"
+
+#include <fitsio.h>
+#include "fpack/fpack.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#include <lz4hc.h>
+#endif
+
+namespace INDI
+{
+
+// Blocks smaller than this compress worse than they gain from running in parallel.
+static constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;
+// zlib stream lengths are 32 bit.
+static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+bool Compression::isAvailable(Codec codec)
+{
+    switch (codec)
+    {
+        case ZLIB:
+        case RICE:
+            return true;
+
+        case ZSTD:
+#ifdef HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+
+        case LZ4:
+#ifdef HAVE_LZ4
+            return true;
+#else
+            return false;
+#endif
+    }
+
+    return false;
+}
+
+const char *Compression::extension(Codec codec)
+{
+    switch (codec)
+    {
+        case ZLIB:
+            return ".z";
+        case ZSTD:
+            return ".zst";
+        case LZ4:
+            return ".lz4";
+        case RICE:
+            return ".fz";
+    }
+
+    return "";
+}
+
+bool Compression::compress(const void *data, size_t size, std::vector<uint8_t> &out, const Settings &settings)
+{
+    if (data == nullptr)
+        return false;
+
+    const uint8_t *input = static_cast<const uint8_t *>(data);
+
+    switch (settings.codec)
+    {
+        case ZLIB:
+            return compressZlib(input, size, out, settings);
+        case ZSTD:
+            return compressZstd(input, size, out, settings);
+        case LZ4:
+            return compressLZ4(input, size, out, settings);
+        case RICE:
+            return compressRice(input, size, out, settings);
+    }
+
+    return false;
+}
+
+bool Compression::compressZlib(const uint8_t *data, size_t size, std::vector<uint8_t> &out, const Settings &settings)
+{
+    struct Block
+    {
+        const uint8_t *data;
+        size_t size;
+        std::vector<uint8_t> out;
+        uLong adler;
+        bool ok;
+    };
+
+    const int level        = std::max(0, std::min(9, settings.level));
+    const size_t blockSize = std::max(MIN_BLOCK_SIZE, std::min(MAX_BLOCK_SIZE, settings.blockSize));
+    const size_t count     = std::max<size_t>(1, (size + blockSize - 1) / blockSize);
+
+    std::vector<Block> blocks(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        blocks[i].data = data + i * blockSize;
+        blocks[i].size = std::min(blockSize, size - i * blockSize);
+    }
+
+    // Each block is compressed as raw deflate data. All blocks but the last end with a sync flush so they are byte
+    // aligned and not final, their concatenation is then a single valid deflate stream.
+    parallel_for(count, std::max(0, settings.threads), [&](size_t i)
+    {
+        Block &block = blocks[i];
+        bool last    = (i == count - 1);
+        block.ok     = false;
+
+        z_stream strm;
+        memset(&strm, 0, sizeof(strm));
+        if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return;
+
+        block.out.resize(deflateBound(&strm, block.size) + 16);
+        strm.next_in   = const_cast<Bytef *>(block.data);
+        strm.avail_in  = block.size;
+        strm.next_out  = block.out.data();
+        strm.avail_out = block.out.size();
+
+        int ret = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+        if (last)
+            block.ok = (ret == Z_STREAM_END);
+        else
+            block.ok = (ret == Z_OK && strm.avail_in == 0 && strm.avail_out > 0);
+
+        block.out.resize(strm.total_out);
+        deflateEnd(&strm);
+
+        block.adler = adler32(adler32(0L, Z_NULL, 0), block.data, block.size);
+    });
+
+    // zlib header, see RFC 1950
+    const uint8_t cmf = 0x78;
+    uint8_t flg       = (level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6;
+    flg += 31 - ((cmf << 8) + flg) % 31;
+
+    size_t total = 2 + 4;
+    for (const auto &block : blocks)
+    {
+        if (block.ok == false)
+            return false;
+        total += block.out.size();
+    }
+
+    out.resize(total);
+    uint8_t *p = out.data();
+    *p++ = cmf;
+    *p++ = flg;
+
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (const auto &block : blocks)
+    {
+        memcpy(p, block.out.data(), block.out.size());
+        p += block.out.size();
+        adler = adler32_combine(adler, block.adler, block.size);
+    }
+
+    *p++ = (adler >> 24) & 0xFF;
+    *p++ = (adler >> 16) & 0xFF;
+    *p++ = (adler >> 8) & 0xFF;
+    *p++ = adler & 0xFF;
+
+    return true;
+}
+
+bool Compression::compressZstd(const uint8_t *data, size_t size, std::vector<uint8_t> &out, const Settings &settings)
+{
+#ifdef HAVE_ZSTD
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    if (cctx == nullptr)
+        return false;
+
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, std::max(1, std::min(ZSTD_maxCLevel(), settings.level)));
+
+    // zstd splits the input into jobs itself. Setting workers fails harmlessly if libzstd was built without threads.
+    size_t threads = settings.threads > 0 ? settings.threads : std::max(1u, std::thread::hardware_concurrency());
+    if (threads > 1 && size > settings.blockSize)
+    {
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, threads);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_jobSize, settings.blockSize);
+    }
+
+    out.resize(ZSTD_compressBound(size));
+    size_t compressedBytes = ZSTD_compress2(cctx, out.data(), out.size(), data, size);
+    ZSTD_freeCCtx(cctx);
+
+    if (ZSTD_isError(compressedBytes))
+        return false;
+
+    out.resize(compressedBytes);
+    return true;
+#else
+    (void)data;
+    (void)size;
+    (void)out;
+    (void)settings;
+    return false;
+#endif
+}
+
+bool Compression::compressLZ4(const uint8_t *data, size_t size, std::vector<uint8_t> &out, const Settings &settings)
+{
+#ifdef HAVE_LZ4
+    LZ4F_preferences_t preferences;
+    memset(&preferences, 0, sizeof(preferences));
+    preferences.compressionLevel      = std::max(0, std::min(LZ4HC_CLEVEL_MAX, settings.level));
+    preferences.frameInfo.blockMode   = LZ4F_blockIndependent;
+    preferences.frameInfo.contentSize = size;
+
+    out.resize(LZ4F_compressFrameBound(size, &preferences));
+    size_t compressedBytes = LZ4F_compressFrame(out.data(), out.size(), data, size, &preferences);
+    if (LZ4F_isError(compressedBytes))
+        return false;
+
+    out.resize(compressedBytes);
+    return true;
+#else
+    (void)data;
+    (void)size;
+    (void)out;
+    (void)settings;
+    return false;
+#endif
+}
+
+bool Compression::compressRice(const uint8_t *data, size_t size, std::vector<uint8_t> &out, const Settings &settings)
+{
+    fpstate fpvar;
+    fp_init(&fpvar);
+    fpvar.quantize_level = settings.quantize;
+
+    unsigned char *compressedData = nullptr;
+    size_t compressedBytes = 0;
+    int islossless = 0;
+    if (fp_pack_data_to_data(reinterpret_cast<const char *>(data), size, &compressedData, &compressedBytes, fpvar,
+                             &islossless) < 0)
+    {
+        free(compressedData);
+        return false;
+    }
+
+    out.assign(compressedData, compressedData + compressedBytes);
+    free(compressedData);
+    return true;
+}
+
+}
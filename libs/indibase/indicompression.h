@@ -0,0 +1,90 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Compression
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace INDI
+{
+
+/**
+ * @brief The Compression class compresses frame buffers before they are saved or sent to clients.
+ *
+ * Large buffers are split into blocks that are compressed in parallel. For zlib, the blocks are joined into a
+ * single zlib stream, so the result can be decompressed with a single call to uncompress() just like compress2().
+ * zstd and lz4 are only available if INDI was built with the respective libraries.
+ */
+class Compression
+{
+    public:
+        typedef enum
+        {
+            ZLIB,   /*!< zlib stream, extension .z */
+            ZSTD,   /*!< zstd frame, extension .zst */
+            LZ4,    /*!< lz4 frame, extension .lz4 */
+            RICE,   /*!< Rice compressed FITS via fpack, extension .fz. FITS data only. */
+        } Codec;
+
+        struct Settings
+        {
+            Codec codec {ZLIB};
+            /** Codec specific compression level. Values out of the codec range are clamped. */
+            int level {6};
+            /** Number of threads to use. 0 selects the number of available cores. */
+            int threads {0};
+            /** Size of independently compressed blocks in bytes. */
+            size_t blockSize {1024 * 1024};
+            /** fpack quantization level for floating point images. */
+            float quantize {4};
+        };
+
+    public:
+        /**
+         * @brief isAvailable Check if a codec was compiled in.
+         */
+        static bool isAvailable(Codec codec);
+
+        /**
+         * @brief extension Return the file extension suffix of a codec, e.g. ".z".
+         */
+        static const char *extension(Codec codec);
+
+        /**
+         * @brief compress Compress a buffer.
+         * @param data buffer to compress. Must be a complete FITS file for Rice compression.
+         * @param size size of buffer in bytes.
+         * @param out compressed data. The vector is resized to the compressed size and may be reused between calls.
+         * @param settings codec, level and threading settings.
+         * @return True on success, false if compression failed or the codec is not available.
+         */
+        static bool compress(const void *data, size_t size, std::vector<uint8_t> &out, const Settings &settings);
+
+    private:
+        static bool compressZlib(const uint8_t *data, size_t size, std::vector<uint8_t> &out, const Settings &settings);
+        static bool compressZstd(const uint8_t *data, size_t size, std::vector<uint8_t> &out, const Settings &settings);
+        static bool compressLZ4(const uint8_t *data, size_t size, std::vector<uint8_t> &out, const Settings &settings);
+        static bool compressRice(const uint8_t *data, size_t size, std::vector<uint8_t> &out, const Settings &settings);
+};
+
+}
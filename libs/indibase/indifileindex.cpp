@@ -0,0 +1,147 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Upload File Index
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "indifileindex.h"
+#include "indiutility.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace INDI
+{
+
+std::string FileIndex::nextFileName(const std::string &dir, const std::string &prefix, const std::string &suffix)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+
+    int index = nextIndex(dir, prefix);
+    if (index < 0)
+        return std::string();
+
+    std::string fileName = dir + "/" + expandPrefix(prefix, index) + suffix;
+
+    // Only indexed names can collide with files we did not create. Rescan once and take the next free index.
+    if (prefix.find("XXX") != std::string::npos && access(fileName.c_str(), F_OK) == 0)
+    {
+        m_LastIndex = -1;
+        index = nextIndex(dir, prefix);
+        if (index < 0)
+            return std::string();
+
+        fileName = dir + "/" + expandPrefix(prefix, index) + suffix;
+    }
+
+    return fileName;
+}
+
+void FileIndex::invalidate()
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_LastIndex = -1;
+}
+
+std::string FileIndex::expandPrefix(const std::string &prefix, int index)
+{
+    std::string expanded = prefix;
+
+    if (expanded.find("ISO8601") != std::string::npos)
+    {
+        time_t t = time(nullptr);
+        std::tm tm;
+        localtime_r(&t, &tm);
+        replace_all(expanded, "ISO8601", format_time(tm, "%Y-%m-%dT%H-%M-%S"));
+    }
+
+    if (expanded.find("XXX") != std::string::npos)
+    {
+        char indexString[16];
+        snprintf(indexString, sizeof(indexString), "%03d", index);
+        replace_all(expanded, "XXX", indexString);
+    }
+
+    return expanded;
+}
+
+int FileIndex::nextIndex(const std::string &dir, const std::string &prefix)
+{
+    if (m_LastIndex < 0 || dir != m_Dir || prefix != m_Prefix)
+    {
+        int maxIndex = scanDirectory(dir, prefix);
+        if (maxIndex < 0)
+        {
+            m_LastIndex = -1;
+            return -1;
+        }
+
+        m_Dir       = dir;
+        m_Prefix    = prefix;
+        m_LastIndex = maxIndex;
+    }
+
+    return ++m_LastIndex;
+}
+
+int FileIndex::scanDirectory(const std::string &dir, const std::string &prefix)
+{
+    // Create directory if does not exist
+    struct stat st;
+    if (stat(dir.c_str(), &st) == -1)
+    {
+        if (errno != ENOENT || mkpath(dir, 0755) == -1)
+            return -1;
+    }
+
+    std::string pattern = prefix;
+    replace_all(pattern, "_ISO8601", "");
+    replace_all(pattern, "_XXX", "");
+
+    DIR *dpdf = opendir(dir.c_str());
+    if (dpdf == nullptr)
+        return -1;
+
+    int maxIndex = 0;
+    struct dirent *epdf = nullptr;
+    while ((epdf = readdir(dpdf)))
+    {
+        std::string file = epdf->d_name;
+        if (file.find(pattern) == std::string::npos)
+            continue;
+
+        std::size_t start = file.find_last_of("_");
+        std::size_t end   = file.find_last_of(".");
+        if (start != std::string::npos)
+        {
+            int index = atoi(file.substr(start + 1, end).c_str());
+            if (index > maxIndex)
+                maxIndex = index;
+        }
+    }
+
+    closedir(dpdf);
+    return maxIndex;
+}
+
+}
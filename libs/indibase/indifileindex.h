@@ -0,0 +1,75 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Upload File Index
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <mutex>
+#include <string>
+
+namespace INDI
+{
+
+/**
+ * @brief The FileIndex class generates numbered file names for local uploads.
+ *
+ * The upload prefix may contain the placeholders ISO8601, replaced by the local time, and XXX, replaced by a running
+ * index. The upload directory is scanned for the highest existing index only when the directory or the prefix change,
+ * after which indices are handed out from memory. If a generated file already exists, for example because another
+ * process wrote to the same directory, the directory is rescanned once.
+ */
+class FileIndex
+{
+    public:
+        /**
+         * @brief nextFileName Create the upload directory if needed and return the next file name.
+         * @param dir upload directory.
+         * @param prefix file name prefix with optional ISO8601 and XXX placeholders.
+         * @param suffix appended to the expanded prefix, e.g. ".fits".
+         * @return Path of the next file, or an empty string if the directory could not be created or read. errno is
+         * set in that case.
+         */
+        std::string nextFileName(const std::string &dir, const std::string &prefix, const std::string &suffix);
+
+        /**
+         * @brief invalidate Forget the cached index so the directory is scanned again on the next call. Call this when
+         * the directory may have changed behind our back, e.g. when a generated file could not be opened.
+         */
+        void invalidate();
+
+        /**
+         * @brief expandPrefix Replace the ISO8601 and XXX placeholders of a prefix.
+         * @param prefix file name prefix.
+         * @param index index to substitute for XXX, zero padded to three digits.
+         * @return Expanded prefix.
+         */
+        static std::string expandPrefix(const std::string &prefix, int index);
+
+    private:
+        int nextIndex(const std::string &dir, const std::string &prefix);
+        int scanDirectory(const std::string &dir, const std::string &prefix);
+
+        std::mutex m_Lock;
+        std::string m_Dir;
+        std::string m_Prefix;
+        int m_LastIndex {-1};
+};
+
+}
@@ -0,0 +1,209 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Image Statistics
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "indiimagestatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Build an AVX2 and a generic version of each kernel and pick one at load time.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define STATISTICS_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define STATISTICS_KERNEL
+#endif
+
+#if defined(__GNUC__)
+#define STATISTICS_INLINE inline __attribute__((always_inline))
+#else
+#define STATISTICS_INLINE inline
+#endif
+
+namespace INDI
+{
+
+// Independent accumulators per lane let the compiler keep them in vector registers.
+static constexpr size_t LANES = 16;
+// Lane sums are flushed to the totals every BLOCK iterations, so narrow lane sums never overflow.
+static constexpr size_t BLOCK = 16384;
+// Maximum number of pixels sampled for the median estimate.
+static constexpr size_t MEDIAN_SAMPLES = 65536;
+
+struct Moments
+{
+    double min {0};
+    double max {0};
+    double sum {0};
+    double sumSquares {0};
+};
+
+/**
+ * Single pass min/max/sum/sum of squares. S and Q are the lane types of the sum and sum of squares, they must hold
+ * BLOCK values of T and T squared.
+ */
+template <typename T, typename S, typename Q>
+static STATISTICS_INLINE Moments accumulate(const T *buffer, size_t count)
+{
+    T lmin[LANES], lmax[LANES];
+    for (size_t l = 0; l < LANES; l++)
+        lmin[l] = lmax[l] = buffer[0];
+
+    double sum = 0, sumSquares = 0;
+    size_t i = 0;
+
+    while (i + LANES <= count)
+    {
+        S lsum[LANES] = {};
+        Q lsq[LANES]  = {};
+
+        size_t end = std::min(count - count % LANES, i + BLOCK * LANES);
+        for (; i < end; i += LANES)
+        {
+            for (size_t l = 0; l < LANES; l++)
+            {
+                T v     = buffer[i + l];
+                lmin[l] = v < lmin[l] ? v : lmin[l];
+                lmax[l] = v > lmax[l] ? v : lmax[l];
+                lsum[l] += static_cast<S>(v);
+                lsq[l]  += static_cast<Q>(v) * static_cast<Q>(v);
+            }
+        }
+
+        for (size_t l = 0; l < LANES; l++)
+        {
+            sum        += static_cast<double>(lsum[l]);
+            sumSquares += static_cast<double>(lsq[l]);
+        }
+    }
+
+    T tmin = lmin[0], tmax = lmax[0];
+    for (size_t l = 1; l < LANES; l++)
+    {
+        tmin = std::min(tmin, lmin[l]);
+        tmax = std::max(tmax, lmax[l]);
+    }
+
+    for (; i < count; i++)
+    {
+        T v  = buffer[i];
+        tmin = std::min(tmin, v);
+        tmax = std::max(tmax, v);
+        sum        += static_cast<double>(v);
+        sumSquares += static_cast<double>(v) * static_cast<double>(v);
+    }
+
+    Moments moments;
+    moments.min        = tmin;
+    moments.max        = tmax;
+    moments.sum        = sum;
+    moments.sumSquares = sumSquares;
+    return moments;
+}
+
+STATISTICS_KERNEL static Moments accumulate8(const uint8_t *buffer, size_t count)
+{
+    return accumulate<uint8_t, uint32_t, uint32_t>(buffer, count);
+}
+
+STATISTICS_KERNEL static Moments accumulate16(const uint16_t *buffer, size_t count)
+{
+    return accumulate<uint16_t, uint32_t, uint64_t>(buffer, count);
+}
+
+STATISTICS_KERNEL static Moments accumulate32(const uint32_t *buffer, size_t count)
+{
+    return accumulate<uint32_t, uint64_t, double>(buffer, count);
+}
+
+STATISTICS_KERNEL static Moments accumulate64(const uint64_t *buffer, size_t count)
+{
+    return accumulate<uint64_t, double, double>(buffer, count);
+}
+
+STATISTICS_KERNEL static Moments accumulateFloat(const float *buffer, size_t count)
+{
+    return accumulate<float, double, double>(buffer, count);
+}
+
+STATISTICS_KERNEL static Moments accumulateDouble(const double *buffer, size_t count)
+{
+    return accumulate<double, double, double>(buffer, count);
+}
+
+template <typename T>
+static double estimateMedian(const T *buffer, size_t count)
+{
+    // Use an odd stride so Bayer images are sampled across all color channels.
+    size_t step = std::max<size_t>(1, count / MEDIAN_SAMPLES);
+    if (step > 1 && step % 2 == 0)
+        step++;
+
+    std::vector<T> samples;
+    samples.reserve(count / step + 1);
+    for (size_t i = 0; i < count; i += step)
+        samples.push_back(buffer[i]);
+
+    auto middle = samples.begin() + samples.size() / 2;
+    std::nth_element(samples.begin(), middle, samples.end());
+    return *middle;
+}
+
+template <typename T>
+static ImageStatistics calculate(const T *buffer, size_t count, Moments (*kernel)(const T *, size_t))
+{
+    ImageStatistics statistics;
+    Moments moments = kernel(buffer, count);
+
+    statistics.min    = moments.min;
+    statistics.max    = moments.max;
+    statistics.mean   = moments.sum / count;
+    statistics.stddev = std::sqrt(std::max(0.0, moments.sumSquares / count - statistics.mean * statistics.mean));
+    statistics.median = estimateMedian(buffer, count);
+    return statistics;
+}
+
+ImageStatistics ImageStatistics::calculate(const void *buffer, size_t count, int bpp)
+{
+    if (buffer == nullptr || count == 0)
+        return ImageStatistics();
+
+    switch (bpp)
+    {
+        case 8:
+            return INDI::calculate(static_cast<const uint8_t *>(buffer), count, accumulate8);
+        case 16:
+            return INDI::calculate(static_cast<const uint16_t *>(buffer), count, accumulate16);
+        case 32:
+            return INDI::calculate(static_cast<const uint32_t *>(buffer), count, accumulate32);
+        case 64:
+            return INDI::calculate(static_cast<const uint64_t *>(buffer), count, accumulate64);
+        case -32:
+            return INDI::calculate(static_cast<const float *>(buffer), count, accumulateFloat);
+        case -64:
+            return INDI::calculate(static_cast<const double *>(buffer), count, accumulateDouble);
+    }
+
+    return ImageStatistics();
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Image Statistics
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace INDI
+{
+
+/**
+ * @brief The ImageStatistics struct holds basic statistics of an image buffer.
+ *
+ * Minimum, maximum, mean and standard deviation are computed in a single vectorized pass over the buffer. On x86-64
+ * Linux, an AVX2 version of each kernel is selected at runtime when the CPU supports it. The median is estimated from
+ * a subsample of at most 65536 pixels.
+ */
+struct ImageStatistics
+{
+    double min {0};
+    double max {0};
+    double mean {0};
+    double stddev {0};
+    double median {0};
+
+    /**
+     * @brief calculate Compute statistics of an image buffer.
+     * @param buffer pixel data.
+     * @param count number of pixels in buffer.
+     * @param bpp bits per pixel. 8, 16, 32 and 64 for unsigned integers, -32 for float and -64 for double.
+     * @return Statistics of the buffer. All values are zero if the buffer is empty or bpp is not supported.
+     */
+    static ImageStatistics calculate(const void *buffer, size_t count, int bpp);
+};
+
+}
@@ -0,0 +1,318 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Live Stacking
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "indilivestack.h"
+
+#include "dsp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace INDI
+{
+
+// Star detection levels and minimum star size, in pixels.
+static constexpr int STAR_LEVELS = 4;
+static constexpr int STAR_MIN_SIZE = 2;
+// Brightest stars used for matching, and the precision of the triangle side ratios.
+static constexpr int MATCH_STARS = 20;
+static constexpr int MATCH_DECIMALS = 2;
+// Minimum number of stars matched to accept a frame, and of the stars used for matching.
+static constexpr int MATCH_MIN = 3;
+static constexpr int MATCH_FRACTION = 3;
+// Frames of the same camera keep their scale, a larger change is a false match.
+static constexpr double MAX_SCALE_ERROR = 0.05;
+// Rows per parallel job.
+static constexpr uint32_t JOB_ROWS = 16;
+// Stacked values of a pixel needed before its outliers are clipped, fewer do not give a usable deviation.
+static constexpr uint16_t CLIP_MIN_FRAMES = 5;
+
+namespace
+{
+struct AccumulateJob
+{
+    const float *frame;
+    float *mean;
+    float *m2;
+    uint16_t *count;
+    uint32_t width;
+    uint32_t height;
+    float clip;
+    // Maps a reference pixel into the frame, the inverse of the transform found by dsp_align_get_offset.
+    bool identity;
+    double center[2];
+    double offset[2];
+    double cosine;
+    double sine;
+};
+
+// Bilinear sample at (x, y), false outside the frame.
+inline bool sample(const AccumulateJob *job, double x, double y, float &value)
+{
+    if (!(x >= 0 && y >= 0 && x <= job->width - 1 && y <= job->height - 1))
+        return false;
+
+    uint32_t x0 = std::min(static_cast<uint32_t>(x), job->width - 2);
+    uint32_t y0 = std::min(static_cast<uint32_t>(y), job->height - 2);
+    float fx = static_cast<float>(x - x0), fy = static_cast<float>(y - y0);
+    const float *p = job->frame + static_cast<size_t>(y0) * job->width + x0;
+    float top = p[0] + fx * (p[1] - p[0]);
+    float bottom = p[job->width] + fx * (p[job->width + 1] - p[job->width]);
+    value = top + fy * (bottom - top);
+    return true;
+}
+
+void accumulateRows(void *arg, int index, int)
+{
+    const AccumulateJob *job = static_cast<const AccumulateJob *>(arg);
+    uint32_t last = std::min(job->height, (index + 1) * JOB_ROWS);
+
+    for (uint32_t y = index * JOB_ROWS; y < last; y++)
+    {
+        size_t row = static_cast<size_t>(y) * job->width;
+        double ry = y - job->center[1] - job->offset[1];
+        for (uint32_t x = 0; x < job->width; x++)
+        {
+            float value;
+            if (job->identity)
+                value = job->frame[row + x];
+            else
+            {
+                double rx = x - job->center[0] - job->offset[0];
+                double fx = job->cosine * rx + job->sine * ry + job->center[0];
+                double fy = job->cosine * ry - job->sine * rx + job->center[1];
+                if (!sample(job, fx, fy, value))
+                    continue;
+            }
+
+            size_t i = row + x;
+            uint16_t n = job->count[i];
+            if (n == std::numeric_limits<uint16_t>::max())
+                continue;
+            if (n >= CLIP_MIN_FRAMES)
+            {
+                // The deviation of a few equal values is zero, and would clip every later one. It is never taken
+                // below the photon noise at unit gain, nor below the quantization step of one ADU.
+                float floor = std::sqrt(std::max(job->mean[i], 1.0f));
+                float sigma = std::max(std::sqrt(job->m2[i] / (n - 1)), floor);
+                if (std::fabs(value - job->mean[i]) > job->clip * sigma)
+                    continue;
+            }
+
+            // Welford update
+            n++;
+            float delta = value - job->mean[i];
+            job->mean[i] += delta / n;
+            job->m2[i] += delta * (value - job->mean[i]);
+            job->count[i] = n;
+        }
+    }
+}
+}
+
+LiveStack::LiveStack()
+{
+}
+
+LiveStack::~LiveStack()
+{
+    freeStream(m_FrameStream);
+    freeStream(m_Reference);
+}
+
+dsp_stream_t *LiveStack::newStream(uint32_t width, uint32_t height)
+{
+    dsp_stream_p stream = dsp_stream_new();
+    dsp_stream_add_dim(stream, width);
+    dsp_stream_add_dim(stream, height);
+    return stream;
+}
+
+void LiveStack::freeStream(dsp_stream_t *stream)
+{
+    if (stream == nullptr)
+        return;
+
+    // The streams only borrow the frame while it is searched, libdsp does not free their align information
+    free(stream->align_info.offset);
+    free(stream->align_info.center);
+    free(stream->align_info.radians);
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
+
+void LiveStack::reset()
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_HasReference = false;
+    m_Stacked = m_Rejected = 0;
+    m_Mean.clear();
+    m_M2.clear();
+    m_Count.clear();
+}
+
+bool LiveStack::add(const void *buffer, uint32_t width, uint32_t height, int bpp)
+{
+    if (buffer == nullptr || width < 2 || height < 2)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_Lock);
+
+    size_t pixels = static_cast<size_t>(width) * height;
+    m_Frame.resize(pixels);
+    switch (bpp)
+    {
+        case 8:
+            std::copy_n(static_cast<const uint8_t *>(buffer), pixels, m_Frame.begin());
+            break;
+        case 16:
+            std::copy_n(static_cast<const uint16_t *>(buffer), pixels, m_Frame.begin());
+            break;
+        case 32:
+            std::copy_n(static_cast<const uint32_t *>(buffer), pixels, m_Frame.begin());
+            break;
+        case -32:
+            std::copy_n(static_cast<const float *>(buffer), pixels, m_Frame.begin());
+            break;
+        default:
+            return false;
+    }
+
+    if (width != m_Width || height != m_Height)
+    {
+        freeStream(m_FrameStream);
+        freeStream(m_Reference);
+        m_FrameStream = newStream(width, height);
+        m_Reference = newStream(width, height);
+        m_HasReference = false;
+        m_Stacked = m_Rejected = 0;
+        m_Width = width;
+        m_Height = height;
+    }
+
+    dsp_stream_set_typed_buffer(m_FrameStream, m_Frame.data(), dsp_type_float);
+    int stars = dsp_align_find_stars(m_FrameStream, STAR_LEVELS, STAR_MIN_SIZE, m_Threshold, nullptr);
+    dsp_stream_set_typed_buffer(m_FrameStream, nullptr, dsp_type_float);
+    if (stars < MATCH_MIN)
+    {
+        m_Rejected++;
+        return false;
+    }
+
+    if (!m_HasReference)
+    {
+        // The first frame with enough stars becomes the reference, only its stars are kept
+        std::swap(m_FrameStream, m_Reference);
+        m_HasReference = true;
+        m_Mean.assign(pixels, 0);
+        m_M2.assign(pixels, 0);
+        m_Count.assign(pixels, 0);
+        accumulate(m_Reference, true);
+        m_Stacked++;
+        return true;
+    }
+
+    int required = std::max(MATCH_MIN, std::min({stars, m_Reference->stars_count, MATCH_STARS}) / MATCH_FRACTION);
+    if (dsp_align_get_offset(m_Reference, m_FrameStream, MATCH_STARS, MATCH_DECIMALS) < required ||
+            std::fabs(m_FrameStream->align_info.factor - 1) > MAX_SCALE_ERROR)
+    {
+        m_Rejected++;
+        return false;
+    }
+
+    accumulate(m_FrameStream, false);
+    m_Stacked++;
+    return true;
+}
+
+void LiveStack::accumulate(const dsp_stream_t *frame, bool reference)
+{
+    AccumulateJob job;
+    job.frame = m_Frame.data();
+    job.mean = m_Mean.data();
+    job.m2 = m_M2.data();
+    job.count = m_Count.data();
+    job.width = m_Width;
+    job.height = m_Height;
+    job.clip = static_cast<float>(m_ClipSigma);
+    job.identity = reference;
+    if (!reference)
+    {
+        // A frame pixel q lands at factor * R(radians) * (q - center) + center + offset in the reference
+        const dsp_align_info &info = frame->align_info;
+        double factor = info.factor;
+        for (int d = 0; d < 2; d++)
+        {
+            job.center[d] = info.center[d];
+            job.offset[d] = info.offset[d];
+        }
+        job.cosine = std::cos(info.radians[0]) / factor;
+        job.sine = std::sin(info.radians[0]) / factor;
+    }
+
+    dsp_parallel_for(static_cast<int>((m_Height + JOB_ROWS - 1) / JOB_ROWS), accumulateRows, &job);
+}
+
+void LiveStack::image(std::vector<float> &image)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    image = m_Mean;
+}
+
+uint32_t LiveStack::width()
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_Width;
+}
+
+uint32_t LiveStack::height()
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_Height;
+}
+
+uint32_t LiveStack::stacked()
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_Stacked;
+}
+
+uint32_t LiveStack::rejected()
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_Rejected;
+}
+
+void LiveStack::setClipSigma(double sigma)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_ClipSigma = sigma;
+}
+
+void LiveStack::setThreshold(double threshold)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_Threshold = threshold;
+}
+
+}
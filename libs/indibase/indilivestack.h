@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    INDI Live Stacking
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct dsp_stream_t;
+
+namespace INDI
+{
+
+/**
+ * @brief The LiveStack class registers and averages a series of 2D frames.
+ *
+ * The stars of each frame are detected and matched against the stars of the first frame, the reference. The frame is
+ * then resampled into the reference coordinates and added to a running mean. From the sixth frame on, each pixel
+ * farther than the clip sigma from the mean of its previous values is left out, which removes satellite trails, hot
+ * pixels and cosmic rays. The deviation is at least the square root of the mean, values are in ADU. Frames whose
+ * stars do not match the reference are rejected.
+ *
+ * Frames are monochrome, resampling a Bayer frame would mix the colors of neighbouring pixels.
+ *
+ * All methods are thread safe.
+ */
+class LiveStack
+{
+    public:
+        LiveStack();
+        ~LiveStack();
+
+        LiveStack(const LiveStack &) = delete;
+        LiveStack &operator=(const LiveStack &) = delete;
+
+        /**
+         * @brief reset Drop the stack and the reference, the next frame becomes the new reference.
+         */
+        void reset();
+
+        /**
+         * @brief add Register a frame and add it to the stack. A frame of a different size resets the stack.
+         * @param buffer pixel data.
+         * @param width frame width.
+         * @param height frame height.
+         * @param bpp bits per pixel. 8, 16 and 32 for unsigned integers, -32 for float.
+         * @return True if the frame was stacked, false if it was rejected.
+         */
+        bool add(const void *buffer, uint32_t width, uint32_t height, int bpp);
+
+        /**
+         * @brief image Copy the stacked image.
+         * @param image receives width * height pixels, the mean of the stacked values of each pixel, or nothing if no
+         * frame is stacked yet. Pixels not covered by any frame are zero.
+         */
+        void image(std::vector<float> &image);
+
+        uint32_t width();
+        uint32_t height();
+
+        /** @return Number of frames stacked since the last reset. */
+        uint32_t stacked();
+        /** @return Number of frames rejected since the last reset. */
+        uint32_t rejected();
+
+        /** Set the clipping limit, in standard deviations of the stacked values of a pixel. */
+        void setClipSigma(double sigma);
+        /** Set the star detection threshold, in units of the background noise. */
+        void setThreshold(double threshold);
+
+    private:
+        void accumulate(const dsp_stream_t *frame, bool reference);
+        static dsp_stream_t *newStream(uint32_t width, uint32_t height);
+        static void freeStream(dsp_stream_t *stream);
+
+        std::mutex m_Lock;
+        uint32_t m_Width {0};
+        uint32_t m_Height {0};
+        uint32_t m_Stacked {0};
+        uint32_t m_Rejected {0};
+        double m_ClipSigma {3};
+        double m_Threshold {5};
+
+        // Frame converted to float, and the streams holding the stars of the frame and of the reference
+        std::vector<float> m_Frame;
+        dsp_stream_t *m_FrameStream {nullptr};
+        dsp_stream_t *m_Reference {nullptr};
+        bool m_HasReference {false};
+
+        // Running mean, sum of squared deviations and count of the values of each pixel
+        std::vector<float> m_Mean;
+        std::vector<float> m_M2;
+        std::vector<uint16_t> m_Count;
+};
+
+}
@@ -27,6 +27,7 @@
 #include "stream/streammanager.h"
 #include "locale_compat.h"
 #include "indiutility.h"
+#include "indiimagestatistics.h"
 
 #include <fitsio.h>
 
@@ -34,9 +35,6 @@
 #include <libnova/ln_types.h>
 #include <libnova/precession.h>
 
-#include <regex>
-
-#include <dirent.h>
 #include <cerrno>
 #include <locale.h>
 #include <cstdlib>
@@ -663,11 +661,13 @@ void SensorInterface::addFITSKeywords(fitsfile *fptr, uint8_t* buf, int len)
 #ifdef WITH_MINMAX
     if (getNAxis() == 2)
     {
-        double min_val, max_val;
-        getMinMax(&min_val, &max_val, buf, len, getBPS());
+        ImageStatistics statistics = ImageStatistics::calculate(buf, len, getBPS());
 
-        fits_update_key_s(fptr, TDOUBLE, "DATAMIN", &min_val, "Minimum value", &status);
-        fits_update_key_s(fptr, TDOUBLE, "DATAMAX", &max_val, "Maximum value", &status);
+        fits_update_key_s(fptr, TDOUBLE, "DATAMIN", &statistics.min, "Minimum value", &status);
+        fits_update_key_s(fptr, TDOUBLE, "DATAMAX", &statistics.max, "Maximum value", &status);
+        fits_update_key_s(fptr, TDOUBLE, "DATAMEAN", &statistics.mean, "Mean value", &status);
+        fits_update_key_s(fptr, TDOUBLE, "DATASTD", &statistics.stddev, "Standard deviation", &status);
+        fits_update_key_s(fptr, TDOUBLE, "DATAMED", &statistics.median, "Median value (estimate)", &status);
     }
 #endif
 
@@ -872,10 +872,9 @@ bool SensorInterface::IntegrationComplete()
 
     if(HasDSP())
     {
-        uint8_t* buf = (uint8_t*)malloc(getBufferSize());
-        memcpy(buf, getBuffer(), getBufferSize());
-        DSP->processBLOB(buf, 1, new int[1] { getBufferSize() * 8 / getBPS() }, getBPS());
-        free(buf);
+        // The plugins only read the buffer
+        int sizes[1] = { getBufferSize() * 8 / getBPS() };
+        DSP->processBLOB(getBuffer(), 1, sizes, getBPS());
     }
     // Run async
     std::thread(&SensorInterface::IntegrationCompletePrivate, this).detach();
@@ -948,41 +947,22 @@ bool SensorInterface::uploadFile(const void *fitsData, size_t totalBytes, bool s
         FILE *fp = nullptr;
         char integrationFileName[MAXRBUF];
 
-        std::string prefix = UploadSettingsT[UPLOAD_PREFIX].text;
-        int maxIndex       = getFileIndex(UploadSettingsT[UPLOAD_DIR].text, UploadSettingsT[UPLOAD_PREFIX].text,
-                                          FitsB.format);
-
-        if (maxIndex < 0)
+        std::string fileName = m_FileIndex.nextFileName(UploadSettingsT[UPLOAD_DIR].text,
+                               UploadSettingsT[UPLOAD_PREFIX].text, FitsB.format);
+        if (fileName.empty())
         {
-            DEBUGF(Logger::DBG_ERROR, "Error iterating directory %s. %s", UploadSettingsT[0].text,
+            DEBUGF(Logger::DBG_ERROR, "Error iterating directory %s. %s", UploadSettingsT[UPLOAD_DIR].text,
                    strerror(errno));
             return false;
         }
 
-        if (maxIndex > 0)
-        {
-            char ts[32];
-            struct tm *tp;
-            time_t t;
-            time(&t);
-            tp = localtime(&t);
-            strftime(ts, sizeof(ts), "%Y-%m-%dT%H-%M-%S", tp);
-            std::string filets(ts);
-            prefix = std::regex_replace(prefix, std::regex("ISO8601"), filets);
-
-            char indexString[8];
-            snprintf(indexString, 8, "%03d", maxIndex);
-            std::string prefixIndex = indexString;
-            //prefix.replace(prefix.find("XXX"), std::string::npos, prefixIndex);
-            prefix = std::regex_replace(prefix, std::regex("XXX"), prefixIndex);
-        }
-
-        snprintf(integrationFileName, MAXRBUF, "%s/%s%s", UploadSettingsT[0].text, prefix.c_str(), FitsB.format);
+        snprintf(integrationFileName, MAXRBUF, "%s", fileName.c_str());
 
         fp = fopen(integrationFileName, "w");
         if (fp == nullptr)
         {
             DEBUGF(Logger::DBG_ERROR, "Unable to save image file (%s). %s", integrationFileName, strerror(errno));
+            m_FileIndex.invalidate();
             return false;
         }
 
@@ -1045,183 +1025,6 @@ bool SensorInterface::saveConfigItems(FILE *fp)
     return true;
 }
 
-void SensorInterface::getMinMax(double *min, double *max, uint8_t *buf, int len, int bpp)
-{
-    int ind         = 0, i, j;
-    int integrationHeight = 1;
-    int integrationWidth  = len;
-    double lmin = 0, lmax = 0;
-
-    switch (bpp)
-    {
-        case 8:
-        {
-            uint8_t *integrationBuffer = static_cast<uint8_t *>(buf);
-            lmin = lmax = integrationBuffer[0];
-
-            for (i = 0; i < integrationHeight; i++)
-                for (j = 0; j < integrationWidth; j++)
-                {
-                    ind = (i * integrationWidth) + j;
-                    if (integrationBuffer[ind] < lmin)
-                        lmin = integrationBuffer[ind];
-                    else if (integrationBuffer[ind] > lmax)
-                        lmax = integrationBuffer[ind];
-                }
-        }
-        break;
-
-        case 16:
-        {
-            uint16_t *integrationBuffer = reinterpret_cast<uint16_t *>(buf);
-            lmin = lmax = integrationBuffer[0];
-
-            for (i = 0; i < integrationHeight; i++)
-                for (j = 0; j < integrationWidth; j++)
-                {
-                    ind = (i * integrationWidth) + j;
-                    if (integrationBuffer[ind] < lmin)
-                        lmin = integrationBuffer[ind];
-                    else if (integrationBuffer[ind] > lmax)
-                        lmax = integrationBuffer[ind];
-                }
-        }
-        break;
-
-        case 32:
-        {
-            uint32_t *integrationBuffer = reinterpret_cast<uint32_t *>(buf);
-            lmin = lmax = integrationBuffer[0];
-
-            for (i = 0; i < integrationHeight; i++)
-                for (j = 0; j < integrationWidth; j++)
-                {
-                    ind = (i * integrationWidth) + j;
-                    if (integrationBuffer[ind] < lmin)
-                        lmin = integrationBuffer[ind];
-                    else if (integrationBuffer[ind] > lmax)
-                        lmax = integrationBuffer[ind];
-                }
-        }
-        break;
-
-        case 64:
-        {
-            unsigned long *integrationBuffer = reinterpret_cast<unsigned long *>(buf);
-            lmin = lmax = integrationBuffer[0];
-
-            for (i = 0; i < integrationHeight; i++)
-                for (j = 0; j < integrationWidth; j++)
-                {
-                    ind = (i * integrationWidth) + j;
-                    if (integrationBuffer[ind] < lmin)
-                        lmin = integrationBuffer[ind];
-                    else if (integrationBuffer[ind] > lmax)
-                        lmax = integrationBuffer[ind];
-                }
-        }
-        break;
-
-        case -32:
-        {
-            double *integrationBuffer = reinterpret_cast<double *>(buf);
-            lmin = lmax = integrationBuffer[0];
-
-            for (i = 0; i < integrationHeight; i++)
-                for (j = 0; j < integrationWidth; j++)
-                {
-                    ind = (i * integrationWidth) + j;
-                    if (integrationBuffer[ind] < lmin)
-                        lmin = integrationBuffer[ind];
-                    else if (integrationBuffer[ind] > lmax)
-                        lmax = integrationBuffer[ind];
-                }
-        }
-        break;
-
-        case -64:
-        {
-            double *integrationBuffer = reinterpret_cast<double *>(buf);
-            lmin = lmax = integrationBuffer[0];
-
-            for (i = 0; i < integrationHeight; i++)
-                for (j = 0; j < integrationWidth; j++)
-                {
-                    ind = (i * integrationWidth) + j;
-                    if (integrationBuffer[ind] < lmin)
-                        lmin = integrationBuffer[ind];
-                    else if (integrationBuffer[ind] > lmax)
-                        lmax = integrationBuffer[ind];
-                }
-        }
-        break;
-    }
-    *min = lmin;
-    *max = lmax;
-}
-
-std::string regex_replace_compat2(const std::string &input, const std::string &pattern, const std::string &replace)
-{
-    std::stringstream s;
-    std::regex_replace(std::ostreambuf_iterator<char>(s), input.begin(), input.end(), std::regex(pattern), replace);
-    return s.str();
-}
-
-int SensorInterface::getFileIndex(const char *dir, const char *prefix, const char *ext)
-{
-    INDI_UNUSED(ext);
-
-    DIR *dpdf = nullptr;
-    struct dirent *epdf = nullptr;
-    std::vector<std::string> files = std::vector<std::string>();
-
-    std::string prefixIndex = prefix;
-    prefixIndex             = regex_replace_compat2(prefixIndex, "_ISO8601", "");
-    prefixIndex             = regex_replace_compat2(prefixIndex, "_XXX", "");
-
-    // Create directory if does not exist
-    struct stat st;
-
-    if (stat(dir, &st) == -1)
-    {
-        LOGF_DEBUG("Creating directory %s...", dir);
-        if (INDI::mkpath(dir, 0755) == -1)
-            LOGF_ERROR("Error creating directory %s (%s)", dir, strerror(errno));
-    }
-
-    dpdf = opendir(dir);
-    if (dpdf != nullptr)
-    {
-        while ((epdf = readdir(dpdf)))
-        {
-            if (strstr(epdf->d_name, prefixIndex.c_str()))
-                files.push_back(epdf->d_name);
-        }
-        closedir(dpdf);
-    }
-    else
-        return -1;
-
-    int maxIndex = 0;
-
-    for (int i = 0; i < static_cast<int>(files.size()); i++)
-    {
-        int index = -1;
-
-        std::string file  = files.at(i);
-        std::size_t start = file.find_last_of("_");
-        std::size_t end   = file.find_last_of(".");
-        if (start != std::string::npos)
-        {
-            index = atoi(file.substr(start + 1, end).c_str());
-            if (index > maxIndex)
-                maxIndex = index;
-        }
-    }
-
-    return (maxIndex + 1);
-}
-
 void SensorInterface::setBPS(int bps)
 {
     BPS = bps;
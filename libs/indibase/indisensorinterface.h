@@ -22,6 +22,7 @@
 #include "dsp.h"
 #include "dsp/manager.h"
 #include "stream/streammanager.h"
+#include "indifileindex.h"
 #include <fitsio.h>
 
 #ifdef HAVE_WEBSOCKET
@@ -531,8 +532,7 @@ protected:
         char integrationExtention[MAXINDIBLOBFMT];
 
         bool uploadFile(const void *fitsData, size_t totalBytes, bool sendIntegration, bool saveIntegration);
-        void getMinMax(double *min, double *max, uint8_t *buf, int len, int bpp);
-        int getFileIndex(const char *dir, const char *prefix, const char *ext);
+        FileIndex m_FileIndex;
 
         bool IntegrationCompletePrivate();
         void* sendFITS(uint8_t* buf, int len);
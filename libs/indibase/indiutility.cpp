@@ -21,7 +21,14 @@
 
 */
 #include "indiutility.h"
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace INDI
 {
@@ -61,6 +68,51 @@ int mkpath(std::string s, mode_t mode)
     return mdret;
 }
 
+int write_file(const std::string &path, const void *data, size_t size, bool sync)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return -1;
+
+#ifdef __linux__
+    // Reserve the space up front so the file is laid out in one extent. Not all file systems support it.
+    if (size > 0 && fallocate(fd, 0, 0, size) != 0 && errno != EOPNOTSUPP && errno != ENOSYS)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+#endif
+
+    const char *buffer = static_cast<const char *>(data);
+    size_t offset = 0;
+    while (offset < size)
+    {
+        ssize_t n = pwrite(fd, buffer + offset, size - offset, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            int error = (n == 0) ? EIO : errno;
+            close(fd);
+            errno = error;
+            return -1;
+        }
+        offset += n;
+    }
+
+#ifdef __linux__
+    int ret = sync ? fdatasync(fd) : 0;
+#else
+    int ret = sync ? fsync(fd) : 0;
+#endif
+
+    if (close(fd) != 0)
+        ret = -1;
+    return ret;
+}
+
 std::string format_time(const std::tm &tm, const char *format)
 {
     char cstr[32];
@@ -80,4 +132,26 @@ void replace_all(std::string &subject, const std::string& search, const std::str
     }
 }
 
+void parallel_for(size_t count, size_t threads, const std::function<void(size_t)> &job)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::atomic<size_t> next {0};
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+            job(i);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::min(count, threads); i++)
+        workers.emplace_back(worker);
+
+    worker();
+
+    for (auto &thread : workers)
+        thread.join();
+}
+
 }
@@ -25,6 +25,8 @@
 #include <string>
 #include <sys/stat.h>
 #include <ctime>
+#include <cstddef>
+#include <functional>
 
 #include "indimacros.h"
 
@@ -37,6 +39,14 @@ namespace INDI
  */
 #ifndef _WINDOWS
 int mkpath(std::string path, mode_t mode);
+
+/**
+ * @brief Writes 'size' bytes of 'data' to a new or truncated file at 'path'.
+ * The file is preallocated to its final size and written with pwrite, without stdio buffering. If 'sync' is true,
+ * the data is flushed to the storage device before returning.
+ * @return 0 on success, -1 on error with errno set.
+ */
+int write_file(const std::string &path, const void *data, size_t size, bool sync = false);
 #endif
 /**
  * @brief Converts the date and time to string - this function uses 'strftime'
@@ -48,4 +58,11 @@ std::string format_time(const std::tm &tm, const char *format);
  */
 void replace_all(std::string &subject, const std::string &search, const std::string &replace);
 
+/**
+ * @brief Calls job(0) .. job(count - 1) on up to 'threads' threads, including the calling thread.
+ * Jobs are handed out one at a time, so uneven jobs are balanced across threads. If 'threads' is 0, the number
+ * of available cores is used.
+ */
+void parallel_for(size_t count, size_t threads, const std::function<void(size_t)> &job);
+
 }
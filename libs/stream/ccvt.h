@@ -84,6 +84,15 @@ extern "C" {
 
 /*@{*/
 
+/**
+ * @brief ccvt_set_parallel Select the row-parallel execution mode.
+ * When enabled, which is the default, the YUV and Bayer conversions split the frame in bands of rows and convert
+ * them on the libdsp thread pool. When disabled, they run on the calling thread only.
+ */
+void ccvt_set_parallel(int enable);
+/** @return Non-zero if the conversions run on the libdsp thread pool. */
+int ccvt_get_parallel(void);
+
 /** 4:2:0 YUV planar to RGB/BGR     */
 void ccvt_420p_bgr24(int width, int height, const void *src, void *dst);
 /** 4:2:0 YUV planar to RGB/BGR     */
@@ -94,7 +103,7 @@ void ccvt_420p_bgr32(int width, int height, const void *src, void *dst);
 void ccvt_420p_rgb32(int width, int height, const void *src, void *dst);
 
 /** 4:2:2 YUYV interlaced to RGB/BGR */
-//void ccvt_yuyv_rgb32(int width, int height, const void *src, void *dst);
+void ccvt_yuyv_rgb32(int width, int height, const void *src, void *dst);
 /** 4:2:2 YUYV interlaced to RGB/BGR */
 void ccvt_yuyv_bgr32(int width, int height, const void *src, void *dst);
 /** 4:2:2 YUYV interlaced to BGR24 */
@@ -178,6 +187,34 @@ int mjpegtoyuv420p(unsigned char *map, unsigned char *cap_map, int width, int he
  * SUCH DAMAGE.
  */
 
+/** Colour filter array layouts, named after the top left 2x2 block of the sensor */
+enum ccvt_bayer_pattern
+{
+    CCVT_BAYER_RGGB,
+    CCVT_BAYER_GRBG,
+    CCVT_BAYER_GBRG,
+    CCVT_BAYER_BGGR
+};
+
+/** Demosaicing methods */
+enum ccvt_bayer_method
+{
+    /** Average of the nearest samples of each colour, the fastest */
+    CCVT_BAYER_BILINEAR,
+    /** Variable Number of Gradients, interpolates along the smoothest directions and keeps edges sharp */
+    CCVT_BAYER_VNG
+};
+
+/**
+ * @brief ccvt_bayer8_rgb24 Demosaic an 8 bit Bayer frame to RGB 24.
+ * Frames smaller than 2x2 are not converted, VNG falls back to bilinear on frames smaller than 3x3.
+ * @param pattern one of ccvt_bayer_pattern.
+ * @param method one of ccvt_bayer_method.
+ */
+void ccvt_bayer8_rgb24(int width, int height, int pattern, int method, const void *src, void *dst);
+/** @brief ccvt_bayer16_rgb48 Demosaic a 16 bit Bayer frame to 16 bit RGB, see ccvt_bayer8_rgb24 */
+void ccvt_bayer16_rgb48(int width, int height, int pattern, int method, const void *src, void *dst);
+
 /** Bayer 8bit to RGB 24 */
 void bayer2rgb24(unsigned char *dst, unsigned char *src, long int WIDTH, long int HEIGHT);
 /** Bayer 16 bit to RGB 24 */
@@ -0,0 +1,430 @@
+/*  CCVT: ColourConVerT: simple library for converting colourspaces
+    Bayer demosaicing
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "ccvt.h"
+#include "ccvt_parallel.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Rows per parallel job */
+#define CCVT_BAYER_JOB_ROWS 16
+/* Border of the row window, VNG reads samples two pixels away */
+#define CCVT_BAYER_PAD 2
+
+#define CCVT_RED   0
+#define CCVT_GREEN 1
+#define CCVT_BLUE  2
+
+/* Colours of the top left 2x2 block of each ccvt_bayer_pattern, in row order */
+static const uint8_t ccvt_bayer_cfa[4][4] =
+{
+    { CCVT_RED, CCVT_GREEN, CCVT_GREEN, CCVT_BLUE },
+    { CCVT_GREEN, CCVT_RED, CCVT_BLUE, CCVT_GREEN },
+    { CCVT_GREEN, CCVT_BLUE, CCVT_RED, CCVT_GREEN },
+    { CCVT_BLUE, CCVT_GREEN, CCVT_GREEN, CCVT_RED }
+};
+
+/* VNG directions, clockwise from north */
+static const int ccvt_vng_dir[8][2] =
+{
+    { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }
+};
+
+typedef struct
+{
+    int width;
+    int height;
+    /* 8 or 16 bits per sample */
+    int depth;
+    int method;
+    const uint8_t *cfa;
+    const void *src;
+    void *dst;
+    /* Row length of the window, the right border is CCVT_LANES samples wider so that the kernels only run full blocks */
+    int stride;
+    /* Per thread window of the job rows and CCVT_BAYER_PAD rows around them, with mirrored borders */
+    uint16_t **window;
+    /* Per thread bilinear estimates of VNG, one plane per colour */
+    int32_t **estimate;
+} ccvt_bayer_job;
+
+/* Mirror about the edge samples, which keeps the colour of the filter array */
+static inline int ccvt_bayer_mirror(int x, int n)
+{
+    if (x < 0)
+        x = -x;
+    if (x >= n)
+        x = 2 * (n - 1) - x;
+    return x < 0 ? 0 : (x >= n ? n - 1 : x);
+}
+
+static inline int ccvt_bayer_colour(const ccvt_bayer_job *job, int x, int y)
+{
+    return job->cfa[(y & 1) * 2 + (x & 1)];
+}
+
+static inline void ccvt_bayer_widen(const uint8_t *__restrict s, uint16_t *__restrict w, int count)
+{
+    int x = 0, l;
+
+    for (; x + CCVT_LANES <= count; x += CCVT_LANES)
+        for (l = 0; l < CCVT_LANES; l++)
+            w[x + l] = s[x + l];
+    for (; x < count; x++)
+        w[x] = s[x];
+}
+
+/* Copy the rows [first - CCVT_BAYER_PAD, last + CCVT_BAYER_PAD) to the window */
+static CCVT_KERNEL void ccvt_bayer_fill(const ccvt_bayer_job *job, uint16_t *window, int first, int last)
+{
+    int r, x;
+
+    for (r = 0; r < last - first + 2 * CCVT_BAYER_PAD; r++)
+    {
+        int y = ccvt_bayer_mirror(first - CCVT_BAYER_PAD + r, job->height);
+        uint16_t *w = window + r * job->stride + CCVT_BAYER_PAD;
+
+        if (job->depth == 8)
+            ccvt_bayer_widen((const uint8_t *)job->src + (size_t)y * job->width, w, job->width);
+        else
+            memcpy(w, (const uint16_t *)job->src + (size_t)y * job->width, job->width * sizeof(uint16_t));
+
+        for (x = 1; x <= CCVT_BAYER_PAD; x++)
+        {
+            w[-x] = w[ccvt_bayer_mirror(-x, job->width)];
+            w[job->width - 1 + x] = w[ccvt_bayer_mirror(job->width - 1 + x, job->width)];
+        }
+    }
+}
+
+/* Interleave count pixels of the planar channels into the output row */
+static inline void ccvt_bayer_store(const ccvt_bayer_job *job, const uint16_t *R, const uint16_t *G,
+                                    const uint16_t *B, int y, int x, int count)
+{
+    int l;
+
+    if (job->depth == 8)
+    {
+        uint8_t *d = (uint8_t *)job->dst + ((size_t)y * job->width + x) * 3;
+        for (l = 0; l < count; l++)
+        {
+            d[3 * l]     = R[l];
+            d[3 * l + 1] = G[l];
+            d[3 * l + 2] = B[l];
+        }
+    }
+    else
+    {
+        uint16_t *d = (uint16_t *)job->dst + ((size_t)y * job->width + x) * 3;
+        for (l = 0; l < count; l++)
+        {
+            d[3 * l]     = R[l];
+            d[3 * l + 1] = G[l];
+            d[3 * l + 2] = B[l];
+        }
+    }
+}
+
+/*
+ * Bilinear interpolation of a block of pixels of a row. The pixels alternate between green and X, red or blue, and Y is
+ * the colour of the other rows. At the green pixels X is the mean of the left and right neighbours and Y of the ones
+ * above and below, at the X pixels G is the mean of the four nearest and Y of the four diagonal ones. All the means
+ * are computed for every pixel and selected by parity, which keeps the loads contiguous.
+ */
+static inline void ccvt_bayer_bilinear_block(const uint16_t *__restrict up, const uint16_t *__restrict cur,
+        const uint16_t *__restrict down, int greenOdd, uint16_t *__restrict X, uint16_t *__restrict G,
+        uint16_t *__restrict Y)
+{
+    int l;
+
+    for (l = 0; l < CCVT_LANES; l++)
+    {
+        int own   = cur[l];
+        int cross = (cur[l - 1] + cur[l + 1] + up[l] + down[l]) / 4;
+        int diag  = (up[l - 1] + up[l + 1] + down[l - 1] + down[l + 1]) / 4;
+        int horizontal = (cur[l - 1] + cur[l + 1]) / 2;
+        int vertical   = (up[l] + down[l]) / 2;
+        /* All ones on green pixels, a branchless select */
+        int green = -((l & 1) == greenOdd);
+        G[l] = (own & green) | (cross & ~green);
+        X[l] = (horizontal & green) | (own & ~green);
+        Y[l] = (vertical & green) | (diag & ~green);
+    }
+}
+
+static CCVT_KERNEL void ccvt_bayer_bilinear_row(const ccvt_bayer_job *job, const uint16_t *cur, int y)
+{
+    uint16_t X[CCVT_LANES], G[CCVT_LANES], Y[CCVT_LANES];
+    /* Blocks start on even columns, so that the colour of their first pixel is the one of column 0 */
+    int greenOdd = job->cfa[(y & 1) * 2] != CCVT_GREEN;
+    int redX = job->cfa[(y & 1) * 2 + !greenOdd] == CCVT_RED;
+    int x, n;
+
+    for (x = 0; x < job->width; x += n)
+    {
+        n = job->width - x < CCVT_LANES ? job->width - x : CCVT_LANES;
+        ccvt_bayer_bilinear_block(cur + x - job->stride, cur + x, cur + x + job->stride, greenOdd, X, G, Y);
+        ccvt_bayer_store(job, redX ? X : Y, G, redX ? Y : X, y, x, n);
+    }
+}
+
+/* Four times the bilinear estimate of each colour at the pixels [-1, width + 1) of a row */
+static void ccvt_bayer_estimate_row(const ccvt_bayer_job *job, const uint16_t *cur, int y, int32_t *E[3])
+{
+    const uint16_t *up = cur - job->stride, *down = cur + job->stride;
+    int x;
+
+    for (x = -1; x <= job->width; x++)
+    {
+        int c = ccvt_bayer_colour(job, x, y);
+        if (c == CCVT_GREEN)
+        {
+            int h = ccvt_bayer_colour(job, x + 1, y);
+            E[CCVT_GREEN][x] = 4 * cur[x];
+            E[h][x] = 2 * (cur[x - 1] + cur[x + 1]);
+            E[2 - h][x] = 2 * (up[x] + down[x]);
+        }
+        else
+        {
+            E[c][x] = 4 * cur[x];
+            E[CCVT_GREEN][x] = cur[x - 1] + cur[x + 1] + up[x] + down[x];
+            E[2 - c][x] = up[x - 1] + up[x + 1] + down[x - 1] + down[x + 1];
+        }
+    }
+}
+
+/*
+ * Variable Number of Gradients (Chang, Cheung and Pang, 1999), on a block of pixels of one row. Each of the eight
+ * directions gets a gradient, the sum of the differences of same colour samples along it. The directions whose
+ * gradient is below 1.5 times the smallest plus half the spread are the smooth ones. The missing colours of the
+ * pixel are its own value plus the mean colour difference of the bilinear estimates at its neighbours in those
+ * directions.
+ */
+static inline void ccvt_bayer_vng_gradient(const uint16_t *__restrict cur, int o1, int oq, int32_t *__restrict grad)
+{
+    int l;
+
+    for (l = 0; l < CCVT_LANES; l++)
+        grad[l] = 2 * abs(cur[l + o1] - cur[l - o1]) + 2 * abs(cur[l + 2 * o1] - cur[l]) +
+                  abs(cur[l + o1 + oq] - cur[l - o1 + oq]) + abs(cur[l + o1 - oq] - cur[l - o1 - oq]);
+}
+
+static CCVT_KERNEL void ccvt_bayer_vng_block(const ccvt_bayer_job *job, const uint16_t *__restrict cur,
+                                        int32_t *const E[3], int c0, int c1, int max,
+                                        uint16_t *__restrict R, uint16_t *__restrict G, uint16_t *__restrict B)
+{
+    int32_t grad[8][CCVT_LANES], lo[CCVT_LANES], hi[CCVT_LANES], limit[CCVT_LANES];
+    int32_t S[3][CCVT_LANES], n[CCVT_LANES];
+    int32_t even[3], odd[3];
+    int d, k, l;
+
+    for (d = 0; d < 8; d++)
+        ccvt_bayer_vng_gradient(cur, ccvt_vng_dir[d][1] * job->stride + ccvt_vng_dir[d][0],
+                                ccvt_vng_dir[d][0] * job->stride - ccvt_vng_dir[d][1], grad[d]);
+
+    for (l = 0; l < CCVT_LANES; l++)
+        lo[l] = hi[l] = grad[0][l];
+    for (d = 1; d < 8; d++)
+    {
+        for (l = 0; l < CCVT_LANES; l++)
+        {
+            lo[l] = grad[d][l] < lo[l] ? grad[d][l] : lo[l];
+            hi[l] = grad[d][l] > hi[l] ? grad[d][l] : hi[l];
+        }
+    }
+    for (l = 0; l < CCVT_LANES; l++)
+    {
+        limit[l] = lo[l] + lo[l] / 2 + (hi[l] - lo[l]) / 2;
+        S[0][l] = S[1][l] = S[2][l] = n[l] = 0;
+    }
+
+    /* Masks are all ones or zero, the selects are branchless */
+    for (d = 0; d < 8; d++)
+    {
+        const int32_t *E0 = E[0] + ccvt_vng_dir[d][1] * job->stride + ccvt_vng_dir[d][0];
+        const int32_t *E1 = E[1] + ccvt_vng_dir[d][1] * job->stride + ccvt_vng_dir[d][0];
+        const int32_t *E2 = E[2] + ccvt_vng_dir[d][1] * job->stride + ccvt_vng_dir[d][0];
+        for (l = 0; l < CCVT_LANES; l++)
+        {
+            int32_t on = -(grad[d][l] <= limit[l]);
+            n[l] -= on;
+            S[0][l] += E0[l] & on;
+            S[1][l] += E1[l] & on;
+            S[2][l] += E2[l] & on;
+        }
+    }
+
+    /* The colour of the pixels alternates between c0 and c1 */
+    for (k = 0; k < 3; k++)
+    {
+        even[k] = -(c0 == k);
+        odd[k]  = -(c1 == k);
+    }
+    for (l = 0; l < CCVT_LANES; l++)
+    {
+        int32_t parity = -(l & 1);
+        int32_t own = (S[0][l] & ((odd[0] & parity) | (even[0] & ~parity))) |
+                      (S[1][l] & ((odd[1] & parity) | (even[1] & ~parity))) |
+                      (S[2][l] & ((odd[2] & parity) | (even[2] & ~parity)));
+        /* The difference of the own colour is zero, which keeps the sample */
+        float scale = 1.0f / (4 * n[l]);
+        int32_t v = cur[l];
+        int32_t r = v + (int32_t)((S[0][l] - own) * scale);
+        int32_t g = v + (int32_t)((S[1][l] - own) * scale);
+        int32_t b = v + (int32_t)((S[2][l] - own) * scale);
+        r = r < 0 ? 0 : r;
+        g = g < 0 ? 0 : g;
+        b = b < 0 ? 0 : b;
+        R[l] = r > max ? max : r;
+        G[l] = g > max ? max : g;
+        B[l] = b > max ? max : b;
+    }
+}
+
+static void ccvt_bayer_vng_row(const ccvt_bayer_job *job, const uint16_t *cur, int y,
+        int32_t *const E[3])
+{
+    uint16_t R[CCVT_LANES], G[CCVT_LANES], B[CCVT_LANES];
+    int max = job->depth == 8 ? 255 : 65535;
+    int c0 = ccvt_bayer_colour(job, 0, y), c1 = ccvt_bayer_colour(job, 1, y);
+    int x, n;
+
+    /* Blocks start on even columns, so that the colour of their first pixel is the one of column 0 */
+    for (x = 0; x < job->width; x += n)
+    {
+        int32_t *const e[3] = { E[0] + x, E[1] + x, E[2] + x };
+        n = job->width - x < CCVT_LANES ? job->width - x : CCVT_LANES;
+        ccvt_bayer_vng_block(job, cur + x, e, c0, c1, max, R, G, B);
+        ccvt_bayer_store(job, R, G, B, y, x, n);
+    }
+}
+
+static void ccvt_bayer_rows(void *arg, int index, int thread)
+{
+    const ccvt_bayer_job *job = (const ccvt_bayer_job *)arg;
+    uint16_t *window = job->window[thread];
+    int first = index * CCVT_BAYER_JOB_ROWS;
+    int last = first + CCVT_BAYER_JOB_ROWS < job->height ? first + CCVT_BAYER_JOB_ROWS : job->height;
+    int y;
+
+    ccvt_bayer_fill(job, window, first, last);
+
+    if (job->method == CCVT_BAYER_VNG)
+    {
+        /* The estimates cover the rows [first - 1, last] and the columns [-1, width], with the layout of the window */
+        size_t plane = (size_t)job->stride * (CCVT_BAYER_JOB_ROWS + 2);
+        int32_t *E[3];
+        for (y = first - 1; y <= last; y++)
+        {
+            E[0] = job->estimate[thread] + (y - first + 1) * job->stride + CCVT_BAYER_PAD;
+            E[1] = E[0] + plane;
+            E[2] = E[1] + plane;
+            ccvt_bayer_estimate_row(job, window + (y - first + CCVT_BAYER_PAD) * job->stride + CCVT_BAYER_PAD, y, E);
+        }
+        for (y = first; y < last; y++)
+        {
+            E[0] = job->estimate[thread] + (y - first + 1) * job->stride + CCVT_BAYER_PAD;
+            E[1] = E[0] + plane;
+            E[2] = E[1] + plane;
+            ccvt_bayer_vng_row(job, window + (y - first + CCVT_BAYER_PAD) * job->stride + CCVT_BAYER_PAD, y, E);
+        }
+        return;
+    }
+
+    for (y = first; y < last; y++)
+        ccvt_bayer_bilinear_row(job, window + (y - first + CCVT_BAYER_PAD) * job->stride + CCVT_BAYER_PAD, y);
+}
+
+static void ccvt_bayer(int width, int height, int depth, int pattern, int method, const void *src, void *dst)
+{
+    ccvt_bayer_job job;
+    int parallel, threads, t;
+
+    if (width < 2 || height < 2 || pattern < CCVT_BAYER_RGGB || pattern > CCVT_BAYER_BGGR)
+        return;
+    /* The gradients of VNG need two samples on each side */
+    if (width < 3 || height < 3)
+        method = CCVT_BAYER_BILINEAR;
+
+    job.width    = width;
+    job.height   = height;
+    job.depth    = depth;
+    job.method   = method;
+    job.cfa      = ccvt_bayer_cfa[pattern];
+    job.src      = src;
+    job.dst      = dst;
+    job.stride   = width + 2 * CCVT_BAYER_PAD + CCVT_LANES;
+    job.estimate = NULL;
+
+    parallel   = ccvt_get_parallel();
+    threads    = ccvt_parallel_threads(parallel);
+    job.window = (uint16_t **)malloc(sizeof(uint16_t *) * threads);
+    if (method == CCVT_BAYER_VNG)
+        job.estimate = (int32_t **)malloc(sizeof(int32_t *) * threads);
+    for (t = 0; t < threads; t++)
+    {
+        /* Zeroed, the samples past the border are computed by the last block of each row but never stored */
+        job.window[t] = (uint16_t *)calloc((size_t)job.stride * (CCVT_BAYER_JOB_ROWS + 2 * CCVT_BAYER_PAD),
+                                           sizeof(uint16_t));
+        if (method == CCVT_BAYER_VNG)
+            job.estimate[t] = (int32_t *)calloc((size_t)3 * job.stride * (CCVT_BAYER_JOB_ROWS + 2), sizeof(int32_t));
+    }
+
+    ccvt_parallel_for(parallel, (height + CCVT_BAYER_JOB_ROWS - 1) / CCVT_BAYER_JOB_ROWS, ccvt_bayer_rows, &job);
+
+    for (t = 0; t < threads; t++)
+    {
+        free(job.window[t]);
+        if (method == CCVT_BAYER_VNG)
+            free(job.estimate[t]);
+    }
+    free(job.window);
+    free(job.estimate);
+}
+
+void ccvt_bayer8_rgb24(int width, int height, int pattern, int method, const void *src, void *dst)
+{
+    ccvt_bayer(width, height, 8, pattern, method, src, dst);
+}
+
+void ccvt_bayer16_rgb48(int width, int height, int pattern, int method, const void *src, void *dst)
+{
+    ccvt_bayer(width, height, 16, pattern, method, src, dst);
+}
+
+void bayer2rgb24(unsigned char *dst, unsigned char *src, long int WIDTH, long int HEIGHT)
+{
+    ccvt_bayer8_rgb24(WIDTH, HEIGHT, CCVT_BAYER_BGGR, CCVT_BAYER_BILINEAR, src, dst);
+}
+
+void bayer16_2_rgb24(unsigned short *dst, unsigned short *src, long int WIDTH, long int HEIGHT)
+{
+    ccvt_bayer16_rgb48(WIDTH, HEIGHT, CCVT_BAYER_BGGR, CCVT_BAYER_BILINEAR, src, dst);
+}
+
+void bayer_rggb_2rgb24(unsigned char *dst, unsigned char *src, long int WIDTH, long int HEIGHT)
+{
+    ccvt_bayer8_rgb24(WIDTH, HEIGHT, CCVT_BAYER_RGGB, CCVT_BAYER_BILINEAR, src, dst);
+}
+
+void bayer_grbg_to_rgb24(unsigned char *dst, unsigned char *src, long int WIDTH, long int HEIGHT)
+{
+    ccvt_bayer8_rgb24(WIDTH, HEIGHT, CCVT_BAYER_GRBG, CCVT_BAYER_BILINEAR, src, dst);
+}
@@ -21,112 +21,245 @@
 */
 
 #include "ccvt.h"
-#include "ccvt_types.h"
-
-/* by suitable definition of PIXTYPE, can do yuv to rgb or bgr, with or
-without word alignment */
-
-/* This doesn't exactly earn a prize in a programming beauty contest. */
-
-#define WHOLE_FUNC2RGB(type)                                        \
-    const unsigned char *y1, *y2, *u, *v;                           \
-    PIXTYPE_##type *l1, *l2;                                        \
-    int r, g, b, cr, cg, cb, yp, j, i;                              \
-                                                                    \
-    if ((width & 1) || (height & 1))                                \
-        return;                                                     \
-                                                                    \
-    l1 = (PIXTYPE_##type *)dst;                                     \
-    l2 = l1 + width;                                                \
-    y1 = (unsigned char *)src;                                      \
-    y2 = y1 + width;                                                \
-    u  = (unsigned char *)src + width * height;                     \
-    v  = u + (width * height) / 4;                                  \
-    j  = height / 2;                                                \
-    while (j--)                                                     \
-    {                                                               \
-        i = width / 2;                                              \
-        while (i--)                                                 \
-        {                                                           \
-            /* Since U & V are valid for 4 pixels, repeat code 4 	\
-			   times for different Y */ \
-            cb = ((*u - 128) * 454) >> 8;                           \
-            cr = ((*v - 128) * 359) >> 8;                           \
-            cg = ((*v - 128) * 183 + (*u - 128) * 88) >> 8;         \
-                                                                    \
-            yp = *(y1++);                                           \
-            r  = yp + cr;                                           \
-            b  = yp + cb;                                           \
-            g  = yp - cg;                                           \
-            SAT(r);                                                 \
-            SAT(g);                                                 \
-            SAT(b);                                                 \
-            l1->b = b;                                              \
-            l1->g = g;                                              \
-            l1->r = r;                                              \
-            l1++;                                                   \
-                                                                    \
-            yp = *(y1++);                                           \
-            r  = yp + cr;                                           \
-            b  = yp + cb;                                           \
-            g  = yp - cg;                                           \
-            SAT(r);                                                 \
-            SAT(g);                                                 \
-            SAT(b);                                                 \
-            l1->b = b;                                              \
-            l1->g = g;                                              \
-            l1->r = r;                                              \
-            l1++;                                                   \
-                                                                    \
-            yp = *(y2++);                                           \
-            r  = yp + cr;                                           \
-            b  = yp + cb;                                           \
-            g  = yp - cg;                                           \
-            SAT(r);                                                 \
-            SAT(g);                                                 \
-            SAT(b);                                                 \
-            l2->b = b;                                              \
-            l2->g = g;                                              \
-            l2->r = r;                                              \
-            l2++;                                                   \
-                                                                    \
-            yp = *(y2++);                                           \
-            r  = yp + cr;                                           \
-            b  = yp + cb;                                           \
-            g  = yp - cg;                                           \
-            SAT(r);                                                 \
-            SAT(g);                                                 \
-            SAT(b);                                                 \
-            l2->b = b;                                              \
-            l2->g = g;                                              \
-            l2->r = r;                                              \
-            l2++;                                                   \
-                                                                    \
-            u++;                                                    \
-            v++;                                                    \
-        }                                                           \
-        y1 = y2;                                                    \
-        y2 += width;                                                \
-        l1 = l2;                                                    \
-        l2 += width;                                                \
+#include "ccvt_parallel.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* Rows per parallel job, even so that the rows sharing a line of 4:2:0 chroma stay in the same job */
+#define CCVT_YUV_JOB_ROWS 16
+
+static int ccvt_parallel = 1;
+
+void ccvt_set_parallel(int enable)
+{
+    __atomic_store_n(&ccvt_parallel, enable != 0, __ATOMIC_RELAXED);
+}
+
+int ccvt_get_parallel(void)
+{
+    return __atomic_load_n(&ccvt_parallel, __ATOMIC_RELAXED);
+}
+
+int ccvt_parallel_threads(int parallel)
+{
+    return parallel ? dsp_parallel_threads() : 1;
+}
+
+void ccvt_parallel_for(int parallel, int count, dsp_parallel_func func, void *arg)
+{
+    int i;
+
+    if (parallel && count > 1)
+    {
+        dsp_parallel_for(count, func, arg);
+        return;
     }
+    for (i = 0; i < count; i++)
+        func(arg, i, 0);
+}
 
-void ccvt_420p_bgr32(int width, int height, const void *src, void *dst)
+static inline int ccvt_sat(int c)
 {
-    WHOLE_FUNC2RGB(bgr32)
+    return c < 0 ? 0 : (c > 255 ? 255 : c);
 }
 
-void ccvt_420p_bgr24(int width, int height, const void *src, void *dst)
+/*
+ * Convert the pixel pairs [first, last) of a row, each pair sharing the chroma sample u[k], v[k]. Y is read with a
+ * stride of ystep bytes. The integer arithmetic is the one of the original ccvt code, so the output is unchanged.
+ * Channels are computed in blocks and then interleaved into the pixel layout given by the constant offsets ro, go, bo
+ * and the pixel size ps, 4 bytes pixels get a zero filler.
+ */
+static inline void ccvt_yuv_pairs(const uint8_t *__restrict y, int ystep, const uint8_t *__restrict u,
+                                  const uint8_t *__restrict v, int cstep, uint8_t *__restrict d, int first, int last,
+                                  const int ro, const int go, const int bo, const int ps)
 {
-    WHOLE_FUNC2RGB(bgr24)
+    uint8_t R[2 * CCVT_LANES], G[2 * CCVT_LANES], B[2 * CCVT_LANES];
+    int k, l, n;
+
+    for (k = first; k < last; k += n)
+    {
+        n = last - k < CCVT_LANES ? last - k : CCVT_LANES;
+        if (n == CCVT_LANES)
+        {
+            for (l = 0; l < CCVT_LANES; l++)
+            {
+                int cu = u[(k + l) * cstep] - 128, cv = v[(k + l) * cstep] - 128;
+                int cb = (cu * 454) >> 8, cr = (cv * 359) >> 8, cg = (cv * 183 + cu * 88) >> 8;
+                int y1 = y[2 * (k + l) * ystep], y2 = y[(2 * (k + l) + 1) * ystep];
+                R[2 * l] = ccvt_sat(y1 + cr);
+                R[2 * l + 1] = ccvt_sat(y2 + cr);
+                G[2 * l] = ccvt_sat(y1 - cg);
+                G[2 * l + 1] = ccvt_sat(y2 - cg);
+                B[2 * l] = ccvt_sat(y1 + cb);
+                B[2 * l + 1] = ccvt_sat(y2 + cb);
+            }
+        }
+        else
+        {
+            for (l = 0; l < n; l++)
+            {
+                int cu = u[(k + l) * cstep] - 128, cv = v[(k + l) * cstep] - 128;
+                int cb = (cu * 454) >> 8, cr = (cv * 359) >> 8, cg = (cv * 183 + cu * 88) >> 8;
+                int y1 = y[2 * (k + l) * ystep], y2 = y[(2 * (k + l) + 1) * ystep];
+                R[2 * l] = ccvt_sat(y1 + cr);
+                R[2 * l + 1] = ccvt_sat(y2 + cr);
+                G[2 * l] = ccvt_sat(y1 - cg);
+                G[2 * l + 1] = ccvt_sat(y2 - cg);
+                B[2 * l] = ccvt_sat(y1 + cb);
+                B[2 * l + 1] = ccvt_sat(y2 + cb);
+            }
+        }
+
+        uint8_t *o = d + 2 * k * ps;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        /* Whole 4 bytes pixels are assembled in registers, which vectorizes far better than byte stores */
+        if (ps == 4)
+        {
+            uint32_t p;
+            for (l = 0; l < 2 * n; l++)
+            {
+                p = ((uint32_t)R[l] << (8 * ro)) | ((uint32_t)G[l] << (8 * go)) | ((uint32_t)B[l] << (8 * bo));
+                memcpy(o + 4 * l, &p, 4);
+            }
+            continue;
+        }
+#endif
+        for (l = 0; l < 2 * n; l++)
+        {
+            o[l * ps + ro] = R[l];
+            o[l * ps + go] = G[l];
+            o[l * ps + bo] = B[l];
+            if (ps == 4)
+                o[l * ps + 3] = 0;
+        }
+    }
 }
 
-void ccvt_420p_rgb32(int width, int height, const void *src, void *dst)
+typedef struct
 {
-    WHOLE_FUNC2RGB(rgb32)
+    int width;
+    int height;
+    const uint8_t *src;
+    uint8_t *dst;
+} ccvt_yuv_job;
+
+/* 4:2:0 planar, the rows 2j and 2j + 1 share the chroma line j */
+#define CCVT_420P_FUNC(type, ro, go, bo, ps)                                                                \
+    static CCVT_KERNEL void ccvt_420p_##type##_rows(void *arg, int index, int thread)                     \
+    {                                                                                                       \
+        const ccvt_yuv_job *job = (const ccvt_yuv_job *)arg;                                                \
+        const uint8_t *u = job->src + job->width * job->height;                                             \
+        const uint8_t *v = u + (job->width * job->height) / 4;                                              \
+        int row, last = index * CCVT_YUV_JOB_ROWS + CCVT_YUV_JOB_ROWS;                                      \
+        (void)thread;                                                                                       \
+        if (last > job->height)                                                                             \
+            last = job->height;                                                                             \
+        for (row = index * CCVT_YUV_JOB_ROWS; row < last; row++)                                            \
+            ccvt_yuv_pairs(job->src + row * job->width, 1, u + (row / 2) * (job->width / 2),                \
+                           v + (row / 2) * (job->width / 2), 1, job->dst + row * job->width * ps, 0,        \
+                           job->width / 2, ro, go, bo, ps);                                                 \
+    }                                                                                                       \
+                                                                                                            \
+    void ccvt_420p_##type(int width, int height, const void *src, void *dst)                               \
+    {                                                                                                       \
+        ccvt_yuv_job job = { width, height, (const uint8_t *)src, (uint8_t *)dst };                         \
+        if ((width & 1) || (height & 1))                                                                    \
+            return;                                                                                         \
+        ccvt_parallel_for(ccvt_get_parallel(), (height + CCVT_YUV_JOB_ROWS - 1) / CCVT_YUV_JOB_ROWS,        \
+                          ccvt_420p_##type##_rows, &job);                                                   \
+    }
+
+CCVT_420P_FUNC(bgr32, 2, 1, 0, 4)
+CCVT_420P_FUNC(bgr24, 2, 1, 0, 3)
+CCVT_420P_FUNC(rgb32, 0, 1, 2, 4)
+CCVT_420P_FUNC(rgb24, 0, 1, 2, 3)
+
+/* 4:2:2 YUYV, each pixel pair is packed as Y1 U Y2 V. Rows are 2 * width bytes, a last odd column is skipped */
+#define CCVT_YUYV_FUNC(type, ro, go, bo, ps)                                                                \
+    static CCVT_KERNEL void ccvt_yuyv_##type##_rows(void *arg, int index, int thread)                     \
+    {                                                                                                       \
+        const ccvt_yuv_job *job = (const ccvt_yuv_job *)arg;                                                \
+        int row, last = index * CCVT_YUV_JOB_ROWS + CCVT_YUV_JOB_ROWS;                                      \
+        (void)thread;                                                                                       \
+        if (last > job->height)                                                                             \
+            last = job->height;                                                                             \
+        for (row = index * CCVT_YUV_JOB_ROWS; row < last; row++)                                            \
+        {                                                                                                   \
+            const uint8_t *s = job->src + row * job->width * 2;                                             \
+            ccvt_yuv_pairs(s, 2, s + 1, s + 3, 4, job->dst + row * job->width * ps, 0, job->width / 2, ro, \
+                           go, bo, ps);                                                                     \
+        }                                                                                                   \
+    }                                                                                                       \
+                                                                                                            \
+    void ccvt_yuyv_##type(int width, int height, const void *src, void *dst)                               \
+    {                                                                                                       \
+        ccvt_yuv_job job = { width, height, (const uint8_t *)src, (uint8_t *)dst };                         \
+        ccvt_parallel_for(ccvt_get_parallel(), (height + CCVT_YUV_JOB_ROWS - 1) / CCVT_YUV_JOB_ROWS,        \
+                          ccvt_yuyv_##type##_rows, &job);                                                   \
+    }
+
+CCVT_YUYV_FUNC(bgr32, 2, 1, 0, 4)
+CCVT_YUYV_FUNC(rgb32, 0, 1, 2, 4)
+CCVT_YUYV_FUNC(bgr24, 2, 1, 0, 3)
+CCVT_YUYV_FUNC(rgb24, 0, 1, 2, 3)
+
+typedef struct
+{
+    int width;
+    int height;
+    const uint8_t *src;
+    uint8_t *y;
+    uint8_t *u;
+    uint8_t *v;
+} ccvt_yuyv_420p_job;
+
+/* Y is copied, U and V are the averages of the two rows sharing a chroma line */
+static CCVT_KERNEL void ccvt_yuyv_420p_rows(void *arg, int index, int thread)
+{
+    const ccvt_yuyv_420p_job *job = (const ccvt_yuyv_420p_job *)arg;
+    int row, k, last = index * CCVT_YUV_JOB_ROWS + CCVT_YUV_JOB_ROWS;
+    int half = job->width / 2;
+    (void)thread;
+
+    if (last > job->height)
+        last = job->height;
+    for (row = index * CCVT_YUV_JOB_ROWS; row < last; row += 2)
+    {
+        const uint8_t *__restrict s1 = job->src + row * job->width * 2;
+        const uint8_t *__restrict s2 = s1 + job->width * 2;
+        uint8_t *__restrict y1 = job->y + row * job->width;
+        uint8_t *__restrict y2 = y1 + job->width;
+        uint8_t *__restrict u = job->u + (row / 2) * half;
+        uint8_t *__restrict v = job->v + (row / 2) * half;
+
+        for (k = 0; k < job->width; k++)
+        {
+            y1[k] = s1[2 * k];
+            y2[k] = s2[2 * k];
+        }
+        for (k = 0; k < half; k++)
+        {
+            u[k] = (s1[4 * k + 1] + s2[4 * k + 1]) / 2;
+            v[k] = (s1[4 * k + 3] + s2[4 * k + 3]) / 2;
+        }
+    }
 }
 
-void ccvt_420p_rgb24(int width, int height, const void *src, void *dst)
+void ccvt_yuyv_420p(int width, int height, const void *src, void *dsty, void *dstu, void *dstv)
 {
-    WHOLE_FUNC2RGB(rgb24)
+    ccvt_yuyv_420p_job job;
+
+    /* Disregard last column/line if width/height is odd */
+    width -= width % 2;
+    height -= height % 2;
+
+    job.width  = width;
+    job.height = height;
+    job.src    = (const uint8_t *)src;
+    job.y      = (uint8_t *)dsty;
+    job.u      = (uint8_t *)dstu;
+    job.v      = (uint8_t *)dstv;
+    ccvt_parallel_for(ccvt_get_parallel(), (height + CCVT_YUV_JOB_ROWS - 1) / CCVT_YUV_JOB_ROWS, ccvt_yuyv_420p_rows,
+                      &job);
 }
@@ -0,0 +1,43 @@
+/*  CCVT: ColourConVerT: simple library for converting colourspaces
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/* Private helpers of the row kernels, not installed */
+
+#pragma once
+
+#include "dsp.h"
+
+/* Pixels per block of the row kernels, fixed size blocks are vectorized without a remainder loop */
+#define CCVT_LANES 32
+
+/* The kernels are built for AVX2 too and selected at load time */
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define CCVT_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define CCVT_KERNEL
+#endif
+
+/*
+ * The parallel mode may be changed by another thread during a conversion, read it once with ccvt_get_parallel and
+ * pass the same value to both helpers, so the scratch buffers match the threads that run the jobs.
+ */
+
+/* Number of threads that may run the jobs of ccvt_parallel_for, for per thread scratch buffers */
+int ccvt_parallel_threads(int parallel);
+
+/* Run count jobs on the libdsp thread pool, or in order on the calling thread if parallel is zero */
+void ccvt_parallel_for(int parallel, int count, dsp_parallel_func func, void *arg);
@@ -0,0 +1,159 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+    Area Downscaler
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "downscaler.h"
+#include "dsp.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Build an AVX2 and a generic version of the row kernel and pick one at load time.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define DOWNSCALE_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define DOWNSCALE_KERNEL
+#endif
+
+namespace INDI
+{
+
+// Bytes per vectorized block and output rows per parallel job.
+static constexpr size_t LANES = 32;
+static constexpr uint32_t JOB_ROWS = 8;
+
+namespace
+{
+struct ScaleJob
+{
+    const uint8_t *source;
+    uint8_t *destination;
+    size_t stride;
+    size_t outputStride;
+    uint32_t channels;
+    uint32_t outputWidth;
+    uint32_t outputHeight;
+    const Downscaler::Axis *columns;
+    const Downscaler::Axis *rows;
+};
+
+DOWNSCALE_KERNEL void accumulateRow(const uint8_t * __restrict source, float weight, float * __restrict row,
+                                    size_t count)
+{
+    // Fixed size blocks are vectorized without a remainder loop
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES)
+        for (size_t l = 0; l < LANES; l++)
+            row[i + l] += weight * source[i + l];
+    for (; i < count; i++)
+        row[i] += weight * source[i];
+}
+
+void scaleRows(void *arg, int index, int)
+{
+    const ScaleJob *job = static_cast<const ScaleJob *>(arg);
+    const Downscaler::Axis &rows = *job->rows;
+    const Downscaler::Axis &columns = *job->columns;
+    const uint32_t channels = job->channels;
+    std::vector<float> row(job->stride);
+
+    uint32_t last = std::min(job->outputHeight, (index + 1) * JOB_ROWS);
+    for (uint32_t y = index * JOB_ROWS; y < last; y++)
+    {
+        // Weighted sum of the source rows covered by the output row
+        std::fill(row.begin(), row.end(), 0.0f);
+        for (uint32_t r = 0; r < rows.count[y]; r++)
+            accumulateRow(job->source + (rows.first[y] + r) * job->stride, rows.weights[rows.offset[y] + r],
+                          row.data(), job->stride);
+
+        // Then of the columns, the weights of both axes sum to one
+        uint8_t *destination = job->destination + y * job->outputStride;
+        for (uint32_t x = 0; x < job->outputWidth; x++)
+        {
+            const float *weights = columns.weights.data() + columns.offset[x];
+            const float *pixel = row.data() + static_cast<size_t>(columns.first[x]) * channels;
+            for (uint32_t c = 0; c < channels; c++)
+            {
+                float sum = 0;
+                for (uint32_t i = 0; i < columns.count[x]; i++)
+                    sum += weights[i] * pixel[i * channels + c];
+                destination[x * channels + c] = static_cast<uint8_t>(std::min(255.0f, sum + 0.5f));
+            }
+        }
+    }
+}
+}
+
+void Downscaler::build(Axis &axis, uint32_t size, uint32_t outputSize)
+{
+    axis.first.resize(outputSize);
+    axis.count.resize(outputSize);
+    axis.offset.resize(outputSize);
+    axis.weights.clear();
+
+    // Output pixel i covers [i * ratio, (i + 1) * ratio) of the source
+    double ratio = static_cast<double>(size) / outputSize;
+    for (uint32_t i = 0; i < outputSize; i++)
+    {
+        double start = i * ratio, end = std::min<double>(size, (i + 1) * ratio);
+        uint32_t first = static_cast<uint32_t>(start);
+        uint32_t last = std::min(size, static_cast<uint32_t>(std::ceil(end)));
+
+        axis.first[i] = first;
+        axis.count[i] = last - first;
+        axis.offset[i] = static_cast<uint32_t>(axis.weights.size());
+        for (uint32_t j = first; j < last; j++)
+            axis.weights.push_back(static_cast<float>((std::min<double>(end, j + 1) - std::max<double>(start, j)) / ratio));
+    }
+}
+
+void Downscaler::scale(const uint8_t *source, uint32_t width, uint32_t height, uint32_t channels,
+                       uint8_t *destination, uint32_t outputWidth, uint32_t outputHeight)
+{
+    if (width == 0 || height == 0 || outputWidth == 0 || outputHeight == 0 || channels == 0)
+        return;
+
+    if (width != mWidth || outputWidth != mOutputWidth)
+    {
+        build(mColumns, width, outputWidth);
+        mWidth = width;
+        mOutputWidth = outputWidth;
+    }
+
+    if (height != mHeight || outputHeight != mOutputHeight)
+    {
+        build(mRows, height, outputHeight);
+        mHeight = height;
+        mOutputHeight = outputHeight;
+    }
+
+    ScaleJob job;
+    job.source = source;
+    job.destination = destination;
+    job.stride = static_cast<size_t>(width) * channels;
+    job.outputStride = static_cast<size_t>(outputWidth) * channels;
+    job.channels = channels;
+    job.outputWidth = outputWidth;
+    job.outputHeight = outputHeight;
+    job.columns = &mColumns;
+    job.rows = &mRows;
+    dsp_parallel_for(static_cast<int>((outputHeight + JOB_ROWS - 1) / JOB_ROWS), scaleRows, &job);
+}
+
+}
@@ -0,0 +1,70 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+    Area Downscaler
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace INDI
+{
+/**
+ * @brief The Downscaler class resizes 8 bit frames to any size by area averaging.
+ *
+ * Each output pixel is the mean of the source area it covers, partially covered source pixels are weighted by their
+ * coverage. Source rows are first summed into a float row, a loop the compiler vectorizes, then the columns of that
+ * row are summed. The weights are kept between frames of the same geometry. Output rows are split across the libdsp
+ * thread pool.
+ */
+class Downscaler
+{
+public:
+    /**
+     * @brief scale Resize a frame of interleaved channels.
+     * @param source frame of width * height * channels bytes.
+     * @param destination frame of outputWidth * outputHeight * channels bytes.
+     */
+    void scale(const uint8_t *source, uint32_t width, uint32_t height, uint32_t channels,
+               uint8_t *destination, uint32_t outputWidth, uint32_t outputHeight);
+
+public:
+    /**
+     * @brief The source pixels covered by each output pixel along one axis, and their weights.
+     */
+    struct Axis
+    {
+        std::vector<uint32_t> first;
+        std::vector<uint32_t> count;
+        std::vector<uint32_t> offset;
+        std::vector<float> weights;
+    };
+
+private:
+    static void build(Axis &axis, uint32_t size, uint32_t outputSize);
+
+private:
+    Axis mColumns;
+    Axis mRows;
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    uint32_t mOutputWidth = 0;
+    uint32_t mOutputHeight = 0;
+};
+}
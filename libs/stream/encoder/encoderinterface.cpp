@@ -56,4 +56,22 @@ bool EncoderInterface::setPixelFormat(INDI_PIXEL_FORMAT pixelFormat, uint8_t pix
     this->pixelDepth = pixelDepth;
     return true;
 }
+
+void EncoderInterface::setRateControl(double bitrate, double fps, int quality)
+{
+    INDI_UNUSED(bitrate);
+    INDI_UNUSED(fps);
+    INDI_UNUSED(quality);
+}
+
+void EncoderInterface::sent(double frameInterval, double encodeTime)
+{
+    INDI_UNUSED(frameInterval);
+    INDI_UNUSED(encodeTime);
+}
+
+int EncoderInterface::getQuality()
+{
+    return 100;
+}
 }
@@ -54,6 +54,26 @@ class EncoderInterface
 
     virtual bool upload(IBLOB *bp, const uint8_t *buffer, uint32_t nbytes, bool isCompressed=false) = 0;
 
+    /**
+     * @brief setRateControl Limit the size of the frames of lossy encoders, others ignore it. It may be called while
+     * another thread uploads frames.
+     * @param bitrate target in bits per second, 0 disables the limit.
+     * @param fps frame rate the encoding must keep up with, 0 disables the limit.
+     * @param quality maximum quality, 1 to 100.
+     */
+    virtual void setRateControl(double bitrate, double fps, int quality);
+
+    /**
+     * @brief sent Report that the last uploaded frame was sent, frameInterval seconds after the previous one, and
+     * took encodeTime seconds to encode.
+     */
+    virtual void sent(double frameInterval, double encodeTime);
+
+    /**
+     * @brief getQuality Return the quality of the last frame, 100 for lossless encoders.
+     */
+    virtual int getQuality();
+
     const char *getName();
 
   protected:
@@ -0,0 +1,246 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    JPEG Encoder Pool
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "jpegencoderpool.h"
+#include "dsp.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <jpeglib.h>
+
+namespace INDI
+{
+
+// Rows per strip, a multiple of the MCU height of both grayscale (8) and subsampled color (16) frames.
+static constexpr uint32_t STRIP_ROWS = 64;
+// Initial size of the output buffer of a strip, it grows when a strip does not fit.
+static constexpr size_t STRIP_BUFFER = 64 * 1024;
+
+namespace
+{
+// Destination manager writing into a vector that grows as needed
+struct Destination
+{
+    jpeg_destination_mgr pub;
+    std::vector<uint8_t> *buffer;
+};
+
+void initDestination(j_compress_ptr cinfo)
+{
+    Destination *dest = reinterpret_cast<Destination *>(cinfo->dest);
+    dest->buffer->resize(std::max(dest->buffer->capacity(), STRIP_BUFFER));
+    dest->pub.next_output_byte = dest->buffer->data();
+    dest->pub.free_in_buffer = dest->buffer->size();
+}
+
+boolean emptyOutputBuffer(j_compress_ptr cinfo)
+{
+    // Called when the buffer is full
+    Destination *dest = reinterpret_cast<Destination *>(cinfo->dest);
+    size_t used = dest->buffer->size();
+    dest->buffer->resize(used * 2);
+    dest->pub.next_output_byte = dest->buffer->data() + used;
+    dest->pub.free_in_buffer = dest->buffer->size() - used;
+    return TRUE;
+}
+
+void termDestination(j_compress_ptr cinfo)
+{
+    Destination *dest = reinterpret_cast<Destination *>(cinfo->dest);
+    dest->buffer->resize(dest->buffer->size() - dest->pub.free_in_buffer);
+}
+
+// Offsets of the frame header (SOF) and scan header (SOS) markers, and of the entropy coded data following the scan
+// header. The data runs to the end of image (EOI) marker in the last two bytes.
+struct Layout
+{
+    size_t frame {0};
+    size_t scan {0};
+    size_t data {0};
+};
+
+bool parse(const std::vector<uint8_t> &jpeg, Layout &layout)
+{
+    size_t size = jpeg.size();
+    if (size < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8 || jpeg[size - 2] != 0xFF || jpeg[size - 1] != 0xD9)
+        return false;
+
+    for (size_t pos = 2; pos + 4 <= size;)
+    {
+        if (jpeg[pos] != 0xFF)
+            return false;
+        uint8_t marker = jpeg[pos + 1];
+        size_t length = (jpeg[pos + 2] << 8) | jpeg[pos + 3];
+        if (marker == 0xC0)
+            layout.frame = pos;
+        if (marker == 0xDA)
+        {
+            layout.scan = pos;
+            layout.data = pos + 2 + length;
+            return layout.frame != 0 && layout.data <= size - 2;
+        }
+        pos += 2 + length;
+    }
+
+    return false;
+}
+}
+
+struct JPEGEncoderPool::Strip
+{
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr error;
+    Destination destination;
+    std::vector<uint8_t> out;
+    Layout layout;
+    bool ok {false};
+
+    // Frame and strip of the parallel job
+    const uint8_t *source;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    int quality;
+
+    Strip()
+    {
+        cinfo.err = jpeg_std_error(&error);
+        jpeg_create_compress(&cinfo);
+        destination.pub.init_destination = initDestination;
+        destination.pub.empty_output_buffer = emptyOutputBuffer;
+        destination.pub.term_destination = termDestination;
+        destination.buffer = &out;
+        cinfo.dest = &destination.pub;
+    }
+
+    ~Strip()
+    {
+        jpeg_destroy_compress(&cinfo);
+    }
+
+    static void job(void *arg, int index, int)
+    {
+        static_cast<std::unique_ptr<Strip> *>(arg)[index]->compress();
+    }
+
+    void compress()
+    {
+        cinfo.image_width = width;
+        cinfo.image_height = height;
+        cinfo.input_components = channels;
+        cinfo.in_color_space = channels == 3 ? JCS_RGB : JCS_GRAYSCALE;
+        jpeg_set_defaults(&cinfo);
+        jpeg_set_quality(&cinfo, quality, TRUE);
+        // The header of the first strip is used for all strips, so none of them can have its own Huffman tables
+        cinfo.optimize_coding = FALSE;
+
+        jpeg_start_compress(&cinfo, TRUE);
+        while (cinfo.next_scanline < cinfo.image_height)
+        {
+            JSAMPROW row = const_cast<JSAMPROW>(source + static_cast<size_t>(cinfo.next_scanline) * width * channels);
+            jpeg_write_scanlines(&cinfo, &row, 1);
+        }
+        jpeg_finish_compress(&cinfo);
+
+        layout = Layout();
+        ok = parse(out, layout);
+    }
+};
+
+JPEGEncoderPool::JPEGEncoderPool()
+{
+}
+
+JPEGEncoderPool::~JPEGEncoderPool()
+{
+}
+
+bool JPEGEncoderPool::compress(const uint8_t *source, uint32_t width, uint32_t height, uint32_t channels,
+                               int quality, std::vector<uint8_t> &out)
+{
+    if (source == nullptr || width == 0 || height == 0 || width > 65535 || height > 65535 ||
+            (channels != 1 && channels != 3))
+        return false;
+
+    // A restart interval counts the MCUs of a strip, 8x8 pixels in grayscale and 16x16 for the subsampled chroma of
+    // the default color settings
+    uint32_t mcu = channels == 3 ? 16 : 8;
+    uint32_t interval = (width + mcu - 1) / mcu * (STRIP_ROWS / mcu);
+    size_t count = interval > 65535 ? 1 : (height + STRIP_ROWS - 1) / STRIP_ROWS;
+    uint32_t rows = count == 1 ? height : STRIP_ROWS;
+
+    while (m_Strips.size() < count)
+        m_Strips.emplace_back(new Strip());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        Strip &strip = *m_Strips[i];
+        uint32_t first = i * rows;
+        strip.source = source + static_cast<size_t>(first) * width * channels;
+        strip.width = width;
+        strip.height = std::min(rows, height - first);
+        strip.channels = channels;
+        strip.quality = quality;
+    }
+    dsp_parallel_for(static_cast<int>(count), Strip::job, m_Strips.data());
+
+    size_t total = 6;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (m_Strips[i]->ok == false)
+            return false;
+        total += m_Strips[i]->out.size();
+    }
+
+    // The header of the first strip, with the height of the frame and a restart interval
+    const Strip &head = *m_Strips[0];
+    out.clear();
+    out.reserve(total);
+    out.insert(out.end(), head.out.begin(), head.out.begin() + head.layout.scan);
+    out[head.layout.frame + 5] = height >> 8;
+    out[head.layout.frame + 6] = height & 0xFF;
+    if (count > 1)
+    {
+        const uint8_t restart[] = { 0xFF, 0xDD, 0x00, 0x04, static_cast<uint8_t>(interval >> 8), static_cast<uint8_t>(interval & 0xFF) };
+        out.insert(out.end(), restart, restart + sizeof(restart));
+    }
+    out.insert(out.end(), head.out.begin() + head.layout.scan, head.out.begin() + head.layout.data);
+
+    // Entropy coded data of each strip, the restart markers cycle through RST0 to RST7
+    for (size_t i = 0; i < count; i++)
+    {
+        const Strip &strip = *m_Strips[i];
+        if (i > 0)
+        {
+            out.push_back(0xFF);
+            out.push_back(0xD0 + (i - 1) % 8);
+        }
+        out.insert(out.end(), strip.out.begin() + strip.layout.data, strip.out.end() - 2);
+    }
+    out.push_back(0xFF);
+    out.push_back(0xD9);
+
+    return true;
+}
+
+}
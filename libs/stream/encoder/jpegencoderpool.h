@@ -0,0 +1,65 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    JPEG Encoder Pool
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace INDI
+{
+
+/**
+ * @brief The JPEGEncoderPool class compresses frames to baseline JPEG on several threads.
+ *
+ * The frame is split into horizontal strips that are compressed in parallel, each by its own libjpeg compressor.
+ * The strips use the same quantization and standard Huffman tables, so their entropy coded data is joined with
+ * restart markers under the header of the first strip, and the result is a single JPEG any decoder can read. The
+ * compressors and their output buffers are kept between frames. libjpeg-turbo is used if libjpeg is provided by it.
+ */
+class JPEGEncoderPool
+{
+    public:
+        JPEGEncoderPool();
+        ~JPEGEncoderPool();
+
+        JPEGEncoderPool(const JPEGEncoderPool &) = delete;
+        JPEGEncoderPool &operator=(const JPEGEncoderPool &) = delete;
+
+        /**
+         * @brief compress Compress a frame.
+         * @param source frame of width * height * channels bytes.
+         * @param channels 1 for grayscale, 3 for RGB.
+         * @param quality JPEG quality, 1 to 100.
+         * @param out compressed frame. The vector is resized to the compressed size and may be reused between calls.
+         * @return True on success, false if the frame format is not supported.
+         */
+        bool compress(const uint8_t *source, uint32_t width, uint32_t height, uint32_t channels, int quality,
+                      std::vector<uint8_t> &out);
+
+    private:
+        struct Strip;
+        std::vector<std::unique_ptr<Strip>> m_Strips;
+};
+
+}
@@ -22,6 +22,11 @@
 #pragma once
 
 #include "encoderinterface.h"
+#include "jpegencoderpool.h"
+#include "ratecontrol.h"
+#include "stream/downscaler.h"
+
+#include <vector>
 
 namespace INDI
 {
@@ -29,7 +34,9 @@ namespace INDI
 /**
  * @brief The MJPEGEncoder class encodes frames in JPEG format before transmitting them to the client.
  *
- * The quality is now hard-coded at 70 when encoding the JPEG image. Further compression is not supported.
+ * Frames wider than SCALE_WIDTH are downscaled, and compressed in parallel by a JPEGEncoderPool. The quality starts at
+ * 85 and is lowered, then the frames are scaled down further, when the frames exceed the target bitrate or the client
+ * falls behind. Further compression is not supported.
  */
 class MJPEGEncoder : public EncoderInterface
 {
@@ -39,14 +46,20 @@ class MJPEGEncoder : public EncoderInterface
 
         virtual bool upload(IBLOB *bp, const uint8_t *buffer, uint32_t nbytes, bool isCompressed = false) override;
 
+        virtual void setRateControl(double bitrate, double fps, int quality) override;
+        virtual void sent(double frameInterval, double encodeTime) override;
+        virtual int getQuality() override;
+
     private:
         const char *getDeviceName();
-        int jpeg_compress_8u_gray (const uint8_t * src, uint16_t width, uint16_t height, int stride, int scale, uint8_t * dest,
-                                   int * destsize, int quality);
-        int jpeg_compress_8u_rgb (const uint8_t * src, uint16_t width, uint16_t height, int stride, int scale, uint8_t * dest,
-                                  int * destsize, int quality);
-        uint8_t *jpegBuffer = nullptr;
-        uint16_t jpegBufferSize = 1;
+
+        JPEGEncoderPool encoderPool;
+        RateControl rateControl;
+        int quality = 85;
+        std::vector<uint8_t> jpegBuffer;
+
+        Downscaler downscaler;
+        std::vector<uint8_t> scaledBuffer;
 
         static const int SCALE_WIDTH = 640;
 
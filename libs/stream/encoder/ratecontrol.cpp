@@ -0,0 +1,133 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    Stream Rate Control
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "ratecontrol.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace INDI
+{
+
+// Frames over budget by this ratio shrink, frames under this ratio grow.
+static constexpr double OVER_BUDGET = 1.1;
+static constexpr double UNDER_BUDGET = 0.7;
+// Quality steps and scale factor per frame when growing.
+static constexpr int QUALITY_STEP = 2;
+static constexpr double SCALE_STEP = 1.1;
+
+RateControl::RateControl()
+{
+}
+
+void RateControl::setTargetBitrate(double bitrate)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_TargetBitrate = std::max(0.0, bitrate);
+}
+
+double RateControl::targetBitrate() const
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_TargetBitrate;
+}
+
+void RateControl::setTargetFps(double fps)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_TargetFps = std::max(0.0, fps);
+}
+
+double RateControl::targetFps() const
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_TargetFps;
+}
+
+void RateControl::setMaximumQuality(int quality)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_MaximumQuality = std::max(MINIMUM_QUALITY, std::min(100, quality));
+    m_Quality = std::min(m_Quality, m_MaximumQuality);
+}
+
+void RateControl::reset()
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_Quality = m_MaximumQuality;
+    m_Scale = 1;
+}
+
+void RateControl::update(size_t bytes, double frameInterval, double encodeTime)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    if (bytes == 0 || frameInterval <= 0)
+        return;
+
+    if (m_TargetBitrate <= 0 && m_TargetFps <= 0)
+    {
+        m_Quality = m_MaximumQuality;
+        m_Scale = 1;
+        return;
+    }
+
+    double sizeRatio = m_TargetBitrate > 0 ? bytes / (m_TargetBitrate / 8 * frameInterval) : 0;
+    double timeRatio = m_TargetFps > 0 ? encodeTime * m_TargetFps : 0;
+    double ratio = std::max(sizeRatio, timeRatio);
+
+    if (timeRatio > OVER_BUDGET && timeRatio >= sizeRatio)
+    {
+        // Too slow to encode, fewer pixels help where a lower quality hardly does
+        m_Scale = std::max(MINIMUM_SCALE, m_Scale * std::max(0.5, std::sqrt(1 / timeRatio)));
+    }
+    else if (ratio > OVER_BUDGET)
+    {
+        // The size falls slowly with the quality, and with the square of the scale
+        if (m_Quality > MINIMUM_QUALITY)
+        {
+            int step = std::max(QUALITY_STEP, static_cast<int>(std::lround((ratio - 1) * 20)));
+            m_Quality = std::max(MINIMUM_QUALITY, m_Quality - std::min(step, 15));
+        }
+        else
+            m_Scale = std::max(MINIMUM_SCALE, m_Scale * std::max(0.5, std::sqrt(1 / ratio)));
+    }
+    else if (ratio < UNDER_BUDGET)
+    {
+        if (m_Scale < 1)
+            m_Scale = std::min(1.0, m_Scale * SCALE_STEP);
+        else
+            m_Quality = std::min(m_MaximumQuality, m_Quality + QUALITY_STEP);
+    }
+}
+
+int RateControl::quality() const
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_Quality;
+}
+
+double RateControl::scale() const
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_Scale;
+}
+
+}
@@ -0,0 +1,97 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    Stream Rate Control
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+namespace INDI
+{
+
+/**
+ * @brief The RateControl class picks the quality and scale of lossy stream frames.
+ *
+ * After each frame, the encoded size is compared with a budget, the target bitrate over the time since the previous
+ * frame. Frames over budget lower the quality first and then the scale, frames well under it raise the scale first
+ * and then the quality. The driver cannot see how fast the client receives the frames, indiserver queues and drops
+ * stream BLOBs on its own, so the targets set by the user are the only limits.
+ *
+ * With a target FPS, the encode time of a frame is also compared with the frame period. Encoding too slowly lowers
+ * the scale directly, as the encode time follows the number of pixels much more than the quality.
+ *
+ * The settings are changed from the driver event thread while the stream thread encodes, all methods are thread
+ * safe.
+ */
+class RateControl
+{
+    public:
+        RateControl();
+
+        /**
+         * @brief setTargetBitrate Set the bitrate to stay under, in bits per second. 0 disables the rate control,
+         * frames keep the maximum quality and full scale.
+         */
+        void setTargetBitrate(double bitrate);
+        double targetBitrate() const;
+
+        /**
+         * @brief setTargetFps Set the frame rate the encoder must keep up with. 0 disables this limit.
+         */
+        void setTargetFps(double fps);
+        double targetFps() const;
+
+        /**
+         * @brief setMaximumQuality Set the quality used when the budget allows it, MINIMUM_QUALITY to 100.
+         */
+        void setMaximumQuality(int quality);
+
+        /**
+         * @brief reset Go back to the maximum quality and full scale.
+         */
+        void reset();
+
+        /**
+         * @brief update Adjust quality and scale after a frame.
+         * @param bytes encoded size of the frame, with the current quality and scale.
+         * @param frameInterval seconds since the previous frame.
+         * @param encodeTime seconds spent encoding the frame.
+         */
+        void update(size_t bytes, double frameInterval, double encodeTime = 0);
+
+        /** @return JPEG quality of the next frame. */
+        int quality() const;
+        /** @return Scale of the next frame, from MINIMUM_SCALE to 1. */
+        double scale() const;
+
+        static constexpr int MINIMUM_QUALITY = 30;
+        static constexpr double MINIMUM_SCALE = 0.25;
+
+    private:
+        mutable std::mutex m_Lock;
+        double m_TargetBitrate {0};
+        double m_TargetFps {0};
+        int m_MaximumQuality {85};
+        int m_Quality {85};
+        double m_Scale {1};
+};
+
+}
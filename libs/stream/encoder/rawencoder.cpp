@@ -22,8 +22,7 @@
 #include "rawencoder.h"
 #include "stream/streammanager.h"
 #include "indiccd.h"
-
-#include <zlib.h>
+#include "indicompression.h"
 
 namespace INDI
 {
@@ -47,21 +46,21 @@ bool RawEncoder::upload(IBLOB *bp, const uint8_t *buffer, uint32_t nbytes, bool
     // Do we want to compress ?
     if (isCompressed)
     {
-        // Compress frame
-        compressedFrame.resize(nbytes + nbytes / 64 + 16 + 3);
-        uLongf compressedBytes = compressedFrame.size();
+        // Compress frame. Blocks are compressed in parallel, the result is still a single zlib stream.
+        Compression::Settings settings;
+        settings.codec = Compression::ZLIB;
+        settings.level = 4;
 
-        int ret = compress2(compressedFrame.data(), &compressedBytes, buffer, nbytes, 4);
-        if (ret != Z_OK)
+        if (Compression::compress(buffer, nbytes, compressedFrame, settings) == false)
         {
             // this should NEVER happen
-            LOGF_ERROR("internal error - compression failed: %d", ret);
+            LOG_ERROR("internal error - compression failed");
             return false;
         }
 
         // Send it compressed
         bp->blob    = compressedFrame.data();
-        bp->bloblen = compressedBytes;
+        bp->bloblen = compressedFrame.size();
         bp->size    = nbytes;
         strcpy(bp->format, ".stream.z");
     }
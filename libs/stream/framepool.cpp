@@ -0,0 +1,177 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    Stream Frame Pool
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "framepool.h"
+
+#include <algorithm>
+
+namespace INDI
+{
+
+struct FramePool::Frame
+{
+    FramePool *pool {nullptr};
+    std::atomic<int> references {0};
+    std::vector<uint8_t> buffer;
+    size_t size {0};
+};
+
+FramePool::Handle::Handle(const Handle &other)
+    : frame(other.frame)
+{
+    if (frame)
+        frame->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+FramePool::Handle::Handle(Handle &&other) noexcept
+    : frame(other.frame)
+{
+    other.frame = nullptr;
+}
+
+FramePool::Handle &FramePool::Handle::operator=(Handle other) noexcept
+{
+    std::swap(frame, other.frame);
+    return *this;
+}
+
+FramePool::Handle::~Handle()
+{
+    reset();
+}
+
+uint8_t *FramePool::Handle::data()
+{
+    return frame ? frame->buffer.data() : nullptr;
+}
+
+const uint8_t *FramePool::Handle::data() const
+{
+    return frame ? frame->buffer.data() : nullptr;
+}
+
+size_t FramePool::Handle::size() const
+{
+    return frame ? frame->size : 0;
+}
+
+void FramePool::Handle::reset()
+{
+    if (frame && frame->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        frame->pool->release(frame);
+    frame = nullptr;
+}
+
+FramePool::FramePool(size_t maxSize, size_t minFrames)
+    : m_MaxSize(maxSize)
+    , m_MinFrames(minFrames)
+{ }
+
+FramePool::~FramePool()
+{ }
+
+FramePool::Handle FramePool::acquire(size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+
+    Frame *frame = nullptr;
+
+    // Prefer a free frame that is already large enough.
+    auto it = std::find_if(m_Free.begin(), m_Free.end(), [size](Frame * f)
+    {
+        return f->buffer.capacity() >= size;
+    });
+
+    if (it != m_Free.end())
+    {
+        frame = *it;
+        *it = m_Free.back();
+        m_Free.pop_back();
+    }
+    else
+    {
+        // Grow a free frame, or allocate a new one.
+        size_t growth = size;
+        if (!m_Free.empty())
+            growth -= m_Free.back()->buffer.capacity();
+
+        if (m_Frames.size() >= m_MinFrames && m_AllocatedSize + growth > m_MaxSize)
+            return Handle();
+
+        if (!m_Free.empty())
+        {
+            frame = m_Free.back();
+            m_Free.pop_back();
+            m_AllocatedSize -= frame->buffer.capacity();
+        }
+        else
+        {
+            m_Frames.emplace_back(new Frame);
+            m_Free.reserve(m_Frames.size());
+            frame = m_Frames.back().get();
+            frame->pool = this;
+        }
+
+        // Reallocate rather than resize, the old content is not needed.
+        std::vector<uint8_t>().swap(frame->buffer);
+        frame->buffer.resize(size);
+        m_AllocatedSize += frame->buffer.capacity();
+    }
+
+    frame->size = size;
+    frame->references.store(1, std::memory_order_relaxed);
+    return Handle(frame);
+}
+
+void FramePool::release(Frame *frame)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_Free.push_back(frame);
+}
+
+void FramePool::setMaxSize(size_t maxSize)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    m_MaxSize = maxSize;
+}
+
+void FramePool::shrink()
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+
+    for (Frame *frame : m_Free)
+    {
+        m_AllocatedSize -= frame->buffer.capacity();
+        m_Frames.erase(std::find_if(m_Frames.begin(), m_Frames.end(), [frame](const std::unique_ptr<Frame> &f)
+        {
+            return f.get() == frame;
+        }));
+    }
+    m_Free.clear();
+}
+
+size_t FramePool::allocatedSize() const
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    return m_AllocatedSize;
+}
+
+}
@@ -0,0 +1,119 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    Stream Frame Pool
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace INDI
+{
+
+/**
+ * @brief The FramePool class recycles frame buffers between the stream producer, recorder and preview.
+ *
+ * A frame is acquired from the pool and shared through reference counted handles. When the last handle is released,
+ * the frame returns to the pool and its buffer is reused by the next acquire, so once the pool has warmed up,
+ * streaming does not allocate memory per frame. The pool grows until its total buffer size reaches the limit, after
+ * which acquire fails until a frame is returned.
+ *
+ * Handles must not outlive the pool.
+ */
+class FramePool
+{
+    public:
+        struct Frame;
+
+        class Handle
+        {
+            public:
+                Handle() = default;
+                Handle(const Handle &other);
+                Handle(Handle &&other) noexcept;
+                Handle &operator=(Handle other) noexcept;
+                ~Handle();
+
+                explicit operator bool() const
+                {
+                    return frame != nullptr;
+                }
+
+                uint8_t *data();
+                const uint8_t *data() const;
+                size_t size() const;
+
+                /**
+                 * @brief reset Release the frame. The handle is empty afterwards.
+                 */
+                void reset();
+
+            private:
+                friend class FramePool;
+                explicit Handle(Frame *frame) : frame(frame) {}
+
+                Frame *frame {nullptr};
+        };
+
+    public:
+        /**
+         * @param maxSize maximum total size of all frame buffers in bytes.
+         * @param minFrames number of frames that may always be allocated, regardless of maxSize.
+         */
+        explicit FramePool(size_t maxSize = SIZE_MAX, size_t minFrames = 1);
+        ~FramePool();
+
+        /**
+         * @brief acquire Get a frame of the given size. The content of the frame is undefined.
+         * @return Handle to the frame, or an empty handle if the pool is exhausted.
+         */
+        Handle acquire(size_t size);
+
+        /**
+         * @brief setMaxSize Change the maximum total size of the frame buffers. Frames already allocated are kept.
+         */
+        void setMaxSize(size_t maxSize);
+
+        /**
+         * @brief shrink Free all frames that are not in use.
+         */
+        void shrink();
+
+        /**
+         * @return Total size of the frame buffers in bytes.
+         */
+        size_t allocatedSize() const;
+
+    private:
+        void release(Frame *frame);
+
+        mutable std::mutex m_Lock;
+        std::vector<std::unique_ptr<Frame>> m_Frames;
+        std::vector<Frame *> m_Free;
+        size_t m_MaxSize;
+        size_t m_MinFrames;
+        size_t m_AllocatedSize {0};
+};
+
+}
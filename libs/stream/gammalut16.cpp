@@ -21,14 +21,170 @@
 
 */
 #include "gammalut16.h"
+#include "dsp.h"
+
+#include <algorithm>
 #include <cmath>
+#include <vector>
+
+// Build an AVX2 and a generic version of each kernel and pick one at load time.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define GAMMA_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define GAMMA_KERNEL
+#endif
+
+#if defined(__GNUC__)
+#define GAMMA_INLINE inline __attribute__((always_inline))
+#else
+#define GAMMA_INLINE inline
+#endif
+
+// Pixels per vectorized block and per parallel job.
+static constexpr size_t LANES = 32;
+static constexpr size_t JOB_PIXELS = 256 * 1024;
+// Maximum number of pixels sampled for the stretch histogram.
+static constexpr size_t STRETCH_SAMPLES = 65536;
+// Shadows are clipped this many normalized MADs below the median, which is mapped to this output level.
+static constexpr double STRETCH_SHADOWS = -2.8;
+static constexpr double STRETCH_BACKGROUND = 0.25;
+
+namespace
+{
+struct Curve
+{
+    // Input range [black, black + range] mapped to [0, 1]
+    int32_t black;
+    int32_t range;
+    float scale;
+    // Midtones balance of the stretch curve
+    float midtones;
+};
+
+template <GammaLut16::Mode M>
+GAMMA_INLINE uint8_t map(uint16_t value, const Curve &curve)
+{
+    // Only integers are compared, float selects are not if-converted with trapping math and the loop would branch
+    int32_t t = static_cast<int32_t>(value) - curve.black;
+    t = t > 0 ? t : 0;
+    t = t < curve.range ? t : curve.range;
+    float x = static_cast<float>(t) * curve.scale;
+
+    float p = x;
+    if (M == GammaLut16::MODE_STRETCH)
+        p = (curve.midtones - 1) * x / ((2 * curve.midtones - 1) * x - curve.midtones);
+
+    int32_t q = static_cast<int32_t>(p * 255.0f + 0.5f);
+    q = q > 0 ? q : 0;
+    q = q < 255 ? q : 255;
+    return static_cast<uint8_t>(q);
+}
+
+template <GammaLut16::Mode M>
+GAMMA_INLINE void map(const uint16_t * __restrict source, size_t count, uint8_t * __restrict destination,
+                      const Curve &curve)
+{
+    // Fixed size blocks are vectorized without a remainder loop
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES)
+        for (size_t l = 0; l < LANES; l++)
+            destination[i + l] = map<M>(source[i + l], curve);
+    for (; i < count; i++)
+        destination[i] = map<M>(source[i], curve);
+}
+
+GAMMA_KERNEL void mapLinear(const uint16_t *source, size_t count, uint8_t *destination, const Curve &curve)
+{
+    map<GammaLut16::MODE_LINEAR>(source, count, destination, curve);
+}
+
+GAMMA_KERNEL void mapStretch(const uint16_t *source, size_t count, uint8_t *destination, const Curve &curve)
+{
+    map<GammaLut16::MODE_STRETCH>(source, count, destination, curve);
+}
+struct MapJob
+{
+    // The gamma curve is looked up in the table, the others are computed
+    const uint8_t *table;
+    void (*kernel)(const uint16_t *, size_t, uint8_t *, const Curve &);
+    const uint16_t *source;
+    size_t count;
+    uint8_t *destination;
+    Curve curve;
+};
+
+void mapJob(void *arg, int index, int)
+{
+    const MapJob *job = static_cast<const MapJob *>(arg);
+    size_t first = index * JOB_PIXELS;
+    size_t count = std::min(JOB_PIXELS, job->count - first);
+    const uint16_t *source = job->source + first;
+    uint8_t *destination = job->destination + first;
+
+    if (job->kernel != nullptr)
+    {
+        job->kernel(source, count, destination, job->curve);
+        return;
+    }
+
+    const uint8_t *table = job->table;
+    for (size_t i = 0; i < count; i++)
+        destination[i] = table[source[i]];
+}
+
+// Shadows clipping point and midtones balance from a histogram of a subsample of the frame.
+void estimateStretch(const uint16_t *source, size_t count, Curve &curve)
+{
+    // Use an odd stride so Bayer frames are sampled across all color channels.
+    size_t step = std::max<size_t>(1, count / STRETCH_SAMPLES);
+    if (step > 1 && step % 2 == 0)
+        step++;
+
+    std::vector<uint32_t> histogram(65536, 0);
+    size_t samples = 0;
+    uint16_t maximum = 0;
+    for (size_t i = 0; i < count; i += step, samples++)
+    {
+        histogram[source[i]]++;
+        maximum = std::max(maximum, source[i]);
+    }
+
+    size_t half = (samples + 1) / 2, accumulated = 0;
+    int median = 0;
+    while (accumulated + histogram[median] < half)
+        accumulated += histogram[median++];
+
+    // The median absolute deviation is the half width of the window around the median holding half the samples
+    int mad = 0;
+    accumulated = histogram[median];
+    while (accumulated < half)
+    {
+        mad++;
+        if (median - mad >= 0)
+            accumulated += histogram[median - mad];
+        if (median + mad <= 65535)
+            accumulated += histogram[median + mad];
+    }
+
+    int black = std::max(0, static_cast<int>(median + STRETCH_SHADOWS * 1.4826 * mad));
+    int white = std::max<int>(maximum, black + 1);
+    double x = static_cast<double>(median - black) / (white - black);
+    // Midtones balance that maps the median to the background level
+    double midtones = x * (1 - STRETCH_BACKGROUND) / (x * (1 - 2 * STRETCH_BACKGROUND) + STRETCH_BACKGROUND);
+
+    curve.black = black;
+    curve.range = white - black;
+    curve.scale = 1.0f / curve.range;
+    curve.midtones = std::min(std::max(midtones, 0.001), 0.999);
+}
+}
 
 GammaLut16::GammaLut16(double gamma, double a, double b, double Ii)
 {
     mLookUpTable.resize(65536);
-    
+
     unsigned int i = 0;
-    for (auto &value: mLookUpTable)
+    for (auto &value : mLookUpTable)
     {
         double I = static_cast<double>(i++) / 65535.0;
         double p;
@@ -40,16 +196,49 @@ GammaLut16::GammaLut16(double gamma, double a, double b, double Ii)
     }
 }
 
-void GammaLut16::apply(const uint16_t *source, size_t count, uint8_t *destination) const
+void GammaLut16::setMode(Mode mode)
 {
-    apply(source, source + count, destination);
+    mMode = mode;
 }
 
+GammaLut16::Mode GammaLut16::mode() const
+{
+    return mMode;
+}
 
-void GammaLut16::apply(const uint16_t *first, const uint16_t *last, uint8_t *destination) const
+void GammaLut16::apply(const uint16_t *source, size_t count, uint8_t *destination) const
 {
-    const uint16_t *lookUpTable = mLookUpTable.data();
+    if (count == 0)
+        return;
+
+    MapJob job;
+    job.table = mLookUpTable.data();
+    job.kernel = nullptr;
+    job.source = source;
+    job.count = count;
+    job.destination = destination;
+    job.curve.black = 0;
+    job.curve.range = 65535;
+    job.curve.scale = 1.0f / 65535;
+    job.curve.midtones = 0.5f;
 
-    while (first != last)
-        *destination++ = lookUpTable[*first++];
+    switch (mMode)
+    {
+        case MODE_LINEAR:
+            job.kernel = mapLinear;
+            break;
+        case MODE_STRETCH:
+            estimateStretch(source, count, job.curve);
+            job.kernel = mapStretch;
+            break;
+        default:
+            break;
+    }
+
+    dsp_parallel_for(static_cast<int>((count + JOB_PIXELS - 1) / JOB_PIXELS), mapJob, &job);
+}
+
+void GammaLut16::apply(const uint16_t *first, const uint16_t *last, uint8_t *destination) const
+{
+    apply(first, last - first, destination);
 }
@@ -22,19 +22,45 @@
 */
 #pragma once
 
-#include <vector>
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
+#include <vector>
 
+/**
+ * @brief The GammaLut16 class reduces 16 bit frames to 8 bit for the preview.
+ *
+ * The frame is mapped through one of three curves. Gamma is the sRGB like curve given to the constructor, linear maps
+ * the full range linearly, and stretch clips the shadows below the histogram peak and applies a midtones transfer
+ * function that brings the background to a quarter of the output range. The gamma curve is a 64 KiB lookup table,
+ * the linear and stretch curves change with each frame and are computed with vectorized float arithmetic instead. On
+ * x86-64 Linux, an AVX2 version of these kernels is selected at runtime. Large frames are split across the libdsp
+ * thread pool.
+ */
 class GammaLut16
 {
+public:
+    enum Mode
+    {
+        MODE_GAMMA,
+        MODE_LINEAR,
+        MODE_STRETCH
+    };
+
 public:
     GammaLut16(double gamma = 2.4, double a = 12.92, double b = 0.055, double Ii = 0.00304);
 
 public:
+    void setMode(Mode mode);
+    Mode mode() const;
+
+    /**
+     * @brief apply Map 16 bit pixels to 8 bit. In stretch mode, the curve is estimated from a histogram of source.
+     */
     void apply(const uint16_t *source, size_t count, uint8_t *destination) const;
     void apply(const uint16_t *first, const uint16_t *last, uint8_t *destination) const;
 
 protected:
-    std::vector<uint16_t> mLookUpTable;
+    std::atomic<Mode> mMode {MODE_GAMMA};
+    std::vector<uint8_t> mLookUpTable;
 };
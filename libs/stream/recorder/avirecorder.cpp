@@ -0,0 +1,311 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    AVI Recorder, stores MJPEG frames without decoding them.
+    See the Microsoft AVI RIFF File Reference for the file format.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "avirecorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#define ERRMSGSIZ 1024
+
+// RIFF header, hdrl list and movi list header
+static constexpr uint32_t AVI_HEADER_SIZE = 224;
+// Position of the movi fourcc, index offsets are relative to it
+static constexpr uint32_t AVI_MOVI_OFFSET = 220;
+static constexpr uint32_t AVIF_HASINDEX   = 0x10;
+static constexpr uint32_t AVIIF_KEYFRAME  = 0x10;
+
+namespace INDI
+{
+
+class AVIChunkWriter
+{
+    public:
+        explicit AVIChunkWriter(std::vector<uint8_t> &buffer) : buffer(buffer) {}
+
+        void fourcc(const char *id)
+        {
+            buffer.insert(buffer.end(), id, id + 4);
+        }
+        void u16(uint16_t value)
+        {
+            buffer.push_back(value & 0xFF);
+            buffer.push_back(value >> 8);
+        }
+        void u32(uint32_t value)
+        {
+            u16(value & 0xFFFF);
+            u16(value >> 16);
+        }
+
+    private:
+        std::vector<uint8_t> &buffer;
+};
+
+AVIRecorder::AVIRecorder()
+{
+    name = "AVI";
+}
+
+AVIRecorder::~AVIRecorder()
+{
+    close();
+}
+
+bool AVIRecorder::setPixelFormat(INDI_PIXEL_FORMAT pixelFormat, uint8_t pixelDepth)
+{
+    INDI_UNUSED(pixelDepth);
+    m_PixelFormat = pixelFormat;
+    return pixelFormat == INDI_JPG;
+}
+
+bool AVIRecorder::setSize(uint16_t width, uint16_t height)
+{
+    if (isRecordingActive)
+        return false;
+
+    rawWidth  = width;
+    rawHeight = height;
+    return true;
+}
+
+bool AVIRecorder::open(const char *filename, char *errmsg)
+{
+    if (isRecordingActive)
+        return false;
+
+    if (m_PixelFormat != INDI_JPG)
+    {
+        snprintf(errmsg, ERRMSGSIZ, "AVI recorder only supports MJPEG streams\n");
+        return false;
+    }
+
+    if ((f = fopen(filename, "w")) == nullptr)
+    {
+        snprintf(errmsg, ERRMSGSIZ, "recorder open error %d, %s\n", errno, strerror(errno));
+        return false;
+    }
+
+    m_Width        = rawWidth;
+    m_Height       = rawHeight;
+    m_MaxFrameSize = 0;
+    m_MoviSize     = 0;
+    m_Index.clear();
+    m_Index.reserve(m_FrameCountHint);
+
+    // Placeholder, rewritten with the frame count and frame rate when the file is closed.
+    writeHeaders();
+    isRecordingActive = true;
+    return true;
+}
+
+bool AVIRecorder::close()
+{
+    if (f)
+    {
+        std::vector<uint8_t> index;
+        index.reserve(8 + m_Index.size() * 16);
+        AVIChunkWriter idx1(index);
+        idx1.fourcc("idx1");
+        idx1.u32(m_Index.size() * 16);
+        for (const auto &entry : m_Index)
+        {
+            idx1.fourcc("00dc");
+            idx1.u32(AVIIF_KEYFRAME);
+            idx1.u32(entry.offset);
+            idx1.u32(entry.size);
+        }
+        fwrite(index.data(), 1, index.size(), f);
+
+        writeHeaders();
+        fclose(f);
+        f = nullptr;
+        m_Index.clear();
+    }
+
+    isRecordingActive = false;
+    return true;
+}
+
+bool AVIRecorder::writeFrame(const uint8_t *frame, uint32_t nbytes)
+{
+    if (!isRecordingActive)
+        return false;
+
+    uint32_t padding = nbytes & 1;
+
+    // RIFF sizes are 32 bit, leave room for the index
+    uint64_t fileSize = AVI_HEADER_SIZE + m_MoviSize + 8 + nbytes + padding + 8 + (m_Index.size() + 1) * 16;
+    if (fileSize > UINT32_MAX)
+        return false;
+
+    if (m_Index.empty())
+    {
+        jpegSize(frame, nbytes, m_Width, m_Height);
+        m_FirstFrame = std::chrono::steady_clock::now();
+    }
+    m_LastFrame = std::chrono::steady_clock::now();
+
+    const uint8_t header[8] =
+    {
+        '0', '0', 'd', 'c',
+        static_cast<uint8_t>(nbytes), static_cast<uint8_t>(nbytes >> 8),
+        static_cast<uint8_t>(nbytes >> 16), static_cast<uint8_t>(nbytes >> 24)
+    };
+
+    const uint8_t zero = 0;
+    if (fwrite(header, 1, sizeof(header), f) != sizeof(header) ||
+            fwrite(frame, 1, nbytes, f) != nbytes ||
+            fwrite(&zero, 1, padding, f) != padding)
+        return false;
+
+    m_Index.push_back(IndexEntry{static_cast<uint32_t>(AVI_HEADER_SIZE - AVI_MOVI_OFFSET + m_MoviSize), nbytes});
+    m_MoviSize += 8 + nbytes + padding;
+    m_MaxFrameSize = std::max(m_MaxFrameSize, nbytes);
+    return true;
+}
+
+void AVIRecorder::writeHeaders()
+{
+    uint32_t frames = m_Index.size();
+
+    // Use the measured frame rate, fall back to the stream frame rate
+    uint32_t usPerFrame = m_FPS > 0 ? 1000000 / m_FPS : 1000000;
+    if (frames > 1)
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(m_LastFrame - m_FirstFrame).count();
+        if (elapsed > 0)
+            usPerFrame = elapsed / (frames - 1);
+    }
+    usPerFrame = std::max<uint32_t>(1, usPerFrame);
+
+    uint32_t indexSize = 8 + frames * 16;
+    uint32_t riffSize  = AVI_HEADER_SIZE - 8 + m_MoviSize + indexSize;
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(AVI_HEADER_SIZE);
+    AVIChunkWriter w(buffer);
+
+    w.fourcc("RIFF");
+    w.u32(riffSize);
+    w.fourcc("AVI ");
+
+    w.fourcc("LIST");
+    w.u32(192);
+    w.fourcc("hdrl");
+
+    // Main AVI header
+    w.fourcc("avih");
+    w.u32(56);
+    w.u32(usPerFrame);
+    w.u32(static_cast<uint64_t>(m_MaxFrameSize) * 1000000 / usPerFrame);
+    w.u32(0);
+    w.u32(AVIF_HASINDEX);
+    w.u32(frames);
+    w.u32(0);
+    w.u32(1);
+    w.u32(m_MaxFrameSize);
+    w.u32(m_Width);
+    w.u32(m_Height);
+    for (int i = 0; i < 4; i++)
+        w.u32(0);
+
+    w.fourcc("LIST");
+    w.u32(116);
+    w.fourcc("strl");
+
+    // Stream header
+    w.fourcc("strh");
+    w.u32(56);
+    w.fourcc("vids");
+    w.fourcc("MJPG");
+    w.u32(0);
+    w.u16(0);
+    w.u16(0);
+    w.u32(0);
+    w.u32(usPerFrame);
+    w.u32(1000000);
+    w.u32(0);
+    w.u32(frames);
+    w.u32(m_MaxFrameSize);
+    w.u32(UINT32_MAX);
+    w.u32(0);
+    w.u16(0);
+    w.u16(0);
+    w.u16(m_Width);
+    w.u16(m_Height);
+
+    // Stream format, BITMAPINFOHEADER
+    w.fourcc("strf");
+    w.u32(40);
+    w.u32(40);
+    w.u32(m_Width);
+    w.u32(m_Height);
+    w.u16(1);
+    w.u16(24);
+    w.fourcc("MJPG");
+    w.u32(m_Width * m_Height * 3);
+    w.u32(0);
+    w.u32(0);
+    w.u32(0);
+    w.u32(0);
+
+    w.fourcc("LIST");
+    w.u32(4 + m_MoviSize);
+    w.fourcc("movi");
+
+    fseek(f, 0L, SEEK_SET);
+    fwrite(buffer.data(), 1, buffer.size(), f);
+    fseek(f, 0L, SEEK_END);
+}
+
+bool AVIRecorder::jpegSize(const uint8_t *frame, uint32_t nbytes, uint16_t &width, uint16_t &height)
+{
+    if (nbytes < 4 || frame[0] != 0xFF || frame[1] != 0xD8)
+        return false;
+
+    // Walk the markers up to the start of frame
+    uint32_t i = 2;
+    while (i + 9 < nbytes)
+    {
+        if (frame[i] != 0xFF)
+            return false;
+
+        uint8_t marker  = frame[i + 1];
+        uint32_t length = (frame[i + 2] << 8) | frame[i + 3];
+
+        // SOF0 to SOF15, except DHT, JPG and DAC
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+        {
+            height = (frame[i + 5] << 8) | frame[i + 6];
+            width  = (frame[i + 7] << 8) | frame[i + 8];
+            return true;
+        }
+
+        i += 2 + length;
+    }
+
+    return false;
+}
+
+}
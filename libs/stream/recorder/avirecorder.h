@@ -0,0 +1,78 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    AVI Recorder
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#pragma once
+
+#include "recorderinterface.h"
+
+#include <chrono>
+#include <cstdint>
+#include <stdio.h>
+#include <vector>
+
+namespace INDI
+{
+
+/**
+ * @brief The AVIRecorder class records MJPEG streams into an MJPEG AVI file.
+ *
+ * Compressed frames are stored as they are received, so recording does not decode any frame. The AVI index allows
+ * random access to single frames for later processing. The frame rate in the header is the average rate measured
+ * over the recording. AVI 1.0 files are limited to 4 GB, frames beyond that limit are rejected.
+ */
+class AVIRecorder : public RecorderInterface
+{
+  public:
+    AVIRecorder();
+    virtual ~AVIRecorder();
+
+    virtual const char *getExtension() { return ".avi"; }
+    virtual bool setPixelFormat(INDI_PIXEL_FORMAT pixelFormat, uint8_t pixelDepth);
+    virtual bool setSize(uint16_t width, uint16_t height);
+    virtual bool open(const char *filename, char *errmsg);
+    virtual bool close();
+    virtual bool writeFrame(const uint8_t *frame, uint32_t nbytes);
+    virtual void setStreamEnabled(bool enable) { isStreamingActive = enable; }
+
+  protected:
+    bool isRecordingActive = false, isStreamingActive = false;
+    uint16_t rawWidth = 0, rawHeight = 0;
+    INDI_PIXEL_FORMAT m_PixelFormat = INDI_MONO;
+
+  private:
+    typedef struct
+    {
+        uint32_t offset;
+        uint32_t size;
+    } IndexEntry;
+
+    void writeHeaders();
+    static bool jpegSize(const uint8_t *frame, uint32_t nbytes, uint16_t &width, uint16_t &height);
+
+    FILE *f = nullptr;
+    std::vector<IndexEntry> m_Index;
+    uint16_t m_Width = 0, m_Height = 0;
+    uint32_t m_MaxFrameSize = 0;
+    uint64_t m_MoviSize = 0;
+    std::chrono::steady_clock::time_point m_FirstFrame, m_LastFrame;
+};
+
+}
@@ -67,6 +67,10 @@ class RecorderInterface
     virtual bool setSize(uint16_t width, uint16_t height) = 0;
     // Set FPS
     virtual bool setFPS(float FPS) { m_FPS = FPS; return true; }
+    // Expected number of frames of the next recording, 0 if unknown. Used to preallocate files.
+    virtual void setFrameCountHint(uint32_t frames) { m_FrameCountHint = frames; }
+    // Write frames bypassing the page cache, if the recorder supports it.
+    virtual void setDirectIO(bool enable) { m_DirectIO = enable; }
     virtual bool open(const char *filename, char *errmsg)                          = 0;
     virtual bool close()                                                           = 0;
     // when frame is in known encoding format
@@ -79,6 +83,8 @@ class RecorderInterface
   protected:
     const char *name;
     float m_FPS = 1;
+    uint32_t m_FrameCountHint = 0;
+    bool m_DirectIO = false;
 };
 
 }
@@ -24,6 +24,7 @@
 
 #include "recordermanager.h"
 #include "serrecorder.h"
+#include "avirecorder.h"
 
 #ifdef HAVE_THEORA
 #include "theorarecorder.h"
@@ -35,6 +36,7 @@ namespace INDI
 RecorderManager::RecorderManager()
 {
     recorder_list.push_back(new SER_Recorder());
+    recorder_list.push_back(new AVIRecorder());
     #ifdef HAVE_THEORA
     recorder_list.push_back(new TheoraRecorder());
     #endif
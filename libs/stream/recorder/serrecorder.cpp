@@ -28,14 +28,25 @@
 #include "serrecorder.h"
 #include "jpegutils.h"
 
+#include <algorithm>
 #include <ctime>
 #include <cerrno>
 #include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/time.h>
 
 
 #define ERRMSGSIZ 1024
 
+// Size of the SER file header in bytes
+static constexpr size_t SER_HEADER_SIZE = 178;
+// O_DIRECT requires buffers, offsets and sizes aligned to the logical block size of the device
+static constexpr size_t SER_DIRECT_ALIGNMENT = 4096;
+// Size and number of staging buffers used with direct I/O
+static constexpr size_t SER_DIRECT_BLOCK_SIZE = 8 * 1024 * 1024;
+static constexpr int SER_DIRECT_BLOCKS = 4;
+
 namespace INDI
 {
 
@@ -60,6 +71,11 @@ SER_Recorder::SER_Recorder()
 
 SER_Recorder::~SER_Recorder()
 {
+    close();
+
+    for (auto buffer : m_DirectBuffers)
+        free(buffer);
+
     free(jpegBuffer);
 }
 
@@ -98,21 +114,35 @@ void SER_Recorder::write_long_int_le(uint64_t *i)
     }
 }
 
+static uint8_t *ser_put_le(uint8_t *buffer, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        *buffer++ = (value >> (8 * i)) & 0xFF;
+    return buffer;
+}
+
+void SER_Recorder::encode_header(const ser_header *s, uint8_t *buffer)
+{
+    memcpy(buffer, s->FileID, 14);
+    buffer = ser_put_le(buffer + 14, s->LuID, 4);
+    buffer = ser_put_le(buffer, s->ColorID, 4);
+    buffer = ser_put_le(buffer, s->LittleEndian, 4);
+    buffer = ser_put_le(buffer, s->ImageWidth, 4);
+    buffer = ser_put_le(buffer, s->ImageHeight, 4);
+    buffer = ser_put_le(buffer, s->PixelDepth, 4);
+    buffer = ser_put_le(buffer, s->FrameCount, 4);
+    memcpy(buffer, s->Observer, 40);
+    memcpy(buffer + 40, s->Instrume, 40);
+    memcpy(buffer + 80, s->Telescope, 40);
+    buffer = ser_put_le(buffer + 120, s->DateTime, 8);
+    ser_put_le(buffer, s->DateTime_UTC, 8);
+}
+
 void SER_Recorder::write_header(ser_header *s)
 {
-    fwrite((s->FileID), sizeof(char), 14, f);
-    write_int_le(&(s->LuID));
-    write_int_le(&(s->ColorID));
-    write_int_le(&(s->LittleEndian));
-    write_int_le(&(s->ImageWidth));
-    write_int_le(&(s->ImageHeight));
-    write_int_le(&(s->PixelDepth));
-    write_int_le(&(s->FrameCount));
-    fwrite((s->Observer), sizeof(char), 40, f);
-    fwrite((s->Instrume), sizeof(char), 40, f);
-    fwrite((s->Telescope), sizeof(char), 40, f);
-    write_long_int_le(&(s->DateTime));
-    write_long_int_le(&(s->DateTime_UTC));
+    uint8_t buffer[SER_HEADER_SIZE];
+    encode_header(s, buffer);
+    fwrite(buffer, 1, sizeof(buffer), f);
 }
 
 bool SER_Recorder::setPixelFormat(INDI_PIXEL_FORMAT pixelFormat, uint8_t pixelDepth)
@@ -175,25 +205,203 @@ bool SER_Recorder::open(const char *filename, char *errmsg)
     if (isRecordingActive)
         return false;
     serh.FrameCount = 0;
-    if ((f = fopen(filename, "w")) == nullptr)
+    serh.DateTime     = getLocalTimeStamp();
+    serh.DateTime_UTC = getUTCTimeStamp();
+    frame_size        = serh.ImageWidth * serh.ImageHeight * (serh.PixelDepth <= 8 ? 1 : 2) * number_of_planes;
+
+    frameStamps.clear();
+    frameStamps.reserve(m_FrameCountHint);
+
+    if (m_DirectIO)
+    {
+        if (!openDirect(filename, errmsg))
+            return false;
+    }
+    else
+    {
+        if ((f = fopen(filename, "w")) == nullptr)
+        {
+            snprintf(errmsg, ERRMSGSIZ, "recorder open error %d, %s\n", errno, strerror(errno));
+            return false;
+        }
+
+        write_header(&serh);
+    }
+
+    isRecordingActive = true;
+
+    return true;
+}
+
+bool SER_Recorder::openDirect(const char *filename, char *errmsg)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+#ifdef O_DIRECT
+    m_Fd = ::open(filename, flags | O_DIRECT, 0644);
+    // Some file systems, e.g. tmpfs, do not support O_DIRECT
+    if (m_Fd < 0 && errno == EINVAL)
+#endif
+        m_Fd = ::open(filename, flags, 0644);
+
+    if (m_Fd < 0)
     {
         snprintf(errmsg, ERRMSGSIZ, "recorder open error %d, %s\n", errno, strerror(errno));
         return false;
     }
 
-    serh.DateTime     = getLocalTimeStamp();
-    serh.DateTime_UTC = getUTCTimeStamp();
-    write_header(&serh);
-    frame_size        = serh.ImageWidth * serh.ImageHeight * (serh.PixelDepth <= 8 ? 1 : 2) * number_of_planes;
-    isRecordingActive = true;
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    fcntl(m_Fd, F_NOCACHE, 1);
+#endif
 
-    frameStamps.clear();
+#ifdef __linux__
+    // Reserve space for the expected frames and their timestamps, so the file is laid out in few extents and the
+    // writer thread does not have to allocate blocks. The file is truncated to its real size when it is closed.
+    if (m_FrameCountHint > 0 && m_PixelFormat != INDI_JPG)
+    {
+        off_t expectedSize = SER_HEADER_SIZE + static_cast<off_t>(m_FrameCountHint) * (frame_size + sizeof(uint64_t));
+        fallocate(m_Fd, 0, 0, expectedSize);
+    }
+#endif
+
+    if (m_DirectBuffers.empty())
+    {
+        for (int i = 0; i < SER_DIRECT_BLOCKS; i++)
+        {
+            void *buffer = nullptr;
+            if (posix_memalign(&buffer, SER_DIRECT_ALIGNMENT, SER_DIRECT_BLOCK_SIZE) != 0)
+            {
+                snprintf(errmsg, ERRMSGSIZ, "recorder open error, not enough memory for direct I/O\n");
+                ::close(m_Fd);
+                m_Fd = -1;
+                return false;
+            }
+            m_DirectBuffers.push_back(static_cast<uint8_t *>(buffer));
+            m_FreeBlocks.push(static_cast<uint8_t *>(buffer));
+        }
+    }
+
+    m_WriteError = 0;
+    m_FileSize   = 0;
+    m_FreeBlocks.pop(m_CurrentBlock.data);
+    m_CurrentBlock.size   = 0;
+    m_CurrentBlock.offset = 0;
+
+    m_WriteThread = std::thread(&SER_Recorder::asyncWriteThread, this);
+
+    // The header is rewritten with the final frame count when the file is closed
+    uint8_t header[SER_HEADER_SIZE];
+    encode_header(&serh, header);
+    writeDirect(header, sizeof(header));
 
     return true;
 }
 
+bool SER_Recorder::writeDirect(const uint8_t *data, size_t size)
+{
+    while (size > 0)
+    {
+        size_t n = std::min(size, SER_DIRECT_BLOCK_SIZE - m_CurrentBlock.size);
+        memcpy(m_CurrentBlock.data + m_CurrentBlock.size, data, n);
+        m_CurrentBlock.size += n;
+        m_FileSize += n;
+        data += n;
+        size -= n;
+
+        if (m_CurrentBlock.size == SER_DIRECT_BLOCK_SIZE)
+        {
+            off_t offset = m_CurrentBlock.offset + SER_DIRECT_BLOCK_SIZE;
+            m_FullBlocks.push(std::move(m_CurrentBlock));
+
+            // Wait for the writer thread to return a buffer
+            m_FreeBlocks.pop(m_CurrentBlock.data);
+            m_CurrentBlock.size   = 0;
+            m_CurrentBlock.offset = offset;
+        }
+    }
+
+    return m_WriteError == 0;
+}
+
+bool SER_Recorder::flushDirect()
+{
+    // Pad the last block to the alignment, the padding is truncated afterwards
+    size_t padded = (m_CurrentBlock.size + SER_DIRECT_ALIGNMENT - 1) / SER_DIRECT_ALIGNMENT * SER_DIRECT_ALIGNMENT;
+    memset(m_CurrentBlock.data + m_CurrentBlock.size, 0, padded - m_CurrentBlock.size);
+    m_CurrentBlock.size = padded;
+
+    m_FullBlocks.push(std::move(m_CurrentBlock));
+    m_FullBlocks.push(DirectBlock{nullptr, 0, 0});
+    m_WriteThread.join();
+    m_CurrentBlock.data = nullptr;
+
+    return m_WriteError == 0;
+}
+
+bool SER_Recorder::closeDirect()
+{
+    // Timestamps follow the last frame
+    std::vector<uint8_t> trailer(frameStamps.size() * sizeof(uint64_t));
+    for (size_t i = 0; i < frameStamps.size(); i++)
+        ser_put_le(trailer.data() + i * sizeof(uint64_t), frameStamps[i], sizeof(uint64_t));
+    writeDirect(trailer.data(), trailer.size());
+    frameStamps.clear();
+
+    bool ok = flushDirect();
+
+#ifdef O_DIRECT
+    // The header is not aligned, write it through the page cache
+    fcntl(m_Fd, F_SETFL, fcntl(m_Fd, F_GETFL) & ~O_DIRECT);
+#endif
+
+    uint8_t header[SER_HEADER_SIZE];
+    encode_header(&serh, header);
+    ok = ok && ftruncate(m_Fd, m_FileSize) == 0 && pwrite(m_Fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    ok = (::close(m_Fd) == 0) && ok;
+    m_Fd = -1;
+
+    return ok;
+}
+
+void SER_Recorder::asyncWriteThread()
+{
+    DirectBlock block;
+    while (m_FullBlocks.pop(block) && block.data != nullptr)
+    {
+        size_t written = 0;
+        while (written < block.size && m_WriteError == 0)
+        {
+            ssize_t n = pwrite(m_Fd, block.data + written, block.size - written, block.offset + written);
+            if (n < 0 && errno == EINTR)
+                continue;
+#ifdef O_DIRECT
+            // Direct I/O may be refused for some devices or alignments, continue without it
+            if (n < 0 && errno == EINVAL && (fcntl(m_Fd, F_GETFL) & O_DIRECT))
+            {
+                fcntl(m_Fd, F_SETFL, fcntl(m_Fd, F_GETFL) & ~O_DIRECT);
+                continue;
+            }
+#endif
+            if (n <= 0)
+            {
+                m_WriteError = (n == 0) ? EIO : errno;
+                break;
+            }
+            written += n;
+        }
+
+        m_FreeBlocks.push(std::move(block.data));
+    }
+}
+
 bool SER_Recorder::close()
 {
+    bool ok = true;
+
+    if (m_Fd >= 0)
+    {
+        ok = closeDirect();
+    }
+
     if (f)
     {
         // Write all timestamps
@@ -209,7 +417,7 @@ bool SER_Recorder::close()
     }
 
     isRecordingActive = false;
-    return true;
+    return ok;
 }
 
 bool SER_Recorder::writeFrame(const uint8_t *frame, uint32_t nbytes)
@@ -266,7 +474,14 @@ bool SER_Recorder::writeFrame(const uint8_t *frame, uint32_t nbytes)
         serh.ImageWidth = w;
         serh.ImageHeight = h;
         serh.ColorID = (naxis == 3) ? SER_RGB : SER_MONO;
-        fwrite(jpegBuffer, 1, memsize, f);
+        frame  = jpegBuffer;
+        nbytes = memsize;
+    }
+
+    if (m_Fd >= 0)
+    {
+        if (!writeDirect(frame, nbytes))
+            return false;
     }
     else
         fwrite(frame, 1, nbytes, f);
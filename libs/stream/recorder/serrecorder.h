@@ -22,9 +22,13 @@
 #pragma once
 
 #include "recorderinterface.h"
+#include "spscqueue.h"
 
+#include <atomic>
 #include <cstdint>
 #include <stdio.h>
+#include <sys/types.h>
+#include <thread>
 
 typedef struct ser_header
 {
@@ -66,6 +70,11 @@ namespace INDI
 
 /**
  * @brief The SER_Recorder class implements recording of video streams in SER format.
+ *
+ * With direct I/O enabled, the file is preallocated from the frame count hint and frames are copied into aligned
+ * staging buffers, which a writer thread writes with O_DIRECT, bypassing the page cache. writeFrame() then only
+ * blocks when all staging buffers are waiting for the disk. Timestamps are kept in a preallocated trailer buffer and
+ * written with the last staging buffer when the file is closed.
  */
 class SER_Recorder : public RecorderInterface
 {
@@ -90,6 +99,7 @@ class SER_Recorder : public RecorderInterface
     void write_int_le(uint32_t *i);
     void write_long_int_le(uint64_t *i);
     void write_header(ser_header *s);
+    void encode_header(const ser_header *s, uint8_t *buffer);
     ser_header serh;
     bool isRecordingActive = false, isStreamingActive = false;
     FILE *f;
@@ -124,5 +134,29 @@ class SER_Recorder : public RecorderInterface
 
     uint8_t *jpegBuffer=nullptr;
     INDI_PIXEL_FORMAT m_PixelFormat;
+
+  private:
+    // Direct I/O
+    typedef struct
+    {
+        uint8_t *data;
+        size_t size;
+        off_t offset;
+    } DirectBlock;
+
+    bool openDirect(const char *filename, char *errmsg);
+    bool writeDirect(const uint8_t *data, size_t size);
+    bool closeDirect();
+    bool flushDirect();
+    void asyncWriteThread();
+
+    int m_Fd {-1};
+    std::vector<uint8_t *> m_DirectBuffers;
+    SPSCQueue<DirectBlock> m_FullBlocks {8};
+    SPSCQueue<uint8_t *> m_FreeBlocks {8};
+    std::thread m_WriteThread;
+    std::atomic<int> m_WriteError {0};
+    DirectBlock m_CurrentBlock {nullptr, 0, 0};
+    off_t m_FileSize {0};
 };
 }
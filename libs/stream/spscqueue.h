@@ -0,0 +1,261 @@
+/*
+    Copyright (C) 2026 by the INDI Library contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \class SPSCQueue template
+ * \brief The SPSCQueue class is a bounded, lock-free FIFO for exactly one producer thread and one consumer thread.
+ *
+ * Elements are moved into a preallocated ring, so push and pop never allocate. The fill level is read without
+ * locking. Threads only sleep when there is nothing to do: the consumer spins briefly before blocking, and the
+ * producer wakes it only if it is actually asleep, so a busy consumer drains a whole batch of elements without any
+ * system call.
+ *
+ * push() must only be called from the producer thread, pop() only from the consumer thread. abort() and size() may
+ * be called from any thread.
+ */
+template <typename T>
+class SPSCQueue
+{
+public:
+    /**
+     * @param capacity maximum number of elements, rounded up to a power of two.
+     */
+    explicit SPSCQueue(size_t capacity = 1024);
+
+    /**
+     * @brief Move data to queue
+     * @param data the data will be moved using std::move
+     * @return returns false if the queue is full, data is left untouched
+     */
+    bool push(T && data);
+
+    /**
+     * @brief Pop data from queue
+     * @param dest the data will be moved from the queue
+     * @return returns false if the abort function was called
+     */
+    bool pop(T & dest);
+
+    /**
+     * @brief Pop data from queue
+     * @param dest the data will be moved from the queue
+     * @param msecs timeout in milliseconds
+     * @return returns false if timeout or the abort function was called
+     */
+    bool pop(T & dest, uint32_t msecs);
+
+    /**
+     * @brief Wait for an empty queue
+     */
+    void waitForEmpty() const;
+
+    /**
+     * @brief Wait for an empty queue
+     * @param msecs timeout in milliseconds
+     * @return returns false if timeout
+     */
+    bool waitForEmpty(uint32_t msecs) const;
+
+    /**
+     * @brief Wake up and exit pop methods with false return. The queue can not be used afterwards.
+     */
+    void abort();
+
+    /**
+     * @brief Return the number of items in the queue
+     * @return count of elements
+     */
+    size_t size() const;
+
+    /**
+     * @brief Return the maximum number of items in the queue
+     */
+    size_t capacity() const;
+
+protected:
+    bool tryPop(T & dest);
+    bool isEmpty() const;
+
+protected:
+    // Number of polls before the consumer goes to sleep
+    static constexpr int spinCount = 64;
+
+    std::vector<T> ring;
+    size_t mask;
+
+    // Written by the consumer only
+    alignas(64) std::atomic<size_t> head {0};
+    // Written by the producer only
+    alignas(64) std::atomic<size_t> tail {0};
+
+    alignas(64) std::atomic<bool> consumerSleeping {false};
+    mutable std::atomic<bool> emptyWaiting {false};
+    std::atomic<bool> aborted {false};
+
+    mutable std::mutex mutex;
+    mutable std::condition_variable decrease;
+    mutable std::condition_variable increase;
+};
+
+// implementation
+template <typename T>
+inline SPSCQueue<T>::SPSCQueue(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    ring.resize(size);
+    mask = size - 1;
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::push(T && data)
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) > mask)
+        return false; // full
+
+    ring[t & mask] = std::move(data);
+    tail.store(t + 1, std::memory_order_seq_cst);
+
+    // Only pay for a wakeup if the consumer is asleep
+    if (consumerSleeping.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        increase.notify_one();
+    }
+    return true;
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::tryPop(T & dest)
+{
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire))
+        return false;
+
+    dest = std::move(ring[h & mask]);
+    ring[h & mask] = T();
+    head.store(h + 1, std::memory_order_seq_cst);
+
+    if (emptyWaiting.load(std::memory_order_seq_cst) && h + 1 == tail.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        decrease.notify_all();
+    }
+    return true;
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::isEmpty() const
+{
+    return head.load(std::memory_order_seq_cst) == tail.load(std::memory_order_seq_cst);
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::pop(T & dest)
+{
+    for (int i = 0; i < spinCount; i++)
+    {
+        if (aborted.load(std::memory_order_relaxed))
+            return false;
+        if (tryPop(dest))
+            return true;
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    consumerSleeping.store(true, std::memory_order_seq_cst);
+    increase.wait(lock, [this](){ return aborted || !isEmpty(); });
+    consumerSleeping.store(false, std::memory_order_relaxed);
+    lock.unlock();
+
+    if (aborted)
+        return false;
+
+    return tryPop(dest);
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::pop(T & dest, uint32_t msecs)
+{
+    if (aborted)
+        return false;
+    if (tryPop(dest))
+        return true;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    consumerSleeping.store(true, std::memory_order_seq_cst);
+    bool ready = increase.wait_for(lock, std::chrono::milliseconds(msecs), [this](){ return aborted || !isEmpty(); });
+    consumerSleeping.store(false, std::memory_order_relaxed);
+    lock.unlock();
+
+    if (!ready || aborted)
+        return false; // timeout or abort
+
+    return tryPop(dest);
+}
+
+template <typename T>
+inline size_t SPSCQueue<T>::size() const
+{
+    size_t h = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - h;
+}
+
+template <typename T>
+inline size_t SPSCQueue<T>::capacity() const
+{
+    return ring.size();
+}
+
+template <typename T>
+inline void SPSCQueue<T>::waitForEmpty() const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    emptyWaiting.store(true, std::memory_order_seq_cst);
+    decrease.wait(lock, [this](){ return aborted || isEmpty(); });
+    emptyWaiting.store(false, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline bool SPSCQueue<T>::waitForEmpty(uint32_t msecs) const
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    emptyWaiting.store(true, std::memory_order_seq_cst);
+    bool empty = decrease.wait_for(lock, std::chrono::milliseconds(msecs), [this](){ return aborted || isEmpty(); });
+    emptyWaiting.store(false, std::memory_order_relaxed);
+    return empty;
+}
+
+template <typename T>
+inline void SPSCQueue<T>::abort()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    aborted = true;
+    increase.notify_all();
+    decrease.notify_all();
+}
@@ -28,10 +28,11 @@
 #include "indisensorinterface.h"
 #include "indilogger.h"
 #include "indiutility.h"
-#include "indisinglethreadpool.h"
 #include "indielapsedtimer.h"
+#include "encoder/ratecontrol.h"
 
 #include <cerrno>
+#include <cstring>
 #include <sys/stat.h>
 
 #include <algorithm>
@@ -57,16 +58,25 @@ StreamManagerPrivate::StreamManagerPrivate(DefaultDevice *defaultDevice)
 
     LOGF_DEBUG("Using default encoder (%s)", encoder->getName());
 
-    framesThread = std::thread(&StreamManagerPrivate::asyncStreamThread, this);
+    framesThread  = std::thread(&StreamManagerPrivate::asyncStreamThread, this);
+    recordThread  = std::thread(&StreamManagerPrivate::asyncRecordThread, this);
+    previewThread = std::thread(&StreamManagerPrivate::asyncPreviewThread, this);
 }
 
 StreamManagerPrivate::~StreamManagerPrivate()
 {
-    if (framesThread.joinable())
+    framesThreadTerminate = true;
+    framesIncoming.abort();
+    framesRecord.abort();
     {
-        framesThreadTerminate = true;
-        framesIncoming.abort();
-        framesThread.join();
+        std::lock_guard<std::mutex> lock(previewMutex);
+        previewAvailable.notify_all();
+    }
+
+    for (auto thread : {&framesThread, &recordThread, &previewThread})
+    {
+        if (thread->joinable())
+            thread->join();
     }
 }
 
@@ -126,6 +136,10 @@ bool StreamManagerPrivate::initProperties()
     RecordOptionsNP.fill(getDeviceName(), "RECORD_OPTIONS",
                        "Record Options", STREAM_TAB, IP_RW, 60, IPS_IDLE);
 
+    RecordDirectIOSP[INDI::DefaultDevice::INDI_ENABLED ].fill("INDI_ENABLED",  "Enabled",  ISS_OFF);
+    RecordDirectIOSP[INDI::DefaultDevice::INDI_DISABLED].fill("INDI_DISABLED", "Disabled", ISS_ON);
+    RecordDirectIOSP.fill(getDeviceName(), "RECORD_DIRECT_IO", "Direct I/O", STREAM_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
     /* Record Switch */
     RecordStreamSP[RECORD_ON   ].fill("RECORD_ON",          "Record On",         ISS_OFF);
     RecordStreamSP[RECORD_TIME ].fill("RECORD_DURATION_ON", "Record (Duration)", ISS_OFF);
@@ -152,17 +166,47 @@ bool StreamManagerPrivate::initProperties()
     else
         EncoderSP.fill(getDeviceName(), "CCD_STREAM_ENCODER",    "Encoder", STREAM_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
+    // Rate Control
+    // The targets are the only limits, indiserver does not tell the driver how fast the client receives.
+    // 0 for both keeps the fixed quality at full scale.
+    EncoderRateNP[RATE_BITRATE].fill("RATE_BITRATE", "Target (kbit/s)", "%.0f", 0, 1000000, 100, 0);
+    EncoderRateNP[RATE_FPS    ].fill("RATE_FPS",     "Target FPS",      "%.0f", 0, 120,     1,   0);
+    EncoderRateNP[RATE_QUALITY].fill("RATE_QUALITY", "Max Quality",     "%.0f", RateControl::MINIMUM_QUALITY, 100, 1, 85);
+    if(currentDevice->getDriverInterface() & INDI::DefaultDevice::SENSOR_INTERFACE)
+        EncoderRateNP.fill(getDeviceName(), "SENSOR_STREAM_RATE", "Rate Control", STREAM_TAB, IP_RW, 0, IPS_IDLE);
+    else
+        EncoderRateNP.fill(getDeviceName(), "CCD_STREAM_RATE",    "Rate Control", STREAM_TAB, IP_RW, 0, IPS_IDLE);
+
+    EncoderInfoNP[INFO_ENCODE_TIME].fill("ENCODE_TIME", "Encode (ms)",     "%.1f", 0, 60000,   0, 0);
+    EncoderInfoNP[INFO_SEND_TIME  ].fill("SEND_TIME",   "Send (ms)",       "%.1f", 0, 60000,   0, 0);
+    EncoderInfoNP[INFO_BITRATE    ].fill("BITRATE",     "Bitrate (kbit/s)", "%.0f", 0, 1000000, 0, 0);
+    EncoderInfoNP[INFO_QUALITY    ].fill("QUALITY",     "Quality",         "%.0f", 0, 100,     0, 0);
+    if(currentDevice->getDriverInterface() & INDI::DefaultDevice::SENSOR_INTERFACE)
+        EncoderInfoNP.fill(getDeviceName(), "SENSOR_STREAM_ENCODER_INFO", "Encoder Info", STREAM_TAB, IP_RO, 0, IPS_IDLE);
+    else
+        EncoderInfoNP.fill(getDeviceName(), "CCD_STREAM_ENCODER_INFO",    "Encoder Info", STREAM_TAB, IP_RO, 0, IPS_IDLE);
+
+    // Preview Stretch
+    StretchSP[STRETCH_GAMMA  ].fill("STRETCH_GAMMA",  "Gamma",  ISS_ON);
+    StretchSP[STRETCH_LINEAR ].fill("STRETCH_LINEAR", "Linear", ISS_OFF);
+    StretchSP[STRETCH_AUTO   ].fill("STRETCH_AUTO",   "Auto",   ISS_OFF);
+    if(currentDevice->getDriverInterface() & INDI::DefaultDevice::SENSOR_INTERFACE)
+        StretchSP.fill(getDeviceName(), "SENSOR_STREAM_STRETCH", "Stretch", STREAM_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+    else
+        StretchSP.fill(getDeviceName(), "CCD_STREAM_STRETCH",    "Stretch", STREAM_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
     // Recorder Selector
     RecorderSP[RECORDER_RAW].fill("SER", "SER", ISS_ON);
+    RecorderSP[RECORDER_AVI].fill("AVI", "AVI (MJPEG)", ISS_OFF);
     RecorderSP[RECORDER_OGV].fill("OGV", "OGV", ISS_OFF);
     if(currentDevice->getDriverInterface() & INDI::DefaultDevice::SENSOR_INTERFACE)
         RecorderSP.fill(getDeviceName(), "SENSOR_STREAM_RECORDER", "Recorder", STREAM_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
     else
         RecorderSP.fill(getDeviceName(), "CCD_STREAM_RECORDER",    "Recorder", STREAM_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
-    // If we do not have theora installed, let's just define SER default recorder
+    // If we do not have theora installed, let's just define SER and AVI recorders
 #ifndef HAVE_THEORA
-    RecorderSP.resize(1);
+    RecorderSP.resize(2);
 #endif
 
     // Limits
@@ -192,8 +236,12 @@ void StreamManagerPrivate::ISGetProperties(const char *dev)
         currentDevice->defineProperty(RecordStreamSP);
         currentDevice->defineProperty(RecordFileTP);
         currentDevice->defineProperty(RecordOptionsNP);
+        currentDevice->defineProperty(RecordDirectIOSP);
         currentDevice->defineProperty(StreamFrameNP);
         currentDevice->defineProperty(EncoderSP);
+        currentDevice->defineProperty(EncoderRateNP);
+        currentDevice->defineProperty(EncoderInfoNP);
+        currentDevice->defineProperty(StretchSP);
         currentDevice->defineProperty(RecorderSP);
         currentDevice->defineProperty(LimitsNP);
     }
@@ -226,8 +274,12 @@ bool StreamManagerPrivate::updateProperties()
         currentDevice->defineProperty(RecordStreamSP);
         currentDevice->defineProperty(RecordFileTP);
         currentDevice->defineProperty(RecordOptionsNP);
+        currentDevice->defineProperty(RecordDirectIOSP);
         currentDevice->defineProperty(StreamFrameNP);
         currentDevice->defineProperty(EncoderSP);
+        currentDevice->defineProperty(EncoderRateNP);
+        currentDevice->defineProperty(EncoderInfoNP);
+        currentDevice->defineProperty(StretchSP);
         currentDevice->defineProperty(RecorderSP);
         currentDevice->defineProperty(LimitsNP);
     }
@@ -241,8 +293,12 @@ bool StreamManagerPrivate::updateProperties()
         currentDevice->deleteProperty(RecordFileTP.getName());
         currentDevice->deleteProperty(RecordStreamSP.getName());
         currentDevice->deleteProperty(RecordOptionsNP.getName());
+        currentDevice->deleteProperty(RecordDirectIOSP.getName());
         currentDevice->deleteProperty(StreamFrameNP.getName());
         currentDevice->deleteProperty(EncoderSP.getName());
+        currentDevice->deleteProperty(EncoderRateNP.getName());
+        currentDevice->deleteProperty(EncoderInfoNP.getName());
+        currentDevice->deleteProperty(StretchSP.getName());
         currentDevice->deleteProperty(RecorderSP.getName());
         currentDevice->deleteProperty(LimitsNP.getName());
     }
@@ -297,16 +353,29 @@ void StreamManagerPrivate::newFrame(const uint8_t * buffer, uint32_t nbytes)
 
     if (isStreaming || (isRecording && !isRecordingAboutToClose))
     {
-        size_t allocatedSize = nbytes * framesIncoming.size() / 1024 / 1024; // allocated size in MB
-        if (allocatedSize > LimitsNP[LIMITS_BUFFER_MAX].getValue())
+        bool record = isRecording && !isRecordingAboutToClose;
+
+        FramePool::Handle frame = framePool.acquire(nbytes);
+        if (!frame)
         {
+            dropFrame(record);
             LOG_WARN("Frame buffer is full, skipping frame...");
             return;
         }
 
-        std::vector<uint8_t> copyBuffer(buffer, buffer + nbytes); // copy the frame
+        memcpy(frame.data(), buffer, nbytes); // copy the frame
+
+        if (record)
+            ++recordBacklog;
 
-        framesIncoming.push(TimeFrame{FPSFast.deltaTime(), std::move(copyBuffer)}); // push it into the queue
+        if (framesIncoming.push(TimeFrame{FPSFast.deltaTime(), std::move(frame), record}) == false) // push it into the queue
+        {
+            if (record)
+                finishRecordFrame();
+            dropFrame(record);
+            LOG_WARN("Frame queue is full, skipping frame...");
+            return;
+        }
     }
 
     if (isRecording && !isRecordingAboutToClose)
@@ -320,7 +389,7 @@ void StreamManagerPrivate::newFrame(const uint8_t * buffer, uint32_t nbytes)
         )
         {
             LOG_INFO("Waiting for all buffered frames to be recorded");
-            framesIncoming.waitForEmpty();
+            waitForRecordBacklog();
             // duplicated message
 #if 0
             LOGF_INFO(
@@ -411,12 +480,6 @@ void StreamManagerPrivate::asyncStreamThread()
     TimeFrame sourceTimeFrame;
     sourceTimeFrame.time = 0;
 
-    std::vector<uint8_t> subframeBuffer;  // Subframe buffer for recording/streaming
-    std::vector<uint8_t> downscaleBuffer; // Downscale buffer for streaming
-
-    INDI::SingleThreadPool previewThreadPool;
-    INDI::ElapsedTimer previewElapsed;
-
     while(!framesThreadTerminate)
     {
         if (framesIncoming.pop(sourceTimeFrame) == false)
@@ -424,11 +487,15 @@ void StreamManagerPrivate::asyncStreamThread()
 
         FrameInfo srcFrameInfo = updateSourceFrameInfo();
 
-        std::vector<uint8_t> *sourceBuffer = &sourceTimeFrame.frame;
+        FramePool::Handle sourceFrame = std::move(sourceTimeFrame.frame);
+        bool record = sourceTimeFrame.record;
 
-        if (sourceBuffer->size() != srcFrameInfo.totalSize())
+        if (sourceFrame.size() != srcFrameInfo.totalSize())
         {
             LOG_ERROR("Invalid source buffer size, skipping frame...");
+            if (record)
+                finishRecordFrame();
+            dropFrame(record);
             continue;
         }
 
@@ -439,58 +506,161 @@ void StreamManagerPrivate::asyncStreamThread()
             dstFrameInfo != srcFrameInfo
         )
         {
-            subframeBuffer.resize(dstFrameInfo.totalSize());
-            subframe(sourceBuffer->data(), srcFrameInfo, subframeBuffer.data(), dstFrameInfo);
+            FramePool::Handle subframeBuffer = processPool.acquire(dstFrameInfo.totalSize());
+            if (!subframeBuffer)
+            {
+                LOG_WARN("Frame buffer is full, skipping frame...");
+                if (record)
+                    finishRecordFrame();
+                dropFrame(record);
+                continue;
+            }
 
-            sourceBuffer = &subframeBuffer;
+            subframe(sourceFrame.data(), srcFrameInfo, subframeBuffer.data(), dstFrameInfo);
+
+            sourceFrame = std::move(subframeBuffer);
         }
 
-        // For recording, save immediately.
+        // For recording, queue every frame. The recorder shares the frame with the preview.
+        if (record)
         {
-            std::lock_guard<std::mutex> lock(recordMutex);
             if (
                 isRecording && !isRecordingAboutToClose &&
-                recordStream(sourceBuffer->data(), sourceBuffer->size(), sourceTimeFrame.time) == false
+                framesRecord.push(TimeFrame{sourceTimeFrame.time, sourceFrame, true}) == false
             )
             {
-                LOG_ERROR("Recording failed.");
-                isRecordingAboutToClose = true;
+                ++recordDropped;
+                LOG_WARN("Recording buffer is full, skipping frame...");
+                finishRecordFrame();
             }
+            else if (!isRecording || isRecordingAboutToClose)
+                finishRecordFrame();
         }
 
-        // For streaming, downscale to 8bit if higher than 8bit to reduce bandwidth
+        // For streaming, only the latest frame is kept, the preview thread skips frames it is too slow for.
         // You can reduce the number of frames by setting a frame limit.
         if (isStreaming && FPSPreview.newFrame())
         {
-            // Downscale to 8bit always for streaming to reduce bandwidth
-            if (PixelFormat != INDI_JPG && PixelDepth > 8)
+            std::lock_guard<std::mutex> lock(previewMutex);
+            if (previewFrame)
+                ++previewSkipped;
+            previewFrame = std::move(sourceFrame);
+            previewAvailable.notify_one();
+        }
+    }
+}
+
+void StreamManagerPrivate::asyncRecordThread()
+{
+    TimeFrame timeFrame;
+
+    while(!framesThreadTerminate)
+    {
+        if (framesRecord.pop(timeFrame) == false)
+            continue;
+
+        {
+            std::lock_guard<std::mutex> lock(recordMutex);
+            if (
+                isRecording && !isRecordingAboutToClose &&
+                recordStream(timeFrame.frame.data(), timeFrame.frame.size(), timeFrame.time) == false
+            )
             {
-                // Allocale new buffer if size changes
-                downscaleBuffer.resize(dstFrameInfo.pixels());
+                LOG_ERROR("Recording failed.");
+                isRecordingAboutToClose = true;
+            }
+        }
+
+        timeFrame.frame.reset();
+        finishRecordFrame();
+    }
+}
+
+void StreamManagerPrivate::asyncPreviewThread()
+{
+    INDI::ElapsedTimer previewElapsed;
 
-                // Apply gamma
-                gammaLut16.apply(
-                    reinterpret_cast<const uint16_t*>(sourceBuffer->data()),
-                    downscaleBuffer.size(),
-                    downscaleBuffer.data()
-                );
+    for (;;)
+    {
+        FramePool::Handle frame;
+        {
+            std::unique_lock<std::mutex> lock(previewMutex);
+            previewAvailable.wait(lock, [this](){ return previewFrame || framesThreadTerminate; });
+            if (framesThreadTerminate)
+                break;
+            std::swap(frame, previewFrame);
+        }
 
-                sourceBuffer = &downscaleBuffer;
+        previewElapsed.start();
+
+        // Downscale to 8bit always for streaming to reduce bandwidth
+        if (PixelFormat != INDI_JPG && PixelDepth > 8)
+        {
+            FramePool::Handle downscaleBuffer = processPool.acquire(frame.size() / 2);
+            if (!downscaleBuffer)
+            {
+                ++previewDropped;
+                continue;
             }
 
-            //uploadStream(sourceBuffer->data(), sourceBuffer->size());
-            previewThreadPool.tryStart(std::bind([this, &previewElapsed](const std::atomic_bool &isAboutToQuit, std::vector<uint8_t> frame){
-                INDI_UNUSED(isAboutToQuit);
-                previewElapsed.start();
-                uploadStream(frame.data(), frame.size());
-                StreamTimeNP[0].setValue(previewElapsed.nsecsElapsed() / 1000000000.0);
-                StreamTimeNP.apply();
+            // Apply gamma
+            gammaLut16.apply(
+                reinterpret_cast<const uint16_t*>(frame.data()),
+                downscaleBuffer.size(),
+                downscaleBuffer.data()
+            );
+
+            frame = std::move(downscaleBuffer);
+        }
 
-            }, std::placeholders::_1, std::move(*sourceBuffer)));
+        if (uploadStream(frame.data(), frame.size()))
+        {
+            ++previewFrames;
+            previewBytes += frame.size();
         }
+        else
+            ++previewDropped;
+        StreamTimeNP[0].setValue(previewElapsed.nsecsElapsed() / 1000000000.0);
+        StreamTimeNP.apply();
+    }
+}
+
+void StreamManagerPrivate::dropFrame(bool record)
+{
+    if (record)
+        ++recordDropped;
+    if (isStreaming)
+        ++previewDropped;
+}
+
+void StreamManagerPrivate::logPreviewStatistics()
+{
+    double seconds = previewStatistics.nsecsElapsed() / 1e9;
+    if (seconds <= 0 || (previewFrames == 0 && previewDropped == 0))
+        return;
+
+    LOGF_INFO(
+        "Preview: %u frames sent in %.1f s (%.1f FPS, %.1f MB/s), %u replaced by newer frames, %u dropped.",
+        previewFrames.load(), seconds, previewFrames / seconds, previewBytes / seconds / 1000000.0,
+        previewSkipped.load(), previewDropped.load()
+    );
+}
+
+void StreamManagerPrivate::finishRecordFrame()
+{
+    if (--recordBacklog == 0)
+    {
+        std::lock_guard<std::mutex> lock(recordBacklogMutex);
+        recordBacklogEmpty.notify_all();
     }
 }
 
+void StreamManagerPrivate::waitForRecordBacklog()
+{
+    std::unique_lock<std::mutex> lock(recordBacklogMutex);
+    recordBacklogEmpty.wait(lock, [this](){ return recordBacklog == 0; });
+}
+
 void StreamManagerPrivate::setSize(uint16_t width, uint16_t height)
 {
     if (width != StreamFrameNP[CCDChip::FRAME_W].value || height != StreamFrameNP[CCDChip::FRAME_H].getValue())
@@ -584,7 +754,11 @@ bool StreamManagerPrivate::recordStream(const uint8_t * buffer, uint32_t nbytes,
     if (!isRecording)
         return false;
 
-    return recorder->writeFrame(buffer, nbytes);
+    if (!recorder->writeFrame(buffer, nbytes))
+        return false;
+
+    recordBytes += nbytes;
+    return true;
 }
 
 std::string StreamManagerPrivate::expand(const std::string &fname, const std::map<std::string, std::string> &patterns)
@@ -634,6 +808,13 @@ bool StreamManagerPrivate::startRecording()
     }
 
     recorder->setFPS(FpsNP[FPS_AVERAGE].value);
+    recorder->setDirectIO(RecordDirectIOSP[INDI::DefaultDevice::INDI_ENABLED].getState() == ISS_ON);
+    if (RecordStreamSP[RECORD_FRAME].getState() == ISS_ON)
+        recorder->setFrameCountHint(RecordOptionsNP[1].getValue());
+    else if (RecordStreamSP[RECORD_TIME].getState() == ISS_ON)
+        recorder->setFrameCountHint(RecordOptionsNP[0].getValue() * FpsNP[FPS_AVERAGE].getValue());
+    else
+        recorder->setFrameCountHint(0);
 
     /* pattern substitution */
     recordfiledir.assign(RecordFileTP[0].text);
@@ -713,6 +894,8 @@ bool StreamManagerPrivate::startRecording()
             RecordStreamSP.apply();
         }
     }
+    recordDropped = 0;
+    recordBytes = 0;
     isRecording = true;
     return true;
 }
@@ -737,6 +920,12 @@ bool StreamManagerPrivate::stopRecording(bool force)
     isRecording = false;
     isRecordingAboutToClose = false;
 
+    if (!isStreaming)
+    {
+        framePool.shrink();
+        processPool.shrink();
+    }
+
     {
         std::lock_guard<std::mutex> lock(recordMutex);
         recorder->close();
@@ -751,6 +940,17 @@ bool StreamManagerPrivate::stopRecording(bool force)
         FPSRecorder.totalFrames()
     );
 
+    // Sustained rate of the recorder input, the size of the recording per second
+    if (FPSRecorder.totalTime() > 0)
+        LOGF_INFO(
+            "Record Throughput: %.1f MB/s (%.1f MB total)",
+            recordBytes / (FPSRecorder.totalTime() * 1000.0),
+            recordBytes / 1000000.0
+        );
+
+    if (recordDropped > 0)
+        LOGF_WARN("%u frames were dropped from the recording.", recordDropped.load());
+
     return true;
 }
 
@@ -850,6 +1050,8 @@ bool StreamManagerPrivate::ISNewSwitch(const char * dev, const char * name, ISSt
                 encoderManager.setEncoder(oneEncoder);
 
                 oneEncoder->setPixelFormat(PixelFormat, PixelDepth);
+                oneEncoder->setRateControl(EncoderRateNP[RATE_BITRATE].getValue() * 1000, EncoderRateNP[RATE_FPS].getValue(),
+                                           EncoderRateNP[RATE_QUALITY].getValue());
 
                 encoder = oneEncoder;
 
@@ -860,6 +1062,27 @@ bool StreamManagerPrivate::ISNewSwitch(const char * dev, const char * name, ISSt
         return true;
     }
 
+    // Preview Stretch
+    if (StretchSP.isNameMatch(name))
+    {
+        StretchSP.update(states, names, n);
+        gammaLut16.setMode(static_cast<GammaLut16::Mode>(StretchSP.findOnSwitchIndex()));
+        StretchSP.setState(IPS_OK);
+        StretchSP.apply();
+        return true;
+    }
+
+    // Direct I/O
+    if (RecordDirectIOSP.isNameMatch(name))
+    {
+        RecordDirectIOSP.update(states, names, n);
+        RecordDirectIOSP.setState(IPS_OK);
+        RecordDirectIOSP.apply();
+        if (isRecording)
+            LOG_INFO("Direct I/O setting is applied to the next recording.");
+        return true;
+    }
+
     // Recorder Selection
     if (RecorderSP.isNameMatch(name))
     {
@@ -874,7 +1097,8 @@ bool StreamManagerPrivate::ISNewSwitch(const char * dev, const char * name, ISSt
             {
                 recorderManager.setRecorder(oneRecorder);
 
-                oneRecorder->setPixelFormat(PixelFormat, PixelDepth);
+                if (oneRecorder->setPixelFormat(PixelFormat, PixelDepth) == false)
+                    LOGF_WARN("Pixel format %d is not supported by %s recorder.", PixelFormat, oneRecorder->getName());
 
                 recorder = oneRecorder;
 
@@ -939,11 +1163,25 @@ bool StreamManagerPrivate::ISNewNumber(const char * dev, const char * name, doub
         return true;
     }
 
+    /* Rate Control */
+    if (EncoderRateNP.isNameMatch(name))
+    {
+        EncoderRateNP.update(values, names, n);
+        encoder->setRateControl(EncoderRateNP[RATE_BITRATE].getValue() * 1000, EncoderRateNP[RATE_FPS].getValue(),
+                                EncoderRateNP[RATE_QUALITY].getValue());
+        EncoderRateNP.setState(IPS_OK);
+        EncoderRateNP.apply();
+        return true;
+    }
+
     /* Limits */
     if (LimitsNP.isNameMatch(name))
     {
         LimitsNP.update(values, names, n);
 
+        framePool.setMaxSize(LimitsNP[LIMITS_BUFFER_MAX].getValue() * 1024 * 1024);
+        processPool.setMaxSize(LimitsNP[LIMITS_BUFFER_MAX].getValue() * 1024 * 1024);
+
         FPSPreview.setTimeWindow(1000.0 / LimitsNP[LIMITS_PREVIEW_FPS].getValue());
         FPSPreview.reset();
 
@@ -1033,8 +1271,12 @@ bool StreamManagerPrivate::setStream(bool enable)
             FPSAverage.reset();
             FPSFast.reset();
             FPSPreview.reset();
+            hasPreviewInterval = false;
             FPSPreview.setTimeWindow(1000.0 / LimitsNP[LIMITS_PREVIEW_FPS].getValue());
             frameCountDivider = 0;
+            previewFrames = previewSkipped = previewDropped = 0;
+            previewBytes = 0;
+            previewStatistics.start();
             
             if(currentDevice->getDriverInterface() & INDI::DefaultDevice::CCD_INTERFACE)
             {
@@ -1104,6 +1346,12 @@ bool StreamManagerPrivate::setStream(bool enable)
             StreamSP.reset();
             StreamSP[1].setState(ISS_ON);
             isStreaming = false;
+            logPreviewStatistics();
+            if (!isRecording)
+            {
+                framePool.shrink();
+                processPool.shrink();
+            }
             Format.clear();
             FpsNP[FPS_INSTANT].setValue(0);
             FpsNP[FPS_AVERAGE].setValue(0);
@@ -1126,8 +1374,11 @@ bool StreamManager::saveConfigItems(FILE * fp)
 {
     D_PTR(StreamManager);
     d->EncoderSP.save(fp);
+    d->EncoderRateNP.save(fp);
+    d->StretchSP.save(fp);
     d->RecordFileTP.save(fp);
     d->RecordOptionsNP.save(fp);
+    d->RecordDirectIOSP.save(fp);
     d->RecorderSP.save(fp);
     d->LimitsNP.save(fp);
     return true;
@@ -1199,10 +1450,13 @@ bool StreamManagerPrivate::uploadStream(const uint8_t * buffer, uint32_t nbytes)
     }
 #endif
 
+    INDI::ElapsedTimer encodeElapsed;
     if(currentDevice->getDriverInterface() & INDI::DefaultDevice::CCD_INTERFACE)
     {
         if (encoder->upload(imageBP->at(0), buffer, nbytes, dynamic_cast<INDI::CCD*>(currentDevice)->PrimaryCCD.isCompressed()))
         {
+            double encodeTime = encodeElapsed.nsecsElapsed() / 1e9;
+
 #ifdef HAVE_WEBSOCKET
             if (dynamic_cast<INDI::CCD*>(currentDevice)->HasWebSocket()
                     && dynamic_cast<INDI::CCD*>(currentDevice)->WebSocketS[CCD::WEBSOCKET_ENABLED].s == ISS_ON)
@@ -1218,8 +1472,10 @@ bool StreamManagerPrivate::uploadStream(const uint8_t * buffer, uint32_t nbytes)
             }
 #endif
             // Upload to client now
+            INDI::ElapsedTimer sendElapsed;
             imageBP->setState(IPS_OK);
             imageBP->apply();
+            updateEncoderInfo(encodeTime, sendElapsed.nsecsElapsed() / 1e9, imageBP->at(0)->getBlobLen());
             return true;
         }
     }
@@ -1227,9 +1483,13 @@ bool StreamManagerPrivate::uploadStream(const uint8_t * buffer, uint32_t nbytes)
     {
         if (encoder->upload(imageBP->at(0), buffer, nbytes, false))//dynamic_cast<INDI::SensorInterface*>(currentDevice)->isCompressed()))
         {
+            double encodeTime = encodeElapsed.nsecsElapsed() / 1e9;
+
             // Upload to client now
+            INDI::ElapsedTimer sendElapsed;
             imageBP->setState(IPS_OK);
             imageBP->apply();
+            updateEncoderInfo(encodeTime, sendElapsed.nsecsElapsed() / 1e9, imageBP->at(0)->getBlobLen());
             return true;
         }
     }
@@ -1237,6 +1497,26 @@ bool StreamManagerPrivate::uploadStream(const uint8_t * buffer, uint32_t nbytes)
     return false;
 }
 
+void StreamManagerPrivate::updateEncoderInfo(double encodeTime, double sendTime, size_t bytes)
+{
+    // The first frame after the stream starts has no interval
+    double frameInterval = hasPreviewInterval ? previewInterval.nsecsElapsed() / 1e9 : 0;
+    previewInterval.start();
+    hasPreviewInterval = true;
+
+    if (frameInterval > 0)
+    {
+        encoder->sent(frameInterval, encodeTime);
+        EncoderInfoNP[INFO_BITRATE].setValue(bytes * 8 / frameInterval / 1000);
+    }
+
+    EncoderInfoNP[INFO_ENCODE_TIME].setValue(encodeTime * 1000);
+    EncoderInfoNP[INFO_SEND_TIME].setValue(sendTime * 1000);
+    EncoderInfoNP[INFO_QUALITY].setValue(encoder->getQuality());
+    EncoderInfoNP.setState(IPS_OK);
+    EncoderInfoNP.apply();
+}
+
 RecorderInterface *StreamManager::getRecorder() const
 {
     D_PTR(const StreamManager);
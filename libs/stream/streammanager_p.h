@@ -27,13 +27,17 @@
 #include "recorder/recordermanager.h"
 #include "encoder/encodermanager.h"
 #include "fpsmeter.h"
-#include "uniquequeue.h"
+#include "spscqueue.h"
+#include "framepool.h"
 #include "gammalut16.h"
+#include "indielapsedtimer.h"
 
 #include <atomic>
 #include <string>
 #include <map>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "indiccdchip.h"
 #include "indisensorinterface.h"
@@ -116,6 +120,37 @@ public:
      */
     void asyncStreamThread();
 
+    /**
+     * @brief Thread writing frames to the recorder. Frames are queued, so a slow disk does not stall the preview.
+     */
+    void asyncRecordThread();
+
+    /**
+     * @brief Thread encoding and uploading the latest frame for preview.
+     */
+    void asyncPreviewThread();
+
+    /**
+     * @brief A frame counted in recordBacklog has been recorded or dropped.
+     */
+    void finishRecordFrame();
+
+    /**
+     * @brief Wait until all frames received while recording have been recorded or dropped.
+     */
+    void waitForRecordBacklog();
+
+    /**
+     * @brief Count a frame lost before it reached the record and preview branches.
+     * @param record true if the frame was meant for the recording.
+     */
+    void dropFrame(bool record);
+
+    /**
+     * @brief Log the frames sent, replaced and dropped by the preview branch since the stream started.
+     */
+    void logPreviewStatistics();
+
     // helpers
     static std::string expand(const std::string &fname, const std::map<std::string, std::string> &patterns);
 
@@ -133,6 +168,14 @@ public:
      */
     bool uploadStream(const uint8_t *buffer, uint32_t nbytes);
 
+    /**
+     * @brief updateEncoderInfo Feed the rate control of the encoder and report the encoding of a frame.
+     * @param encodeTime seconds spent encoding the frame.
+     * @param sendTime seconds spent handing the frame to indiserver, it does not tell how fast the client receives.
+     * @param bytes size of the encoded frame.
+     */
+    void updateEncoderInfo(double encodeTime, double sendTime, size_t bytes);
+
     /**
      * @brief recordStream Calls the backend recorder to record a single frame.
      * @param deltams time in milliseconds since last frame
@@ -189,6 +232,9 @@ public:
     /* Record Options */
     INDI::PropertyNumber RecordOptionsNP {2};
 
+    /* Write recordings bypassing the page cache */
+    INDI::PropertySwitch RecordDirectIOSP {2};
+
     // Stream Frame
     INDI::PropertyNumber StreamFrameNP {4};
 
@@ -199,9 +245,21 @@ public:
     INDI::PropertySwitch EncoderSP {2};
     enum { ENCODER_RAW, ENCODER_MJPEG };
 
+    // Rate control of lossy encoders. Target bitrate and FPS, 0 for no limit, and maximum quality
+    INDI::PropertyNumber EncoderRateNP {3};
+    enum { RATE_BITRATE, RATE_FPS, RATE_QUALITY };
+
+    // Time to encode and to send the last frame, bitrate and quality of the stream
+    INDI::PropertyNumber EncoderInfoNP {4};
+    enum { INFO_ENCODE_TIME, INFO_SEND_TIME, INFO_BITRATE, INFO_QUALITY };
+
+    // Preview curve of frames deeper than 8 bits, ordered as GammaLut16::Mode
+    INDI::PropertySwitch StretchSP {3};
+    enum { STRETCH_GAMMA, STRETCH_LINEAR, STRETCH_AUTO };
+
     // Recorder Selector. Static but should be implmeneted as a dynamic plugin interface
-    INDI::PropertySwitch RecorderSP {2};
-    enum { RECORDER_RAW, RECORDER_OGV };
+    INDI::PropertySwitch RecorderSP {3};
+    enum { RECORDER_RAW, RECORDER_AVI, RECORDER_OGV };
 
     // Limits. Maximum queue size for incoming frames. FPS Limit for preview
     INDI::PropertyNumber LimitsNP {2};
@@ -226,6 +284,8 @@ public:
     FPSMeter FPSAverage;
     FPSMeter FPSFast;
     FPSMeter FPSPreview;
+    INDI::ElapsedTimer previewInterval;
+    std::atomic<bool> hasPreviewInterval { false };
     FPSMeter FPSRecorder;
 
     uint32_t frameCountDivider = 0;
@@ -238,12 +298,38 @@ public:
     // Processing for streaming
     typedef struct {
         double time;
-        std::vector<uint8_t> frame;
+        FramePool::Handle frame;
+        bool record; // counted in recordBacklog
     } TimeFrame;
 
+    // Incoming frames, limited by LIMITS_BUFFER_MAX
+    FramePool                framePool {512 * 1024 * 1024};
+    // Subframed and downscaled frames, limited by LIMITS_BUFFER_MAX
+    FramePool                processPool {512 * 1024 * 1024, 4};
+
     std::thread              framesThread;   // async incoming frames processing
     std::atomic<bool>        framesThreadTerminate {false};
-    UniqueQueue<TimeFrame>   framesIncoming;
+    SPSCQueue<TimeFrame>     framesIncoming; // newFrame() is the producer, asyncStreamThread() the consumer
+
+    // Recording branch, lossless until the buffer is full
+    std::thread              recordThread;
+    SPSCQueue<TimeFrame>     framesRecord;   // asyncStreamThread() is the producer, asyncRecordThread() the consumer
+    std::atomic<size_t>      recordBacklog {0};
+    std::atomic<uint32_t>    recordDropped {0};
+    std::atomic<uint64_t>    recordBytes {0};
+    std::mutex               recordBacklogMutex;
+    std::condition_variable  recordBacklogEmpty;
+
+    // Preview branch, only the latest frame is kept
+    std::thread              previewThread;
+    std::mutex               previewMutex;
+    std::condition_variable  previewAvailable;
+    FramePool::Handle        previewFrame;
+    std::atomic<uint32_t>    previewFrames {0};  // uploaded
+    std::atomic<uint32_t>    previewSkipped {0}; // replaced by a newer frame before the preview thread took it
+    std::atomic<uint32_t>    previewDropped {0}; // lost to full buffers or failed uploads
+    std::atomic<uint64_t>    previewBytes {0};
+    INDI::ElapsedTimer       previewStatistics;
 
     std::mutex               fastFPSUpdate;
     std::mutex               recordMutex;
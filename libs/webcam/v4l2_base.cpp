@@ -1940,6 +1940,11 @@ void V4L2_Base::setColorProcessing(bool quantization, bool colorconvert, bool li
     bpp = decoder->getBpp();
 }
 
+void V4L2_Base::setBayerMethod(int method)
+{
+    decoder->setBayerMethod(method);
+}
+
 unsigned char * V4L2_Base::getY()
 {
     return decoder->getY();
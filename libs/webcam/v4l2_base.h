@@ -136,6 +136,7 @@ class V4L2_Base
         struct v4l2_rect getcroprect();
 
         void setColorProcessing(bool quantization, bool colorconvert, bool linearization);
+        void setBayerMethod(int method);
 
         void setlxstate(short s)
         {
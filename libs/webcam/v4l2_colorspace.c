@@ -78,6 +78,38 @@ void linearize(float *buf, unsigned int len, struct v4l2_format *fmt)
     }
 }
 
+static void linearizeTable(float lut[256], struct v4l2_format *fmt)
+{
+    unsigned int i;
+
+    for (i = 0; i < 256; i++)
+        lut[i] = i / 255.0;
+    linearize(lut, 256, fmt);
+}
+
+void linearizeY8(const unsigned char *src, float *dst, unsigned int len, struct v4l2_format *fmt)
+{
+    float lut[256];
+    unsigned int i;
+
+    linearizeTable(lut, fmt);
+    for (i = 0; i < len; i++)
+        dst[i] = lut[src[i]];
+}
+
+void linearizeY8to16(const unsigned char *src, unsigned short *dst, unsigned int len, struct v4l2_format *fmt)
+{
+    float lut[256];
+    unsigned short lut16[256];
+    unsigned int i;
+
+    linearizeTable(lut, fmt);
+    for (i = 0; i < 256; i++)
+        lut16[i] = (unsigned short)(lut[i] * 65535.0);
+    for (i = 0; i < len; i++)
+        dst[i] = lut16[src[i]];
+}
+
 const char *getColorSpaceName(struct v4l2_format *fmt)
 {
     switch (fmt->fmt.pix.colorspace)
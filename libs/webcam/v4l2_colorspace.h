@@ -27,6 +27,10 @@ const char *getQuantizationName(struct v4l2_format *fmt);
 
 void rangeY8(unsigned char *buf, unsigned int len);
 void linearize(float *buf, unsigned int len, struct v4l2_format *fmt);
+/* Linearize 8 bit luma through a table of its 256 values, same result as linearize() on Y / 255 */
+void linearizeY8(const unsigned char *src, float *dst, unsigned int len, struct v4l2_format *fmt);
+/* Same as linearizeY8, scaled to 16 bit */
+void linearizeY8to16(const unsigned char *src, unsigned short *dst, unsigned int len, struct v4l2_format *fmt);
 
 #ifdef __cplusplus
 }
@@ -72,6 +72,7 @@ V4L2_Builtin_Decoder::V4L2_Builtin_Decoder()
     useSoftCrop    = false;
     doCrop         = false;
     doQuantization = false;
+    bayerMethod    = CCVT_BAYER_BILINEAR;
     YBuf           = nullptr;
     UBuf           = nullptr;
     VBuf           = nullptr;
@@ -453,18 +454,18 @@ void V4L2_Builtin_Decoder::decode(unsigned char *frame, struct v4l2_buffer *buf)
         break;
 
         case V4L2_PIX_FMT_SBGGR8:
-            bayer2rgb24(rgb24_buffer, frame, fmt.fmt.pix.width, fmt.fmt.pix.height);
+            ccvt_bayer8_rgb24(fmt.fmt.pix.width, fmt.fmt.pix.height, CCVT_BAYER_BGGR, bayerMethod, frame, rgb24_buffer);
             break;
 
         case V4L2_PIX_FMT_SRGGB8:
-            bayer_rggb_2rgb24(rgb24_buffer, frame, fmt.fmt.pix.width, fmt.fmt.pix.height);
+            ccvt_bayer8_rgb24(fmt.fmt.pix.width, fmt.fmt.pix.height, CCVT_BAYER_RGGB, bayerMethod, frame, rgb24_buffer);
             break;
         case V4L2_PIX_FMT_SGRBG8:
-            bayer_grbg_to_rgb24(rgb24_buffer, frame, fmt.fmt.pix.width, fmt.fmt.pix.height);
+            ccvt_bayer8_rgb24(fmt.fmt.pix.width, fmt.fmt.pix.height, CCVT_BAYER_GRBG, bayerMethod, frame, rgb24_buffer);
             break;
         case V4L2_PIX_FMT_SBGGR16:
-            bayer16_2_rgb24((unsigned short *)rgb24_buffer, (unsigned short *)frame, fmt.fmt.pix.width,
-                            fmt.fmt.pix.height);
+            ccvt_bayer16_rgb48(fmt.fmt.pix.width, fmt.fmt.pix.height, CCVT_BAYER_BGGR, bayerMethod, frame,
+                               rgb24_buffer);
             break;
 
         case V4L2_PIX_FMT_JPEG:
@@ -549,6 +550,12 @@ void V4L2_Builtin_Decoder::setLinearization(bool dolinearization)
     else
         bpp = 8;
 }
+
+void V4L2_Builtin_Decoder::setBayerMethod(int method)
+{
+    bayerMethod = method;
+}
+
 void V4L2_Builtin_Decoder::allocBuffers()
 {
     YBuf = nullptr;
@@ -625,17 +632,11 @@ void V4L2_Builtin_Decoder::allocBuffers()
 
 void V4L2_Builtin_Decoder::makeLinearY()
 {
-    unsigned char *src = YBuf;
-    float *dest;
-    unsigned int i;
     if (!linearBuffer)
     {
         linearBuffer = new float[(bufwidth * bufheight)];
     }
-    dest = linearBuffer;
-    for (i = 0; i < bufwidth * bufheight; i++)
-        *dest++ = (*src++) / 255.0;
-    linearize(linearBuffer, bufwidth * bufheight, &fmt);
+    linearizeY8(YBuf, linearBuffer, bufwidth * bufheight, &fmt);
 }
 void V4L2_Builtin_Decoder::makeY()
 {
@@ -675,16 +676,9 @@ unsigned char *V4L2_Builtin_Decoder::getY()
         rangeY8(YBuf, (bufwidth * bufheight));
     if (doLinearization)
     {
-        unsigned int i;
-        float *src;
-        unsigned short *dest;
         if (!yuyvBuffer)
             yuyvBuffer = new unsigned char[(bufwidth * bufheight) * 2];
-        makeLinearY();
-        src  = linearBuffer;
-        dest = (unsigned short *)yuyvBuffer;
-        for (i = 0; i < bufwidth * bufheight; i++)
-            *dest++ = (unsigned short)(*src++ * 65535.0);
+        linearizeY8to16(YBuf, (unsigned short *)yuyvBuffer, bufwidth * bufheight, &fmt);
         return yuyvBuffer;
     }
     return YBuf;
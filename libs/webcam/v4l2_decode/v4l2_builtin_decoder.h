@@ -56,6 +56,7 @@ class V4L2_Builtin_Decoder : public V4L2_Decoder
     virtual int getBpp();
     virtual void setQuantization(bool);
     virtual void setLinearization(bool);
+    virtual void setBayerMethod(int method);
 
   protected:
     void init_supported_formats();
@@ -71,6 +72,7 @@ class V4L2_Builtin_Decoder : public V4L2_Decoder
     bool doCrop;      // do software cropping when decoding frames
     bool doQuantization;
     bool doLinearization;
+    int bayerMethod;
 
     unsigned char *YBuf;
     unsigned char *UBuf;
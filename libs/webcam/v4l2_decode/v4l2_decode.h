@@ -55,6 +55,8 @@ class V4L2_Decoder
     virtual int getBpp()                  = 0;
     virtual void setQuantization(bool)    = 0;
     virtual void setLinearization(bool)   = 0;
+    /** Select the demosaicing of Bayer formats, one of ccvt_bayer_method */
+    virtual void setBayerMethod(int)      = 0;
 
   protected:
     const char *name;
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+
+/*
+ * libdsp star detection and registration benchmark over synthetic CCD frames, gaussian stars over a noisy sky
+ * background as the CCD simulator renders them. The second frame of each size is shifted and rotated.
+ *
+ * Usage: bench_align [iterations]
+ */
+
+#include "dsp.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+static dsp_stream_p frame(int width, int height, int stars, double dx, double dy, double radians)
+{
+    dsp_stream_p stream = dsp_stream_new();
+    dsp_stream_add_dim(stream, width);
+    dsp_stream_add_dim(stream, height);
+    dsp_stream_alloc_buffer(stream, stream->len);
+
+    std::mt19937 generator(1);
+    std::normal_distribution<double> noise(1000.0, 20.0);
+    std::uniform_real_distribution<double> x(0, width), y(0, height), magnitude(0, 5);
+    for (int i = 0; i < stream->len; i++)
+        stream->buf[i] = noise(generator);
+    for (int i = 0; i < stars; i++)
+    {
+        double sx = x(generator) - width / 2.0, sy = y(generator) - height / 2.0;
+        double cx = cos(radians) * sx - sin(radians) * sy + width / 2.0 + dx;
+        double cy = sin(radians) * sx + cos(radians) * sy + height / 2.0 + dy;
+        double flux = 40000.0 * pow(10, -0.4 * magnitude(generator));
+        for (int py = std::max(0, int(cy) - 8); py < std::min(height, int(cy) + 9); py++)
+            for (int px = std::max(0, int(cx) - 8); px < std::min(width, int(cx) + 9); px++)
+                stream->buf[px + py * width] += flux * exp(-((px - cx) * (px - cx) + (py - cy) * (py - cy)) / 4.5);
+    }
+    return stream;
+}
+
+static void run(int width, int height, int stars, int iterations)
+{
+    dsp_stream_p reference = frame(width, height, stars, 0, 0, 0);
+    dsp_stream_p stream = frame(width, height, stars, 12.3, -7.8, 0.01);
+
+    auto start = std::chrono::steady_clock::now();
+    int found = 0;
+    for (int i = 0; i < iterations; i++)
+        found = dsp_align_find_stars(stream, 4, 2, 5.0, nullptr);
+    auto detected = std::chrono::steady_clock::now();
+
+    dsp_align_find_stars(reference, 4, 2, 5.0, nullptr);
+    auto registering = std::chrono::steady_clock::now();
+    int matched = 0;
+    for (int i = 0; i < iterations; i++)
+        matched = dsp_align_get_offset(reference, stream, 30, 3);
+    auto end = std::chrono::steady_clock::now();
+
+    double detect   = std::chrono::duration<double, std::milli>(detected - start).count() / iterations;
+    double register_ms = std::chrono::duration<double, std::milli>(end - registering).count() / iterations;
+    printf("%5dx%-5d %5d stars  found %5d  %8.2f ms  matched %3d  %8.2f ms  offset %.2f %.2f  rotation %.4f\n",
+           width, height, stars, found, detect, matched, register_ms,
+           stream->align_info.offset[0], stream->align_info.offset[1], stream->align_info.radians[0]);
+
+    dsp_stream_free_buffer(reference);
+    dsp_stream_free(reference);
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+
+    printf("Star detection and registration, %d iterations, %d threads\n", iterations, dsp_parallel_threads());
+
+    run(640, 480, 50, iterations);
+    run(1280, 960, 200, iterations);
+    run(3008, 2008, 500, iterations);
+    run(6000, 4000, 1000, iterations);
+
+    return 0;
+}
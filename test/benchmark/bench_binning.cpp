@@ -0,0 +1,84 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+/*
+ * Software binning benchmark on a 6000x4000 frame, the size of a typical APS-C sensor.
+ *
+ * Usage: bench_binning [iterations] [threads]
+ */
+
+#include "indibinning.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static constexpr uint32_t WIDTH  = 6000;
+static constexpr uint32_t HEIGHT = 4000;
+
+template <typename T>
+static void run(const char *name, int bpp, uint32_t binX, uint32_t binY, INDI::Binning::Mode mode, bool bayer,
+                int iterations, int threads)
+{
+    std::vector<T> in(static_cast<size_t>(WIDTH) * HEIGHT);
+    std::vector<T> out(in.size());
+
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<uint32_t> distribution(0, 4095);
+    for (auto &pixel : in)
+        pixel = static_cast<T>(distribution(generator));
+
+    // Warm up, touches the output pages once
+    INDI::Binning::bin(in.data(), out.data(), WIDTH, HEIGHT, bpp, binX, binY, mode, bayer, 1, threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        INDI::Binning::bin(in.data(), out.data(), WIDTH, HEIGHT, bpp, binX, binY, mode, bayer, 1, threads);
+    auto end = std::chrono::steady_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+    double mpixels = static_cast<double>(WIDTH) * HEIGHT / 1e6;
+    printf("%-8s %ux%u %-7s %-5s %8.2f ms %8.1f Mpixel/s\n", name, binX, binY,
+           mode == INDI::Binning::BIN_SUM ? "sum" : mode == INDI::Binning::BIN_AVERAGE ? "average" : "median",
+           bayer ? "bayer" : "mono", ms, mpixels / (ms / 1000));
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+    int threads    = argc > 2 ? atoi(argv[2]) : 0;
+
+    printf("Binning %ux%u frame, %d iterations, %d threads (0 = auto)\n", WIDTH, HEIGHT, iterations, threads);
+
+    for (uint32_t bin : {2, 3, 4})
+    {
+        run<uint8_t>("8 bit", 8, bin, bin, INDI::Binning::BIN_SUM, false, iterations, threads);
+        run<uint16_t>("16 bit", 16, bin, bin, INDI::Binning::BIN_SUM, false, iterations, threads);
+        run<uint16_t>("16 bit", 16, bin, bin, INDI::Binning::BIN_AVERAGE, false, iterations, threads);
+        run<uint16_t>("16 bit", 16, bin, bin, INDI::Binning::BIN_SUM, true, iterations, threads);
+        run<uint32_t>("32 bit", 32, bin, bin, INDI::Binning::BIN_SUM, false, iterations, threads);
+        run<float>("float", -32, bin, bin, INDI::Binning::BIN_AVERAGE, false, iterations, threads);
+    }
+
+    run<uint16_t>("16 bit", 16, 2, 1, INDI::Binning::BIN_SUM, false, iterations, threads);
+    run<uint16_t>("16 bit", 16, 3, 3, INDI::Binning::BIN_MEDIAN, false, iterations, threads);
+
+    return 0;
+}
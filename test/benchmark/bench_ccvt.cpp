@@ -0,0 +1,114 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+/*
+ * Colour conversion benchmark of the V4L2 decoder formats at 1080p and 4K: YUYV and 4:2:0 planar, which NV12 and
+ * MJPEG frames are converted to, to RGB, and 8 and 16 bit Bayer demosaicing, on one thread and on the thread pool.
+ *
+ * Usage: bench_ccvt [iterations]
+ */
+
+#include "ccvt.h"
+#include "dsp.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+template <typename F>
+static double measure(int iterations, F f)
+{
+    // Warm up, touches the output pages once
+    f();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    const struct
+    {
+        const char *name;
+        int width;
+        int height;
+    } sizes[] = {{"1080p", 1920, 1080}, {"4K", 3840, 2160}};
+
+    printf("Colour conversion, %d iterations, %d threads\n", iterations, dsp_parallel_threads());
+
+    for (const auto &size : sizes)
+    {
+        int width = size.width, height = size.height;
+        size_t pixels = static_cast<size_t>(width) * height;
+
+        std::vector<uint16_t> in(pixels * 2);
+        std::mt19937 generator(1);
+        std::uniform_int_distribution<int> distribution(0, 65535);
+        for (auto &value : in)
+            value = static_cast<uint16_t>(distribution(generator));
+        std::vector<uint16_t> out(pixels * 3);
+
+        const struct
+        {
+            const char *name;
+            void (*convert)(int width, int height, const void *src, void *dst);
+        } yuv[] = {{"yuyv to rgb24", ccvt_yuyv_rgb24}, {"yuyv to bgr32", ccvt_yuyv_bgr32},
+            {"420p to rgb24", ccvt_420p_rgb24}, {"420p to bgr32", ccvt_420p_bgr32}
+        };
+        const struct
+        {
+            const char *name;
+            bool wide;
+            int method;
+        } bayer[] = {{"bayer8 bilinear", false, CCVT_BAYER_BILINEAR}, {"bayer8 vng", false, CCVT_BAYER_VNG},
+            {"bayer16 bilinear", true, CCVT_BAYER_BILINEAR}, {"bayer16 vng", true, CCVT_BAYER_VNG}
+        };
+
+        for (int parallel : {0, 1})
+        {
+            ccvt_set_parallel(parallel);
+            const char *mode = parallel ? "parallel" : "serial";
+            for (const auto &format : yuv)
+            {
+                double ms = measure(iterations, [&]() { format.convert(width, height, in.data(), out.data()); });
+                printf("%-5s %-16s %-8s %8.2f ms %8.1f Mpixel/s\n", size.name, format.name, mode, ms,
+                       pixels / 1e6 / (ms / 1000));
+            }
+            for (const auto &format : bayer)
+            {
+                double ms = measure(iterations, [&]()
+                {
+                    if (format.wide)
+                        ccvt_bayer16_rgb48(width, height, CCVT_BAYER_RGGB, format.method, in.data(), out.data());
+                    else
+                        ccvt_bayer8_rgb24(width, height, CCVT_BAYER_RGGB, format.method, in.data(), out.data());
+                });
+                printf("%-5s %-16s %-8s %8.2f ms %8.1f Mpixel/s\n", size.name, format.name, mode, ms,
+                       pixels / 1e6 / (ms / 1000));
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+/*
+ * libdsp Fourier transform benchmark over typical receiver spectrum lengths and CCD frame sizes.
+ * The first transform of a size includes planning, or loading the plan from the saved wisdom.
+ *
+ * Usage: bench_fft [iterations]
+ */
+
+#include "dsp.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static void run(const char *name, const std::vector<int> &sizes, int iterations)
+{
+    dsp_stream_p stream = dsp_stream_new();
+    for (int size : sizes)
+        dsp_stream_add_dim(stream, size);
+    dsp_stream_alloc_buffer(stream, stream->len);
+    for (int i = 0; i < stream->len; i++)
+        stream->buf[i] = rand() % 4096;
+
+    auto start = std::chrono::steady_clock::now();
+    free(dsp_fourier_dft(stream));
+    auto planned = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        free(dsp_fourier_dft(stream));
+    auto end = std::chrono::steady_clock::now();
+
+    double first = std::chrono::duration<double, std::milli>(planned - start).count();
+    double ms    = std::chrono::duration<double, std::milli>(end - planned).count() / iterations;
+    printf("%-10s %9d elements  first %9.2f ms  then %8.2f ms\n", name, stream->len, first, ms);
+
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+
+    printf("Fourier transform, %d iterations, %d threads\n", iterations, dsp_parallel_threads());
+
+    // Receiver spectra
+    run("1024", {1024}, iterations);
+    run("4096", {4096}, iterations);
+    run("65536", {65536}, iterations);
+    run("1048576", {1048576}, iterations);
+
+    // CCD frames
+    run("640x480", {640, 480}, iterations);
+    run("1280x960", {1280, 960}, iterations);
+    run("3008x2008", {3008, 2008}, iterations);
+    run("6000x4000", {6000, 4000}, iterations);
+
+    return 0;
+}
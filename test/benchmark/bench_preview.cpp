@@ -0,0 +1,93 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+/*
+ * Stream preview benchmark on a 4K frame: reduction of 16 bit pixels to 8 bit with each curve, then area
+ * downscaling to the width of the MJPEG stream.
+ *
+ * Usage: bench_preview [iterations]
+ */
+
+#include "gammalut16.h"
+#include "downscaler.h"
+#include "dsp.h"
+
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static constexpr uint32_t WIDTH  = 3840;
+static constexpr uint32_t HEIGHT = 2160;
+
+template <typename F>
+static double measure(int iterations, F f)
+{
+    // Warm up, touches the output pages once
+    f();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 50;
+    size_t pixels = static_cast<size_t>(WIDTH) * HEIGHT;
+
+    std::vector<uint16_t> in(pixels);
+    std::mt19937 generator(1);
+    std::normal_distribution<double> distribution(2000, 100);
+    for (auto &pixel : in)
+        pixel = static_cast<uint16_t>(std::max(0.0, distribution(generator)));
+
+    printf("Stream preview %ux%u, %d iterations, %d threads\n", WIDTH, HEIGHT, iterations, dsp_parallel_threads());
+
+    std::vector<uint8_t> out(pixels * 3);
+    GammaLut16 lut;
+    const struct
+    {
+        const char *name;
+        GammaLut16::Mode mode;
+    } modes[] = {{"gamma", GammaLut16::MODE_GAMMA}, {"linear", GammaLut16::MODE_LINEAR}, {"stretch", GammaLut16::MODE_STRETCH}};
+    for (const auto &mode : modes)
+    {
+        lut.setMode(mode.mode);
+        double ms = measure(iterations, [&]() { lut.apply(in.data(), pixels, out.data()); });
+        printf("16 to 8 bit %-8s %8.2f ms %8.1f Mpixel/s\n", mode.name, ms, pixels / 1e6 / (ms / 1000));
+    }
+
+    INDI::Downscaler downscaler;
+    uint32_t width = 640, height = HEIGHT * width / WIDTH;
+    std::vector<uint8_t> scaled(static_cast<size_t>(width) * height * 3);
+    for (uint32_t channels : {1u, 3u})
+    {
+        double ms = measure(iterations, [&]()
+        {
+            downscaler.scale(out.data(), WIDTH, HEIGHT, channels, scaled.data(), width, height);
+        });
+        printf("downscale %ux%u to %ux%u %s %8.2f ms\n", WIDTH, HEIGHT, width, height, channels == 1 ? "mono" : "rgb ", ms);
+    }
+
+    return 0;
+}
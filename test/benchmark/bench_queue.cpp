@@ -0,0 +1,125 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+/*
+ * Producer/consumer benchmark of UniqueQueue and SPSCQueue. The producer pushes a small frame descriptor as fast as
+ * it can, the consumer pops it and optionally spends some time per item to simulate a recorder.
+ *
+ * Usage: bench_queue [items] [work ns per item]
+ */
+
+#include "uniquequeue.h"
+#include "spscqueue.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+struct Item
+{
+    double time {0};
+    std::unique_ptr<uint64_t> payload;
+};
+
+static void work(uint32_t ns)
+{
+    if (ns == 0)
+        return;
+    auto end = std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+    while (std::chrono::steady_clock::now() < end);
+}
+
+static void report(const char *name, size_t items, std::chrono::steady_clock::time_point start, uint64_t sum)
+{
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%-12s %10zu items %10.2f ms %10.2f Mitems/s %8.1f ns/item (checksum %llu)\n", name, items, ms,
+           items / ms / 1000, ms * 1e6 / items, static_cast<unsigned long long>(sum));
+}
+
+static void benchUniqueQueue(size_t items, uint32_t ns)
+{
+    UniqueQueue<Item> queue;
+    uint64_t sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&]()
+    {
+        Item item;
+        for (size_t i = 0; i < items; i++)
+        {
+            queue.pop(item);
+            sum += *item.payload;
+            work(ns);
+        }
+    });
+
+    for (size_t i = 0; i < items; i++)
+    {
+        // UniqueQueue is unbounded, keep it comparable to the bounded queue
+        while (queue.size() >= 1024)
+            std::this_thread::yield();
+        queue.push(Item{0, std::unique_ptr<uint64_t>(new uint64_t(i))});
+    }
+
+    consumer.join();
+    report("UniqueQueue", items, start, sum);
+}
+
+static void benchSPSCQueue(size_t items, uint32_t ns)
+{
+    SPSCQueue<Item> queue(1024);
+    uint64_t sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&]()
+    {
+        Item item;
+        for (size_t i = 0; i < items; i++)
+        {
+            queue.pop(item);
+            sum += *item.payload;
+            work(ns);
+        }
+    });
+
+    for (size_t i = 0; i < items; i++)
+    {
+        Item item{0, std::unique_ptr<uint64_t>(new uint64_t(i))};
+        while (queue.push(std::move(item)) == false)
+            std::this_thread::yield();
+    }
+
+    consumer.join();
+    report("SPSCQueue", items, start, sum);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t items = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    uint32_t ns  = argc > 2 ? atoi(argv[2]) : 0;
+
+    printf("%zu items, %u ns of work per item, %u cores\n", items, ns, std::thread::hardware_concurrency());
+
+    benchUniqueQueue(items, ns);
+    benchSPSCQueue(items, ns);
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include "recorder/avirecorder.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using INDI::AVIRecorder;
+
+// Smallest JPEG the recorder parses: SOI, a SOF0 segment with the frame size, then filler bytes
+static std::vector<uint8_t> jpegFrame(uint16_t width, uint16_t height, size_t size, uint8_t fill)
+{
+    std::vector<uint8_t> frame =
+    {
+        0xFF, 0xD8, 0xFF, 0xC0, 0x00, 0x11, 0x08,
+        static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+        static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width)
+    };
+    frame.resize(size, fill);
+    return frame;
+}
+
+static uint32_t u32(const std::vector<uint8_t> &file, size_t offset)
+{
+    return file[offset] | (file[offset + 1] << 8) | (file[offset + 2] << 16) | (static_cast<uint32_t>(file[offset + 3]) << 24);
+}
+
+static std::string fourcc(const std::vector<uint8_t> &file, size_t offset)
+{
+    return std::string(reinterpret_cast<const char *>(&file[offset]), 4);
+}
+
+static size_t find(const std::vector<uint8_t> &file, const char *id)
+{
+    for (size_t i = 0; i + 4 <= file.size(); i++)
+        if (memcmp(&file[i], id, 4) == 0)
+            return i;
+    return std::string::npos;
+}
+
+TEST(CORE_AVI_RECORDER, Test_layout)
+{
+    char path[] = "/tmp/indi_avi_recorder_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+
+    // Odd sizes are padded to an even chunk size
+    std::vector<std::vector<uint8_t>> frames =
+    {
+        jpegFrame(320, 240, 1001, 1), jpegFrame(320, 240, 2000, 2), jpegFrame(320, 240, 777, 3)
+    };
+
+    AVIRecorder recorder;
+    char errmsg[1024] = {0};
+    ASSERT_TRUE(recorder.setPixelFormat(INDI_JPG, 8));
+    ASSERT_TRUE(recorder.setSize(640, 480));
+    ASSERT_TRUE(recorder.open(path, errmsg)) << errmsg;
+    for (const auto &frame : frames)
+        ASSERT_TRUE(recorder.writeFrame(frame.data(), frame.size()));
+    ASSERT_TRUE(recorder.close());
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    unlink(path);
+
+    ASSERT_GE(file.size(), 12U);
+    ASSERT_EQ(fourcc(file, 0), "RIFF");
+    ASSERT_EQ(fourcc(file, 8), "AVI ");
+    ASSERT_EQ(u32(file, 4), file.size() - 8);
+
+    // Frame count and size come from the frames, not from setSize
+    size_t avih = find(file, "avih");
+    ASSERT_NE(avih, std::string::npos);
+    ASSERT_EQ(u32(file, avih + 8 + 16), frames.size());
+    ASSERT_EQ(u32(file, avih + 8 + 32), 320U);
+    ASSERT_EQ(u32(file, avih + 8 + 36), 240U);
+
+    // The movi list holds one 00dc chunk per frame and ends where idx1 begins
+    size_t movi = find(file, "movi");
+    ASSERT_NE(movi, std::string::npos);
+    ASSERT_EQ(fourcc(file, movi - 8), "LIST");
+    size_t idx1 = movi + u32(file, movi - 4);
+    ASSERT_EQ(fourcc(file, idx1), "idx1");
+    ASSERT_EQ(u32(file, idx1 + 4), frames.size() * 16);
+    ASSERT_EQ(idx1 + 8 + frames.size() * 16, file.size());
+
+    size_t chunk = movi + 4;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        const size_t entry = idx1 + 8 + i * 16;
+        ASSERT_EQ(fourcc(file, entry), "00dc");
+        // Index offsets point to the chunk header and are relative to the movi fourcc
+        ASSERT_EQ(movi + u32(file, entry + 8), chunk);
+        ASSERT_EQ(u32(file, entry + 12), frames[i].size());
+
+        ASSERT_EQ(fourcc(file, chunk), "00dc");
+        ASSERT_EQ(u32(file, chunk + 4), frames[i].size());
+        ASSERT_EQ(0, memcmp(&file[chunk + 8], frames[i].data(), frames[i].size())) << "frame " << i;
+        chunk += 8 + frames[i].size() + (frames[i].size() & 1);
+    }
+    ASSERT_EQ(chunk, idx1);
+}
+
+TEST(CORE_AVI_RECORDER, Test_rejectsUncompressed)
+{
+    AVIRecorder recorder;
+    char errmsg[1024] = {0};
+    ASSERT_FALSE(recorder.setPixelFormat(INDI_MONO, 8));
+    ASSERT_FALSE(recorder.open("/tmp/indi_avi_recorder_unused.avi", errmsg));
+}
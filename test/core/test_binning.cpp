@@ -0,0 +1,78 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "indibinning.h"
+
+TEST(CORE_BINNING, Test_sumSaturates)
+{
+    std::vector<uint16_t> in {60000, 60000, 1, 2,
+                              60000, 60000, 3, 4};
+    std::vector<uint16_t> out(2);
+
+    ASSERT_TRUE(INDI::Binning::bin(in.data(), out.data(), 4, 2, 16, 2, 2, INDI::Binning::BIN_SUM));
+    ASSERT_EQ(UINT16_MAX, out[0]);
+    ASSERT_EQ(10, out[1]);
+}
+
+TEST(CORE_BINNING, Test_asymmetricAverage)
+{
+    std::vector<uint8_t> in {1, 2, 3, 4,
+                             5, 6, 7, 8,
+                             9, 10, 11, 12};
+    std::vector<uint8_t> out(6);
+
+    ASSERT_TRUE(INDI::Binning::bin(in.data(), out.data(), 4, 3, 8, 2, 1, INDI::Binning::BIN_AVERAGE));
+    ASSERT_EQ((std::vector<uint8_t> {2, 4, 6, 8, 10, 12}), out);
+}
+
+TEST(CORE_BINNING, Test_median)
+{
+    std::vector<uint16_t> in {1, 1000,
+                              2, 3};
+    std::vector<uint16_t> out(1);
+
+    ASSERT_TRUE(INDI::Binning::bin(in.data(), out.data(), 2, 2, 16, 2, 2, INDI::Binning::BIN_MEDIAN));
+    ASSERT_EQ(3, out[0]);
+}
+
+TEST(CORE_BINNING, Test_bayer)
+{
+    // 4x4 RGGB frame, each channel has a constant value
+    std::vector<uint16_t> in {1, 2, 1, 2,
+                              3, 4, 3, 4,
+                              1, 2, 1, 2,
+                              3, 4, 3, 4};
+    std::vector<uint16_t> out(4);
+
+    ASSERT_TRUE(INDI::Binning::bin(in.data(), out.data(), 4, 4, 16, 2, 2, INDI::Binning::BIN_SUM, true));
+    ASSERT_EQ((std::vector<uint16_t> {4, 8, 12, 16}), out);
+}
+
+TEST(CORE_BINNING, Test_float)
+{
+    std::vector<float> in {1.5f, 2.5f,
+                           3.0f, 4.0f};
+    std::vector<float> out(1);
+
+    ASSERT_TRUE(INDI::Binning::bin(in.data(), out.data(), 2, 2, -32, 2, 2, INDI::Binning::BIN_AVERAGE));
+    ASSERT_FLOAT_EQ(2.75f, out[0]);
+}
@@ -0,0 +1,245 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include "ccvt.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// Colours of the top left 2x2 block of each pattern: 0 red, 1 green, 2 blue
+static const int cfa[4][4] = {{0, 1, 1, 2}, {1, 0, 2, 1}, {1, 2, 0, 1}, {2, 1, 1, 0}};
+
+static int colour(int pattern, int x, int y)
+{
+    return cfa[pattern][(y & 1) * 2 + (x & 1)];
+}
+
+// The reference YUV to RGB conversion of ccvt
+static void yuv(int y, int u, int v, uint8_t rgb[3])
+{
+    u -= 128;
+    v -= 128;
+    rgb[0] = std::clamp(y + ((v * 359) >> 8), 0, 255);
+    rgb[1] = std::clamp(y - ((v * 183 + u * 88) >> 8), 0, 255);
+    rgb[2] = std::clamp(y + ((u * 454) >> 8), 0, 255);
+}
+
+template <typename T>
+static std::vector<T> randomFrame(size_t size, int max, unsigned seed)
+{
+    std::vector<T> frame(size);
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> distribution(0, max);
+    for (auto &value : frame)
+        value = static_cast<T>(distribution(generator));
+    return frame;
+}
+
+// Bilinear demosaicing with the borders mirrored about the edge samples
+template <typename T>
+static std::vector<T> bilinear(const std::vector<T> &in, int width, int height, int pattern)
+{
+    auto at = [&](int x, int y)
+    {
+        x = x < 0 ? -x : (x >= width ? 2 * (width - 1) - x : x);
+        y = y < 0 ? -y : (y >= height ? 2 * (height - 1) - y : y);
+        return static_cast<int>(in[static_cast<size_t>(y) * width + x]);
+    };
+
+    std::vector<T> out(in.size() * 3);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            T *rgb = &out[(static_cast<size_t>(y) * width + x) * 3];
+            int c = colour(pattern, x, y);
+            if (c == 1)
+            {
+                int horizontal = (at(x - 1, y) + at(x + 1, y)) / 2, vertical = (at(x, y - 1) + at(x, y + 1)) / 2;
+                rgb[1] = at(x, y);
+                rgb[colour(pattern, x + 1, y)] = horizontal;
+                rgb[colour(pattern, x, y + 1)] = vertical;
+            }
+            else
+            {
+                rgb[c] = at(x, y);
+                rgb[1] = (at(x - 1, y) + at(x + 1, y) + at(x, y - 1) + at(x, y + 1)) / 4;
+                rgb[2 - c] = (at(x - 1, y - 1) + at(x + 1, y - 1) + at(x - 1, y + 1) + at(x + 1, y + 1)) / 4;
+            }
+        }
+    return out;
+}
+
+// Sample a RGB image through the colour filter array
+static std::vector<uint8_t> mosaic(const std::vector<uint8_t> &rgb, int width, int height, int pattern)
+{
+    std::vector<uint8_t> out(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            out[static_cast<size_t>(y) * width + x] = rgb[(static_cast<size_t>(y) * width + x) * 3 + colour(pattern, x, y)];
+    return out;
+}
+
+static double squaredError(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b)
+{
+    double sum = 0;
+    for (size_t i = 0; i < a.size(); i++)
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return sum;
+}
+
+TEST(CORE_CCVT, Test_420p)
+{
+    // Wider than a vector block, with a remainder
+    const int width = 150, height = 38;
+    auto in = randomFrame<uint8_t>(width * height * 3 / 2, 255, 1);
+    const uint8_t *Y = in.data(), *U = Y + width * height, *V = U + width * height / 4;
+
+    std::vector<uint8_t> rgb(width * height * 3), bgr32(width * height * 4);
+    ccvt_420p_rgb24(width, height, in.data(), rgb.data());
+    ccvt_420p_bgr32(width, height, in.data(), bgr32.data());
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            int i = y * width + x, c = (y / 2) * (width / 2) + x / 2;
+            uint8_t expected[3];
+            yuv(Y[i], U[c], V[c], expected);
+            for (int k = 0; k < 3; k++)
+            {
+                ASSERT_EQ(rgb[i * 3 + k], expected[k]) << "at " << x << "," << y;
+                ASSERT_EQ(bgr32[i * 4 + 2 - k], expected[k]) << "at " << x << "," << y;
+            }
+            ASSERT_EQ(bgr32[i * 4 + 3], 0);
+        }
+}
+
+TEST(CORE_CCVT, Test_yuyv)
+{
+    const int width = 134, height = 21;
+    auto in = randomFrame<uint8_t>(width * height * 2, 255, 2);
+
+    std::vector<uint8_t> rgb(width * height * 3), bgr(width * height * 3), rgb32(width * height * 4);
+    ccvt_yuyv_rgb24(width, height, in.data(), rgb.data());
+    ccvt_yuyv_bgr24(width, height, in.data(), bgr.data());
+    ccvt_yuyv_rgb32(width, height, in.data(), rgb32.data());
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            const uint8_t *pair = &in[(y * width + (x & ~1)) * 2];
+            uint8_t expected[3];
+            yuv(pair[(x & 1) * 2], pair[1], pair[3], expected);
+            int i = y * width + x;
+            for (int k = 0; k < 3; k++)
+            {
+                ASSERT_EQ(rgb[i * 3 + k], expected[k]) << "at " << x << "," << y;
+                ASSERT_EQ(bgr[i * 3 + 2 - k], expected[k]) << "at " << x << "," << y;
+                ASSERT_EQ(rgb32[i * 4 + k], expected[k]) << "at " << x << "," << y;
+            }
+            ASSERT_EQ(rgb32[i * 4 + 3], 0);
+        }
+}
+
+TEST(CORE_CCVT, Test_bayerBilinear)
+{
+    // Odd sizes, and rows that do not fill the last vector block
+    const int sizes[][2] = {{2, 2}, {3, 5}, {37, 19}, {101, 40}};
+    for (const auto &size : sizes)
+    {
+        int width = size[0], height = size[1];
+        auto in8 = randomFrame<uint8_t>(width * height, 255, width);
+        auto in16 = randomFrame<uint16_t>(width * height, 65535, height);
+        for (int pattern = CCVT_BAYER_RGGB; pattern <= CCVT_BAYER_BGGR; pattern++)
+        {
+            std::vector<uint8_t> out8(width * height * 3);
+            std::vector<uint16_t> out16(width * height * 3);
+            ccvt_bayer8_rgb24(width, height, pattern, CCVT_BAYER_BILINEAR, in8.data(), out8.data());
+            ccvt_bayer16_rgb48(width, height, pattern, CCVT_BAYER_BILINEAR, in16.data(), out16.data());
+            ASSERT_EQ(out8, bilinear(in8, width, height, pattern)) << width << "x" << height << " pattern " << pattern;
+            ASSERT_EQ(out16, bilinear(in16, width, height, pattern)) << width << "x" << height << " pattern " << pattern;
+        }
+    }
+}
+
+TEST(CORE_CCVT, Test_bayerFlat)
+{
+    const int width = 45, height = 23;
+    const uint8_t colours[3] = {200, 120, 40};
+    std::vector<uint8_t> rgb(width * height * 3);
+    for (size_t i = 0; i < rgb.size(); i++)
+        rgb[i] = colours[i % 3];
+
+    for (int method : {CCVT_BAYER_BILINEAR, CCVT_BAYER_VNG})
+        for (int pattern = CCVT_BAYER_RGGB; pattern <= CCVT_BAYER_BGGR; pattern++)
+        {
+            std::vector<uint8_t> out(rgb.size());
+            ccvt_bayer8_rgb24(width, height, pattern, method, mosaic(rgb, width, height, pattern).data(), out.data());
+            ASSERT_EQ(out, rgb) << "method " << method << " pattern " << pattern;
+        }
+}
+
+TEST(CORE_CCVT, Test_bayerVNGEdges)
+{
+    // Grey disc on a dark background, VNG does not interpolate across its edge
+    const int width = 96, height = 80;
+    std::vector<uint8_t> rgb(width * height * 3);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            int dx = x - width / 2, dy = y - height / 2;
+            uint8_t value = dx * dx + dy * dy < 30 * 30 ? 220 : 20;
+            std::fill_n(&rgb[(y * width + x) * 3], 3, value);
+        }
+
+    for (int pattern = CCVT_BAYER_RGGB; pattern <= CCVT_BAYER_BGGR; pattern++)
+    {
+        auto in = mosaic(rgb, width, height, pattern);
+        std::vector<uint8_t> linear(rgb.size()), vng(rgb.size());
+        ccvt_bayer8_rgb24(width, height, pattern, CCVT_BAYER_BILINEAR, in.data(), linear.data());
+        ccvt_bayer8_rgb24(width, height, pattern, CCVT_BAYER_VNG, in.data(), vng.data());
+        EXPECT_LT(squaredError(vng, rgb), squaredError(linear, rgb) / 2) << "pattern " << pattern;
+    }
+}
+
+TEST(CORE_CCVT, Test_serialParallel)
+{
+    // Several parallel jobs, the last one partial
+    const int width = 130, height = 70;
+    auto yuv420 = randomFrame<uint8_t>(width * height * 3 / 2, 255, 3);
+    auto bayer = randomFrame<uint16_t>(width * height, 65535, 4);
+
+    auto convert = [&]()
+    {
+        std::vector<uint8_t> rgb(width * height * 3);
+        std::vector<uint16_t> linear(width * height * 3), vng(width * height * 3);
+        ccvt_420p_rgb24(width, height, yuv420.data(), rgb.data());
+        ccvt_bayer16_rgb48(width, height, CCVT_BAYER_GRBG, CCVT_BAYER_BILINEAR, bayer.data(), linear.data());
+        ccvt_bayer16_rgb48(width, height, CCVT_BAYER_GRBG, CCVT_BAYER_VNG, bayer.data(), vng.data());
+        return std::make_tuple(rgb, linear, vng);
+    };
+
+    ASSERT_TRUE(ccvt_get_parallel());
+    auto parallel = convert();
+    ccvt_set_parallel(0);
+    auto serial = convert();
+    ccvt_set_parallel(1);
+    ASSERT_EQ(parallel, serial);
+}
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+#include <zlib.h>
+
+#include "indicompression.h"
+
+static std::vector<uint8_t> makeFrame(size_t size)
+{
+    std::vector<uint8_t> frame(size);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        frame[i] = static_cast<uint8_t>((i / 7) + ((seed >> 16) & 0x3));
+    }
+    return frame;
+}
+
+static void testZlibRoundTrip(size_t size, int level, int threads)
+{
+    std::vector<uint8_t> frame = makeFrame(size);
+    std::vector<uint8_t> compressed;
+
+    INDI::Compression::Settings settings;
+    settings.codec     = INDI::Compression::ZLIB;
+    settings.level     = level;
+    settings.threads   = threads;
+    settings.blockSize = 64 * 1024;
+    ASSERT_TRUE(INDI::Compression::compress(frame.data(), frame.size(), compressed, settings));
+
+    // Parallel blocks must still decode as a single zlib stream
+    std::vector<uint8_t> decompressed(size);
+    uLongf decompressedBytes = decompressed.size();
+    ASSERT_EQ(Z_OK, uncompress(decompressed.data(), &decompressedBytes, compressed.data(), compressed.size()));
+    ASSERT_EQ(size, decompressedBytes);
+    ASSERT_EQ(frame, decompressed);
+}
+
+TEST(CORE_COMPRESSION, Test_zlibSingleBlock)
+{
+    testZlibRoundTrip(1000, 6, 1);
+}
+
+TEST(CORE_COMPRESSION, Test_zlibParallelBlocks)
+{
+    testZlibRoundTrip(5 * 1024 * 1024 + 17, 1, 4);
+    testZlibRoundTrip(5 * 1024 * 1024 + 17, 9, 0);
+}
+
+TEST(CORE_COMPRESSION, Test_zlibStored)
+{
+    testZlibRoundTrip(200 * 1024, 0, 2);
+}
+
+TEST(CORE_COMPRESSION, Test_extension)
+{
+    ASSERT_STREQ(".z", INDI::Compression::extension(INDI::Compression::ZLIB));
+    ASSERT_STREQ(".fz", INDI::Compression::extension(INDI::Compression::RICE));
+    ASSERT_TRUE(INDI::Compression::isAvailable(INDI::Compression::ZLIB));
+}
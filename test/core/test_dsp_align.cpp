@@ -0,0 +1,201 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "dsp.h"
+
+struct Star
+{
+    double x, y, flux;
+};
+
+// Gaussian stars over a noisy sky background, as the CCD simulator renders them
+static dsp_stream_p starField(int width, int height, const std::vector<Star> &stars, double sigma, unsigned seed)
+{
+    dsp_stream_p stream = dsp_stream_new();
+    dsp_stream_add_dim(stream, width);
+    dsp_stream_add_dim(stream, height);
+    dsp_stream_alloc_buffer(stream, stream->len);
+
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> noise(100.0, 3.0);
+    for (int i = 0; i < stream->len; i++)
+        stream->buf[i] = noise(generator);
+    for (const Star &star : stars)
+    {
+        for (int y = std::max(0, int(star.y) - 10); y < std::min(height, int(star.y) + 11); y++)
+            for (int x = std::max(0, int(star.x) - 10); x < std::min(width, int(star.x) + 11); x++)
+            {
+                double r2 = (x - star.x) * (x - star.x) + (y - star.y) * (y - star.y);
+                stream->buf[x + y * width] += star.flux * exp(-r2 / (2 * sigma * sigma));
+            }
+    }
+    return stream;
+}
+
+static std::vector<Star> randomStars(int count, int width, int height, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> x(20, width - 20), y(20, height - 20), flux(200, 3000);
+    std::vector<Star> stars;
+    while (static_cast<int>(stars.size()) < count)
+    {
+        Star star { x(generator), y(generator), flux(generator) };
+        bool isolated = true;
+        for (const Star &other : stars)
+            isolated &= std::hypot(star.x - other.x, star.y - other.y) > 15;
+        if (isolated)
+            stars.push_back(star);
+    }
+    return stars;
+}
+
+static void freeStream(dsp_stream_p stream)
+{
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
+
+TEST(CORE_DSP_ALIGN, Test_findStars)
+{
+    std::vector<Star> stars = randomStars(30, 400, 300, 1);
+    dsp_stream_p stream = starField(400, 300, stars, 1.5, 2);
+
+    ASSERT_EQ(dsp_align_find_stars(stream, 4, 2, 5.0, nullptr), 30);
+    for (const Star &star : stars)
+    {
+        double distance = 1e9;
+        for (int i = 0; i < stream->stars_count; i++)
+            distance = std::min(distance, std::hypot(stream->stars[i].center.location[0] - star.x,
+                                stream->stars[i].center.location[1] - star.y));
+        EXPECT_LT(distance, 0.2);
+    }
+    // The FWHM of the thresholded part of the stars
+    for (int i = 0; i < stream->stars_count; i++)
+        EXPECT_NEAR(stream->stars[i].diameter, 2.35482 * 1.5, 1.0);
+    freeStream(stream);
+}
+
+TEST(CORE_DSP_ALIGN, Test_closePairIsDeblended)
+{
+    std::vector<Star> stars { { 50, 50, 3000 }, { 56, 50, 1500 } };
+    dsp_stream_p stream = starField(100, 100, stars, 1.5, 3);
+
+    // A single threshold joins both stars, more levels split them
+    EXPECT_EQ(dsp_align_find_stars(stream, 1, 2, 5.0, nullptr), 1);
+    ASSERT_EQ(dsp_align_find_stars(stream, 8, 2, 5.0, nullptr), 2);
+    EXPECT_NEAR(stream->stars[0].center.location[0], 50, 0.3);
+    EXPECT_NEAR(stream->stars[1].center.location[0], 56, 0.3);
+    freeStream(stream);
+}
+
+TEST(CORE_DSP_ALIGN, Test_typed)
+{
+    std::vector<Star> stars = randomStars(10, 200, 150, 4);
+    dsp_stream_p stream = starField(200, 150, stars, 1.5, 5);
+    dsp_stream_p typed = dsp_stream_new();
+    dsp_stream_add_dim(typed, 200);
+    dsp_stream_add_dim(typed, 150);
+    dsp_stream_alloc_typed_buffer(typed, dsp_type_uint16);
+    dsp_stream_write(typed, 0, 1, stream->buf, stream->len);
+
+    ASSERT_EQ(dsp_align_find_stars(stream, 4, 2, 5.0, nullptr), 10);
+    ASSERT_EQ(dsp_align_find_stars(typed, 4, 2, 5.0, nullptr), 10);
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_NEAR(typed->stars[i].center.location[0], stream->stars[i].center.location[0], 0.05);
+        EXPECT_NEAR(typed->stars[i].center.location[1], stream->stars[i].center.location[1], 0.05);
+    }
+    freeStream(stream);
+    freeStream(typed);
+}
+
+TEST(CORE_DSP_ALIGN, Test_getOffset)
+{
+    const int width = 500, height = 400;
+    const double radians = 0.05, factor = 1.02, dx = 7.5, dy = -4.25;
+    const double cx = width / 2.0, cy = height / 2.0;
+
+    std::vector<Star> stars = randomStars(25, width, height, 6);
+    // stars2 maps to stars through the transform, up to missing and extra stars near the edges
+    std::vector<Star> stars2;
+    for (const Star &star : stars)
+    {
+        double x = star.x - dx - cx, y = star.y - dy - cy;
+        double c = cos(-radians) / factor, s = sin(-radians) / factor;
+        stars2.push_back({ c * x - s * y + cx, s * x + c * y + cy, star.flux });
+    }
+    stars2.erase(stars2.begin() + 20, stars2.end());
+    stars2.push_back({ 30, 30, 800 });
+
+    dsp_stream_p reference = starField(width, height, stars, 1.5, 7);
+    dsp_stream_p stream = starField(width, height, stars2, 1.5, 8);
+    ASSERT_GE(dsp_align_find_stars(reference, 4, 2, 5.0, nullptr), 24);
+    ASSERT_GE(dsp_align_find_stars(stream, 4, 2, 5.0, nullptr), 20);
+
+    int matched = dsp_align_get_offset(reference, stream, 20, 2);
+    EXPECT_GE(matched, 10);
+    EXPECT_NEAR(stream->align_info.radians[0], radians, 1e-3);
+    EXPECT_NEAR(stream->align_info.factor, factor, 1e-3);
+
+    // Every star of stream lands on its reference star
+    for (int i = 0; i < 20; i++)
+    {
+        const Star &p = stars2[i];
+        double x = p.x - stream->align_info.center[0], y = p.y - stream->align_info.center[1];
+        double r = stream->align_info.radians[0], f = stream->align_info.factor;
+        double tx = f * (x * cos(r) - y * sin(r)) + stream->align_info.center[0] + stream->align_info.offset[0];
+        double ty = f * (x * sin(r) + y * cos(r)) + stream->align_info.center[1] + stream->align_info.offset[1];
+        EXPECT_NEAR(tx, stars[i].x, 0.2);
+        EXPECT_NEAR(ty, stars[i].y, 0.2);
+    }
+    freeStream(reference);
+    freeStream(stream);
+}
+
+TEST(CORE_DSP_ALIGN, Test_cropLimit)
+{
+    std::vector<Star> stars { { 10, 10, 2000 }, { 60, 40, 1000 } };
+    dsp_stream_p reference = starField(80, 60, stars, 1.5, 9);
+    ASSERT_EQ(dsp_align_find_stars(reference, 4, 2, 5.0, nullptr), 2);
+
+    ASSERT_EQ(dsp_align_crop_limit(reference, reference, 2, 15), 2);
+    ASSERT_EQ(reference->child_count, 2);
+    // Clipped by the top left corner
+    dsp_stream_p crop = reference->children[0];
+    EXPECT_EQ(crop->ROI[0].start, 0);
+    EXPECT_EQ(crop->sizes[0], 26);
+    EXPECT_EQ(crop->ROI[1].start, 0);
+    EXPECT_EQ(crop->sizes[1], 26);
+    crop = reference->children[1];
+    EXPECT_EQ(crop->ROI[0].start, 45);
+    EXPECT_EQ(crop->sizes[0], 31);
+    EXPECT_EQ(crop->ROI[1].start, 25);
+    EXPECT_EQ(crop->sizes[1], 31);
+    EXPECT_EQ(crop->buf[15 + 15 * 31], reference->buf[60 + 40 * 80]);
+
+    freeStream(reference->children[0]);
+    freeStream(reference->children[1]);
+    freeStream(reference);
+}
@@ -0,0 +1,172 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "dsp.h"
+
+static dsp_stream_p newStream(const std::vector<int> &sizes)
+{
+    dsp_stream_p stream = dsp_stream_new();
+    for (int size : sizes)
+        dsp_stream_add_dim(stream, size);
+    dsp_stream_alloc_buffer(stream, stream->len);
+    return stream;
+}
+
+static void freeStream(dsp_stream_p stream)
+{
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
+
+// Centered convolution with zero padding, element by element
+static double reference(dsp_stream_p stream, dsp_stream_p matrix, int index)
+{
+    std::vector<int> pos(stream->dims);
+    for (int d = 0, rest = index; d < stream->dims; d++, rest /= stream->sizes[d - 1])
+        pos[d] = rest % stream->sizes[d];
+
+    double sum = 0;
+    for (int k = 0; k < matrix->len; k++)
+    {
+        int z = 0, stride = 1, rest = k;
+        bool inside = true;
+        for (int d = 0; d < stream->dims && inside; d++)
+        {
+            int size = d < matrix->dims ? matrix->sizes[d] : 1;
+            int c = pos[d] + size / 2 - rest % size;
+            rest /= size;
+            inside = c >= 0 && c < stream->sizes[d];
+            z += c * stride;
+            stride *= stream->sizes[d];
+        }
+        if (inside)
+            sum += stream->buf[z] * matrix->buf[k];
+    }
+    return sum;
+}
+
+static void checkConvolution(const std::vector<int> &sizes, const std::vector<int> &matrixSizes, bool separable)
+{
+    dsp_stream_p stream = newStream(sizes);
+    dsp_stream_p matrix = newStream(matrixSizes);
+
+    srand(1);
+    for (int i = 0; i < stream->len; i++)
+        stream->buf[i] = rand() % 1000;
+    for (int i = 0; i < matrix->len; i++)
+        matrix->buf[i] = separable ? (1 + i % matrixSizes[0]) * (1 + i / matrixSizes[0]) : (rand() % 100) / 10.0 - 3;
+
+    dsp_stream_p out = dsp_convolution_convolution(stream, matrix);
+    ASSERT_NE(nullptr, out);
+    ASSERT_EQ(stream->len, out->len);
+    for (int i = 0; i < stream->len; i++)
+        ASSERT_NEAR(reference(stream, matrix, i), out->buf[i], 1e-6) << "at " << i;
+
+    freeStream(out);
+    freeStream(matrix);
+    freeStream(stream);
+}
+
+TEST(CORE_DSP_CONVOLUTION, Test_direct)
+{
+    checkConvolution({37, 23}, {5, 4}, false);
+}
+
+TEST(CORE_DSP_CONVOLUTION, Test_separable)
+{
+    checkConvolution({37, 23}, {3, 3}, true);
+    checkConvolution({37, 23}, {1, 7}, false);
+    checkConvolution({37, 23}, {7, 1}, false);
+}
+
+TEST(CORE_DSP_CONVOLUTION, Test_fft)
+{
+    checkConvolution({60, 40}, {21, 17}, false);
+}
+
+TEST(CORE_DSP_CONVOLUTION, Test_dimensions)
+{
+    checkConvolution({100}, {31}, false);
+    checkConvolution({37, 23}, {3}, false);
+    checkConvolution({6, 5, 4}, {3, 3, 3}, false);
+}
+
+TEST(CORE_DSP_CONVOLUTION, Test_matrixTooLarge)
+{
+    dsp_stream_p stream = newStream({10});
+    dsp_stream_p matrix = newStream({3, 3});
+    ASSERT_EQ(nullptr, dsp_convolution_convolution(stream, matrix));
+    freeStream(matrix);
+    freeStream(stream);
+}
+
+// A 16 bit typed stream gives the rounded and saturated result of the dsp_t stream
+static void checkTyped(const std::vector<int> &sizes, const std::vector<int> &matrixSizes, bool separable)
+{
+    dsp_stream_p stream = newStream(sizes);
+    dsp_stream_p matrix = newStream(matrixSizes);
+
+    srand(2);
+    std::vector<uint16_t> data(stream->len);
+    for (int i = 0; i < stream->len; i++)
+        data[i] = stream->buf[i] = rand() % 60000;
+    for (int i = 0; i < matrix->len; i++)
+        matrix->buf[i] = separable ? (1 + i % matrixSizes[0]) * (1 + i / matrixSizes[0]) / 16.0 : (rand() % 100) / 100.0 - 0.3;
+
+    dsp_stream_p expected = dsp_convolution_convolution(stream, matrix);
+
+    dsp_stream_p typed = dsp_stream_new();
+    for (int size : sizes)
+        dsp_stream_add_dim(typed, size);
+    dsp_stream_set_typed_buffer(typed, data.data(), dsp_type_uint16);
+
+    dsp_stream_p out = dsp_convolution_convolution(typed, matrix);
+    ASSERT_NE(nullptr, out);
+    ASSERT_NE(nullptr, out->data);
+    ASSERT_EQ(dsp_type_uint16, out->type);
+
+    std::vector<double> result(out->len);
+    dsp_stream_read(out, 0, 1, result.data(), out->len);
+    for (int i = 0; i < stream->len; i++)
+        ASSERT_NEAR(std::round(std::min(65535.0, std::max(0.0, expected->buf[i]))), result[i], 1) << "at " << i;
+
+    freeStream(out);
+    // The wrapped buffer belongs to the test
+    freeStream(typed);
+    freeStream(expected);
+    freeStream(matrix);
+    freeStream(stream);
+}
+
+TEST(CORE_DSP_CONVOLUTION, Test_typed)
+{
+    checkTyped({37, 150}, {5, 4}, false);
+    checkTyped({37, 150}, {3, 3}, true);
+    checkTyped({37, 150}, {1, 7}, false);
+    checkTyped({37, 150}, {7, 1}, false);
+    checkTyped({60, 40}, {21, 17}, false);
+    checkTyped({6, 5, 4}, {3, 3, 3}, false);
+}
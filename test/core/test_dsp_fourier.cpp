@@ -0,0 +1,127 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "dsp.h"
+
+static dsp_stream_p newStream(const std::vector<int> &sizes)
+{
+    dsp_stream_p stream = dsp_stream_new();
+    for (int size : sizes)
+        dsp_stream_add_dim(stream, size);
+    dsp_stream_alloc_buffer(stream, stream->len);
+    for (int i = 0; i < stream->len; i++)
+        stream->buf[i] = std::sin(i * 1.3) + i % 4;
+    return stream;
+}
+
+static void freeStream(dsp_stream_p stream)
+{
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
+
+// Full spectrum of a one or two dimensional stream, element by element
+static void checkSpectrum(dsp_stream_p stream, const dsp_complex *dft)
+{
+    int width  = stream->sizes[0];
+    int height = stream->dims > 1 ? stream->sizes[1] : 1;
+
+    for (int ky = 0; ky < height; ky++)
+        for (int kx = 0; kx < width; kx++)
+        {
+            double re = 0, im = 0;
+            for (int y = 0; y < height; y++)
+                for (int x = 0; x < width; x++)
+                {
+                    double angle = -2 * M_PI * (static_cast<double>(kx) * x / width + static_cast<double>(ky) * y / height);
+                    re += stream->buf[y * width + x] * std::cos(angle);
+                    im += stream->buf[y * width + x] * std::sin(angle);
+                }
+            ASSERT_NEAR(dft[ky * width + kx].real, re, 1e-9) << "at " << kx << "," << ky;
+            ASSERT_NEAR(dft[ky * width + kx].imaginary, im, 1e-9) << "at " << kx << "," << ky;
+        }
+}
+
+TEST(CORE_DSP_FOURIER, Test_dft1d)
+{
+    dsp_stream_p stream = newStream({7});
+    dsp_complex *dft = dsp_fourier_dft(stream);
+    ASSERT_NE(dft, nullptr);
+    checkSpectrum(stream, dft);
+    free(dft);
+    freeStream(stream);
+}
+
+TEST(CORE_DSP_FOURIER, Test_dft2d)
+{
+    dsp_stream_p stream = newStream({12, 9});
+    // The second transform runs on the cached plan
+    for (int i = 0; i < 2; i++)
+    {
+        dsp_complex *dft = dsp_fourier_dft(stream);
+        ASSERT_NE(dft, nullptr);
+        checkSpectrum(stream, dft);
+        free(dft);
+    }
+    freeStream(stream);
+}
+
+TEST(CORE_DSP_FOURIER, Test_manySizes)
+{
+    // More sizes than the cache holds, released plans are destroyed
+    for (int size = 2; size < 40; size++)
+    {
+        dsp_stream_p stream = newStream({size, 3});
+        dsp_complex *dft = dsp_fourier_dft(stream);
+        ASSERT_NE(dft, nullptr);
+        checkSpectrum(stream, dft);
+        free(dft);
+        freeStream(stream);
+    }
+}
+
+TEST(CORE_DSP_FOURIER, Test_idftTyped)
+{
+    // A typed stream is converted, its result is the one of the dsp_t stream
+    std::vector<uint16_t> data(10 * 6);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<uint16_t>(i * 37 % 101);
+    dsp_stream_p typed = dsp_stream_new();
+    dsp_stream_add_dim(typed, 10);
+    dsp_stream_add_dim(typed, 6);
+    dsp_stream_set_typed_buffer(typed, data.data(), dsp_type_uint16);
+    dsp_stream_p stream = newStream({10, 6});
+    for (int i = 0; i < stream->len; i++)
+        stream->buf[i] = data[i];
+
+    dsp_t *result = dsp_fourier_idft(typed);
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result, typed->buf);
+    ASSERT_EQ(typed->data, nullptr);
+    dsp_fourier_idft(stream);
+    for (int i = 0; i < stream->len; i++)
+        ASSERT_NEAR(result[i], stream->buf[i], 1e-9) << "at " << i;
+    freeStream(typed);
+    freeStream(stream);
+}
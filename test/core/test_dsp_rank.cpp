@@ -0,0 +1,168 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "dsp.h"
+
+// Sorted centered window with replicated edges, element by element
+static std::vector<double> reference(const std::vector<double> &in, int size, int rank)
+{
+    int len = in.size();
+    std::vector<double> out(len), window(size);
+    for (int i = 0; i < len; i++)
+    {
+        for (int j = 0; j < size; j++)
+            window[j] = in[std::max(0, std::min(len - 1, i - size / 2 + j))];
+        std::sort(window.begin(), window.end());
+        out[i] = window[rank];
+    }
+    return out;
+}
+
+static std::vector<double> randomLine(int len, int levels, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> distribution(0, levels);
+    std::vector<double> line(len);
+    for (auto &value : line)
+        value = distribution(generator);
+    return line;
+}
+
+TEST(CORE_DSP_RANK, Test_buffer)
+{
+    for (int size : {1, 2, 3, 4, 7, 15, 64})
+        for (int levels : {3, 1000})
+        {
+            std::vector<double> in = randomLine(200, levels, size * 31 + levels);
+            for (int rank : {0, size / 2, size - 1})
+            {
+                std::vector<double> out(in.size());
+                dsp_filter_rank_buffer(in.data(), out.data(), in.size(), size, rank);
+                ASSERT_EQ(out, reference(in, size, rank)) << "size " << size << " rank " << rank;
+            }
+        }
+}
+
+TEST(CORE_DSP_RANK, Test_windowLargerThanBuffer)
+{
+    std::vector<double> in = randomLine(5, 100, 1);
+    std::vector<double> out(in.size());
+    dsp_filter_rank_buffer(in.data(), out.data(), in.size(), 11, 5);
+    ASSERT_EQ(out, reference(in, 11, 5));
+}
+
+TEST(CORE_DSP_RANK, Test_separable)
+{
+    const int width = 37, height = 23, size = 5;
+    dsp_stream_p stream = dsp_stream_new();
+    dsp_stream_add_dim(stream, width);
+    dsp_stream_add_dim(stream, height);
+    dsp_stream_alloc_buffer(stream, stream->len);
+    std::vector<double> in = randomLine(width * height, 4095, 7);
+    std::copy(in.begin(), in.end(), stream->buf);
+
+    // Rows, then columns of the filtered rows
+    std::vector<double> expected(in.size());
+    for (int y = 0; y < height; y++)
+    {
+        std::vector<double> row(in.begin() + y * width, in.begin() + (y + 1) * width);
+        row = reference(row, size, size / 2);
+        std::copy(row.begin(), row.end(), expected.begin() + y * width);
+    }
+    for (int x = 0; x < width; x++)
+    {
+        std::vector<double> column(height);
+        for (int y = 0; y < height; y++)
+            column[y] = expected[y * width + x];
+        column = reference(column, size, size / 2);
+        for (int y = 0; y < height; y++)
+            expected[y * width + x] = column[y];
+    }
+
+    dsp_stream_p out = dsp_filter_median(stream, size);
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(std::vector<double>(out->buf, out->buf + out->len), expected);
+    // The input is left untouched
+    ASSERT_EQ(std::vector<double>(stream->buf, stream->buf + stream->len), in);
+
+    ASSERT_EQ(dsp_filter_rank(stream, size, size), nullptr);
+
+    dsp_stream_free_buffer(out);
+    dsp_stream_free(out);
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
+
+TEST(CORE_DSP_RANK, Test_bufferMedian)
+{
+    // A hot pixel is removed, the filter does not read its own output
+    dsp_stream_p stream = dsp_stream_new();
+    dsp_stream_add_dim(stream, 9);
+    dsp_stream_alloc_buffer(stream, stream->len);
+    const double line[9] = {1, 2, 3, 4, 60000, 6, 7, 8, 9};
+    std::copy(line, line + 9, stream->buf);
+
+    dsp_buffer_median(stream, 3, 1);
+    const double expected[9] = {1, 2, 3, 4, 6, 7, 7, 8, 9};
+    for (int i = 0; i < 9; i++)
+        ASSERT_EQ(stream->buf[i], expected[i]) << "at " << i;
+
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
+
+TEST(CORE_DSP_RANK, Test_typed)
+{
+    const int width = 41, height = 30, size = 5;
+    dsp_stream_p stream = dsp_stream_new();
+    dsp_stream_add_dim(stream, width);
+    dsp_stream_add_dim(stream, height);
+    dsp_stream_alloc_buffer(stream, stream->len);
+    std::vector<double> in = randomLine(width * height, 255, 9);
+    std::copy(in.begin(), in.end(), stream->buf);
+
+    std::vector<uint8_t> data(in.begin(), in.end());
+    dsp_stream_p typed = dsp_stream_new();
+    dsp_stream_add_dim(typed, width);
+    dsp_stream_add_dim(typed, height);
+    dsp_stream_set_typed_buffer(typed, data.data(), dsp_type_uint8);
+
+    dsp_stream_p expected = dsp_filter_rank(stream, size, 1);
+    dsp_stream_p out = dsp_filter_rank(typed, size, 1);
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(out->type, dsp_type_uint8);
+    ASSERT_EQ(std::vector<uint8_t>(static_cast<uint8_t *>(out->data), static_cast<uint8_t *>(out->data) + out->len),
+              std::vector<uint8_t>(expected->buf, expected->buf + expected->len));
+
+    dsp_stream_free_buffer(out);
+    dsp_stream_free(out);
+    dsp_stream_free_buffer(expected);
+    dsp_stream_free(expected);
+    dsp_stream_free_buffer(typed);
+    dsp_stream_free(typed);
+    dsp_stream_free_buffer(stream);
+    dsp_stream_free(stream);
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <unistd.h>
+
+#include "indifileindex.h"
+
+static std::string makeTempDir()
+{
+    char path[] = "/tmp/indi_file_index_XXXXXX";
+    return mkdtemp(path) ? path : "";
+}
+
+static void touch(const std::string &path)
+{
+    FILE *fp = fopen(path.c_str(), "w");
+    ASSERT_NE(fp, nullptr);
+    fclose(fp);
+}
+
+TEST(CORE_FILE_INDEX, Test_continuesExistingIndex)
+{
+    std::string dir = makeTempDir();
+    ASSERT_FALSE(dir.empty());
+    touch(dir + "/IMAGE_007.fits");
+    touch(dir + "/OTHER_042.fits");
+
+    INDI::FileIndex index;
+    ASSERT_EQ(index.nextFileName(dir, "IMAGE_XXX", ".fits"), dir + "/IMAGE_008.fits");
+    // Files are not created by FileIndex, the index still advances.
+    ASSERT_EQ(index.nextFileName(dir, "IMAGE_XXX", ".fits"), dir + "/IMAGE_009.fits");
+    ASSERT_EQ(index.nextFileName(dir, "OTHER_XXX", ".fits"), dir + "/OTHER_043.fits");
+}
+
+TEST(CORE_FILE_INDEX, Test_detectsCollision)
+{
+    std::string dir = makeTempDir();
+    ASSERT_FALSE(dir.empty());
+
+    INDI::FileIndex index;
+    ASSERT_EQ(index.nextFileName(dir, "IMAGE_XXX", ".fits"), dir + "/IMAGE_001.fits");
+
+    // Written by someone else since the last scan
+    touch(dir + "/IMAGE_002.fits");
+    touch(dir + "/IMAGE_005.fits");
+    ASSERT_EQ(index.nextFileName(dir, "IMAGE_XXX", ".fits"), dir + "/IMAGE_006.fits");
+}
+
+TEST(CORE_FILE_INDEX, Test_createsDirectory)
+{
+    std::string dir = makeTempDir();
+    ASSERT_FALSE(dir.empty());
+    dir += "/a/b";
+
+    INDI::FileIndex index;
+    ASSERT_EQ(index.nextFileName(dir, "IMAGE_XXX", ".fits"), dir + "/IMAGE_001.fits");
+    ASSERT_EQ(access(dir.c_str(), F_OK), 0);
+}
+
+TEST(CORE_FILE_INDEX, Test_expandPrefix)
+{
+    ASSERT_EQ(INDI::FileIndex::expandPrefix("IMAGE_XXX", 12), "IMAGE_012");
+    ASSERT_EQ(INDI::FileIndex::expandPrefix("IMAGE_XXX", 1234), "IMAGE_1234");
+    ASSERT_EQ(INDI::FileIndex::expandPrefix("IMAGE", 3), "IMAGE");
+
+    std::string expanded = INDI::FileIndex::expandPrefix("M31_ISO8601_XXX", 1);
+    ASSERT_EQ(expanded.size(), std::string("M31_YYYY-MM-DDTHH-MM-SS_001").size());
+    ASSERT_EQ(expanded.find("ISO8601"), std::string::npos);
+}
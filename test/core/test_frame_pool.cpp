@@ -0,0 +1,91 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include "framepool.h"
+
+using INDI::FramePool;
+
+TEST(CORE_FRAME_POOL, Test_recyclesFrames)
+{
+    FramePool pool;
+
+    const uint8_t *first;
+    {
+        FramePool::Handle frame = pool.acquire(1000);
+        ASSERT_TRUE(static_cast<bool>(frame));
+        ASSERT_EQ(frame.size(), 1000U);
+        first = frame.data();
+    }
+
+    // Released frames are reused, smaller requests fit in the same buffer
+    FramePool::Handle frame = pool.acquire(500);
+    ASSERT_EQ(frame.data(), first);
+    ASSERT_EQ(frame.size(), 500U);
+    ASSERT_EQ(pool.allocatedSize(), 1000U);
+}
+
+TEST(CORE_FRAME_POOL, Test_sharedHandles)
+{
+    FramePool pool;
+
+    FramePool::Handle frame = pool.acquire(100);
+    FramePool::Handle copy  = frame;
+    frame.reset();
+    ASSERT_FALSE(static_cast<bool>(frame));
+
+    // Still referenced by copy, so a new frame is allocated
+    FramePool::Handle other = pool.acquire(100);
+    ASSERT_NE(other.data(), copy.data());
+    ASSERT_EQ(pool.allocatedSize(), 200U);
+
+    const uint8_t *data = copy.data();
+    copy.reset();
+    ASSERT_EQ(pool.acquire(100).data(), data);
+}
+
+TEST(CORE_FRAME_POOL, Test_limit)
+{
+    FramePool pool(250, 1);
+
+    FramePool::Handle a = pool.acquire(100);
+    FramePool::Handle b = pool.acquire(100);
+    ASSERT_TRUE(static_cast<bool>(a));
+    ASSERT_TRUE(static_cast<bool>(b));
+    ASSERT_FALSE(static_cast<bool>(pool.acquire(100)));
+
+    b.reset();
+    ASSERT_TRUE(static_cast<bool>(pool.acquire(100)));
+
+    // The first frame is always allowed
+    FramePool small(10, 1);
+    ASSERT_TRUE(static_cast<bool>(small.acquire(100)));
+}
+
+TEST(CORE_FRAME_POOL, Test_shrink)
+{
+    FramePool pool;
+
+    FramePool::Handle a = pool.acquire(100);
+    pool.acquire(100);
+    ASSERT_EQ(pool.allocatedSize(), 200U);
+
+    pool.shrink();
+    ASSERT_EQ(pool.allocatedSize(), 100U);
+}
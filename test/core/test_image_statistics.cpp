@@ -0,0 +1,66 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "indiimagestatistics.h"
+
+TEST(CORE_IMAGE_STATISTICS, Test_uint16)
+{
+    // Odd size so the scalar tail of the kernel is exercised
+    std::vector<uint16_t> frame(1001);
+    for (size_t i = 0; i < frame.size(); i++)
+        frame[i] = static_cast<uint16_t>(i * 60);
+
+    INDI::ImageStatistics statistics = INDI::ImageStatistics::calculate(frame.data(), frame.size(), 16);
+    ASSERT_DOUBLE_EQ(0, statistics.min);
+    ASSERT_DOUBLE_EQ(60000, statistics.max);
+    ASSERT_DOUBLE_EQ(30000, statistics.mean);
+    ASSERT_DOUBLE_EQ(30000, statistics.median);
+    ASSERT_NEAR(17337.82, statistics.stddev, 0.01);
+}
+
+TEST(CORE_IMAGE_STATISTICS, Test_uint8Constant)
+{
+    std::vector<uint8_t> frame(100000, 42);
+
+    INDI::ImageStatistics statistics = INDI::ImageStatistics::calculate(frame.data(), frame.size(), 8);
+    ASSERT_DOUBLE_EQ(42, statistics.min);
+    ASSERT_DOUBLE_EQ(42, statistics.max);
+    ASSERT_DOUBLE_EQ(42, statistics.mean);
+    ASSERT_DOUBLE_EQ(0, statistics.stddev);
+    ASSERT_DOUBLE_EQ(42, statistics.median);
+}
+
+TEST(CORE_IMAGE_STATISTICS, Test_float)
+{
+    std::vector<float> frame {3.5f, -1.0f, 2.0f};
+
+    INDI::ImageStatistics statistics = INDI::ImageStatistics::calculate(frame.data(), frame.size(), -32);
+    ASSERT_DOUBLE_EQ(-1.0, statistics.min);
+    ASSERT_DOUBLE_EQ(3.5, statistics.max);
+    ASSERT_DOUBLE_EQ(2.0, statistics.median);
+}
+
+TEST(CORE_IMAGE_STATISTICS, Test_empty)
+{
+    INDI::ImageStatistics statistics = INDI::ImageStatistics::calculate(nullptr, 0, 16);
+    ASSERT_DOUBLE_EQ(0, statistics.max);
+}
@@ -0,0 +1,230 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "indilivestack.h"
+
+using INDI::LiveStack;
+
+static constexpr uint32_t WIDTH = 320;
+static constexpr uint32_t HEIGHT = 240;
+static constexpr double SKY = 1000;
+static constexpr double NOISE = 20;
+
+struct Star
+{
+    double x, y, flux;
+};
+
+static std::vector<Star> randomStars(int count, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> x(30, WIDTH - 30), y(30, HEIGHT - 30), flux(3000, 20000);
+    std::vector<Star> stars;
+    while (static_cast<int>(stars.size()) < count)
+    {
+        Star star { x(generator), y(generator), flux(generator) };
+        bool isolated = true;
+        for (const Star &other : stars)
+            isolated &= std::hypot(star.x - other.x, star.y - other.y) > 15;
+        if (isolated)
+            stars.push_back(star);
+    }
+    return stars;
+}
+
+// 16 bit frame of the stars moved by (dx, dy) and rotated by radians around the center
+static std::vector<uint16_t> render(const std::vector<Star> &stars, double dx, double dy, double radians,
+                                    unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> noise(SKY, NOISE);
+    std::vector<double> image(WIDTH * HEIGHT);
+    for (double &pixel : image)
+        pixel = noise(generator);
+
+    const double cx = WIDTH / 2.0, cy = HEIGHT / 2.0, sigma = 1.5;
+    for (const Star &star : stars)
+    {
+        double x = cos(radians) * (star.x - cx) - sin(radians) * (star.y - cy) + cx + dx;
+        double y = sin(radians) * (star.x - cx) + cos(radians) * (star.y - cy) + cy + dy;
+        for (int j = std::max(0, int(y) - 10); j < std::min(int(HEIGHT), int(y) + 11); j++)
+            for (int i = std::max(0, int(x) - 10); i < std::min(int(WIDTH), int(x) + 11); i++)
+            {
+                double r2 = (i - x) * (i - x) + (j - y) * (j - y);
+                image[i + j * WIDTH] += star.flux * exp(-r2 / (2 * sigma * sigma));
+            }
+    }
+
+    std::vector<uint16_t> frame(image.size());
+    for (size_t i = 0; i < image.size(); i++)
+        frame[i] = static_cast<uint16_t>(std::min(65535.0, std::max(0.0, std::round(image[i]))));
+    return frame;
+}
+
+// Standard deviation of the background in a star free corner
+static double backgroundNoise(const std::vector<float> &image)
+{
+    double sum = 0, sumSquares = 0;
+    int count = 0;
+    for (uint32_t y = 2; y < 22; y++)
+        for (uint32_t x = 2; x < 22; x++)
+        {
+            sum += image[x + y * WIDTH];
+            sumSquares += image[x + y * WIDTH] * image[x + y * WIDTH];
+            count++;
+        }
+    double mean = sum / count;
+    return std::sqrt(sumSquares / count - mean * mean);
+}
+
+TEST(CORE_LIVE_STACK, Test_reducesNoise)
+{
+    std::vector<Star> stars = randomStars(25, 1);
+    LiveStack stack;
+
+    std::vector<uint16_t> first = render(stars, 0, 0, 0, 100);
+    std::vector<float> single(first.begin(), first.end());
+    ASSERT_TRUE(stack.add(first.data(), WIDTH, HEIGHT, 16));
+
+    for (int i = 1; i < 16; i++)
+    {
+        std::vector<uint16_t> frame = render(stars, 0.7 * i, -0.4 * i, 0.002 * i, 100 + i);
+        EXPECT_TRUE(stack.add(frame.data(), WIDTH, HEIGHT, 16)) << "frame " << i;
+    }
+    EXPECT_EQ(stack.stacked(), 16u);
+    EXPECT_EQ(stack.rejected(), 0u);
+
+    std::vector<float> image;
+    stack.image(image);
+    ASSERT_EQ(image.size(), WIDTH * HEIGHT);
+    // Sixteen frames have a quarter of the noise, interpolation lowers it a bit more
+    EXPECT_LT(backgroundNoise(image), backgroundNoise(single) / 3);
+
+    // Stars stay where they are in the reference frame
+    for (const Star &star : stars)
+    {
+        size_t i = std::lround(star.x) + std::lround(star.y) * WIDTH;
+        EXPECT_GT(image[i], SKY + star.flux / 2);
+    }
+}
+
+TEST(CORE_LIVE_STACK, Test_clipsOutliers)
+{
+    std::vector<Star> stars = randomStars(25, 2);
+    LiveStack stack;
+
+    for (int i = 0; i < 8; i++)
+    {
+        std::vector<uint16_t> frame = render(stars, i, i, 0, 200 + i);
+        // A satellite trail through one frame
+        if (i == 5)
+            for (uint32_t x = 0; x < WIDTH; x++)
+                frame[x + 10 * WIDTH] = 60000;
+        ASSERT_TRUE(stack.add(frame.data(), WIDTH, HEIGHT, 16));
+    }
+
+    std::vector<float> image;
+    stack.image(image);
+    // The trail crosses row 5 of the reference
+    for (uint32_t x = 20; x < WIDTH - 20; x++)
+        EXPECT_NEAR(image[x + 5 * WIDTH], SKY, 5 * NOISE) << "x " << x;
+}
+
+TEST(CORE_LIVE_STACK, Test_equalFramesDoNotFreeze)
+{
+    std::vector<Star> stars = randomStars(25, 4);
+    LiveStack stack;
+
+    // The deviation of the first values of each pixel is zero
+    std::vector<uint16_t> frame = render(stars, 0, 0, 0, 400);
+    for (int i = 0; i < 6; i++)
+        ASSERT_TRUE(stack.add(frame.data(), WIDTH, HEIGHT, 16));
+    std::vector<float> before;
+    stack.image(before);
+
+    // Brighter sky, well within the noise of the later frames
+    for (int i = 0; i < 10; i++)
+    {
+        std::vector<uint16_t> brighter = render(stars, 0, 0, 0, 401 + i);
+        for (auto &pixel : brighter)
+            pixel += 2 * NOISE;
+        ASSERT_TRUE(stack.add(brighter.data(), WIDTH, HEIGHT, 16));
+    }
+    std::vector<float> after;
+    stack.image(after);
+
+    double shift = 0;
+    for (uint32_t y = 2; y < 22; y++)
+        for (uint32_t x = 2; x < 22; x++)
+            shift += after[x + y * WIDTH] - before[x + y * WIDTH];
+    EXPECT_GT(shift / 400, NOISE);
+}
+
+TEST(CORE_LIVE_STACK, Test_rejectsUnmatchedFrames)
+{
+    std::vector<Star> stars = randomStars(25, 3);
+    LiveStack stack;
+
+    // Without stars there is no reference yet
+    std::vector<uint16_t> empty = render({}, 0, 0, 0, 300);
+    EXPECT_FALSE(stack.add(empty.data(), WIDTH, HEIGHT, 16));
+    std::vector<float> image;
+    stack.image(image);
+    EXPECT_TRUE(image.empty());
+
+    std::vector<uint16_t> frame = render(stars, 0, 0, 0, 301);
+    EXPECT_TRUE(stack.add(frame.data(), WIDTH, HEIGHT, 16));
+    // Another field does not match the reference
+    std::vector<uint16_t> other = render(randomStars(25, 4), 0, 0, 0, 302);
+    EXPECT_FALSE(stack.add(other.data(), WIDTH, HEIGHT, 16));
+    EXPECT_FALSE(stack.add(empty.data(), WIDTH, HEIGHT, 16));
+
+    EXPECT_EQ(stack.stacked(), 1u);
+    EXPECT_EQ(stack.rejected(), 3u);
+
+    stack.reset();
+    EXPECT_EQ(stack.stacked(), 0u);
+    EXPECT_EQ(stack.rejected(), 0u);
+    EXPECT_TRUE(stack.add(other.data(), WIDTH, HEIGHT, 16));
+}
+
+TEST(CORE_LIVE_STACK, Test_sizeChangeResets)
+{
+    std::vector<Star> stars = randomStars(25, 5);
+    LiveStack stack;
+
+    std::vector<uint16_t> frame = render(stars, 0, 0, 0, 400);
+    ASSERT_TRUE(stack.add(frame.data(), WIDTH, HEIGHT, 16));
+    ASSERT_TRUE(stack.add(frame.data(), WIDTH, HEIGHT, 16));
+    EXPECT_EQ(stack.stacked(), 2u);
+
+    // The same buffer read as a frame of half the height
+    EXPECT_TRUE(stack.add(frame.data(), WIDTH, HEIGHT / 2, 16));
+    EXPECT_EQ(stack.stacked(), 1u);
+    EXPECT_EQ(stack.height(), HEIGHT / 2);
+
+    std::vector<float> image;
+    stack.image(image);
+    EXPECT_EQ(image.size(), WIDTH * HEIGHT / 2);
+}
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "spscqueue.h"
+
+TEST(CORE_SPSC_QUEUE, Test_fifoAndCapacity)
+{
+    SPSCQueue<int> queue(3);
+    ASSERT_EQ(queue.capacity(), 4U);
+
+    for (int i = 0; i < 4; i++)
+        ASSERT_TRUE(queue.push(int(i)));
+    ASSERT_FALSE(queue.push(4));
+    ASSERT_EQ(queue.size(), 4U);
+
+    int value = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(queue.pop(value, 0));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_EQ(queue.size(), 0U);
+    ASSERT_FALSE(queue.pop(value, 10));
+}
+
+TEST(CORE_SPSC_QUEUE, Test_threads)
+{
+    const int count = 100000;
+    SPSCQueue<int> queue(16);
+
+    std::thread producer([&]()
+    {
+        for (int i = 0; i < count; i++)
+        {
+            while (queue.push(int(i)) == false)
+                std::this_thread::yield();
+        }
+    });
+
+    int value = -1;
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_TRUE(queue.pop(value));
+        ASSERT_EQ(value, i);
+    }
+
+    producer.join();
+    ASSERT_TRUE(queue.waitForEmpty(0));
+}
+
+TEST(CORE_SPSC_QUEUE, Test_waitForEmptyAndAbort)
+{
+    SPSCQueue<int> queue;
+    queue.push(1);
+    queue.push(2);
+
+    std::thread consumer([&]()
+    {
+        int value;
+        while (queue.pop(value));
+    });
+
+    queue.waitForEmpty();
+    ASSERT_EQ(queue.size(), 0U);
+
+    queue.abort();
+    consumer.join();
+}
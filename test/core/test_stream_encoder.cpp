@@ -0,0 +1,190 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include "encoder/jpegencoderpool.h"
+#include "encoder/ratecontrol.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <jpeglib.h>
+
+using INDI::JPEGEncoderPool;
+using INDI::RateControl;
+
+// Decode a JPEG, returns false if libjpeg reports a corrupt stream
+static bool decode(const std::vector<uint8_t> &jpeg, std::vector<uint8_t> &image, uint32_t &width, uint32_t &height,
+                   uint32_t &channels)
+{
+    jpeg_decompress_struct cinfo;
+    jpeg_error_mgr error;
+    cinfo.err = jpeg_std_error(&error);
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<uint8_t *>(jpeg.data()), jpeg.size());
+    jpeg_read_header(&cinfo, TRUE);
+    jpeg_start_decompress(&cinfo);
+
+    width = cinfo.output_width;
+    height = cinfo.output_height;
+    channels = cinfo.output_components;
+    image.resize(static_cast<size_t>(width) * height * channels);
+    while (cinfo.output_scanline < cinfo.output_height)
+    {
+        JSAMPROW row = image.data() + static_cast<size_t>(cinfo.output_scanline) * width * channels;
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return error.num_warnings == 0;
+}
+
+static void roundTrip(uint32_t width, uint32_t height, uint32_t channels)
+{
+    // Smooth gradients survive the compression within a few levels
+    std::vector<uint8_t> frame(static_cast<size_t>(width) * height * channels);
+    for (uint32_t y = 0; y < height; y++)
+        for (uint32_t x = 0; x < width; x++)
+            for (uint32_t c = 0; c < channels; c++)
+                frame[(static_cast<size_t>(y) * width + x) * channels + c] = (x * 255 / width + y * 255 / height * c) / 2 + 40;
+
+    JPEGEncoderPool pool;
+    std::vector<uint8_t> jpeg, image;
+    // The second frame reuses the compressors of the first
+    for (int quality : {60, 90})
+    {
+        ASSERT_TRUE(pool.compress(frame.data(), width, height, channels, quality, jpeg));
+
+        uint32_t w, h, c;
+        ASSERT_TRUE(decode(jpeg, image, w, h, c));
+        ASSERT_EQ(w, width);
+        ASSERT_EQ(h, height);
+        ASSERT_EQ(c, channels);
+
+        double error = 0;
+        for (size_t i = 0; i < frame.size(); i++)
+            error += std::abs(frame[i] - image[i]);
+        EXPECT_LT(error / frame.size(), 2.0);
+    }
+}
+
+TEST(CORE_STREAM_ENCODER, Test_grayStrips)
+{
+    // Several strips, the last one shorter and not a multiple of the MCU
+    roundTrip(640, 363, 1);
+}
+
+TEST(CORE_STREAM_ENCODER, Test_colorStrips)
+{
+    // More than 8 strips, so the restart markers wrap around
+    roundTrip(333, 650, 3);
+}
+
+TEST(CORE_STREAM_ENCODER, Test_singleStrip)
+{
+    roundTrip(64, 20, 1);
+}
+
+TEST(CORE_STREAM_ENCODER, Test_unsupportedFormat)
+{
+    std::vector<uint8_t> frame(16 * 16 * 2), jpeg;
+    JPEGEncoderPool pool;
+    EXPECT_FALSE(pool.compress(frame.data(), 16, 16, 2, 85, jpeg));
+    EXPECT_FALSE(pool.compress(frame.data(), 0, 16, 1, 85, jpeg));
+}
+
+TEST(CORE_STREAM_ENCODER, Test_rateControlTargetBitrate)
+{
+    RateControl rate;
+    rate.setTargetBitrate(800000);
+
+    // 10 FPS at 800 kbit/s leave 10 kB per frame, the frame size follows the quality and the square of the scale
+    double interval = 0.1;
+    for (int i = 0; i < 100; i++)
+    {
+        size_t bytes = 100 * rate.quality() * rate.scale() * rate.scale() * 20;
+        rate.update(bytes, interval);
+    }
+
+    size_t bytes = 100 * rate.quality() * rate.scale() * rate.scale() * 20;
+    EXPECT_LE(bytes, 11000U);
+    EXPECT_GE(bytes, 7000U);
+}
+
+TEST(CORE_STREAM_ENCODER, Test_rateControlTargetFps)
+{
+    RateControl rate;
+    rate.setTargetFps(30);
+
+    // A full scale frame takes twice the 33 ms period to encode, the encode time follows the square of the scale
+    for (int i = 0; i < 100; i++)
+        rate.update(50000, 1.0 / 30, 2.0 / 30 * rate.scale() * rate.scale());
+
+    double encodeTime = 2.0 / 30 * rate.scale() * rate.scale();
+    EXPECT_LE(encodeTime * 30, 1.1);
+    EXPECT_GE(encodeTime * 30, 0.7);
+    // Without a bitrate target the quality stays at the maximum
+    EXPECT_EQ(rate.quality(), 85);
+
+    // Fast encoding brings the full scale back
+    for (int i = 0; i < 30; i++)
+        rate.update(50000, 1.0 / 30, 0.005);
+    EXPECT_EQ(rate.scale(), 1);
+}
+
+TEST(CORE_STREAM_ENCODER, Test_rateControlRecovers)
+{
+    RateControl rate;
+    ASSERT_EQ(rate.quality(), 85);
+    ASSERT_EQ(rate.targetBitrate(), 0);
+
+    // 50 kB at 20 FPS is well under 8 Mbit/s
+    rate.setTargetBitrate(8000000);
+    for (int i = 0; i < 10; i++)
+        rate.update(50000, 0.05);
+    EXPECT_EQ(rate.quality(), 85);
+    EXPECT_EQ(rate.scale(), 1);
+
+    // A target of a tenth of that lowers the quality, then the scale
+    rate.setTargetBitrate(800000);
+    for (int i = 0; i < 30; i++)
+        rate.update(50000, 0.05);
+    EXPECT_EQ(rate.quality(), RateControl::MINIMUM_QUALITY);
+    EXPECT_LT(rate.scale(), 1);
+    EXPECT_GE(rate.scale(), RateControl::MINIMUM_SCALE);
+
+    // Small frames bring the scale back first
+    for (int i = 0; i < 30; i++)
+        rate.update(500, 0.05);
+    EXPECT_EQ(rate.scale(), 1);
+    EXPECT_GT(rate.quality(), RateControl::MINIMUM_QUALITY);
+
+    // Without a target the frames keep the maximum quality, whatever their size
+    rate.setTargetBitrate(0);
+    rate.update(1000000, 0.05);
+    EXPECT_EQ(rate.quality(), 85);
+    EXPECT_EQ(rate.scale(), 1);
+
+    rate.setMaximumQuality(10);
+    EXPECT_EQ(rate.quality(), RateControl::MINIMUM_QUALITY);
+    rate.setMaximumQuality(85);
+    rate.reset();
+    EXPECT_EQ(rate.quality(), 85);
+}
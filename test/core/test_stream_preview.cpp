@@ -0,0 +1,120 @@
+/*******************************************************************************
+ Copyright(c) 2026 INDI Library contributors.
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Library General Public
+ License version 2 as published by the Free Software Foundation.
+ .
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Library General Public License for more details.
+ .
+ You should have received a copy of the GNU Library General Public License
+ along with this library; see the file COPYING.LIB.  If not, write to
+ the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ Boston, MA 02110-1301, USA.
+*******************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include "gammalut16.h"
+#include "downscaler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// The reference gamma curve, as sRGB
+static uint8_t srgb(uint16_t value)
+{
+    double I = value / 65535.0;
+    double p = I <= 0.00304 ? 12.92 * I : 1.055 * std::pow(I, 1 / 2.4) - 0.055;
+    return static_cast<uint8_t>(std::round(255 * p));
+}
+
+TEST(CORE_STREAM_PREVIEW, Test_gammaCurve)
+{
+    std::vector<uint16_t> in(65536 + 7);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = static_cast<uint16_t>(i);
+    std::vector<uint8_t> out(in.size());
+
+    GammaLut16 lut;
+    lut.apply(in.data(), in.size(), out.data());
+    for (size_t i = 0; i < in.size(); i++)
+        ASSERT_NEAR(out[i], srgb(in[i]), 1) << "at " << i;
+}
+
+TEST(CORE_STREAM_PREVIEW, Test_linearCurve)
+{
+    // Larger than a parallel job, with a remainder that is not a multiple of the vector block
+    std::vector<uint16_t> in(1000003);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = static_cast<uint16_t>(i * 7);
+    std::vector<uint8_t> out(in.size());
+
+    GammaLut16 lut;
+    lut.setMode(GammaLut16::MODE_LINEAR);
+    lut.apply(in.data(), in.size(), out.data());
+    for (size_t i = 0; i < in.size(); i++)
+        ASSERT_EQ(out[i], static_cast<uint8_t>(std::lround(in[i] * 255.0 / 65535))) << "at " << i;
+}
+
+TEST(CORE_STREAM_PREVIEW, Test_autoStretch)
+{
+    // A dark background with noise and a few saturated stars
+    std::vector<uint16_t> in(512 * 512);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = static_cast<uint16_t>(1000 + (i * 2654435761u) % 64);
+    for (size_t i = 0; i < in.size(); i += 4099)
+        in[i] = 65535;
+    std::vector<uint8_t> out(in.size());
+
+    GammaLut16 lut;
+    lut.setMode(GammaLut16::MODE_STRETCH);
+    lut.apply(in.data(), in.size(), out.data());
+
+    // The background median lands near a quarter of the range, the stars stay white
+    std::vector<uint8_t> sorted(out);
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    EXPECT_NEAR(sorted[sorted.size() / 2], 64, 4);
+    EXPECT_EQ(out[0], 255);
+}
+
+TEST(CORE_STREAM_PREVIEW, Test_downscaleAverages)
+{
+    // Two by two blocks of a gray frame
+    const std::vector<uint8_t> in =
+    {
+        10, 20, 30, 40,
+        50, 60, 70, 80
+    };
+    std::vector<uint8_t> out(2);
+
+    INDI::Downscaler downscaler;
+    downscaler.scale(in.data(), 4, 2, 1, out.data(), 2, 1);
+    EXPECT_EQ(out[0], 35);
+    EXPECT_EQ(out[1], 55);
+}
+
+TEST(CORE_STREAM_PREVIEW, Test_downscaleFractional)
+{
+    // A 3 to 2 ratio weights the middle RGB pixel half to each output pixel
+    const std::vector<uint8_t> in =
+    {
+        0, 30, 90,  60, 30, 0,  120, 30, 30
+    };
+    std::vector<uint8_t> out(6);
+
+    INDI::Downscaler downscaler;
+    downscaler.scale(in.data(), 3, 1, 3, out.data(), 2, 1);
+    const std::vector<uint8_t> expected = { 20, 30, 60,  100, 30, 20 };
+    EXPECT_EQ(out, expected);
+
+    // A flat frame stays flat at any size
+    std::vector<uint8_t> flat(1920 * 1080, 77), scaled(640 * 360);
+    downscaler.scale(flat.data(), 1920, 1080, 1, scaled.data(), 640, 360);
+    for (auto value : scaled)
+        ASSERT_EQ(value, 77);
+}